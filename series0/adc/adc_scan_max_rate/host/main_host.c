@@ -0,0 +1,352 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC scan plan and DMA refresh timing on the host PL230 model
+ *
+ * Build with the models and the runner of
+ * ../../../series1/ldma/ldma_host_model, see readme.txt. adcPlanCompute()
+ * is first checked on the kit configuration, at 1 Msps and on bad or late
+ * configurations. The stream driver of the example then runs on the PL230
+ * model, with hostProducer() playing the ADC: each call puts the next
+ * result in the data register and raises the channel's request. The DMA
+ * interrupt is held off by a delay, in results, from each completed
+ * buffer, as by a critical section; the delay grows phase by phase. The
+ * stream must stall exactly in the phases where the plan of the same
+ * timing reports adcPlanRefreshLate.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "pl230_model.h"
+#include "host.h"
+#include "dma_stream.h"
+#include "adc_plan.h"
+
+#define DMA_CHANNEL         0
+#define INPUT_COUNT         2
+#define BUFFER_COUNT        6
+#define BUFFER_LENGTH       8
+#define BATCH               4
+
+/* Results per phase of the sweep */
+#define PHASE_LENGTH        (16 * BUFFER_LENGTH)
+
+/* HFPERCLK cycles per result: one ADC clock per cycle, 1 + 12 cycles per
+   conversion and no guard */
+#define RESULT_CYCLES       13
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if ( !(cond) )                                                      \
+    {                                                                   \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+      failures++;                                                       \
+    }                                                                   \
+  } while (0)
+
+/* Interrupt delays of the sweep, in results */
+static const uint32_t delays[] =
+{
+  0, 1, BUFFER_LENGTH / 2, BUFFER_LENGTH - 1, BUFFER_LENGTH,
+  BUFFER_LENGTH + 1, 2 * BUFFER_LENGTH, 0
+};
+
+#define PHASE_COUNT         (sizeof(delays) / sizeof(delays[0]))
+
+dmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][BUFFER_LENGTH];
+
+/* Simulated ADC0->SCANDATA */
+volatile uint32_t adcRegister;
+
+uint32_t samples;
+uint32_t phase;
+uint32_t phaseEnd = PHASE_LENGTH;
+uint32_t phaseStalls[PHASE_COUNT];
+uint32_t stallsBefore;
+bool delaying;
+bool unmasked;
+uint32_t delayed;
+uint32_t lastSample = 0xFFFFUL;
+uint32_t gaps;
+uint32_t overrunCalls;
+uint32_t failures;
+
+/***************************************************************************//**
+ * @brief
+ *   Consumer, checks the results of each buffer
+ ******************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint16_t *buffer = data;
+
+  (void)user;
+  CHECK(length == BUFFER_LENGTH);
+  for (uint32_t i = 1; i < length; i++)
+  {
+    CHECK(buffer[i] == (uint16_t)(buffer[0] + i));
+  }
+
+  if ( overrun )
+  {
+    overrunCalls++;
+  }
+  if ( buffer[0] != (uint16_t)(lastSample + 1) )
+  {
+    /* Every gap must be reported */
+    CHECK(overrun);
+    gaps++;
+  }
+  lastSample = buffer[length - 1];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Plan of the model's timing: one HFPERCLK cycle per core cycle, and the
+ *   DMA interrupt held off by delay results
+ ******************************************************************************/
+static adcPlanStatus_TypeDef modelPlan(uint32_t delay, adcPlan_TypeDef *plan)
+{
+  adcPlanConfig_TypeDef config = {
+    .hfperHz        = 13000000,
+    .coreHz         = 13000000,
+    .adcMaxHz       = 13000000,
+    .inputs         = INPUT_COUNT,
+    .acqCycles      = 1,
+    .resolutionBits = 12,
+    .guardCycles    = 0,
+    .scanRate       = 0,
+    .bufferLength   = BUFFER_LENGTH,
+    .bufferCount    = BUFFER_COUNT,
+    .batch          = BATCH,
+    .dmaCycles      = 1,
+    .irqCycles      = 0,
+    .latencyCycles  = delay * RESULT_CYCLES,
+    .consumerCycles = 0,
+  };
+
+  return adcPlanCompute(&config, plan);
+}
+
+static void checkPlans(void)
+{
+  adcPlanConfig_TypeDef kit = {
+    .hfperHz        = 48000000,
+    .coreHz         = 48000000,
+    .adcMaxHz       = 13000000,
+    .inputs         = 2,
+    .acqCycles      = 1,
+    .resolutionBits = 12,
+    .guardCycles    = 1,
+    .scanRate       = 0,
+    .bufferLength   = 1024,
+    .bufferCount    = 6,
+    .batch          = 4,
+    .dmaCycles      = 12,
+    .irqCycles      = 300,
+    .latencyCycles  = 2000,
+    .consumerCycles = 4,
+  };
+  adcPlanConfig_TypeDef config;
+  adcPlan_TypeDef plan;
+
+  /* The kit: 12 MHz ADC clock, 108 cycles per scan of 2 inputs */
+  CHECK(adcPlanCompute(&kit, &plan) == adcPlanOk);
+  CHECK((plan.prescale == 3) && (plan.adcHz == 12000000));
+  CHECK((plan.timerTop == 107) && (plan.scanCycles == 108));
+  CHECK(plan.sampleRate == 888889);
+  CHECK(plan.bufferCycles == 108 * 512);
+  CHECK(plan.readMargin == 52 - 12);
+  CHECK(plan.refreshMargin == 108 * 512 - 2000 - 300);
+  CHECK(plan.queueMargin == 108 * 512 - 4 * 1024);
+  CHECK((plan.dmaLoad == 222) && (plan.cpuLoad == 79));
+  printf("kit: %lu samples/s, ADC %lu Hz, TIMER top %lu, "
+         "DMA %lu/1000, CPU %lu/1000\n",
+         (unsigned long)plan.sampleRate, (unsigned long)plan.adcHz,
+         (unsigned long)plan.timerTop, (unsigned long)plan.dmaLoad,
+         (unsigned long)plan.cpuLoad);
+
+  /* 1 Msps needs a 13 MHz ADC clock, from HFPERCLK at 39 MHz */
+  config = kit;
+  config.hfperHz = 39000000;
+  config.coreHz = 39000000;
+  config.guardCycles = 0;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanOk);
+  CHECK((plan.adcHz == 13000000) && (plan.sampleRate == 1000000));
+
+  /* A slower scan rate, the core at twice HFPERCLK */
+  config = kit;
+  config.hfperHz = 24000000;
+  config.scanRate = 100000;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanOk);
+  CHECK((plan.timerTop == 239) && (plan.scanCycles == 480));
+  CHECK(plan.sampleRate == 200000);
+  config.scanRate = 500000;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanAdcTooSlow);
+  config.scanRate = 100;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanBadConfig);
+
+  /* Bad configurations */
+  config = kit;
+  config.inputs = 3;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanBadConfig);
+  config = kit;
+  config.inputs = 9;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanBadConfig);
+  config = kit;
+  config.coreHz = 60000000;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanBadConfig);
+  config = kit;
+  config.bufferCount = config.batch + 1;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanBadConfig);
+  config = kit;
+  config.resolutionBits = 10;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanBadConfig);
+
+  /* Late configurations */
+  config = kit;
+  config.dmaCycles = 52;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanReadLate);
+  config = kit;
+  config.bufferLength = 16;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanRefreshLate);
+  CHECK(plan.refreshMargin == 108 * 8 - 2000 - 300);
+  config = kit;
+  config.consumerCycles = 60;
+  CHECK(adcPlanCompute(&config, &plan) == adcPlanConsumerLate);
+}
+
+static void report(void)
+{
+  adcPlan_TypeDef plan;
+  adcPlanStatus_TypeDef status;
+  uint32_t p;
+
+  printf("delay  margin  plan         stalls\n");
+  for (p = 0; p < PHASE_COUNT; p++)
+  {
+    status = modelPlan(delays[p], &plan);
+    printf("%5lu  %6ld  %-11s  %6lu\n", (unsigned long)delays[p],
+           (long)plan.refreshMargin,
+           (status == adcPlanOk) ? "ok" :
+           (status == adcPlanRefreshLate) ? "refresh late" : "other",
+           (unsigned long)phaseStalls[p]);
+
+    /* The stream stalls exactly when the plan says the refresh is late */
+    CHECK((status == adcPlanOk) || (status == adcPlanRefreshLate));
+    CHECK((status == adcPlanRefreshLate) == (phaseStalls[p] > 0));
+  }
+
+  /* A stall is reported even when the interrupt came just in time for the
+     next result */
+  CHECK(overrunCalls >= gaps);
+  CHECK(dmaStreamStalls(&stream) == stallsBefore);
+  printf("samples %lu, overruns %lu, stalls %lu, gaps %lu\n",
+         (unsigned long)samples,
+         (unsigned long)dmaStreamOverruns(&stream),
+         (unsigned long)dmaStreamStalls(&stream), (unsigned long)gaps);
+  printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+}
+
+bool hostProducer(void)
+{
+  uint32_t bit = 1UL << DMA_CHANNEL;
+
+  /* The delayed interrupt has run */
+  if ( unmasked )
+  {
+    DMA->IEN &= ~bit;
+    unmasked = false;
+  }
+
+  /* A buffer is done: its interrupt waits for delays[phase] results */
+  if ( !delaying && (pl230ModelIntGet() & bit) )
+  {
+    delaying = true;
+    delayed = 0;
+  }
+  if ( delaying && (delayed == delays[phase]) )
+  {
+    delaying = false;
+    unmasked = true;
+    DMA->IEN |= bit;
+    return true;
+  }
+
+  /* Next phase, between two interrupts */
+  if ( !delaying && (samples >= phaseEnd) )
+  {
+    phaseStalls[phase] = dmaStreamStalls(&stream) - stallsBefore;
+    stallsBefore = dmaStreamStalls(&stream);
+    phaseEnd += PHASE_LENGTH;
+    if ( ++phase == PHASE_COUNT )
+    {
+      report();
+      return false;
+    }
+  }
+
+  /* A stalled channel ignores the request, the result is lost */
+  adcRegister = (uint16_t)samples++;
+  if ( delaying )
+  {
+    delayed++;
+  }
+  pl230ModelRequest(bit);
+  return true;
+}
+
+int main(void)
+{
+  DMA_Init_TypeDef dmaInit;
+  dmaStreamConfig_TypeDef config = {
+    .channel     = DMA_CHANNEL,
+    .select      = 0,
+    .source      = &adcRegister,
+    .size        = dmaDataSize2,
+    .arbRate     = dmaArbitrate1,
+    .highPri     = true,
+    .storage     = streamBuffers,
+    .bufferCount = BUFFER_COUNT,
+    .length      = BUFFER_LENGTH,
+    .batch       = BATCH,
+    .callback    = consume,
+    .user        = NULL,
+  };
+
+  CHIP_Init();
+  checkPlans();
+
+  dmaInit.hprot        = 0;
+  dmaInit.controlBlock = dmaControlBlock;
+  DMA_Init(&dmaInit);
+
+  if ( dmaStreamInit(&stream, &config) != dmaStreamOk )
+  {
+    printf("dmaStreamInit failed\n");
+    return 1;
+  }
+  dmaStreamStart(&stream);
+
+  /* The interrupt only runs when hostProducer() lets it */
+  DMA->IEN &= ~(1UL << DMA_CHANNEL);
+
+  while (1)
+  {
+    dmaStreamWait(&stream);
+    dmaStreamProcess(&stream);
+  }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************//**
+ * @file  adc_plan.h
+ * @brief Timing plan of a continuous ADC scan streamed by the Series 0 DMA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_PLAN_H
+#define ADC_PLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest ADC prescaler, PRESC in ADC_CTRL
+#define ADC_PLAN_MAX_PRESCALE   127
+
+typedef enum {
+  adcPlanOk,
+  adcPlanBadConfig,         // Zero or out of range values, or buffers not a
+                            // whole number of scans
+  adcPlanAdcTooSlow,        // Scan rate above what the ADC can convert
+  adcPlanReadLate,          // The DMA cannot read a result before the next
+                            // one overwrites it
+  adcPlanRefreshLate,       // The other buffer is full before the DMA
+                            // interrupt has refreshed a descriptor
+  adcPlanConsumerLate       // The consumer cannot keep up
+} adcPlanStatus_TypeDef;
+
+typedef struct {
+  uint32_t hfperHz;         // HFPERCLK, clocks the ADC and the TIMER
+  uint32_t coreHz;          // HFCORECLK, a multiple of hfperHz
+  uint32_t adcMaxHz;        // Fastest ADC clock, 13 MHz on Series 0
+  uint32_t inputs;          // Inputs per scan
+  uint32_t acqCycles;       // Acquisition time, in ADC clock cycles
+  uint32_t resolutionBits;  // 12, 8 or 6
+  uint32_t guardCycles;     // ADC clock cycles between scans
+  uint32_t scanRate;        // Scans per second, 0 for the fastest
+  uint32_t bufferLength;    // Samples per buffer, a multiple of inputs
+  uint32_t bufferCount;
+  uint32_t batch;           // Buffers per wake-up of the consumer
+  uint32_t dmaCycles;       // Core cycles per DMA transfer
+  uint32_t irqCycles;       // Core cycles of the DMA interrupt
+  uint32_t latencyCycles;   // Longest time the DMA interrupt can be held off
+  uint32_t consumerCycles;  // Core cycles per sample in the consumer
+} adcPlanConfig_TypeDef;
+
+typedef struct {
+  uint32_t prescale;        // ADC clock = hfperHz / (prescale + 1)
+  uint32_t adcHz;
+  uint32_t timerTop;        // TIMER top, HFPERCLK cycles per scan - 1
+  uint32_t sampleRate;      // Conversions per second, all inputs
+  uint32_t scanCycles;      // Core cycles per scan
+  uint32_t bufferCycles;    // Core cycles to fill a buffer
+  int32_t readMargin;       // Core cycles left to read a result
+  int32_t refreshMargin;    // Core cycles left to refresh a descriptor
+  int32_t queueMargin;      // Core cycles the consumer can be late once woken
+  uint32_t dmaLoad;         // Share of the core cycles taken by the DMA, per
+                            // mille
+  uint32_t cpuLoad;         // Share taken by the interrupt and the consumer,
+                            // per mille
+} adcPlan_TypeDef;
+
+adcPlanStatus_TypeDef adcPlanCompute(const adcPlanConfig_TypeDef *config,
+                                     adcPlan_TypeDef *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_PLAN_H
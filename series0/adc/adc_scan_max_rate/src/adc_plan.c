@@ -0,0 +1,141 @@
+/***************************************************************************//**
+ * @file adc_plan.c
+ * @brief Timing plan of a continuous ADC scan streamed by the Series 0 DMA.
+ *
+ * A TIMER overflow starts each scan through PRS, and the DMA moves every
+ * result into a ring of buffers with a ping-pong cycle, see dma_stream.c.
+ * The plan picks the ADC prescaler and the TIMER top for a scan rate, or
+ * the fastest rate the ADC can convert, and tells how much time is left at
+ * each of the three deadlines of the stream:
+ *   - read: the ADC has no FIFO on Series 0, so the DMA must read a result
+ *     before the next conversion of the scan ends
+ *   - refresh: when one descriptor is done, the DMA interrupt must refresh
+ *     it before the other one has filled its buffer, or the cycle stops
+ *   - queue: once woken, the consumer must give a buffer back before the
+ *     DMA has to drop the oldest one
+ *
+ * A conversion takes the acquisition time plus one ADC clock cycle per bit.
+ * Nothing here touches the hardware, so it runs as is on a host.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "adc_plan.h"
+
+// Largest number of scan inputs, channels 0 to 7 single-ended
+#define MAX_INPUTS      8
+
+// Largest buffer, n_minus_1 of a DMA descriptor is 10 bits
+#define MAX_LENGTH      1024
+
+static int32_t clampMargin(int64_t value)
+{
+  if (value > INT32_MAX) {
+    return INT32_MAX;
+  }
+  if (value < INT32_MIN) {
+    return INT32_MIN;
+  }
+  return (int32_t)value;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Compute the plan of a configuration
+ *
+ * @details
+ *   The plan is filled unless the status is adcPlanBadConfig or
+ *   adcPlanAdcTooSlow; with one of the late statuses, the margins tell by
+ *   how much.
+ ******************************************************************************/
+adcPlanStatus_TypeDef adcPlanCompute(const adcPlanConfig_TypeDef *config,
+                                     adcPlan_TypeDef *plan)
+{
+  uint32_t prescale, period, ratio, conversion, scan, perBuffer;
+  int64_t consumeCycles;
+
+  if ((config->hfperHz == 0) || (config->adcMaxHz == 0)
+      || (config->coreHz < config->hfperHz)
+      || (config->coreHz % config->hfperHz != 0)
+      || (config->inputs == 0) || (config->inputs > MAX_INPUTS)
+      || ((config->resolutionBits != 12) && (config->resolutionBits != 8)
+          && (config->resolutionBits != 6))
+      || (config->bufferLength == 0) || (config->bufferLength > MAX_LENGTH)
+      || (config->bufferLength % config->inputs != 0)
+      || (config->batch == 0)
+      || (config->bufferCount < config->batch + 2)) {
+    return adcPlanBadConfig;
+  }
+
+  // Fastest ADC clock not above adcMaxHz
+  prescale = (config->hfperHz + config->adcMaxHz - 1) / config->adcMaxHz - 1;
+  if (prescale > ADC_PLAN_MAX_PRESCALE) {
+    return adcPlanBadConfig;
+  }
+
+  // HFPERCLK cycles per conversion and per scan
+  conversion = (config->acqCycles + config->resolutionBits) * (prescale + 1);
+  scan = conversion * config->inputs + config->guardCycles * (prescale + 1);
+
+  if (config->scanRate == 0) {
+    period = scan;
+  } else {
+    period = (config->hfperHz + config->scanRate / 2) / config->scanRate;
+    if (period < scan) {
+      return adcPlanAdcTooSlow;
+    }
+  }
+  if ((period == 0) || (period > 0x10000)) {
+    return adcPlanBadConfig;
+  }
+
+  ratio = config->coreHz / config->hfperHz;
+  perBuffer = config->bufferLength / config->inputs;
+
+  plan->prescale = prescale;
+  plan->adcHz = config->hfperHz / (prescale + 1);
+  plan->timerTop = period - 1;
+  plan->sampleRate = (uint32_t)(((uint64_t)config->hfperHz * config->inputs
+                                 + period / 2) / period);
+  plan->scanCycles = period * ratio;
+  plan->bufferCycles = plan->scanCycles * perBuffer;
+
+  // The next result of the scan ends a conversion later
+  plan->readMargin = clampMargin((int64_t)conversion * ratio
+                                 - config->dmaCycles);
+
+  plan->refreshMargin = clampMargin((int64_t)plan->bufferCycles
+                                    - config->latencyCycles
+                                    - config->irqCycles);
+
+  // Woken with a batch ready and two buffers filling, the consumer frees
+  // its first buffer before the ring is full
+  consumeCycles = (int64_t)config->consumerCycles * config->bufferLength;
+  plan->queueMargin = clampMargin((int64_t)(config->bufferCount - 1
+                                            - config->batch)
+                                  * plan->bufferCycles - consumeCycles);
+
+  plan->dmaLoad = (uint32_t)((uint64_t)config->dmaCycles * config->inputs
+                             * 1000 / plan->scanCycles);
+  plan->cpuLoad = (uint32_t)((consumeCycles + config->irqCycles) * 1000
+                             / plan->bufferCycles);
+
+  if (plan->readMargin <= 0) {
+    return adcPlanReadLate;
+  }
+  if (plan->refreshMargin <= 0) {
+    return adcPlanRefreshLate;
+  }
+  if ((plan->queueMargin <= 0) || (plan->dmaLoad + plan->cpuLoad >= 1000)) {
+    return adcPlanConsumerLate;
+  }
+  return adcPlanOk;
+}
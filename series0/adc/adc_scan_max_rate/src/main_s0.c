@@ -0,0 +1,368 @@
+/**************************************************************************//**
+ * @file
+ * @brief Continuous ADC scan at the highest rate: TIMER0 starts the scans
+ * through PRS, and the DMA streams every result into a ring of buffers with
+ * a ping-pong cycle refreshed in its interrupt.
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_timer.h"
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "dma_stream.h"
+#include "adc_plan.h"
+
+// Set to 1 for the throughput and jitter measurement build
+#ifndef ADC_STREAM_MEASURE
+#define ADC_STREAM_MEASURE  0
+#endif
+
+// Fastest ADC clock on Series 0
+#define ADC_FREQ            13000000
+
+#define DMA_CHANNEL         0
+#define PRS_CHANNEL         0
+
+// Scan inputs, see README for the corresponding EXP header pins
+#define SCAN_INPUTS         (ADC_SCANCTRL_INPUTMASK_CH6 | ADC_SCANCTRL_INPUTMASK_CH7)
+#define INPUT_COUNT         2
+
+// Scans per second, 0 for the fastest the ADC can convert
+#define SCAN_RATE           0
+
+// ADC clock cycles left between scans, so that a trigger never finds the
+// previous scan still running
+#define SCAN_GUARD          1
+
+// 6 buffers of 1024 results, the main loop wakes up once every 4 buffers
+#define BUFFER_COUNT        6
+#define BUFFER_LENGTH       1024
+#define BATCH               4
+
+// Estimates for the plan: core cycles per DMA transfer, per DMA interrupt
+// with the refresh, and per sample in the consumer; the interrupt may be
+// held off by critical sections of up to LATENCY_CYCLES
+#define DMA_CYCLES          12
+#define IRQ_CYCLES          300
+#define CONSUMER_CYCLES     4
+#define LATENCY_CYCLES      2000
+
+#if (ADC_STREAM_MEASURE)
+typedef struct {
+  float sampleRate;         // Samples per second delivered to the consumer
+  uint32_t plannedRate;     // Samples per second of the plan
+  int32_t minLatency;       // Core cycles from the planned end of a buffer
+  int32_t maxLatency;       // to the consumer, relative to the first buffer
+  uint32_t jitter;          // maxLatency - minLatency
+  uint32_t buffers;         // Buffers measured since the last restart
+} measureReport_TypeDef;
+#endif
+
+// Stream of ADC results
+dmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][BUFFER_LENGTH];
+
+// Plan of the acquisition
+adcPlanConfig_TypeDef planConfig = {
+  0, 0, ADC_FREQ, INPUT_COUNT, 1, 12, SCAN_GUARD, SCAN_RATE,
+  BUFFER_LENGTH, BUFFER_COUNT, BATCH,
+  DMA_CYCLES, IRQ_CYCLES, LATENCY_CYCLES, CONSUMER_CYCLES
+};
+
+// Values to watch in the debugger
+adcPlan_TypeDef plan;
+adcPlanStatus_TypeDef planStatus;
+dmaStreamStatus_TypeDef streamStatus;
+uint32_t channelMean[INPUT_COUNT];
+volatile uint32_t bufferCount;
+volatile uint32_t wakeups;
+volatile uint32_t restarts;
+
+#if (ADC_STREAM_MEASURE)
+measureReport_TypeDef measure;
+
+static uint32_t firstTime;
+static uint32_t lastTime;
+static uint64_t elapsed;
+static uint32_t samples;
+#endif
+
+#if (ADC_STREAM_MEASURE)
+/**************************************************************************//**
+ * @brief Start the core cycle counter
+ *****************************************************************************/
+static void initCycleCounter(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**************************************************************************//**
+ * @brief Time the delivery of a buffer against the plan
+ *****************************************************************************/
+static void measureBuffer(uint32_t length)
+{
+  uint32_t now = DWT->CYCCNT;
+  int32_t latency;
+
+  if (measure.buffers == 0)
+  {
+    firstTime = now;
+    lastTime = now;
+    elapsed = 0;
+    samples = 0;
+    measure.minLatency = 0;
+    measure.maxLatency = 0;
+  }
+  else
+  {
+    elapsed += now - lastTime;
+    lastTime = now;
+    samples += length;
+
+    // Buffers end every plan.bufferCycles after the first one
+    latency = (int32_t)(now - firstTime - measure.buffers * plan.bufferCycles);
+    if (latency < measure.minLatency)
+    {
+      measure.minLatency = latency;
+    }
+    if (latency > measure.maxLatency)
+    {
+      measure.maxLatency = latency;
+    }
+    measure.jitter = (uint32_t)(measure.maxLatency - measure.minLatency);
+    measure.sampleRate = (float)samples * CMU_ClockFreqGet(cmuClock_CORE)
+                         / (float)elapsed;
+  }
+  measure.buffers++;
+}
+#endif
+
+/**************************************************************************//**
+ * @brief Stream consumer, averages each input over a buffer
+ *
+ * A buffer holds whole scans, inputs in ascending order.
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint16_t *results = data;
+  uint32_t sum[INPUT_COUNT] = { 0 };
+  uint32_t i, ch;
+
+  (void)overrun;
+  (void)user;
+
+#if (ADC_STREAM_MEASURE)
+  measureBuffer(length);
+#endif
+
+  for (i = 0; i < length; i += INPUT_COUNT)
+  {
+    for (ch = 0; ch < INPUT_COUNT; ch++)
+    {
+      sum[ch] += results[i + ch];
+    }
+  }
+  for (ch = 0; ch < INPUT_COUNT; ch++)
+  {
+    channelMean[ch] = sum[ch] / (length / INPUT_COUNT);
+  }
+  bufferCount++;
+}
+
+/**************************************************************************//**
+ * @brief Clock initialization, the core and HFPERCLK from the HFXO
+ *****************************************************************************/
+void initClocks(void)
+{
+  CMU_OscillatorEnable(cmuOsc_HFXO, true, true);
+  CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFXO);
+
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  planConfig.hfperHz = CMU_ClockFreqGet(cmuClock_HFPER);
+  planConfig.coreHz = CMU_ClockFreqGet(cmuClock_CORE);
+}
+
+/**************************************************************************//**
+ * @brief TIMER0 initialization, overflows once per scan and pulses
+ * PRS_CHANNEL
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  // Started once the DMA is ready
+  timerInit.enable = false;
+  TIMER_TopSet(TIMER0, plan.timerTop);
+  TIMER_Init(TIMER0, &timerInit);
+
+  // TIMER0 overflow starts a scan through PRS
+  CMU_ClockEnable(cmuClock_PRS, true);
+  PRS_SourceSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_TIMER0,
+                      PRS_CH_CTRL_SIGSEL_TIMER0OF, prsEdgeOff);
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization, scans started by PRS_CHANNEL
+ *****************************************************************************/
+void initAdc(void)
+{
+  // Declare init structs
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitScan_TypeDef initScan = ADC_INITSCAN_DEFAULT;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+
+  // Clock of the plan, and no warm-up between scans
+  init.timebase   = ADC_TimebaseCalc(0);
+  init.prescale   = (uint8_t)plan.prescale;
+  init.warmUpMode = adcWarmupKeepADCWarm;
+
+  // Add external ADC inputs to scan. See README for corresponding EXP header pin.
+  initScan.input      = SCAN_INPUTS;
+  initScan.diff       = false;
+  initScan.reference  = adcRef2V5;
+  initScan.resolution = adcRes12Bit;
+  initScan.acqTime    = adcAcqTime1;
+
+  // Enable PRS trigger and select channel 0
+  initScan.prsEnable = true;
+  initScan.prsSel    = adcPRSSELCh0;
+
+  // Initialize ADC
+  ADC_Init(ADC0, &init);
+  ADC_InitScan(ADC0, &initScan);
+}
+
+/**************************************************************************//**
+ * @brief DMA initialization, and the stream of ADC results
+ *****************************************************************************/
+void initDma(void)
+{
+  DMA_Init_TypeDef dmaInit;
+  dmaStreamConfig_TypeDef config;
+
+  CMU_ClockEnable(cmuClock_DMA, true);
+
+  dmaInit.hprot        = 0;
+  dmaInit.controlBlock = dmaControlBlock;
+  DMA_Init(&dmaInit);
+
+  // One 16-bit result per request, at high priority: the ADC has no FIFO,
+  // and the next result overwrites this one
+  config.channel     = DMA_CHANNEL;
+  config.select      = DMAREQ_ADC0_SCAN;
+  config.source      = &ADC0->SCANDATA;
+  config.size        = dmaDataSize2;
+  config.arbRate     = dmaArbitrate1;
+  config.highPri     = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.length      = BUFFER_LENGTH;
+  config.batch       = BATCH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  streamStatus = dmaStreamInit(&stream, &config);
+}
+
+/**************************************************************************//**
+ * @brief Start the stream, then the scans
+ *
+ * A result that is not read in time is lost, and the inputs of the
+ * following results are no longer known, as Series 0 results do not carry
+ * their input: the scans are restarted from a fresh stream.
+ *****************************************************************************/
+static void startAcquisition(void)
+{
+  TIMER_Enable(TIMER0, false);
+  dmaStreamStop(&stream);
+
+  // Let the scan end, then drop its result and the overflow
+  ADC0->CMD = ADC_CMD_SCANSTOP;
+  while (ADC0->STATUS & ADC_STATUS_SCANACT);
+  (void)ADC0->SCANDATA;
+  ADC_IntClear(ADC0, ADC_IF_SCANOF);
+
+#if (ADC_STREAM_MEASURE)
+  measure.buffers = 0;
+#endif
+
+  dmaStreamStart(&stream);
+  TIMER_CounterSet(TIMER0, 0);
+  TIMER_Enable(TIMER0, true);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  // Chip errata
+  CHIP_Init();
+
+  initClocks();
+
+  // Prescaler, TIMER top and margins of the acquisition
+  planStatus = adcPlanCompute(&planConfig, &plan);
+  if ((planStatus == adcPlanBadConfig) || (planStatus == adcPlanAdcTooSlow))
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+#if (ADC_STREAM_MEASURE)
+  initCycleCounter();
+  measure.plannedRate = plan.sampleRate;
+#endif
+
+  initAdc();
+  initDma();
+  initTimer();
+  if (streamStatus != dmaStreamOk)
+  {
+    while (1);
+  }
+  startAcquisition();
+
+  // Infinite loop
+  while (1)
+  {
+    // Sleep in EM1 until BATCH buffers are filled
+    dmaStreamWait(&stream);
+    wakeups++;
+
+    // Results lost, restart on whole scans
+    if (ADC_IntGet(ADC0) & ADC_IF_SCANOF)
+    {
+      restarts++;
+      startAcquisition();
+      continue;
+    }
+
+    // Average the filled buffers
+    dmaStreamProcess(&stream);
+  }
+}
@@ -0,0 +1,220 @@
+/**************************************************************************//**
+ * @file
+ * @brief DMA Ping-Pong Streaming on the host PL230 model
+ *
+ * Build with the models and the runner of
+ * ../../../series1/ldma/ldma_host_model, see readme.txt. hostProducer()
+ * plays the ADC: each call puts the next sample number in the data
+ * register and raises the channel's request. The run has four phases:
+ *   1) the consumer keeps up, and is woken once per batch of buffers
+ *   2) the consumer pauses, so buffers are dropped as overruns
+ *   3) the DMA interrupt is masked, as by a long critical section, so both
+ *      descriptors are done and the DMA stalls until it is unmasked
+ *   4) the consumer keeps up again
+ * The consumer checks that each buffer holds consecutive samples, and that
+ * every gap between buffers was reported as an overrun.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "pl230_model.h"
+#include "host.h"
+#include "dma_stream.h"
+
+#define DMA_CHANNEL         0
+#define BUFFER_COUNT        6
+#define BUFFER_LENGTH       8
+#define BATCH               4
+
+/* Phases, in samples */
+#define PAUSE_START         (40 * BUFFER_LENGTH)
+#define PAUSE_END           (50 * BUFFER_LENGTH)
+#define MASK_START          (70 * BUFFER_LENGTH + 3)
+#define MASK_END            (73 * BUFFER_LENGTH)
+#define SAMPLE_COUNT        (100 * BUFFER_LENGTH)
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if ( !(cond) )                                                      \
+    {                                                                   \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+      failures++;                                                       \
+    }                                                                   \
+  } while (0)
+
+dmaStream_TypeDef stream;
+uint32_t streamBuffers[BUFFER_COUNT][BUFFER_LENGTH];
+
+/* Simulated ADC0->SINGLEDATA */
+volatile uint32_t adcRegister;
+
+uint32_t samples;
+volatile bool paused;
+uint32_t buffersConsumed;
+uint32_t lastSample = 0xFFFFFFFFUL;
+uint32_t gaps;
+uint32_t overrunCalls;
+uint32_t phase1Wakeups;
+uint32_t phase1Interrupts;
+uint32_t failures;
+
+/***************************************************************************//**
+ * @brief
+ *   Consumer, checks the samples of each buffer
+ ******************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint32_t *buffer = data;
+
+  (void)user;
+  CHECK(length == BUFFER_LENGTH);
+  for (uint32_t i = 1; i < length; i++)
+  {
+    CHECK(buffer[i] == buffer[0] + i);
+  }
+
+  if ( overrun )
+  {
+    overrunCalls++;
+  }
+  if ( buffer[0] != lastSample + 1 )
+  {
+    /* Every gap must be reported */
+    CHECK(overrun);
+    gaps++;
+  }
+  lastSample = buffer[length - 1];
+  buffersConsumed++;
+}
+
+static uint32_t dmaInterrupts(void)
+{
+  dmaModelStats_TypeDef stats;
+
+  pl230ModelGetStats(&stats);
+  return stats.doneCount[DMA_CHANNEL];
+}
+
+static void report(void)
+{
+  uint32_t interrupts = dmaInterrupts();
+
+  CHECK(phase1Wakeups <= phase1Interrupts / BATCH + 1);
+  CHECK(dmaStreamOverruns(&stream) > 0);
+  CHECK(dmaStreamStalls(&stream) == 1);
+  CHECK(gaps >= 2);
+  CHECK(overrunCalls == gaps);
+  CHECK(lastSample >= SAMPLE_COUNT - BATCH * BUFFER_LENGTH);
+
+  printf("phase 1: %lu DMA interrupts, %lu wake-ups with a batch of %d\n",
+         (unsigned long)phase1Interrupts, (unsigned long)phase1Wakeups, BATCH);
+  printf("samples %lu, buffers consumed %lu, DMA interrupts %lu, wake-ups %lu\n",
+         (unsigned long)samples, (unsigned long)buffersConsumed,
+         (unsigned long)interrupts, (unsigned long)hostWakeups);
+  printf("overruns %lu, stalls %lu, gaps %lu\n",
+         (unsigned long)dmaStreamOverruns(&stream),
+         (unsigned long)dmaStreamStalls(&stream), (unsigned long)gaps);
+  printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+}
+
+bool hostProducer(void)
+{
+  if ( samples == SAMPLE_COUNT )
+  {
+    report();
+    return false;
+  }
+
+  switch ( samples )
+  {
+    case PAUSE_START:
+      phase1Interrupts = dmaInterrupts();
+      phase1Wakeups = hostWakeups;
+      paused = true;
+      break;
+
+    case PAUSE_END:
+      paused = false;
+      break;
+
+    case MASK_START:
+      DMA->IEN &= ~(1UL << DMA_CHANNEL);
+      break;
+
+    case MASK_END:
+      DMA->IEN |= 1UL << DMA_CHANNEL;
+      break;
+  }
+
+  /* A stalled channel ignores the request, the sample is lost */
+  adcRegister = samples++;
+  pl230ModelRequest(1UL << DMA_CHANNEL);
+  return true;
+}
+
+int main(void)
+{
+  DMA_Init_TypeDef dmaInit;
+  dmaStreamConfig_TypeDef config = {
+    .channel     = DMA_CHANNEL,
+    .select      = 0,
+    .source      = &adcRegister,
+    .size        = dmaDataSize4,
+    .arbRate     = dmaArbitrate1,
+    .highPri     = false,
+    .storage     = streamBuffers,
+    .bufferCount = BUFFER_COUNT,
+    .length      = BUFFER_LENGTH,
+    .batch       = BATCH,
+    .callback    = consume,
+    .user        = NULL,
+  };
+
+  CHIP_Init();
+
+  dmaInit.hprot        = 0;
+  dmaInit.controlBlock = dmaControlBlock;
+  DMA_Init(&dmaInit);
+
+  /* Bad configurations */
+  config.bufferCount = BATCH + 1;
+  CHECK(dmaStreamInit(&stream, &config) == dmaStreamBadConfig);
+  config.bufferCount = BUFFER_COUNT;
+  config.length = DMA_STREAM_MAX_LENGTH + 1;
+  CHECK(dmaStreamInit(&stream, &config) == dmaStreamBadConfig);
+  config.length = BUFFER_LENGTH;
+
+  if ( dmaStreamInit(&stream, &config) != dmaStreamOk )
+  {
+    printf("dmaStreamInit failed\n");
+    return 1;
+  }
+  dmaStreamStart(&stream);
+
+  while (1)
+  {
+    if ( paused )
+    {
+      EMU_EnterEM1();
+    }
+    else
+    {
+      dmaStreamWait(&stream);
+      dmaStreamProcess(&stream);
+    }
+  }
+}
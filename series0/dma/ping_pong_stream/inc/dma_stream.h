@@ -0,0 +1,92 @@
+/***************************************************************************//**
+ * @file  dma_stream.h
+ * @brief Ping-pong peripheral-to-memory streaming on the Series 0 DMA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef DMA_STREAM_H
+#define DMA_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_dma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change this to allow more buffers per stream
+#define DMA_STREAM_MAX_BUFFERS    8
+
+// Units per buffer, n_minus_1 of a descriptor is 10 bits
+#define DMA_STREAM_MAX_LENGTH     1024
+
+typedef enum {
+  dmaStreamOk,
+  dmaStreamBadConfig        // Buffer count, batch, length or storage not usable
+} dmaStreamStatus_TypeDef;
+
+// Called with each filled buffer, in order. The data is still in the
+// stream's buffer and is given back to the DMA when the callback returns.
+// 'overrun' is true if data was lost just before this buffer.
+typedef void (*dmaStreamCallback_TypeDef)(const void *data, uint32_t length,
+                                          bool overrun, void *user);
+
+typedef struct {
+  unsigned int channel;
+  uint32_t select;                    // Peripheral request, e.g. DMAREQ_ADC0_SINGLE
+  const volatile void *source;        // Peripheral data register
+  DMA_DataSize_TypeDef size;          // Unit size of the data register
+  DMA_ArbiterConfig_TypeDef arbRate;  // Units per request, dmaArbitrate1 for one
+  bool highPri;
+  void *storage;                      // bufferCount * length units
+  uint32_t bufferCount;               // At least batch + 2
+  uint32_t length;                    // Units per buffer
+  uint32_t batch;                     // Filled buffers per wake-up
+  dmaStreamCallback_TypeDef callback;
+  void *user;                         // Passed to the callback
+} dmaStreamConfig_TypeDef;
+
+// The primary and alternate descriptors fill the buffers in turn, and the
+// DMA callback of each one gives it the next free buffer
+typedef struct {
+  dmaStreamConfig_TypeDef config;
+  DMA_CB_TypeDef cb;
+  uint32_t unitBytes;
+  bool fillPrimary;             // Descriptor filling the 'fill' buffer
+  volatile uint32_t fill;       // Oldest buffer being filled
+  volatile uint32_t tail;       // Oldest filled buffer
+  volatile uint32_t ready;      // Filled buffers not yet consumed
+  volatile uint32_t overruns;   // Buffers lost, the consumer was late
+  volatile uint32_t stalls;     // DMA restarts, the interrupt was late
+  volatile uint32_t gapBefore;  // Buffers following lost data, one bit each
+  volatile bool busy;           // Callback running on the tail buffer
+  volatile bool dropped;        // Tail buffer was lost during the callback
+  volatile bool running;
+} dmaStream_TypeDef;
+
+dmaStreamStatus_TypeDef dmaStreamInit(dmaStream_TypeDef *stream,
+                                      const dmaStreamConfig_TypeDef *config);
+void dmaStreamStart(dmaStream_TypeDef *stream);
+void dmaStreamStop(dmaStream_TypeDef *stream);
+
+void dmaStreamWait(dmaStream_TypeDef *stream);
+uint32_t dmaStreamProcess(dmaStream_TypeDef *stream);
+
+uint32_t dmaStreamReady(const dmaStream_TypeDef *stream);
+uint32_t dmaStreamOverruns(const dmaStream_TypeDef *stream);
+uint32_t dmaStreamStalls(const dmaStream_TypeDef *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DMA_STREAM_H
@@ -0,0 +1,300 @@
+/***************************************************************************//**
+ * @file dma_stream.c
+ * @brief Ping-pong peripheral-to-memory streaming on the Series 0 DMA.
+ *
+ * The primary and alternate descriptors of a ping-pong cycle fill a ring of
+ * buffers in turn. When one of them is done, the DMA callback counts its
+ * buffer as filled and refreshes the descriptor with the next free buffer
+ * while the other one is filling, so the cycle never ends.
+ *
+ * The refresh needs an interrupt per buffer, but it is short, and the
+ * consumer is woken only once every 'batch' buffers: dmaStreamWait() sleeps
+ * with SLEEPONEXIT set, so the MCU goes back to sleep after each interrupt
+ * until the callback clears it.
+ *
+ * Data is lost in two ways, both reported to the consumer:
+ *   - overrun: all buffers are filled and not consumed, the DMA then moves
+ *     on to the oldest one, which is dropped
+ *   - stall: the interrupt came so late that both descriptors were done,
+ *     and the DMA stopped until the callback restarted it
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "em_device.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "dma_stream.h"
+
+static uint32_t next(const dmaStream_TypeDef *stream, uint32_t index)
+{
+  return (index + 1 < stream->config.bufferCount) ? index + 1 : 0;
+}
+
+static uint8_t *buffer(const dmaStream_TypeDef *stream, uint32_t index)
+{
+  return (uint8_t *)stream->config.storage
+         + (index * stream->config.length * stream->unitBytes);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    The oldest buffer being filled is full: queue it, and refresh its
+ *    descriptor with the buffer after the one the other descriptor fills
+ *
+ * @note
+ *    Called from the DMA interrupt
+ *****************************************************************************/
+static void complete(dmaStream_TypeDef *stream)
+{
+  uint32_t target;
+
+  stream->fill = next(stream, stream->fill);
+  stream->ready++;
+  target = next(stream, stream->fill);
+
+  // All other buffers are filled, the target is the oldest one, drop it
+  if (stream->ready == stream->config.bufferCount - 1) {
+    if (stream->busy) {
+      stream->dropped = true;
+    }
+    stream->gapBefore &= ~(1UL << stream->tail);
+    stream->tail = next(stream, stream->tail);
+    stream->gapBefore |= 1UL << stream->tail;
+    stream->ready--;
+    stream->overruns++;
+  }
+
+  DMA_RefreshPingPong(stream->config.channel, stream->fillPrimary, false,
+                      buffer(stream, target), NULL, stream->config.length - 1, false);
+  stream->fillPrimary = !stream->fillPrimary;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    DMA callback, called when the primary or the alternate descriptor is
+ *    done
+ *****************************************************************************/
+static void blockDone(unsigned int channel, bool primary, void *user)
+{
+  dmaStream_TypeDef *stream = user;
+
+  // Two completions can share an interrupt, so the stream keeps track of
+  // the descriptors itself
+  (void)primary;
+  if (!stream->running) {
+    return;
+  }
+  complete(stream);
+
+  // The other descriptor was done before this one was refreshed, and the
+  // cycle ended on it. Both are refreshed now, in order, so enable the
+  // channel again; its done flag may have been raised again meanwhile.
+  // Data is lost before the next buffer filled.
+  if (!DMA_ChannelEnabled(channel)) {
+    complete(stream);
+    stream->stalls++;
+    stream->gapBefore |= 1UL << stream->fill;
+    DMA_IntClear(1UL << channel);
+    DMA_ChannelEnable(channel, true);
+  }
+
+  // Wake up the consumer once a batch is ready
+  if (stream->ready >= stream->config.batch) {
+    SCB->SCR &= ~SCB_SCR_SLEEPONEXIT_Msk;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Check the configuration and set up the channel and its descriptors
+ *
+ * @note
+ *    DMA_Init() must have been called. The stream keeps a copy of the
+ *    configuration, but uses the storage in place.
+ *****************************************************************************/
+dmaStreamStatus_TypeDef dmaStreamInit(dmaStream_TypeDef *stream,
+                                      const dmaStreamConfig_TypeDef *config)
+{
+  DMA_CfgChannel_TypeDef channelConfig;
+  DMA_CfgDescr_TypeDef descrConfig;
+
+  if ((config->batch == 0) || (config->bufferCount < config->batch + 2)
+      || (config->bufferCount > DMA_STREAM_MAX_BUFFERS)
+      || (config->size > dmaDataSize4) || (config->storage == NULL)
+      || (config->callback == NULL)) {
+    return dmaStreamBadConfig;
+  }
+  if (((uintptr_t)config->storage & ((1UL << config->size) - 1)) != 0) {
+    return dmaStreamBadConfig;
+  }
+  if ((config->length == 0) || (config->length > DMA_STREAM_MAX_LENGTH)) {
+    return dmaStreamBadConfig;
+  }
+
+  stream->config = *config;
+  stream->unitBytes = 1UL << config->size;
+  stream->tail = 0;
+  stream->ready = 0;
+  stream->overruns = 0;
+  stream->stalls = 0;
+  stream->gapBefore = 0;
+  stream->busy = false;
+  stream->dropped = false;
+  stream->running = false;
+
+  stream->cb.cbFunc = blockDone;
+  stream->cb.userPtr = stream;
+
+  channelConfig.highPri = config->highPri;
+  channelConfig.enableInt = true;
+  channelConfig.select = config->select;
+  channelConfig.cb = &stream->cb;
+  DMA_CfgChannel(config->channel, &channelConfig);
+
+  // From the data register into consecutive units
+  descrConfig.dstInc = (DMA_DataInc_TypeDef)config->size;
+  descrConfig.srcInc = dmaDataIncNone;
+  descrConfig.size = config->size;
+  descrConfig.arbRate = config->arbRate;
+  descrConfig.hprot = 0;
+  DMA_CfgDescr(config->channel, true, &descrConfig);
+  DMA_CfgDescr(config->channel, false, &descrConfig);
+  return dmaStreamOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start filling the buffers from the first one, buffers not yet
+ *    consumed are dropped
+ *****************************************************************************/
+void dmaStreamStart(dmaStream_TypeDef *stream)
+{
+  uint32_t nMinus1 = stream->config.length - 1;
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  stream->fill = 0;
+  stream->fillPrimary = true;
+  stream->tail = 0;
+  stream->ready = 0;
+  stream->gapBefore = 0;
+  stream->running = true;
+  DMA_ActivatePingPong(stream->config.channel, false,
+                       buffer(stream, 0), (const void *)stream->config.source, nMinus1,
+                       buffer(stream, 1), (const void *)stream->config.source, nMinus1);
+  CORE_EXIT_ATOMIC();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Stop the DMA channel, the buffers filled so far can still be consumed
+ *****************************************************************************/
+void dmaStreamStop(dmaStream_TypeDef *stream)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (stream->running) {
+    DMA_ChannelEnable(stream->config.channel, false);
+    DMA_IntClear(1UL << stream->config.channel);
+    stream->running = false;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Sleep in EM1 until a batch of buffers is ready, or the stream stops
+ *
+ * @details
+ *    The MCU goes back to sleep after each DMA interrupt, without returning
+ *    here, until the callback sees a full batch. Other interrupt handlers
+ *    that need the main loop to run must clear SCB_SCR_SLEEPONEXIT_Msk.
+ *****************************************************************************/
+void dmaStreamWait(dmaStream_TypeDef *stream)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  while (stream->running && (stream->ready < stream->config.batch)) {
+    SCB->SCR |= SCB_SCR_SLEEPONEXIT_Msk;
+    EMU_EnterEM1();
+    CORE_EXIT_CRITICAL();
+    CORE_ENTER_CRITICAL();
+  }
+  SCB->SCR &= ~SCB_SCR_SLEEPONEXIT_Msk;
+  CORE_EXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Pass the filled buffers to the callback, oldest first
+ *
+ * @details
+ *    Call from the main loop. The callback runs with interrupts enabled, on
+ *    the data in place; the buffer is given back to the DMA when it
+ *    returns.
+ *
+ * @return
+ *    The number of buffers passed to the callback
+ *****************************************************************************/
+uint32_t dmaStreamProcess(dmaStream_TypeDef *stream)
+{
+  uint32_t consumed = 0;
+  uint32_t index;
+  bool overrun;
+  CORE_DECLARE_IRQ_STATE;
+
+  for (;; ) {
+    CORE_ENTER_ATOMIC();
+    if (stream->ready == 0) {
+      CORE_EXIT_ATOMIC();
+      break;
+    }
+    index = stream->tail;
+    overrun = (stream->gapBefore & (1UL << index)) != 0;
+    stream->gapBefore &= ~(1UL << index);
+    stream->busy = true;
+    stream->dropped = false;
+    CORE_EXIT_ATOMIC();
+
+    stream->config.callback(buffer(stream, index), stream->config.length, overrun,
+                            stream->config.user);
+    consumed++;
+
+    // A buffer dropped during the callback was already taken off the queue
+    CORE_ENTER_ATOMIC();
+    stream->busy = false;
+    if (!stream->dropped) {
+      stream->tail = next(stream, stream->tail);
+      stream->ready--;
+    }
+    CORE_EXIT_ATOMIC();
+  }
+  return consumed;
+}
+
+uint32_t dmaStreamReady(const dmaStream_TypeDef *stream)
+{
+  return stream->ready;
+}
+
+uint32_t dmaStreamOverruns(const dmaStream_TypeDef *stream)
+{
+  return stream->overruns;
+}
+
+uint32_t dmaStreamStalls(const dmaStream_TypeDef *stream)
+{
+  return stream->stalls;
+}
@@ -0,0 +1,180 @@
+/**************************************************************************//**
+ * @file
+ * @brief DMA Ping-Pong Streaming Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_timer.h"
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "dma_stream.h"
+
+// DMA channel and PRS channel used for the example
+#define DMA_CHANNEL         0
+#define PRS_CHANNEL         0
+
+// 6 buffers of 16 samples, the main loop wakes up once every 4 buffers
+#define BUFFER_COUNT        6
+#define BUFFER_LENGTH       16
+#define BATCH               4
+
+// ADC clock, and the TIMER0 prescaler and sample rate
+#define ADC_FREQ            13000000
+#define TIMER_PRESCALE      timerPrescale16
+#define SAMPLE_RATE         1000
+
+// Stream of ADC samples
+dmaStream_TypeDef stream;
+uint32_t streamBuffers[BUFFER_COUNT][BUFFER_LENGTH];
+
+// Values to watch in the debugger
+volatile uint32_t bufferCount;
+volatile uint32_t gapCount;
+volatile uint32_t wakeups;
+volatile uint32_t lastAverage;
+dmaStreamStatus_TypeDef streamStatus;
+
+/**************************************************************************//**
+ * @brief
+ *    Stream consumer, averages each buffer of samples in place
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint32_t *samples = data;
+  uint32_t i, sum = 0;
+
+  (void)user;
+
+  for (i = 0; i < length; i++) {
+    sum += samples[i];
+  }
+  lastAverage = sum / length;
+
+  bufferCount++;
+  if (overrun) {
+    gapCount++;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    TIMER0 initialization, overflows at SAMPLE_RATE and pulses PRS_CHANNEL
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  TIMER_TopSet(TIMER0, CMU_ClockFreqGet(cmuClock_HFPER) / 16 / SAMPLE_RATE - 1);
+  timerInit.prescale = TIMER_PRESCALE;
+  TIMER_Init(TIMER0, &timerInit);
+
+  // TIMER0 overflow starts a conversion through PRS
+  CMU_ClockEnable(cmuClock_PRS, true);
+  PRS_SourceSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_TIMER0,
+                      PRS_CH_CTRL_SIGSEL_TIMER0OF, prsEdgeOff);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    ADC initialization, single conversions of the temperature sensor
+ *    started by PRS_CHANNEL
+ *****************************************************************************/
+void initAdc(void)
+{
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(cmuClock_ADC0, true);
+
+  init.timebase = ADC_TimebaseCalc(0);
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, 0);
+
+  // Internal temperature sensor, so no pin differs between kits
+  initSingle.input      = adcSingleInpTemp;
+  initSingle.reference  = adcRef1V25;
+  initSingle.resolution = adcRes12Bit;
+  initSingle.acqTime    = adcAcqTime32;
+
+  // Conversions are started by PRS
+  initSingle.prsEnable = true;
+  initSingle.prsSel    = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+
+  ADC_Init(ADC0, &init);
+  ADC_InitSingle(ADC0, &initSingle);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    DMA initialization, and the stream of ADC samples
+ *****************************************************************************/
+void initDma(void)
+{
+  DMA_Init_TypeDef dmaInit;
+  dmaStreamConfig_TypeDef config;
+
+  CMU_ClockEnable(cmuClock_DMA, true);
+
+  dmaInit.hprot        = 0;
+  dmaInit.controlBlock = dmaControlBlock;
+  DMA_Init(&dmaInit);
+
+  // One ADC result per request into BUFFER_COUNT buffers
+  config.channel     = DMA_CHANNEL;
+  config.select      = DMAREQ_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = dmaDataSize4;
+  config.arbRate     = dmaArbitrate1;
+  config.highPri     = false;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.length      = BUFFER_LENGTH;
+  config.batch       = BATCH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  streamStatus = dmaStreamInit(&stream, &config);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  // Chip errata
+  CHIP_Init();
+
+  initAdc();
+  initDma();
+  if (streamStatus == dmaStreamOk) {
+    dmaStreamStart(&stream);
+  }
+  initTimer();
+
+  while (1) {
+    // Sleep in EM1 until BATCH buffers are filled
+    dmaStreamWait(&stream);
+    wakeups++;
+
+    // Average the filled buffers
+    dmaStreamProcess(&stream);
+  }
+}
@@ -0,0 +1,203 @@
+/**************************************************************************//**
+ * @file
+ * @brief DMA Ring Capture on the host PL230 model
+ *
+ * Build with the models and the runner of
+ * ../../../series1/ldma/ldma_host_model, see readme.txt. hostProducer()
+ * plays the ADC: each call puts the next sample number in the data
+ * register and raises the channel's request. Every few samples, at
+ * pseudo-random intervals shorter than the ring, it also plays the main
+ * loop polling the ring: it checks the write index against the samples
+ * sent, and reads what is available, in place or copied, in whole or in
+ * part. The samples read must be consecutive across many laps of the ring,
+ * with no DMA interrupt.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "pl230_model.h"
+#include "host.h"
+#include "dma_ring.h"
+
+#define DMA_CHANNEL         1
+#define RING_LENGTH         64
+#define SAMPLE_COUNT        (20 * RING_LENGTH + 17)
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if ( !(cond) )                                                      \
+    {                                                                   \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+      failures++;                                                       \
+    }                                                                   \
+  } while (0)
+
+dmaRing_TypeDef ring;
+uint16_t ringBuffer[RING_LENGTH];
+
+/* Simulated ADC0->SINGLEDATA */
+volatile uint32_t adcRegister;
+
+uint32_t samples;
+uint32_t nextPoll = 1;
+uint32_t expected;
+uint32_t polls;
+uint32_t seed = 1;
+uint32_t failures;
+
+static uint32_t nextRandom(uint32_t range)
+{
+  seed = seed * 1103515245UL + 12345UL;
+  return (seed >> 16) % range;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The main loop: read the ring, all of it or only a part
+ ******************************************************************************/
+static void poll(void)
+{
+  uint16_t copy[RING_LENGTH];
+  const uint16_t *data;
+  uint32_t units, count, i;
+
+  polls++;
+  CHECK(dmaRingWriteIndex(&ring) == samples % RING_LENGTH);
+  CHECK(dmaRingAvailable(&ring) == samples - expected);
+
+  switch ( nextRandom(3) )
+  {
+    case 0:
+      /* In place, up to the end of the ring, then from its start */
+      data = dmaRingPeek(&ring, &units);
+      while ( units > 0 )
+      {
+        for (i = 0; i < units; i++)
+        {
+          CHECK(data[i] == (uint16_t)expected);
+          expected++;
+        }
+        dmaRingConsume(&ring, units);
+        data = dmaRingPeek(&ring, &units);
+      }
+      break;
+
+    case 1:
+      /* Copied, all of it */
+      count = dmaRingRead(&ring, copy, RING_LENGTH);
+      for (i = 0; i < count; i++)
+      {
+        CHECK(copy[i] == (uint16_t)expected);
+        expected++;
+      }
+      break;
+
+    default:
+      /* Copied, only some, the rest is read next time */
+      count = dmaRingRead(&ring, copy, nextRandom(8));
+      for (i = 0; i < count; i++)
+      {
+        CHECK(copy[i] == (uint16_t)expected);
+        expected++;
+      }
+      break;
+  }
+}
+
+static void report(void)
+{
+  dmaModelStats_TypeDef stats;
+
+  pl230ModelGetStats(&stats);
+  CHECK(expected == samples);
+  CHECK(stats.doneCount[DMA_CHANNEL] == SAMPLE_COUNT / RING_LENGTH);
+  CHECK(hostWakeups == 0);
+
+  printf("samples %lu, read %lu in %lu polls, laps %lu, wake-ups %lu\n",
+         (unsigned long)samples, (unsigned long)expected, (unsigned long)polls,
+         (unsigned long)stats.doneCount[DMA_CHANNEL], (unsigned long)hostWakeups);
+  printf("%s\n", (failures == 0) ? "PASS" : "FAIL");
+}
+
+bool hostProducer(void)
+{
+  if ( samples == nextPoll )
+  {
+    poll();
+    /* The next poll before the DMA laps the oldest unread sample */
+    nextPoll = samples + 1 + nextRandom(RING_LENGTH - 1 - (samples - expected));
+  }
+
+  if ( samples == SAMPLE_COUNT )
+  {
+    while ( expected != samples )
+    {
+      poll();
+    }
+    report();
+    return false;
+  }
+
+  adcRegister = 0xA5000000UL | (samples & 0xFFFF);
+  samples++;
+  pl230ModelRequest(1UL << DMA_CHANNEL);
+  return true;
+}
+
+int main(void)
+{
+  DMA_Init_TypeDef dmaInit;
+  dmaRingConfig_TypeDef config = {
+    .channel = DMA_CHANNEL,
+    .select  = 0,
+    .source  = &adcRegister,
+    .size    = dmaDataSize2,
+    .storage = ringBuffer,
+    .length  = RING_LENGTH,
+  };
+
+  CHIP_Init();
+
+  dmaInit.hprot        = 0;
+  dmaInit.controlBlock = dmaControlBlock;
+  DMA_Init(&dmaInit);
+
+  /* Bad configurations: no loop on channel 2, length not a power of two,
+     storage not aligned */
+  config.channel = 2;
+  CHECK(dmaRingInit(&ring, &config) == dmaRingBadConfig);
+  config.channel = DMA_CHANNEL;
+  config.length = 48;
+  CHECK(dmaRingInit(&ring, &config) == dmaRingBadConfig);
+  config.length = RING_LENGTH;
+  config.storage = (uint8_t *)ringBuffer + 1;
+  CHECK(dmaRingInit(&ring, &config) == dmaRingBadConfig);
+  config.storage = ringBuffer;
+
+  if ( dmaRingInit(&ring, &config) != dmaRingOk )
+  {
+    printf("dmaRingInit failed\n");
+    return 1;
+  }
+  dmaRingStart(&ring);
+
+  /* No interrupt: the run ends when the producer is done */
+  while (1)
+  {
+    EMU_EnterEM1();
+  }
+}
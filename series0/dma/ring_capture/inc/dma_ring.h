@@ -0,0 +1,68 @@
+/***************************************************************************//**
+ * @file  dma_ring.h
+ * @brief Endless capture into a ring buffer with the Series 0 DMA loop mode
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef DMA_RING_H
+#define DMA_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_dma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Units in the ring, n_minus_1 of a descriptor is 10 bits
+#define DMA_RING_MAX_LENGTH     1024
+
+// Channels with the loop extension, DMA->LOOP0 and DMA->LOOP1
+#define DMA_RING_LOOP_CHANNELS  2
+
+typedef enum {
+  dmaRingOk,
+  dmaRingBadConfig          // Channel, length or storage not usable
+} dmaRingStatus_TypeDef;
+
+typedef struct {
+  unsigned int channel;               // 0 or 1
+  uint32_t select;                    // Peripheral request, e.g. DMAREQ_ADC0_SINGLE
+  const volatile void *source;        // Peripheral data register
+  DMA_DataSize_TypeDef size;          // Unit size of the data register
+  void *storage;                      // length units
+  uint32_t length;                    // Power of two, 2 to DMA_RING_MAX_LENGTH
+} dmaRingConfig_TypeDef;
+
+// The DMA owns the write index, the consumer the read index
+typedef struct {
+  dmaRingConfig_TypeDef config;
+  uint32_t unitBytes;
+  uint32_t read;
+} dmaRing_TypeDef;
+
+dmaRingStatus_TypeDef dmaRingInit(dmaRing_TypeDef *ring,
+                                  const dmaRingConfig_TypeDef *config);
+void dmaRingStart(dmaRing_TypeDef *ring);
+void dmaRingStop(dmaRing_TypeDef *ring);
+
+uint32_t dmaRingWriteIndex(const dmaRing_TypeDef *ring);
+uint32_t dmaRingAvailable(const dmaRing_TypeDef *ring);
+const void *dmaRingPeek(const dmaRing_TypeDef *ring, uint32_t *units);
+void dmaRingConsume(dmaRing_TypeDef *ring, uint32_t units);
+uint32_t dmaRingRead(dmaRing_TypeDef *ring, void *dst, uint32_t maxUnits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DMA_RING_H
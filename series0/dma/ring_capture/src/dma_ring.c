@@ -0,0 +1,184 @@
+/***************************************************************************//**
+ * @file dma_ring.c
+ * @brief Endless capture into a ring buffer with the Series 0 DMA loop mode.
+ *
+ * A basic cycle fills the ring from a peripheral data register, one unit per
+ * request. With the loop extension of the EFM32GG/LG/WG DMA, the DMA
+ * reloads n_minus_1 when the cycle is done and goes on from the start of
+ * the ring, forever, and without an interrupt: the channel interrupt is
+ * disabled.
+ *
+ * The DMA writes the remaining count back to the primary descriptor after
+ * each unit, and after the unit itself, so the write index is derived from
+ * it: length - (n_minus_1 + 1). The consumer owns the read index, and no
+ * lock is needed on either side. The consumer must read the ring at least
+ * once per lap of the DMA; data overwritten before that cannot be told
+ * apart from new data.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "em_device.h"
+#include "dmactrl.h"
+#include "dma_ring.h"
+
+/**************************************************************************//**
+ * @brief
+ *    Check the configuration and set up the channel, its descriptor and
+ *    its loop
+ *
+ * @note
+ *    DMA_Init() must have been called. The ring keeps a copy of the
+ *    configuration, but uses the storage in place.
+ *****************************************************************************/
+dmaRingStatus_TypeDef dmaRingInit(dmaRing_TypeDef *ring,
+                                  const dmaRingConfig_TypeDef *config)
+{
+  DMA_CfgChannel_TypeDef channelConfig;
+  DMA_CfgDescr_TypeDef descrConfig;
+  DMA_CfgLoop_TypeDef loopConfig;
+
+  if ((config->channel >= DMA_RING_LOOP_CHANNELS) || (config->size > dmaDataSize4)
+      || (config->storage == NULL)) {
+    return dmaRingBadConfig;
+  }
+  if (((uintptr_t)config->storage & ((1UL << config->size) - 1)) != 0) {
+    return dmaRingBadConfig;
+  }
+  if ((config->length < 2) || (config->length > DMA_RING_MAX_LENGTH)
+      || ((config->length & (config->length - 1)) != 0)) {
+    return dmaRingBadConfig;
+  }
+
+  ring->config = *config;
+  ring->unitBytes = 1UL << config->size;
+  ring->read = 0;
+
+  // No callback and no interrupt, the consumer polls
+  channelConfig.highPri = false;
+  channelConfig.enableInt = false;
+  channelConfig.select = config->select;
+  channelConfig.cb = NULL;
+  DMA_CfgChannel(config->channel, &channelConfig);
+
+  // From the data register into consecutive units, one per request
+  descrConfig.dstInc = (DMA_DataInc_TypeDef)config->size;
+  descrConfig.srcInc = dmaDataIncNone;
+  descrConfig.size = config->size;
+  descrConfig.arbRate = dmaArbitrate1;
+  descrConfig.hprot = 0;
+  DMA_CfgDescr(config->channel, true, &descrConfig);
+
+  loopConfig.enable = true;
+  loopConfig.nMinus1 = (uint16_t)(config->length - 1);
+  DMA_CfgLoop(config->channel, &loopConfig);
+  return dmaRingOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start filling the ring from its start, data not yet read is dropped
+ *****************************************************************************/
+void dmaRingStart(dmaRing_TypeDef *ring)
+{
+  ring->read = 0;
+  DMA_ActivateBasic(ring->config.channel, true, false, ring->config.storage,
+                    (const void *)ring->config.source, ring->config.length - 1);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Stop the DMA channel, the data captured so far can still be read
+ *****************************************************************************/
+void dmaRingStop(dmaRing_TypeDef *ring)
+{
+  DMA_ChannelEnable(ring->config.channel, false);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Index of the next unit the DMA writes
+ *****************************************************************************/
+uint32_t dmaRingWriteIndex(const dmaRing_TypeDef *ring)
+{
+  uint32_t ctrl = dmaControlBlock[ring->config.channel].CTRL;
+  uint32_t remaining = ((ctrl & _DMA_CTRL_N_MINUS_1_MASK) >> _DMA_CTRL_N_MINUS_1_SHIFT) + 1;
+
+  return (ring->config.length - remaining) & (ring->config.length - 1);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Units written by the DMA and not yet read, at most length - 1
+ *****************************************************************************/
+uint32_t dmaRingAvailable(const dmaRing_TypeDef *ring)
+{
+  return (dmaRingWriteIndex(ring) - ring->read) & (ring->config.length - 1);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Oldest unread units, in place
+ *
+ * @param[out] units
+ *    Units that can be read from the returned address, up to the end of the
+ *    ring; call again after dmaRingConsume() for the units from its start
+ *****************************************************************************/
+const void *dmaRingPeek(const dmaRing_TypeDef *ring, uint32_t *units)
+{
+  uint32_t available = dmaRingAvailable(ring);
+  uint32_t toEnd = ring->config.length - ring->read;
+
+  *units = (available < toEnd) ? available : toEnd;
+  return (const uint8_t *)ring->config.storage + ring->read * ring->unitBytes;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Give 'units' units back to the DMA, after dmaRingPeek()
+ *****************************************************************************/
+void dmaRingConsume(dmaRing_TypeDef *ring, uint32_t units)
+{
+  ring->read = (ring->read + units) & (ring->config.length - 1);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copy up to 'maxUnits' unread units to 'dst', across the end of the
+ *    ring
+ *
+ * @return
+ *    The number of units copied
+ *****************************************************************************/
+uint32_t dmaRingRead(dmaRing_TypeDef *ring, void *dst, uint32_t maxUnits)
+{
+  uint8_t *out = dst;
+  uint32_t copied = 0;
+  uint32_t units;
+  const void *data;
+
+  while (copied < maxUnits) {
+    data = dmaRingPeek(ring, &units);
+    if (units == 0) {
+      break;
+    }
+    if (units > maxUnits - copied) {
+      units = maxUnits - copied;
+    }
+    memcpy(out, data, units * ring->unitBytes);
+    out += units * ring->unitBytes;
+    copied += units;
+    dmaRingConsume(ring, units);
+  }
+  return copied;
+}
@@ -0,0 +1,215 @@
+/**************************************************************************//**
+ * @file
+ * @brief DMA Ring Capture Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_rtc.h"
+#include "em_timer.h"
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "dma_ring.h"
+
+// DMA channel, one of the two with the loop extension, and PRS channel
+#define DMA_CHANNEL         0
+#define PRS_CHANNEL         0
+
+// Ring of 256 samples, 256 ms at the sample rate
+#define RING_LENGTH         256
+
+// ADC clock, and the TIMER0 prescaler and sample rate
+#define ADC_FREQ            13000000
+#define TIMER_PRESCALE      timerPrescale16
+#define SAMPLE_RATE         1000
+
+// The main loop reads the ring every 100 ms, well within a lap
+#define LFRCO_FREQ          32768
+#define POLL_TOP            (LFRCO_FREQ / 10 - 1)
+
+// Samples captured by the DMA, 12-bit results in halfwords
+dmaRing_TypeDef ring;
+uint16_t ringBuffer[RING_LENGTH];
+
+// Values to watch in the debugger
+volatile uint32_t sampleCount;
+volatile uint32_t lastAverage;
+volatile uint32_t lastMin;
+volatile uint32_t lastMax;
+dmaRingStatus_TypeDef ringStatus;
+
+/**************************************************************************//**
+ * @brief RTC interrupt service routine, wakes up the main loop
+ *****************************************************************************/
+void RTC_IRQHandler(void)
+{
+  RTC_IntClear(RTC_IFC_COMP0);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    RTC initialization, interrupts every 100 ms from the LFRCO
+ *****************************************************************************/
+void initRtc(void)
+{
+  RTC_Init_TypeDef rtcInit = RTC_INIT_DEFAULT;
+
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+  CMU_ClockEnable(cmuClock_RTC, true);
+
+  // Restart from 0 on COMP0
+  rtcInit.comp0Top = true;
+  RTC_CompareSet(0, POLL_TOP);
+
+  RTC_IntEnable(RTC_IEN_COMP0);
+  NVIC_ClearPendingIRQ(RTC_IRQn);
+  NVIC_EnableIRQ(RTC_IRQn);
+
+  RTC_Init(&rtcInit);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    TIMER0 initialization, overflows at SAMPLE_RATE and pulses PRS_CHANNEL
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  TIMER_TopSet(TIMER0, CMU_ClockFreqGet(cmuClock_HFPER) / 16 / SAMPLE_RATE - 1);
+  timerInit.prescale = TIMER_PRESCALE;
+  TIMER_Init(TIMER0, &timerInit);
+
+  // TIMER0 overflow starts a conversion through PRS
+  CMU_ClockEnable(cmuClock_PRS, true);
+  PRS_SourceSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_TIMER0,
+                      PRS_CH_CTRL_SIGSEL_TIMER0OF, prsEdgeOff);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    ADC initialization, single conversions of the temperature sensor
+ *    started by PRS_CHANNEL
+ *****************************************************************************/
+void initAdc(void)
+{
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(cmuClock_ADC0, true);
+
+  init.timebase = ADC_TimebaseCalc(0);
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, 0);
+
+  // Internal temperature sensor, so no pin differs between kits
+  initSingle.input      = adcSingleInpTemp;
+  initSingle.reference  = adcRef1V25;
+  initSingle.resolution = adcRes12Bit;
+  initSingle.acqTime    = adcAcqTime32;
+
+  // Conversions are started by PRS
+  initSingle.prsEnable = true;
+  initSingle.prsSel    = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+
+  ADC_Init(ADC0, &init);
+  ADC_InitSingle(ADC0, &initSingle);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    DMA initialization, and the ring of ADC samples
+ *****************************************************************************/
+void initDma(void)
+{
+  DMA_Init_TypeDef dmaInit;
+  dmaRingConfig_TypeDef config;
+
+  CMU_ClockEnable(cmuClock_DMA, true);
+
+  dmaInit.hprot        = 0;
+  dmaInit.controlBlock = dmaControlBlock;
+  DMA_Init(&dmaInit);
+
+  config.channel = DMA_CHANNEL;
+  config.select  = DMAREQ_ADC0_SINGLE;
+  config.source  = &ADC0->SINGLEDATA;
+  config.size    = dmaDataSize2;
+  config.storage = ringBuffer;
+  config.length  = RING_LENGTH;
+
+  ringStatus = dmaRingInit(&ring, &config);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Read the samples captured since the last call, in place
+ *****************************************************************************/
+void readRing(void)
+{
+  const uint16_t *samples;
+  uint32_t units, i;
+  uint32_t sum = 0, count = 0, min = 0xFFFF, max = 0;
+
+  // Up to the end of the ring, then from its start
+  samples = dmaRingPeek(&ring, &units);
+  while (units > 0) {
+    for (i = 0; i < units; i++) {
+      sum += samples[i];
+      min = (samples[i] < min) ? samples[i] : min;
+      max = (samples[i] > max) ? samples[i] : max;
+    }
+    count += units;
+    dmaRingConsume(&ring, units);
+    samples = dmaRingPeek(&ring, &units);
+  }
+
+  if (count > 0) {
+    sampleCount += count;
+    lastAverage = sum / count;
+    lastMin = min;
+    lastMax = max;
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  // Chip errata
+  CHIP_Init();
+
+  initAdc();
+  initDma();
+  if (ringStatus == dmaRingOk) {
+    dmaRingStart(&ring);
+  }
+  initTimer();
+  initRtc();
+
+  while (1) {
+    // The DMA fills the ring without waking up the MCU, the RTC does
+    EMU_EnterEM1();
+    readRing();
+  }
+}
@@ -0,0 +1,384 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC calibration kernels on a host: checks and benchmark
+ *
+ * Build on its own, see readme.txt. The fixed-point kernels and tables are
+ * checked against a double precision reference on every code, for many
+ * calibrations and output scales, then timed against a plain floating
+ * point conversion on a frame of codes: either a trace recorded from the
+ * kit, given with -f, or a synthetic one.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "adc_cal.h"
+#include "host_check.h"
+
+#define MAX_SAMPLES         65536
+
+/* Full scale of the 2.5V reference, in mV */
+#define FULL_SCALE_MV       2500
+
+/* Calibrations tried against the reference */
+#define RANDOM_CALS         2000
+
+/* Output scales: mV * num / den + bias */
+typedef struct
+{
+  int32_t num;
+  int32_t den;
+  int32_t bias;
+  const char *name;
+} scale_TypeDef;
+
+static const scale_TypeDef scales[] =
+{
+  { 1,     1,    0,     "mV" },
+  { 10,    1,    0,     "0.1 mV" },
+  { 12,    1,    0,     "1/12 mV" },
+  { 1,     4,    -125,  "kPa, 0.5-4.5 V sensor" },
+  { -1,    10,   300,   "C, -10 mV/C sensor" },
+  { 3,     7,    0,     "divider 3/7" },
+  { 1,     1000, 0,     "V" },
+};
+
+#define SCALE_COUNT         (sizeof(scales) / sizeof(scales[0]))
+
+static uint16_t codes[MAX_SAMPLES];
+static int16_t output[MAX_SAMPLES];
+static float floatOutput[MAX_SAMPLES];
+static int16_t table[ADC_CAL_CODES];
+static uint32_t traceLength;
+static uint32_t seed = 1;
+static volatile int32_t sink;
+
+/* Integer in [low, high] */
+static int32_t randomRange(int32_t low, int32_t high)
+{
+  return low + (int32_t)(hostRandom(&seed) % (uint32_t)(high - low + 1));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Synthetic frame: a slow sine over most of the range, with noise
+ ******************************************************************************/
+static void synthesize(void)
+{
+  double value;
+  uint32_t i;
+
+  for (i = 0; i < MAX_SAMPLES; i++)
+  {
+    value = 2048.0 + 1800.0 * sin(2.0 * M_PI * i / 4096.0)
+            + (double)(hostRandom(&seed) % 9) - 4.0;
+    codes[i] = (uint16_t)((value < 0) ? 0 : (value > 4095) ? 4095 : value);
+  }
+  traceLength = MAX_SAMPLES;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read a recorded trace, one code per line or separated by spaces
+ ******************************************************************************/
+static int load(const char *name)
+{
+  FILE *file = fopen(name, "r");
+  unsigned long value;
+
+  if ( file == NULL )
+  {
+    perror(name);
+    return -1;
+  }
+  traceLength = 0;
+  while ( (traceLength < MAX_SAMPLES) && (fscanf(file, "%lu", &value) == 1) )
+  {
+    codes[traceLength++] = (uint16_t)(value & (ADC_CAL_CODES - 1));
+  }
+  fclose(file);
+  return (traceLength > 0) ? 0 : -1;
+}
+
+/* Exact output of a code */
+static double reference(const adcCal_TypeDef *cal, const scale_TypeDef *scale,
+                        uint32_t code)
+{
+  double mv;
+
+  mv = ((double)code * (1 << ADC_CAL_FRACTION_BITS) - cal->zeroCode)
+       * cal->pointMv / (double)(cal->pointCode - cal->zeroCode);
+  return mv * scale->num / scale->den + scale->bias;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check a kernel and its table on every code, return the largest error
+ *
+ * @details
+ *   A kernel is only refused when an output would be above
+ *   ADC_CAL_MAX_OUTPUT.
+ ******************************************************************************/
+static double checkKernel(const adcCal_TypeDef *cal,
+                          const scale_TypeDef *scale)
+{
+  static uint16_t all[ADC_CAL_CODES];
+  static int16_t converted[ADC_CAL_CODES];
+  adcCalKernel_TypeDef kernel;
+  double error, worst = 0.0;
+  uint32_t code;
+
+  if ( adcCalKernelInit(&kernel, cal, scale->num, scale->den, scale->bias)
+       != adcCalOk )
+  {
+    CHECK((fabs(reference(cal, scale, 0)) > ADC_CAL_MAX_OUTPUT)
+          || (fabs(reference(cal, scale, ADC_CAL_CODES - 1))
+              > ADC_CAL_MAX_OUTPUT));
+    return 0.0;
+  }
+  CHECK(kernel.shift >= 14);
+
+  for (code = 0; code < ADC_CAL_CODES; code++)
+  {
+    all[code] = (uint16_t)code;
+  }
+  adcCalConvert(&kernel, all, ADC_CAL_CODES, converted);
+  adcCalTableInit(&kernel, table);
+  CHECK(memcmp(converted, table, sizeof(table)) == 0);
+
+  for (code = 0; code < ADC_CAL_CODES; code++)
+  {
+    error = fabs(converted[code] - reference(cal, scale, code));
+    if ( error > worst )
+    {
+      worst = error;
+    }
+  }
+
+  /* Half a unit, and the rounding of the gain */
+  CHECK(worst <= 0.5 + 2048.0 / (1UL << kernel.shift));
+
+  /* In place, and with the table */
+  adcCalConvert(&kernel, all, ADC_CAL_CODES, (int16_t *)all);
+  CHECK(memcmp(converted, all, sizeof(all)) == 0);
+  for (code = 0; code < ADC_CAL_CODES; code++)
+  {
+    all[code] = (uint16_t)code;
+  }
+  adcCalConvertTable(table, all, ADC_CAL_CODES, (int16_t *)all);
+  CHECK(memcmp(converted, all, sizeof(all)) == 0);
+
+  return worst;
+}
+
+static void checkCalibration(void)
+{
+  adcCal_TypeDef cal, stored;
+  adcCalKernel_TypeDef kernel;
+  adcCalRecord_TypeDef record;
+  uint16_t samples[5] = { 100, 101, 101, 102, 102 };
+  double worst = 0.0;
+  uint32_t c, s;
+
+  /* Averages in 1/16 LSB, rounded */
+  CHECK(adcCalAverage(samples, 5) == 1619);
+  CHECK(adcCalAverage(samples, 1) == 1600);
+  CHECK(adcCalAverage(samples, 0) == 0);
+
+  /* Points not usable leave the calibration as it was */
+  adcCalNominal(&cal, FULL_SCALE_MV);
+  CHECK(adcCalTwoPoint(&cal, 1000, 1000 + ADC_CAL_MIN_SPAN - 1, 1000)
+        == adcCalBadPoints);
+  CHECK(adcCalTwoPoint(&cal, 2000, 1000, 1000) == adcCalBadPoints);
+  CHECK(adcCalTwoPoint(&cal, 0, 16000, 0) == adcCalBadPoints);
+  CHECK((cal.zeroCode == 0) && (cal.pointMv == FULL_SCALE_MV));
+
+  /* Scales not usable */
+  CHECK(adcCalKernelInit(&kernel, &cal, 1, 0, 0) == adcCalBadScale);
+  CHECK(adcCalKernelInit(&kernel, &cal, 0, 1, 0) == adcCalBadScale);
+  CHECK(adcCalKernelInit(&kernel, &cal, 0x7FFFFFFF, 1, 0) == adcCalBadScale);
+  CHECK(adcCalKernelInit(&kernel, &cal, 1000, 1, 0) == adcCalBadScale);
+  CHECK(adcCalKernelInit(&kernel, &cal, 1, 1, -31000) == adcCalOk);
+  CHECK(adcCalKernelInit(&kernel, &cal, 1, 1, -32001) == adcCalBadScale);
+
+  /* Nominal: code 4095 is 2499.39 mV, the last step rounds up at 2048 */
+  CHECK(adcCalKernelInit(&kernel, &cal, 1, 1, 0) == adcCalOk);
+  adcCalTableInit(&kernel, table);
+  CHECK((table[0] == 0) && (table[2048] == 1250) && (table[4095] == 2499));
+
+  /* Calibrations as measured on devices, and some far from them; the
+     largest error in mV is printed */
+  for (c = 0; c < RANDOM_CALS; c++)
+  {
+    cal.zeroCode = randomRange(-400, 800);
+    cal.pointCode = cal.zeroCode + randomRange(ADC_CAL_MIN_SPAN, 70000);
+    cal.pointMv = randomRange(1, 5000);
+    for (s = 0; s < SCALE_COUNT; s++)
+    {
+      double error = checkKernel(&cal, &scales[s]);
+      if ( (s == 0) && (error > worst) )
+      {
+        worst = error;
+      }
+    }
+  }
+  printf("largest error %.4f mV\n", worst);
+
+  /* Stored records */
+  cal.zeroCode = 37;
+  cal.pointCode = 40000;
+  cal.pointMv = 1500;
+  adcCalPack(&cal, 0x1234, &record);
+  CHECK(adcCalUnpack(&record, 0x1234, &stored));
+  CHECK(memcmp(&cal, &stored, sizeof(cal)) == 0);
+  CHECK(!adcCalUnpack(&record, 0x1235, &stored));
+  record.cal.pointMv++;
+  CHECK(!adcCalUnpack(&record, 0x1234, &stored));
+  memset(&record, 0xFF, sizeof(record));
+  CHECK(!adcCalUnpack(&record, 0xFFFFFFFF, &stored));
+}
+
+static double now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+typedef enum
+{
+  methodFloat,
+  methodFloatRounded,
+  methodKernel,
+  methodTable
+} method_TypeDef;
+
+static const char *methodNames[] =
+{
+  "float, per sample",
+  "float, rounded to int16",
+  "multiply-shift",
+  "table",
+};
+
+/***************************************************************************//**
+ * @brief
+ *   Convert the frame once with a method
+ ******************************************************************************/
+static void run(method_TypeDef method, const adcCal_TypeDef *cal,
+                const adcCalKernel_TypeDef *kernel)
+{
+  float zero = (float)cal->zeroCode;
+  float perCode = (float)cal->pointMv / (float)(cal->pointCode - cal->zeroCode);
+  float value;
+  uint32_t i;
+
+  switch ( method )
+  {
+    case methodFloat:
+      /* As an application would write it */
+      for (i = 0; i < traceLength; i++)
+      {
+        floatOutput[i] = ((float)codes[i] * 16.0f - zero) * perCode;
+      }
+      sink = (int32_t)floatOutput[traceLength / 2];
+      break;
+
+    case methodFloatRounded:
+      for (i = 0; i < traceLength; i++)
+      {
+        value = ((float)codes[i] * 16.0f - zero) * perCode;
+        output[i] = (int16_t)lrintf(value);
+      }
+      sink = output[traceLength / 2];
+      break;
+
+    case methodKernel:
+      adcCalConvert(kernel, codes, traceLength, output);
+      sink = output[traceLength / 2];
+      break;
+
+    case methodTable:
+      adcCalConvertTable(table, codes, traceLength, output);
+      sink = output[traceLength / 2];
+      break;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Host time per sample of each method, converting the frame to mV
+ ******************************************************************************/
+static void benchmark(void)
+{
+  adcCal_TypeDef cal;
+  adcCalKernel_TypeDef kernel;
+  double start, elapsed;
+  uint32_t m, runs;
+
+  /* A typical calibration: offset of 1.5 LSB, gain 0.3% high */
+  adcCalTwoPoint(&cal, 24, 24 + 65339, FULL_SCALE_MV);
+  adcCalKernelInit(&kernel, &cal, 1, 1, 0);
+  adcCalTableInit(&kernel, table);
+
+  printf("%u samples to mV\n", (unsigned)traceLength);
+  printf("method                    ns/sample\n");
+  for (m = methodFloat; m <= methodTable; m++)
+  {
+    runs = 0;
+    start = now();
+    do
+    {
+      run((method_TypeDef)m, &cal, &kernel);
+      runs++;
+      elapsed = now() - start;
+    } while ( elapsed < 0.2 );
+
+    printf("%-25s %9.3f\n", methodNames[m],
+           elapsed * 1e9 / ((double)runs * traceLength));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int option;
+
+  checkCalibration();
+  synthesize();
+
+  while ( (option = getopt(argc, argv, "f:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'f':
+        if ( load(optarg) != 0 )
+        {
+          return 1;
+        }
+        break;
+
+      default:
+        printf("usage: %s [-f trace]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  benchmark();
+
+  hostCheckReport();
+  return 0;
+}
@@ -0,0 +1,94 @@
+/***************************************************************************//**
+ * @file  adc_cal.h
+ * @brief Two-point ADC calibration and fixed-point conversion of frames
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_CAL_H
+#define ADC_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Codes of a 12-bit result, and entries of a conversion table
+#define ADC_CAL_CODES           4096
+
+// Averaged codes are kept in 1/16 LSB
+#define ADC_CAL_FRACTION_BITS   4
+
+// Smallest distance between the two points, 16 codes
+#define ADC_CAL_MIN_SPAN        (16 << ADC_CAL_FRACTION_BITS)
+
+// Largest output of a kernel, either sign
+#define ADC_CAL_MAX_OUTPUT      32000
+
+// Marks a stored record
+#define ADC_CAL_MAGIC           0x4C414341UL  // "ACAL"
+
+typedef enum {
+  adcCalOk,
+  adcCalBadPoints,          // Points too close, or not increasing
+  adcCalBadScale            // Output scale not usable, or outputs above
+                            // ADC_CAL_MAX_OUTPUT
+} adcCalStatus_TypeDef;
+
+// Two points of the transfer function: the code read at 0 mV, and the code
+// read at pointMv, in 1/16 LSB
+typedef struct {
+  int32_t zeroCode;
+  int32_t pointCode;
+  int32_t pointMv;
+} adcCal_TypeDef;
+
+// Conversion of a 12-bit code to output units, in fixed point:
+// out = (code * gain + intercept) >> shift; the intercept holds the offset,
+// the bias and the rounding
+typedef struct {
+  int32_t gain;
+  int32_t intercept;
+  uint32_t shift;
+} adcCalKernel_TypeDef;
+
+// Calibration as stored in flash. tag tells what it was measured for, e.g.
+// the reference; check covers all the words before it.
+typedef struct {
+  uint32_t magic;
+  uint32_t tag;
+  adcCal_TypeDef cal;
+  uint32_t check;
+} adcCalRecord_TypeDef;
+
+void adcCalNominal(adcCal_TypeDef *cal, int32_t fullScaleMv);
+int32_t adcCalAverage(const uint16_t *codes, uint32_t count);
+adcCalStatus_TypeDef adcCalTwoPoint(adcCal_TypeDef *cal, int32_t zeroCode,
+                                    int32_t pointCode, int32_t pointMv);
+adcCalStatus_TypeDef adcCalKernelInit(adcCalKernel_TypeDef *kernel,
+                                      const adcCal_TypeDef *cal,
+                                      int32_t num, int32_t den, int32_t bias);
+void adcCalConvert(const adcCalKernel_TypeDef *kernel, const uint16_t *codes,
+                   uint32_t count, int16_t *out);
+void adcCalTableInit(const adcCalKernel_TypeDef *kernel, int16_t *table);
+void adcCalConvertTable(const int16_t *table, const uint16_t *codes,
+                        uint32_t count, int16_t *out);
+void adcCalPack(const adcCal_TypeDef *cal, uint32_t tag,
+                adcCalRecord_TypeDef *record);
+bool adcCalUnpack(const adcCalRecord_TypeDef *record, uint32_t tag,
+                  adcCal_TypeDef *cal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_CAL_H
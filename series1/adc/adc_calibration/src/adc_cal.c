@@ -0,0 +1,227 @@
+/***************************************************************************//**
+ * @file adc_cal.c
+ * @brief Two-point ADC calibration and fixed-point conversion of frames.
+ *
+ * The calibration is a straight line through two measured points, the code
+ * at 0 mV and the code at a known voltage, both averaged to 1/16 LSB. A
+ * kernel folds the line and a further scale to engineering units,
+ * out = mV * num / den + bias, into one multiply, one add and one shift per
+ * sample: the shift is the largest for which no intermediate value can
+ * leave 32 bits over the 12-bit codes. The outputs of all codes must be
+ * within ADC_CAL_MAX_OUTPUT, so the shift is at least 14 and a kernel is
+ * within half an output unit of the exact value, plus 2048 / 2^shift for
+ * the rounding of the gain: 0.01 for millivolts. Building a kernel uses
+ * floating point once; converting a frame does not.
+ *
+ * A table of ADC_CAL_CODES entries, built from a kernel, gives the same
+ * results with one load per sample, for any transfer function.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "adc_cal.h"
+
+// Largest shift of a kernel
+#define MAX_SHIFT   30
+
+// Bound of the intermediate values of a kernel
+#define LIMIT       2147483648.0
+
+static int32_t roundToInt(double value)
+{
+  return (int32_t)((value >= 0) ? value + 0.5 : value - 0.5);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Calibration of an ideal ADC: 0 mV reads 0, fullScaleMv reads
+ *   ADC_CAL_CODES
+ ******************************************************************************/
+void adcCalNominal(adcCal_TypeDef *cal, int32_t fullScaleMv)
+{
+  cal->zeroCode = 0;
+  cal->pointCode = ADC_CAL_CODES << ADC_CAL_FRACTION_BITS;
+  cal->pointMv = fullScaleMv;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Average of count codes in 1/16 LSB, rounded
+ ******************************************************************************/
+int32_t adcCalAverage(const uint16_t *codes, uint32_t count)
+{
+  uint32_t sum = 0;
+  uint32_t i;
+
+  if (count == 0) {
+    return 0;
+  }
+  for (i = 0; i < count; i++) {
+    sum += codes[i];
+  }
+  return (int32_t)(((uint64_t)sum * (1 << ADC_CAL_FRACTION_BITS) + count / 2)
+                   / count);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the two points, in 1/16 LSB; cal is left as it was if they are
+ *   not usable
+ ******************************************************************************/
+adcCalStatus_TypeDef adcCalTwoPoint(adcCal_TypeDef *cal, int32_t zeroCode,
+                                    int32_t pointCode, int32_t pointMv)
+{
+  if ((pointMv <= 0) || (pointCode - zeroCode < ADC_CAL_MIN_SPAN)) {
+    return adcCalBadPoints;
+  }
+  cal->zeroCode = zeroCode;
+  cal->pointCode = pointCode;
+  cal->pointMv = pointMv;
+  return adcCalOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Kernel converting 12-bit codes to mV * num / den + bias
+ *
+ * @details
+ *   With num = den = 1 and bias = 0 the output is in mV.
+ ******************************************************************************/
+adcCalStatus_TypeDef adcCalKernelInit(adcCalKernel_TypeDef *kernel,
+                                      const adcCal_TypeDef *cal,
+                                      int32_t num, int32_t den, int32_t bias)
+{
+  double scale, intercept, last, extent, unit;
+  uint32_t shift;
+
+  if ((cal->pointCode - cal->zeroCode < ADC_CAL_MIN_SPAN)
+      || (num == 0) || (den <= 0)) {
+    return adcCalBadScale;
+  }
+
+  // Output units per code, and output at code 0
+  scale = (double)(1 << ADC_CAL_FRACTION_BITS) * cal->pointMv * num
+          / ((double)(cal->pointCode - cal->zeroCode) * den);
+  intercept = bias - (double)cal->zeroCode * cal->pointMv * num
+                     / ((double)(cal->pointCode - cal->zeroCode) * den);
+
+  // Outputs of the first and last codes, the extremes
+  last = intercept + scale * (ADC_CAL_CODES - 1);
+  if ((intercept > ADC_CAL_MAX_OUTPUT) || (intercept < -ADC_CAL_MAX_OUTPUT)
+      || (last > ADC_CAL_MAX_OUTPUT) || (last < -ADC_CAL_MAX_OUTPUT)) {
+    return adcCalBadScale;
+  }
+
+  // Bound of the product, the sum and the rounding, whatever their signs
+  extent = ((scale < 0) ? -scale : scale) * (ADC_CAL_CODES - 1)
+           + ((intercept < 0) ? -intercept : intercept) + 1.0;
+
+  shift = MAX_SHIFT;
+  unit = (double)(1UL << MAX_SHIFT);
+  while (extent * unit >= LIMIT) {
+    shift--;
+    unit /= 2;
+  }
+
+  kernel->gain = roundToInt(scale * unit);
+  kernel->intercept = roundToInt(intercept * unit)
+                      + ((shift > 0) ? (int32_t)(1UL << (shift - 1)) : 0);
+  kernel->shift = shift;
+  return adcCalOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert count 12-bit codes with a kernel; out may be the codes
+ ******************************************************************************/
+void adcCalConvert(const adcCalKernel_TypeDef *kernel, const uint16_t *codes,
+                   uint32_t count, int16_t *out)
+{
+  int32_t gain = kernel->gain;
+  int32_t intercept = kernel->intercept;
+  uint32_t shift = kernel->shift;
+  uint32_t i;
+
+  for (i = 0; i < count; i++) {
+    out[i] = (int16_t)(((int32_t)codes[i] * gain + intercept) >> shift);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Fill a table of ADC_CAL_CODES outputs, one per code, from a kernel
+ ******************************************************************************/
+void adcCalTableInit(const adcCalKernel_TypeDef *kernel, int16_t *table)
+{
+  uint32_t code;
+
+  for (code = 0; code < ADC_CAL_CODES; code++) {
+    table[code] = (int16_t)(((int32_t)code * kernel->gain
+                             + kernel->intercept) >> kernel->shift);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Convert count codes with a table; only the low 12 bits of a code are
+ *   used, and out may be the codes
+ ******************************************************************************/
+void adcCalConvertTable(const int16_t *table, const uint16_t *codes,
+                        uint32_t count, int16_t *out)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++) {
+    out[i] = table[codes[i] & (ADC_CAL_CODES - 1)];
+  }
+}
+
+static uint32_t recordCheck(const adcCalRecord_TypeDef *record)
+{
+  const uint32_t *word = (const uint32_t *)record;
+  uint32_t check = ADC_CAL_MAGIC ^ 0xFFFFFFFFUL;
+  uint32_t i;
+
+  for (i = 0; i < offsetof(adcCalRecord_TypeDef, check) / 4; i++) {
+    check = (check ^ word[i]) * 31;
+  }
+  return check;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Record to store a calibration with
+ ******************************************************************************/
+void adcCalPack(const adcCal_TypeDef *cal, uint32_t tag,
+                adcCalRecord_TypeDef *record)
+{
+  record->magic = ADC_CAL_MAGIC;
+  record->tag = tag;
+  record->cal = *cal;
+  record->check = recordCheck(record);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Calibration of a stored record, if it is whole, was made for tag and
+ *   holds usable points
+ ******************************************************************************/
+bool adcCalUnpack(const adcCalRecord_TypeDef *record, uint32_t tag,
+                  adcCal_TypeDef *cal)
+{
+  if ((record->magic != ADC_CAL_MAGIC) || (record->tag != tag)
+      || (record->check != recordCheck(record))) {
+    return false;
+  }
+  return adcCalTwoPoint(cal, record->cal.zeroCode, record->cal.pointCode,
+                        record->cal.pointMv) == adcCalOk;
+}
@@ -0,0 +1,467 @@
+/**************************************************************************//**
+ * @file
+ * @brief Calibrated ADC frames: the DEVINFO calibration, a runtime offset and
+ * gain calibration stored in flash, and fixed-point conversion of DMA frames
+ * to millivolts and engineering units.
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "em_timer.h"
+#include "em_msc.h"
+#include "ldma_stream.h"
+#include "adc_cal.h"
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired sample frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// External ADC input, see README for the corresponding EXP header pin
+#define ADC_INPUT       adcPosSelAPORT4XCH11
+
+// Full scale of the 2.5V reference, in mV
+#define ADC_REFERENCE   adcRef2V5
+#define FULL_SCALE_MV   2500
+
+// The ADC requests the LDMA once ADC_DVL results are in the single FIFO
+#define ADC_DVL         4
+
+// Double buffering of frames of FRAME_LENGTH samples, a quarter of a second
+#define BUFFER_COUNT    2
+#define FRAME_LENGTH    256
+
+// Conversions averaged for each point of the calibration
+#define CAL_SAMPLES     64
+
+// Voltage on the input during the calibration, in mV, e.g. from a lab
+// supply; with 0 only the offset is calibrated and the gain stays nominal
+#define CAL_POINT_MV    0
+
+// The calibration is kept in the last page of the main flash, and only
+// used for the same reference and point
+#define CAL_PAGE        ((uint32_t*)(FLASH_BASE + FLASH_SIZE - FLASH_PAGE_SIZE))
+#define CAL_TAG         (((uint32_t)ADC_REFERENCE << 16) | CAL_POINT_MV)
+
+// Engineering units: a pressure sensor giving 250 mV to 2250 mV for 0 to
+// 1000 hPa, so hPa = mV / 2 - 125
+#define UNIT_NUM        1
+#define UNIT_DEN        2
+#define UNIT_BIAS       -125
+
+// The conversions are timed in TIMER_PRESCALE cycles so they fit in 16 bits
+#define TIMER_PRESCALE  4
+
+// Factory calibration, as read from DEVINFO, and the trims ADC_InitSingle()
+// loaded from it for ADC_REFERENCE
+typedef struct {
+  uint32_t devinfo[3];      // DEVINFO->ADC0CAL0 to ADC0CAL2
+  uint32_t singleOffset;    // ADC0->CAL fields in use
+  uint32_t singleOffsetInv;
+  uint32_t singleGain;
+} factoryCal_TypeDef;
+
+typedef struct {
+  float averageMv;          // Average of the last frame
+  float averageUnits;       // Same, in hPa
+  float kernelCycles;       // Cycles per sample, multiply-shift kernel
+  float tableCycles;        // Cycles per sample, table
+  float floatCycles;        // Cycles per sample, single precision float
+} calReport_TypeDef;
+
+// Stream of ADC samples
+ldmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][FRAME_LENGTH];
+
+// Conversions of the last frame
+int16_t mvFrame[FRAME_LENGTH];
+int16_t unitFrame[FRAME_LENGTH];
+float floatFrame[FRAME_LENGTH];
+
+// Millivolts with a kernel, engineering units with a table
+static adcCalKernel_TypeDef mvKernel;
+static adcCalKernel_TypeDef unitKernel;
+static int16_t unitTable[ADC_CAL_CODES];
+
+// Conversions of a calibration point
+static uint16_t calSamples[CAL_SAMPLES];
+
+// Values to watch in the debugger
+factoryCal_TypeDef factoryCal;
+adcCal_TypeDef cal;
+bool calFromFlash;
+calReport_TypeDef report;
+volatile uint32_t frameCount;
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are converted in the main loop
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/**************************************************************************//**
+ * @brief Cycles per sample since start, from TIMER0
+ *****************************************************************************/
+static float cyclesPerSample(uint32_t start, uint32_t length)
+{
+  uint32_t cycles = ((TIMER_CounterGet(TIMER0) - start) & 0xFFFF)
+                    * TIMER_PRESCALE;
+
+  return (float)cycles / length;
+}
+
+/**************************************************************************//**
+ * @brief Stream consumer, converts each frame three ways and times them
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint16_t *codes = data;
+  float perCode;
+  float zero;
+  int32_t mvSum = 0;
+  int32_t unitSum = 0;
+  uint32_t start, i;
+
+  (void)overrun;
+  (void)user;
+
+  // Millivolts, multiply-shift kernel
+  start = TIMER_CounterGet(TIMER0);
+  adcCalConvert(&mvKernel, codes, length, mvFrame);
+  report.kernelCycles = cyclesPerSample(start, length);
+
+  // Engineering units, table
+  start = TIMER_CounterGet(TIMER0);
+  adcCalConvertTable(unitTable, codes, length, unitFrame);
+  report.tableCycles = cyclesPerSample(start, length);
+
+  // Millivolts, as an application would write it in floating point
+  start = TIMER_CounterGet(TIMER0);
+  zero = (float)cal.zeroCode;
+  perCode = (float)cal.pointMv / (float)(cal.pointCode - cal.zeroCode);
+  for (i = 0; i < length; i++)
+  {
+    floatFrame[i] = ((float)codes[i] * 16.0f - zero) * perCode;
+  }
+  report.floatCycles = cyclesPerSample(start, length);
+
+  for (i = 0; i < length; i++)
+  {
+    mvSum += mvFrame[i];
+    unitSum += unitFrame[i];
+  }
+  report.averageMv = (float)mvSum / length;
+  report.averageUnits = (float)unitSum / length;
+  frameCount++;
+}
+
+/**************************************************************************//**
+ * @brief TIMER initialization, free running to count cycles
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  timerInit.prescale = timerPrescale4;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+  TIMER_Init(TIMER0, &timerInit);
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization, streams the ADC results into frames
+ *****************************************************************************/
+void initLdma(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+
+  // ADC_DVL 16-bit results per request, the low half of SINGLEDATA
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = ldmaCtrlSizeHalf;
+  config.blockSize   = (LDMA_CtrlBlockSize_t)(ADC_DVL - 1);
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = FRAME_LENGTH;
+  config.length      = FRAME_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if (ldmaStreamInit(&stream, &config) == ldmaStreamOk)
+  {
+    ldmaStreamStart(&stream);
+  }
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *****************************************************************************/
+void initAdc(void)
+{
+  // Declare init struct
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock on demand in EM2
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  // Initialize ADC
+  ADC_Init(ADC0, &init);
+}
+
+/**************************************************************************//**
+ * @brief Single conversions of an input, started by software or by PRS
+ *****************************************************************************/
+static void initSingle(ADC_PosSel_TypeDef input, bool prs)
+{
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  initSingle.posSel     = input;
+  initSingle.reference  = ADC_REFERENCE;
+  initSingle.resolution = adcRes12Bit;
+  initSingle.acqTime    = adcAcqTime16;
+
+  // Conversions are started by PRS, and the LDMA wakes up in EM2 to read
+  // the results
+  initSingle.prsEnable      = prs;
+  initSingle.prsSel         = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  initSingle.singleDmaEm2Wu = prs;
+
+  // Also loads the factory calibration of the reference into ADC0->CAL
+  ADC_InitSingle(ADC0, &initSingle);
+
+  // Set the single data valid level (DVL) and clear the single FIFO
+  ADC0->SINGLECTRLX = (ADC0->SINGLECTRLX & ~_ADC_SINGLECTRLX_DVL_MASK)
+                      | ((prs ? ADC_DVL - 1 : 0) << _ADC_SINGLECTRLX_DVL_SHIFT);
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+}
+
+/**************************************************************************//**
+ * @brief Record the factory calibration, and the trims in use
+ *****************************************************************************/
+static void readFactoryCal(void)
+{
+  factoryCal.devinfo[0] = DEVINFO->ADC0CAL0;
+  factoryCal.devinfo[1] = DEVINFO->ADC0CAL1;
+  factoryCal.devinfo[2] = DEVINFO->ADC0CAL2;
+
+  factoryCal.singleOffset = (ADC0->CAL & _ADC_CAL_SINGLEOFFSET_MASK)
+                            >> _ADC_CAL_SINGLEOFFSET_SHIFT;
+  factoryCal.singleOffsetInv = (ADC0->CAL & _ADC_CAL_SINGLEOFFSETINV_MASK)
+                               >> _ADC_CAL_SINGLEOFFSETINV_SHIFT;
+  factoryCal.singleGain = (ADC0->CAL & _ADC_CAL_SINGLEGAIN_MASK)
+                          >> _ADC_CAL_SINGLEGAIN_SHIFT;
+}
+
+/**************************************************************************//**
+ * @brief Average of CAL_SAMPLES conversions of an input, in 1/16 LSB
+ *****************************************************************************/
+static int32_t measure(ADC_PosSel_TypeDef input)
+{
+  uint32_t i;
+
+  initSingle(input, false);
+  for (i = 0; i < CAL_SAMPLES; i++)
+  {
+    ADC_Start(ADC0, adcStartSingle);
+    while ((ADC0->STATUS & ADC_STATUS_SINGLEDV) == 0);
+    calSamples[i] = (uint16_t)ADC_DataSingleGet(ADC0);
+  }
+  return adcCalAverage(calSamples, CAL_SAMPLES);
+}
+
+/**************************************************************************//**
+ * @brief Runtime calibration on top of the factory trims, stored in flash
+ *
+ * The offset is measured on VSS; a negative offset reads as 0, as the
+ * factory trims leave it small. The gain is measured on the input, at
+ * CAL_POINT_MV.
+ *****************************************************************************/
+static void calibrate(void)
+{
+  adcCalRecord_TypeDef record;
+  int32_t zeroCode, pointCode, pointMv;
+
+  zeroCode = measure(adcPosSelVSS);
+
+#if (CAL_POINT_MV > 0)
+  pointCode = measure(ADC_INPUT);
+  pointMv = CAL_POINT_MV;
+#else
+  pointCode = zeroCode + (ADC_CAL_CODES << ADC_CAL_FRACTION_BITS);
+  pointMv = FULL_SCALE_MV;
+#endif
+
+  if (adcCalTwoPoint(&cal, zeroCode, pointCode, pointMv) == adcCalOk)
+  {
+    adcCalPack(&cal, CAL_TAG, &record);
+    MSC_ErasePage(CAL_PAGE);
+    MSC_WriteWord(CAL_PAGE, &record, sizeof(record));
+  }
+}
+
+/**************************************************************************//**
+ * @brief Calibration from flash, or measured if there is none for CAL_TAG
+ *****************************************************************************/
+static void initCalibration(void)
+{
+  adcCalNominal(&cal, FULL_SCALE_MV);
+
+  initSingle(ADC_INPUT, false);
+  readFactoryCal();
+
+  calFromFlash = adcCalUnpack((const adcCalRecord_TypeDef *)CAL_PAGE,
+                              CAL_TAG, &cal);
+  if (!calFromFlash)
+  {
+    calibrate();
+  }
+
+  // Millivolts and hPa from the same calibration
+  adcCalKernelInit(&mvKernel, &cal, 1, 1, 0);
+  if (adcCalKernelInit(&unitKernel, &cal, UNIT_NUM, UNIT_DEN, UNIT_BIAS)
+      == adcCalOk)
+  {
+    adcCalTableInit(&unitKernel, unitTable);
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  // Init DCDC regulator if available
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  // The calibration is kept in flash
+  MSC_Init();
+
+  // Count conversion cycles
+  initTimer();
+
+  // Setup the ADC, then load or measure the calibration
+  initAdc();
+  initCalibration();
+
+  // Conversions of the input via PRS, streamed into frames by the LDMA
+  initSingle(ADC_INPUT, true);
+  initLdma();
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while(1)
+  {
+    // Enter EM2 until the next frame is filled
+    EMU_EnterEM2(false);
+
+    // Convert the filled frames
+    ldmaStreamProcess(&stream);
+  }
+}
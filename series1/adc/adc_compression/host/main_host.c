@@ -0,0 +1,335 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC frame codecs on a host: checks and benchmark
+ *
+ * Build on its own, see readme.txt. Each codec is checked on frames of all
+ * short lengths and on the traces, lossless ones exactly, ADPCM by its
+ * signal to noise ratio, and encoding in place must give the same bytes.
+ * The traces are then encoded frame by frame, as the LDMA would fill them,
+ * and the compression ratio is printed next to the host time per sample.
+ * The traces are synthetic, or recorded on the kit and given with -f.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "adc_codec.h"
+#include "host_check.h"
+
+#define MAX_SAMPLES         65536
+#define MAX_FRAME           4096
+#define MAX_TRACES          8
+
+typedef struct
+{
+  const char *name;
+  uint16_t *samples;
+  uint32_t length;
+  double minSnr;            /* ADPCM signal to noise ratio expected, dB */
+} trace_TypeDef;
+
+static const adcCodecType_TypeDef codecs[] =
+{
+  adcCodecPack12, adcCodecDelta, adcCodecAdpcm
+};
+
+#define CODEC_COUNT         (sizeof(codecs) / sizeof(codecs[0]))
+
+static trace_TypeDef traces[MAX_TRACES];
+static uint32_t traceCount;
+static uint16_t frame[MAX_FRAME];
+static uint16_t decoded[MAX_FRAME];
+static uint8_t encoded[2 * MAX_FRAME];
+static uint32_t seed = 1;
+
+static const char *codecName(adcCodecType_TypeDef type)
+{
+  return (type == adcCodecPack12) ? "pack12"
+         : (type == adcCodecDelta) ? "delta" : "adpcm";
+}
+
+static uint16_t quantize(double value)
+{
+  value = floor(value + 0.5);
+  return (uint16_t)((value < 0) ? 0 : (value > 4095) ? 4095 : value);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Synthetic 12-bit traces: a quiet DC input, a slow and a fast sine, and
+ *   full scale noise, the worst case of the lossless codecs
+ ******************************************************************************/
+static void synthesize(void)
+{
+  static uint16_t dc[MAX_SAMPLES], slow[MAX_SAMPLES], fast[MAX_SAMPLES];
+  static uint16_t noise[MAX_SAMPLES];
+  uint32_t i;
+
+  for (i = 0; i < MAX_SAMPLES; i++)
+  {
+    dc[i] = quantize(1500.3 + 1.5 * hostGaussian(&seed));
+    slow[i] = quantize(2048 + 1500 * sin(2 * M_PI * i / 1000.0)
+                       + 1.5 * hostGaussian(&seed));
+    fast[i] = quantize(2048 + 1800 * sin(2 * M_PI * i / 12.3)
+                       + 1.5 * hostGaussian(&seed));
+    noise[i] = (uint16_t)(hostUniform(&seed) * 4096);
+  }
+  traces[traceCount++] = (trace_TypeDef){ "dc", dc, MAX_SAMPLES, 10.0 };
+  traces[traceCount++] = (trace_TypeDef){ "slow sine", slow, MAX_SAMPLES, 40.0 };
+  traces[traceCount++] = (trace_TypeDef){ "fast sine", fast, MAX_SAMPLES, 20.0 };
+  traces[traceCount++] = (trace_TypeDef){ "noise", noise, MAX_SAMPLES, 0.0 };
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read a recorded trace, one sample per line or separated by spaces
+ ******************************************************************************/
+static int load(const char *name)
+{
+  FILE *file = fopen(name, "r");
+  uint16_t *samples;
+  uint32_t length = 0;
+  unsigned long value;
+
+  if ( (file == NULL) || (traceCount == MAX_TRACES) )
+  {
+    perror(name);
+    return -1;
+  }
+  samples = malloc(MAX_SAMPLES * sizeof(uint16_t));
+  while ( (length < MAX_SAMPLES) && (fscanf(file, "%lu", &value) == 1) )
+  {
+    samples[length++] = (uint16_t)(value & 0xFFF);
+  }
+  fclose(file);
+  if ( length == 0 )
+  {
+    free(samples);
+    return -1;
+  }
+  traces[traceCount++] = (trace_TypeDef){ name, samples, length, 0.0 };
+  return 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Signal to noise ratio of the decoded samples, about their mean
+ ******************************************************************************/
+static double snr(const uint16_t *in, const uint16_t *out, uint32_t count)
+{
+  double mean = 0, signal = 0, noise = 0;
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    mean += in[i];
+  }
+  mean /= count;
+  for (i = 0; i < count; i++)
+  {
+    signal += (in[i] - mean) * (in[i] - mean);
+    noise += ((double)in[i] - out[i]) * ((double)in[i] - out[i]);
+  }
+  return (noise == 0) ? 99.0 : 10.0 * log10(signal / noise);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Encode a frame both ways, check the size, the in place encoding and
+ *   the decoded samples; returns the bytes
+ ******************************************************************************/
+static uint32_t checkFrame(adcCodecType_TypeDef type, const uint16_t *in,
+                           uint32_t count)
+{
+  uint32_t bytes, n;
+
+  bytes = adcCodecEncode(type, in, count, encoded);
+  CHECK(bytes <= ADC_CODEC_MAX_BYTES(type, count));
+  CHECK(ADC_CODEC_MAX_BYTES(type, count) <= 2 * count);
+
+  memcpy(frame, in, count * sizeof(frame[0]));
+  n = adcCodecEncode(type, frame, count, (uint8_t *)frame);
+  CHECK((n == bytes) && (memcmp(frame, encoded, bytes) == 0));
+
+  n = adcCodecDecode(type, encoded, bytes, decoded, MAX_FRAME);
+  CHECK(n == count);
+  if ( ((type != adcCodecAdpcm) || (count < ADC_CODEC_ADPCM_MIN))
+       && (count > 0) )
+  {
+    CHECK(memcmp(decoded, in, count * sizeof(in[0])) == 0);
+  }
+  if ( (type == adcCodecAdpcm) && (count > 0) )
+  {
+    CHECK(decoded[0] == in[0]);
+  }
+  return bytes;
+}
+
+static void checkCodecs(void)
+{
+  static const uint16_t steps[] = { 0, 4095, 0, 4095, 4095, 0, 1, 4094 };
+  uint32_t c, t, count, i, n;
+  double ratio;
+
+  for (c = 0; c < CODEC_COUNT; c++)
+  {
+    /* All short lengths, in place too */
+    for (count = 0; count <= 64; count++)
+    {
+      checkFrame(codecs[c], traces[1].samples, count);
+    }
+
+    /* Full scale steps, and higher bits ignored */
+    checkFrame(codecs[c], steps, sizeof(steps) / sizeof(steps[0]));
+    for (i = 0; i < 16; i++)
+    {
+      frame[i] = (uint16_t)(0xF000 | (i * 255));
+    }
+    n = adcCodecEncode(codecs[c], frame, 16, encoded);
+    CHECK(adcCodecDecode(codecs[c], encoded, n, decoded, 16) == 16);
+    CHECK((decoded[0] == 0) && (decoded[15] <= 4095));
+
+    /* Decoding stops at maxCount */
+    n = adcCodecEncode(codecs[c], traces[1].samples, 100, encoded);
+    CHECK(adcCodecDecode(codecs[c], encoded, n, decoded, 37) == 37);
+
+    /* Traces in frames of 1024, ADPCM close enough to the input */
+    for (t = 0; t < traceCount; t++)
+    {
+      for (i = 0; i + 1024 <= traces[t].length; i += 1024)
+      {
+        checkFrame(codecs[c], traces[t].samples + i, 1024);
+        if ( codecs[c] == adcCodecAdpcm )
+        {
+          ratio = snr(traces[t].samples + i, decoded, 1024);
+          CHECK(ratio >= traces[t].minSnr);
+        }
+      }
+    }
+  }
+
+  /* Quiet signals take 1 byte per sample with differences */
+  n = adcCodecEncode(adcCodecDelta, traces[0].samples, 1024, encoded);
+  CHECK(n < 1024 + 8);
+}
+
+static double now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Ratio and host time per sample of each codec on each trace
+ ******************************************************************************/
+static void benchmark(uint32_t frameLength)
+{
+  const trace_TypeDef *trace;
+  double start, encodeTime, decodeTime, quality;
+  uint32_t c, t, i, n, bytes, runs, samples;
+
+  printf("frames of %u samples\n", (unsigned)frameLength);
+  printf("trace       codec   bytes/sample  vs u16  vs u32  "
+         "encode ns  decode ns  snr dB\n");
+
+  for (t = 0; t < traceCount; t++)
+  {
+    trace = &traces[t];
+    samples = trace->length - trace->length % frameLength;
+    for (c = 0; c < CODEC_COUNT; c++)
+    {
+      /* Size and quality */
+      bytes = 0;
+      quality = 0;
+      for (i = 0; i < samples; i += frameLength)
+      {
+        n = adcCodecEncode(codecs[c], trace->samples + i, frameLength, encoded);
+        bytes += n;
+        adcCodecDecode(codecs[c], encoded, n, decoded, frameLength);
+        quality += snr(trace->samples + i, decoded, frameLength);
+      }
+      quality /= samples / frameLength;
+
+      /* In place, on a copy of each frame as the LDMA would leave it */
+      runs = 0;
+      encodeTime = 0;
+      decodeTime = 0;
+      do
+      {
+        for (i = 0; i < samples; i += frameLength)
+        {
+          memcpy(frame, trace->samples + i, frameLength * sizeof(frame[0]));
+          start = now();
+          n = adcCodecEncode(codecs[c], frame, frameLength, (uint8_t *)frame);
+          encodeTime += now() - start;
+          start = now();
+          adcCodecDecode(codecs[c], (uint8_t *)frame, n, decoded, frameLength);
+          decodeTime += now() - start;
+        }
+        runs++;
+      } while ( encodeTime + decodeTime < 0.1 );
+
+      printf("%-11.11s %-7s %12.3f %7.2f %7.2f %10.2f %10.2f %7.1f\n",
+             trace->name, codecName(codecs[c]), (double)bytes / samples,
+             2.0 * samples / bytes, 4.0 * samples / bytes,
+             encodeTime * 1e9 / ((double)runs * samples),
+             decodeTime * 1e9 / ((double)runs * samples), quality);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t frameLength = 1024;
+  int option;
+
+  synthesize();
+
+  while ( (option = getopt(argc, argv, "f:n:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'f':
+        if ( load(optarg) != 0 )
+        {
+          return 1;
+        }
+        break;
+
+      case 'n':
+        frameLength = (uint32_t)atoi(optarg);
+        break;
+
+      default:
+        printf("usage: %s [-f trace] [-n frame length]\n", argv[0]);
+        return 1;
+    }
+  }
+  if ( (frameLength < 4) || (frameLength > MAX_FRAME) )
+  {
+    printf("frame length from 4 to %u\n", MAX_FRAME);
+    return 1;
+  }
+
+  checkCodecs();
+  benchmark(frameLength);
+
+  hostCheckReport();
+  return 0;
+}
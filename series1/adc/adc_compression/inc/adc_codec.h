@@ -0,0 +1,55 @@
+/***************************************************************************//**
+ * @file  adc_codec.h
+ * @brief Compression of frames of 12-bit ADC samples
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_CODEC_H
+#define ADC_CODEC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  adcCodecPack12,           // Lossless, 2 samples in 3 bytes
+  adcCodecDelta,            // Lossless, zigzag varint of the differences,
+                            // 1 byte for differences of -64 to 63
+  adcCodecAdpcm             // Lossy, IMA ADPCM, 4 bits per sample
+} adcCodecType_TypeDef;
+
+// ADPCM frame header: first sample, step index and padding flag
+#define ADC_CODEC_ADPCM_HEADER  4
+
+// ADPCM frames shorter than this hold the samples as 16-bit words instead,
+// as the header would make them larger than that
+#define ADC_CODEC_ADPCM_MIN     3
+
+// Largest encoded frame of 'count' samples, never more than 2 * count bytes
+// so a frame can be encoded in place
+#define ADC_CODEC_MAX_BYTES(type, count)                                  \
+  (((type) == adcCodecPack12) ? (3 * (count) + 1) / 2                      \
+   : ((type) == adcCodecDelta) ? 2 * (count)                               \
+   : ((count) < ADC_CODEC_ADPCM_MIN) ? 2 * (count)                         \
+   : ADC_CODEC_ADPCM_HEADER + (count) / 2)
+
+uint32_t adcCodecEncode(adcCodecType_TypeDef type, const uint16_t *samples,
+                        uint32_t count, uint8_t *out);
+uint32_t adcCodecDecode(adcCodecType_TypeDef type, const uint8_t *in,
+                        uint32_t bytes, uint16_t *samples, uint32_t maxCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_CODEC_H
@@ -0,0 +1,382 @@
+/***************************************************************************//**
+ * @file adc_codec.c
+ * @brief Compression of frames of 12-bit ADC samples.
+ *
+ * Three codecs for frames of 16-bit words holding 12-bit samples, as the
+ * LDMA stores them from the ADC data registers:
+ * - 12-bit packing, 2 samples in 3 bytes, lossless
+ * - the differences from one sample to the next, zigzag encoded (0, -1, 1,
+ *   -2 ... to 0, 1, 2, 3 ...) and stored in 7-bit groups, lossless; 1 byte
+ *   for differences of -64 to 63, 2 bytes for the others
+ * - IMA ADPCM, 4 bits per sample, lossy, on the samples scaled to 16 bits
+ *
+ * Each frame is encoded on its own, so it can be decoded without the ones
+ * before it, e.g. when one is lost in transmission. The work per sample is
+ * bounded: no codec loops or branches more for some samples than for
+ * others beyond a fixed number of steps.
+ *
+ * The output is never written ahead of the samples not read yet, so a
+ * frame can be encoded in place, in the buffer the LDMA filled, which holds
+ * the ADC_CODEC_MAX_BYTES() of every codec: at most 2 * count bytes. ADPCM
+ * frames of fewer than ADC_CODEC_ADPCM_MIN samples are stored as they are,
+ * as with the header they would take more than that.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "adc_codec.h"
+
+#define SAMPLE_MASK     0x0FFF
+#define SAMPLE_MAX      4095
+
+// ADPCM works on signed 16-bit values: 12-bit samples less the mid-scale,
+// times 16
+#define ADPCM_OFFSET    2048
+#define ADPCM_SHIFT     4
+#define ADPCM_INDEX_MAX 88
+#define ADPCM_PAD       0x01    // Header flag: the last nibble is padding
+
+static const int8_t adpcmIndexTable[16] = {
+  -1, -1, -1, -1, 2, 4, 6, 8,
+  -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const uint16_t adpcmStepTable[ADPCM_INDEX_MAX + 1] = {
+  7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+  19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+  50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+  130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+  337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+  876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+  2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+  5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+  15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+typedef struct {
+  int32_t predicted;        // Signed 16-bit
+  int32_t index;
+} adpcmState_TypeDef;
+
+/**************************************************************************//**
+ * @brief
+ *    Pack pairs of samples into 3 bytes, low bits first; an odd last
+ *    sample takes 2 bytes
+ *****************************************************************************/
+static uint32_t packEncode(const uint16_t *samples, uint32_t count,
+                           uint8_t *out)
+{
+  uint8_t *p = out;
+  uint32_t a, b, i;
+
+  for (i = 0; i + 1 < count; i += 2) {
+    a = samples[i] & SAMPLE_MASK;
+    b = samples[i + 1] & SAMPLE_MASK;
+    *p++ = (uint8_t)a;
+    *p++ = (uint8_t)((a >> 8) | (b << 4));
+    *p++ = (uint8_t)(b >> 4);
+  }
+  if (i < count) {
+    a = samples[i] & SAMPLE_MASK;
+    *p++ = (uint8_t)a;
+    *p++ = (uint8_t)(a >> 8);
+  }
+  return (uint32_t)(p - out);
+}
+
+static uint32_t packDecode(const uint8_t *in, uint32_t bytes,
+                           uint16_t *samples, uint32_t maxCount)
+{
+  uint32_t count = 0;
+  uint32_t i;
+
+  for (i = 0; (i + 3 <= bytes) && (count < maxCount); i += 3) {
+    samples[count++] = (uint16_t)(in[i] | ((in[i + 1] & 0x0F) << 8));
+    if (count < maxCount) {
+      samples[count++] = (uint16_t)((in[i + 1] >> 4) | (in[i + 2] << 4));
+    }
+  }
+  if ((i + 2 == bytes) && (count < maxCount)) {
+    samples[count++] = (uint16_t)(in[i] | ((in[i + 1] & 0x0F) << 8));
+  }
+  return count;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Zigzag varint of the differences, the first from 0
+ *****************************************************************************/
+static uint32_t deltaEncode(const uint16_t *samples, uint32_t count,
+                            uint8_t *out)
+{
+  uint8_t *p = out;
+  int32_t previous = 0;
+  int32_t sample, difference;
+  uint32_t zigzag, i;
+
+  for (i = 0; i < count; i++) {
+    sample = samples[i] & SAMPLE_MASK;
+    difference = sample - previous;
+    previous = sample;
+
+    // 13-bit differences, so at most 14 bits once zigzag encoded
+    zigzag = ((uint32_t)difference << 1) ^ (uint32_t)(difference >> 31);
+    if (zigzag < 0x80) {
+      *p++ = (uint8_t)zigzag;
+    } else {
+      *p++ = (uint8_t)(zigzag | 0x80);
+      *p++ = (uint8_t)(zigzag >> 7);
+    }
+  }
+  return (uint32_t)(p - out);
+}
+
+static uint32_t deltaDecode(const uint8_t *in, uint32_t bytes,
+                            uint16_t *samples, uint32_t maxCount)
+{
+  uint32_t count = 0;
+  uint32_t sample = 0;
+  uint32_t zigzag, i = 0;
+
+  while ((i < bytes) && (count < maxCount)) {
+    zigzag = in[i++];
+    if (zigzag & 0x80) {
+      if (i == bytes) {
+        break;
+      }
+      zigzag = (zigzag & 0x7F) | ((uint32_t)in[i++] << 7);
+    }
+    sample += (zigzag >> 1) ^ (0 - (zigzag & 1));
+    samples[count++] = (uint16_t)(sample & SAMPLE_MASK);
+  }
+  return count;
+}
+
+static int32_t adpcmScale(uint16_t sample)
+{
+  return ((int32_t)(sample & SAMPLE_MASK) - ADPCM_OFFSET) * (1 << ADPCM_SHIFT);
+}
+
+static uint16_t adpcmUnscale(int32_t value)
+{
+  value = (value + (ADPCM_OFFSET << ADPCM_SHIFT) + (1 << (ADPCM_SHIFT - 1)))
+          >> ADPCM_SHIFT;
+  return (uint16_t)((value > SAMPLE_MAX) ? SAMPLE_MAX : value);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Update the predictor with a 4-bit code, as the decoder does
+ *****************************************************************************/
+static void adpcmUpdate(adpcmState_TypeDef *state, uint32_t code)
+{
+  int32_t step = adpcmStepTable[state->index];
+  int32_t difference = step >> 3;
+
+  if (code & 4) {
+    difference += step;
+  }
+  if (code & 2) {
+    difference += step >> 1;
+  }
+  if (code & 1) {
+    difference += step >> 2;
+  }
+  state->predicted += (code & 8) ? -difference : difference;
+  if (state->predicted > 32767) {
+    state->predicted = 32767;
+  } else if (state->predicted < -32768) {
+    state->predicted = -32768;
+  }
+
+  state->index += adpcmIndexTable[code];
+  if (state->index < 0) {
+    state->index = 0;
+  } else if (state->index > ADPCM_INDEX_MAX) {
+    state->index = ADPCM_INDEX_MAX;
+  }
+}
+
+static uint32_t adpcmCode(adpcmState_TypeDef *state, int32_t value)
+{
+  int32_t step = adpcmStepTable[state->index];
+  int32_t difference = value - state->predicted;
+  uint32_t code = 0;
+
+  if (difference < 0) {
+    code = 8;
+    difference = -difference;
+  }
+  if (difference >= step) {
+    code |= 4;
+    difference -= step;
+  }
+  if (difference >= (step >> 1)) {
+    code |= 2;
+    difference -= step >> 1;
+  }
+  if (difference >= (step >> 2)) {
+    code |= 1;
+  }
+  adpcmUpdate(state, code);
+  return code;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Samples as 16-bit words, low byte first, for ADPCM frames too short
+ *    for the header
+ *****************************************************************************/
+static uint32_t rawEncode(const uint16_t *samples, uint32_t count,
+                          uint8_t *out)
+{
+  uint16_t sample;
+  uint32_t i;
+
+  for (i = 0; i < count; i++) {
+    sample = samples[i] & SAMPLE_MASK;
+    out[2 * i] = (uint8_t)sample;
+    out[2 * i + 1] = (uint8_t)(sample >> 8);
+  }
+  return 2 * count;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    IMA ADPCM: a header with the first sample and the first step index,
+ *    then one nibble per following sample, low nibble first
+ *
+ * @details
+ *    The first step is the one closest to the first difference, so a frame
+ *    decodes on its own without a long settling of the step size. Frames
+ *    of fewer than ADC_CODEC_ADPCM_MIN samples are stored raw; they are the
+ *    only ones of ADC_CODEC_ADPCM_HEADER bytes or less.
+ *****************************************************************************/
+static uint32_t adpcmEncode(const uint16_t *samples, uint32_t count,
+                            uint8_t *out)
+{
+  adpcmState_TypeDef state;
+  uint8_t *p = out + ADC_CODEC_ADPCM_HEADER;
+  uint16_t first, second;
+  int32_t difference;
+  uint32_t low, high, i;
+
+  if (count < ADC_CODEC_ADPCM_MIN) {
+    return rawEncode(samples, count, out);
+  }
+
+  // Read the samples the header overwrites first
+  first = samples[0] & SAMPLE_MASK;
+  second = samples[1];
+  difference = adpcmScale(second) - adpcmScale(first);
+  if (difference < 0) {
+    difference = -difference;
+  }
+  state.predicted = adpcmScale(first);
+  state.index = 0;
+  while ((state.index < ADPCM_INDEX_MAX)
+         && (adpcmStepTable[state.index] < difference)) {
+    state.index++;
+  }
+
+  out[0] = (uint8_t)first;
+  out[1] = (uint8_t)(first >> 8);
+  out[2] = (uint8_t)state.index;
+  out[3] = (count % 2 == 0) ? ADPCM_PAD : 0;
+
+  // Samples 1 and 2 in the first byte, 3 and 4 in the next ...; sample 1
+  // was read before the header was written
+  for (i = 1; i < count; i += 2) {
+    low = adpcmCode(&state, adpcmScale((i == 1) ? second : samples[i]));
+    high = (i + 1 < count) ? adpcmCode(&state, adpcmScale(samples[i + 1])) : 0;
+    *p++ = (uint8_t)(low | (high << 4));
+  }
+  return (uint32_t)(p - out);
+}
+
+static uint32_t adpcmDecode(const uint8_t *in, uint32_t bytes,
+                            uint16_t *samples, uint32_t maxCount)
+{
+  adpcmState_TypeDef state;
+  uint32_t count, total, i;
+
+  if (bytes <= ADC_CODEC_ADPCM_HEADER) {
+    for (count = 0; (count < bytes / 2) && (count < maxCount); count++) {
+      samples[count] = (uint16_t)((in[2 * count] | (in[2 * count + 1] << 8))
+                                  & SAMPLE_MASK);
+    }
+    return count;
+  }
+  if ((maxCount == 0) || (in[2] > ADPCM_INDEX_MAX)) {
+    return 0;
+  }
+  total = 1 + 2 * (bytes - ADC_CODEC_ADPCM_HEADER)
+          - ((in[3] & ADPCM_PAD) ? 1 : 0);
+  if (total > maxCount) {
+    total = maxCount;
+  }
+
+  samples[0] = (uint16_t)((in[0] | (in[1] << 8)) & SAMPLE_MASK);
+  state.predicted = adpcmScale(samples[0]);
+  state.index = in[2];
+  for (count = 1, i = ADC_CODEC_ADPCM_HEADER; count < total; count++) {
+    adpcmUpdate(&state, (count & 1) ? (in[i] & 0x0F) : (in[i++] >> 4));
+    samples[count] = adpcmUnscale(state.predicted);
+  }
+  return total;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Encode a frame of samples, of which only the low 12 bits are used
+ *
+ * @details
+ *    'out' may be the samples themselves, see the file description.
+ *
+ * @return
+ *    Bytes written, at most ADC_CODEC_MAX_BYTES(type, count)
+ *****************************************************************************/
+uint32_t adcCodecEncode(adcCodecType_TypeDef type, const uint16_t *samples,
+                        uint32_t count, uint8_t *out)
+{
+  switch (type) {
+    case adcCodecPack12:
+      return packEncode(samples, count, out);
+    case adcCodecDelta:
+      return deltaEncode(samples, count, out);
+    case adcCodecAdpcm:
+      return adpcmEncode(samples, count, out);
+    default:
+      return 0;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Decode a frame encoded by adcCodecEncode()
+ *
+ * @return
+ *    Samples decoded, at most maxCount
+ *****************************************************************************/
+uint32_t adcCodecDecode(adcCodecType_TypeDef type, const uint8_t *in,
+                        uint32_t bytes, uint16_t *samples, uint32_t maxCount)
+{
+  switch (type) {
+    case adcCodecPack12:
+      return packDecode(in, bytes, samples, maxCount);
+    case adcCodecDelta:
+      return deltaDecode(in, bytes, samples, maxCount);
+    case adcCodecAdpcm:
+      return adpcmDecode(in, bytes, samples, maxCount);
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,340 @@
+/**************************************************************************//**
+ * @file
+ * @brief Compress frames of ADC samples in place, in EM2, with 12-bit
+ * packing, delta-zigzag-varint or IMA ADPCM.
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "em_timer.h"
+#include "ldma_stream.h"
+#include "adc_codec.h"
+
+// Change this to set how many samples get sent at once
+#define ADC_DVL         2
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired sample frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// Double buffering of frames of FRAME_LENGTH 16-bit samples, each one is
+// encoded in place once full
+#define BUFFER_COUNT    2
+#define FRAME_LENGTH    1024
+
+// Frames encoded with each codec before moving on to the next one
+#define CODEC_FRAMES    4
+
+// Raw samples kept for the host benchmark
+#define TRACE_LENGTH    4096
+
+// The codecs are timed in TIMER_PRESCALE cycles so a frame fits in 16 bits
+#define TIMER_PRESCALE  4
+
+static const adcCodecType_TypeDef codecs[] = {
+  adcCodecPack12,
+  adcCodecDelta,
+  adcCodecAdpcm
+};
+
+#define CODEC_COUNT     (sizeof(codecs) / sizeof(codecs[0]))
+
+typedef struct {
+  float bytesPerSample;     // Encoded size
+  float wordRatio;          // Compression from the 32-bit words of adcBuffer
+                            // in adc_single_letimer_prs_dma
+  float cyclesPerSample;    // Average over the frames
+  float maxCyclesPerSample; // Worst frame
+} codecReport_TypeDef;
+
+// Stream of ADC samples
+ldmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][FRAME_LENGTH];
+
+// Values to watch in the debugger
+codecReport_TypeDef report[CODEC_COUNT];
+volatile uint32_t currentCodec;
+volatile uint32_t rounds;
+volatile uint32_t gapCount;
+uint16_t rawTrace[TRACE_LENGTH];
+volatile uint32_t rawCount;
+
+// Totals for the codec being measured
+static uint32_t codecFrames;
+static uint32_t codecBytes;
+static uint32_t codecCycles;
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are encoded in the main loop
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/**************************************************************************//**
+ * @brief Stream consumer, encodes each frame in place and times the codec
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  // The frame belongs to the consumer until it returns, so it is encoded
+  // in place
+  uint16_t *samples = (uint16_t *)data;
+  codecReport_TypeDef *r = &report[currentCodec];
+  uint32_t start, cycles, bytes, i;
+  float perSample;
+
+  (void)user;
+
+  if (overrun)
+  {
+    gapCount++;
+  }
+
+  // Keep the first raw samples, e.g. to export them for the host benchmark
+  for (i = 0; (i < length) && (rawCount < TRACE_LENGTH); i++)
+  {
+    rawTrace[rawCount++] = samples[i];
+  }
+
+  // TIMER0 counts HFPERCLK cycles, the core clock as HFPERCLK is not divided
+  start = TIMER_CounterGet(TIMER0);
+  bytes = adcCodecEncode(codecs[currentCodec], samples, length,
+                         (uint8_t *)samples);
+  cycles = ((TIMER_CounterGet(TIMER0) - start) & 0xFFFF) * TIMER_PRESCALE;
+
+  // The frame now holds 'bytes' encoded bytes, to be stored or sent before
+  // returning
+  codecFrames++;
+  codecBytes += bytes;
+  codecCycles += cycles;
+  perSample = (float)cycles / length;
+  if (perSample > r->maxCyclesPerSample)
+  {
+    r->maxCyclesPerSample = perSample;
+  }
+
+  // Enough frames: report on this codec and go on with the next one
+  if (codecFrames == CODEC_FRAMES)
+  {
+    r->bytesPerSample = (float)codecBytes / (CODEC_FRAMES * length);
+    r->wordRatio = 4.0f / r->bytesPerSample;
+    r->cyclesPerSample = (float)codecCycles / (CODEC_FRAMES * length);
+
+    codecFrames = 0;
+    codecBytes = 0;
+    codecCycles = 0;
+    currentCodec++;
+    if (currentCodec == CODEC_COUNT)
+    {
+      currentCodec = 0;
+      rounds++;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief TIMER initialization, free running to count cycles
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  timerInit.prescale = timerPrescale4;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+  TIMER_Init(TIMER0, &timerInit);
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization, streams the ADC results into frames
+ *****************************************************************************/
+void initLdma(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+
+  // ADC_DVL 16-bit results per request, the low half of SINGLEDATA
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = ldmaCtrlSizeHalf;
+  config.blockSize   = (LDMA_CtrlBlockSize_t)(ADC_DVL - 1);
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = FRAME_LENGTH;
+  config.length      = FRAME_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if (ldmaStreamInit(&stream, &config) == ldmaStreamOk)
+  {
+    ldmaStreamStart(&stream);
+  }
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *****************************************************************************/
+void initAdc(void)
+{
+  // Declare init structs
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(cmuClock_ADC0, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock in EM2 when necessary
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+  // DMA is available in EM2 for processing SINGLEFIFO DVL request
+  initSingle.singleDmaEm2Wu = 1;
+
+  // Add external ADC input. See README for corresponding EXP header pin.
+  initSingle.posSel = adcPosSelAPORT0XCH2;
+
+  // Basic ADC single configuration
+  initSingle.diff = false;              // single-ended
+  initSingle.reference  = adcRef2V5;    // 2.5V reference
+  initSingle.resolution = adcRes12Bit;  // 12-bit resolution
+  initSingle.acqTime    = adcAcqTime4;  // set acquisition time to meet minimum requirements
+
+  // Enable PRS trigger and select channel 0
+  initSingle.prsEnable = true;
+  initSingle.prsSel = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+
+  // Initialize ADC
+  ADC_Init(ADC0, &init);
+  ADC_InitSingle(ADC0, &initSingle);
+
+  // Set single data valid level (DVL)
+  ADC0->SINGLECTRLX = (ADC0->SINGLECTRLX & ~_ADC_SINGLECTRLX_DVL_MASK) | (((ADC_DVL - 1) << _ADC_SINGLECTRLX_DVL_SHIFT) & _ADC_SINGLECTRLX_DVL_MASK);
+
+  // Clear the Single FIFO
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  // Count codec cycles
+  initTimer();
+
+  // Setup ADC to perform conversions via PRS
+  initAdc();
+  // Setup the LDMA to stream the results into frames
+  initLdma();
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while(1)
+  {
+    // Enter EM2 until the next frame is filled
+    EMU_EnterEM2(false);
+
+    // Encode the filled frames
+    ldmaStreamProcess(&stream);
+  }
+}
@@ -0,0 +1,255 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC frame summaries and flash log on a host
+ *
+ * Build on its own, see readme.txt. The summaries of random and edge case
+ * frames are checked against a floating point reference, then the log is
+ * run on pages in RAM: it wraps around, is found again after a reset, and
+ * skips a summary whose write was cut short.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "adc_summary.h"
+#include "adc_log.h"
+#include "host_check.h"
+
+#define PAGE_SIZE           256
+#define PAGE_COUNT          3
+#define SLOTS_PER_PAGE      (PAGE_SIZE / sizeof(adcSummary_TypeDef))
+
+static uint32_t flash[PAGE_COUNT * PAGE_SIZE / sizeof(uint32_t)];
+static uint16_t samples[ADC_SUMMARY_MAX_COUNT];
+static uint32_t seed = 1;
+
+/* Words left before a write is cut short, as by a reset */
+static uint32_t wordsLeft = UINT32_MAX;
+
+/***************************************************************************//**
+ * @brief
+ *   Flash erase on RAM, checking the page is one of the log
+ ******************************************************************************/
+static void ramErase(uint32_t *page)
+{
+  CHECK(((page - flash) % (PAGE_SIZE / 4) == 0)
+        && (page >= flash) && (page < flash + PAGE_COUNT * PAGE_SIZE / 4));
+  memset(page, 0xFF, PAGE_SIZE);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash write on RAM, which like flash can only clear bits
+ ******************************************************************************/
+static void ramWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  uint32_t i;
+
+  for (i = 0; i < bytes / 4; i++)
+  {
+    if ( wordsLeft == 0 )
+    {
+      return;
+    }
+    wordsLeft--;
+    dst[i] &= src[i];
+  }
+}
+
+static const adcLogConfig_TypeDef config =
+{
+  flash, PAGE_COUNT, PAGE_SIZE, ramErase, ramWrite
+};
+
+/***************************************************************************//**
+ * @brief
+ *   Check a summary against a floating point computation
+ ******************************************************************************/
+static void checkSummary(const uint16_t *in, uint32_t count)
+{
+  adcSummary_TypeDef summary;
+  double sum = 0, squares = 0, mean, rms;
+  uint32_t min = 0xFFFF, max = 0;
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    sum += in[i];
+    min = (in[i] < min) ? in[i] : min;
+    max = (in[i] > max) ? in[i] : max;
+  }
+  mean = sum / count;
+  for (i = 0; i < count; i++)
+  {
+    squares += (in[i] - mean) * (in[i] - mean);
+  }
+  rms = sqrt(squares / count);
+
+  adcSummarise(in, count, &summary);
+  CHECK(summary.count == count);
+  CHECK((summary.min == min) && (summary.max == max));
+
+  /* 1/16 LSB, rounded, and never all ones */
+  mean *= 1 << ADC_SUMMARY_FRACTION_BITS;
+  rms *= 1 << ADC_SUMMARY_FRACTION_BITS;
+  mean = (mean > 0xFFFE) ? 0xFFFE : mean;
+  rms = (rms > 0xFFFE) ? 0xFFFE : rms;
+  CHECK(fabs(summary.mean - mean) <= 0.5);
+  CHECK(fabs(summary.rms - rms) <= 0.5 + 1e-6 * rms);
+}
+
+static void checkSummaries(void)
+{
+  adcSummary_TypeDef summary;
+  uint32_t i, run;
+
+  /* Random 12-bit frames of various lengths */
+  for (run = 0; run < 50; run++)
+  {
+    for (i = 0; i < ADC_SUMMARY_MAX_COUNT; i++)
+    {
+      samples[i] = (uint16_t)(hostRandom(&seed) & 0xFFF);
+    }
+    checkSummary(samples, 1 + hostRandom(&seed) % ADC_SUMMARY_MAX_COUNT);
+  }
+
+  /* Small noise on a large level */
+  for (i = 0; i < ADC_SUMMARY_MAX_COUNT; i++)
+  {
+    samples[i] = (uint16_t)(3000 + hostRandom(&seed) % 3);
+  }
+  checkSummary(samples, ADC_SUMMARY_MAX_COUNT);
+
+  /* A constant, a single sample, and 16-bit full scale */
+  for (i = 0; i < ADC_SUMMARY_MAX_COUNT; i++)
+  {
+    samples[i] = 1234;
+  }
+  checkSummary(samples, 100);
+  adcSummarise(samples, 100, &summary);
+  CHECK((summary.mean == 1234 << 4) && (summary.rms == 0));
+  checkSummary(samples, 1);
+  for (i = 0; i < ADC_SUMMARY_MAX_COUNT; i++)
+  {
+    samples[i] = (i & 1) ? 0xFFFF : 0;
+  }
+  checkSummary(samples, ADC_SUMMARY_MAX_COUNT);
+
+  /* An empty frame */
+  adcSummarise(samples, 0, &summary);
+  CHECK((summary.count == 0) && (summary.mean == 0) && (summary.rms == 0));
+}
+
+static void append(adcLog_TypeDef *log, uint16_t value)
+{
+  adcSummary_TypeDef summary;
+
+  samples[0] = value;
+  adcSummarise(samples, 1, &summary);
+  adcLogAppend(log, &summary);
+}
+
+static void checkLog(void)
+{
+  adcLog_TypeDef log;
+  adcLogConfig_TypeDef bad = config;
+  adcSummary_TypeDef summary;
+  uint32_t i, appended;
+
+  bad.pageCount = 1;
+  CHECK(adcLogInit(&log, &bad) == adcLogBadConfig);
+  bad = config;
+  bad.pageSize = 100;
+  CHECK(adcLogInit(&log, &bad) == adcLogBadConfig);
+
+  /* Blank flash: an empty log, and no erase */
+  memset(flash, 0xFF, sizeof(flash));
+  CHECK(adcLogInit(&log, &config) == adcLogOk);
+  CHECK((adcLogCount(&log) == 0) && (log.erases == 0));
+  CHECK(adcLogRead(&log, 0, &summary) == adcLogEmpty);
+
+  /* Fill it twice over: the oldest page is dropped a page at a time */
+  appended = 2 * PAGE_COUNT * SLOTS_PER_PAGE + 5;
+  for (i = 0; i < appended; i++)
+  {
+    append(&log, (uint16_t)i);
+    CHECK(adcLogCount(&log) < PAGE_COUNT * SLOTS_PER_PAGE);
+    CHECK((adcLogCount(&log) >= (PAGE_COUNT - 1) * SLOTS_PER_PAGE)
+          || (adcLogCount(&log) == i + 1));
+  }
+  CHECK(log.erases == appended / SLOTS_PER_PAGE - PAGE_COUNT + 1);
+  CHECK(log.wordsWritten == appended * sizeof(summary) / 4);
+  CHECK(adcLogCount(&log) == (PAGE_COUNT - 1) * SLOTS_PER_PAGE + 5);
+  for (i = 0; i < adcLogCount(&log); i++)
+  {
+    CHECK(adcLogRead(&log, i, &summary) == adcLogOk);
+    CHECK((summary.sequence == appended - 1 - i)
+          && (summary.min == (uint16_t)(appended - 1 - i)));
+  }
+  CHECK(adcLogRead(&log, adcLogCount(&log), &summary) == adcLogEmpty);
+
+  /* After a reset, the log carries on from the newest summary */
+  CHECK(adcLogInit(&log, &config) == adcLogOk);
+  CHECK(adcLogCount(&log) == (PAGE_COUNT - 1) * SLOTS_PER_PAGE + 5);
+  CHECK((adcLogRead(&log, 0, &summary) == adcLogOk)
+        && (summary.sequence == appended - 1));
+  append(&log, 7);
+  CHECK((adcLogRead(&log, 0, &summary) == adcLogOk)
+        && (summary.sequence == appended) && (summary.min == 7));
+  appended++;
+
+  /* A reset right after the last summary of a page: the next page is
+     erased on init, and only then */
+  while ( log.next % SLOTS_PER_PAGE != 0 )
+  {
+    append(&log, 1);
+    appended++;
+  }
+  CHECK(adcLogInit(&log, &config) == adcLogOk);
+  CHECK(log.erases == 0);
+  CHECK(adcLogCount(&log) == (PAGE_COUNT - 1) * SLOTS_PER_PAGE);
+
+  /* A write cut short: the summary is skipped, the next ones are not */
+  wordsLeft = 2;
+  append(&log, 2);
+  wordsLeft = UINT32_MAX;
+  CHECK(adcLogInit(&log, &config) == adcLogOk);
+  CHECK(adcLogRead(&log, 0, &summary) == adcLogTorn);
+  CHECK((adcLogRead(&log, 1, &summary) == adcLogOk)
+        && (summary.sequence == appended - 1));
+  append(&log, 3);
+  CHECK((adcLogRead(&log, 0, &summary) == adcLogOk)
+        && (summary.sequence == appended + 1) && (summary.min == 3));
+  CHECK(adcLogRead(&log, 1, &summary) == adcLogTorn);
+
+  /* A write cut short before its first word leaves no trace, and its slot
+     is used again */
+  wordsLeft = 0;
+  append(&log, 4);
+  wordsLeft = UINT32_MAX;
+  CHECK(adcLogInit(&log, &config) == adcLogOk);
+  CHECK((adcLogRead(&log, 0, &summary) == adcLogOk)
+        && (summary.sequence == appended + 1));
+
+  printf("log: %u summaries, %u erases on init\n",
+         (unsigned)adcLogCount(&log), (unsigned)log.erases);
+}
+
+int main(void)
+{
+  checkSummaries();
+  checkLog();
+
+  hostCheckReport();
+  return 0;
+}
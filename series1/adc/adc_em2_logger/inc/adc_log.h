@@ -0,0 +1,65 @@
+/***************************************************************************//**
+ * @file  adc_log.h
+ * @brief Append-only flash log of ADC frame summaries
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_LOG_H
+#define ADC_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "adc_summary.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  adcLogOk,
+  adcLogBadConfig,          // Fewer than 2 pages, or pages not a multiple of
+                            // the record size
+  adcLogEmpty,              // No record of that age
+  adcLogTorn                // Record not completely written, e.g. on a reset
+} adcLogStatus_TypeDef;
+
+typedef struct {
+  uint32_t *base;           // First of pageCount consecutive pages
+  uint32_t pageCount;
+  uint32_t pageSize;        // Page size in bytes
+  void (*erase)(uint32_t *page);
+  void (*write)(uint32_t *dst, const uint32_t *src, uint32_t bytes);
+} adcLogConfig_TypeDef;
+
+typedef struct {
+  adcLogConfig_TypeDef config;
+  uint32_t slotsPerPage;
+  uint32_t slotCount;
+  uint32_t next;            // Slot of the next record
+  uint32_t sequence;        // Sequence number of the next record
+  uint32_t count;           // Slots holding a record, complete or not
+  uint32_t appended;        // Records written since adcLogInit()
+  uint32_t erases;          // Pages erased since adcLogInit()
+  uint32_t wordsWritten;    // Flash words written since adcLogInit()
+} adcLog_TypeDef;
+
+adcLogStatus_TypeDef adcLogInit(adcLog_TypeDef *log,
+                                const adcLogConfig_TypeDef *config);
+void adcLogAppend(adcLog_TypeDef *log, adcSummary_TypeDef *summary);
+uint32_t adcLogCount(const adcLog_TypeDef *log);
+adcLogStatus_TypeDef adcLogRead(const adcLog_TypeDef *log, uint32_t age,
+                                adcSummary_TypeDef *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_LOG_H
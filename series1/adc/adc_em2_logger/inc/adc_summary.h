@@ -0,0 +1,55 @@
+/***************************************************************************//**
+ * @file  adc_summary.h
+ * @brief Min/max/mean/RMS summary of a frame of ADC samples
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_SUMMARY_H
+#define ADC_SUMMARY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fraction bits of the mean and RMS, in LSB of 12-bit samples
+#define ADC_SUMMARY_FRACTION_BITS   4
+
+// Frames of up to this many samples can be summarised
+#define ADC_SUMMARY_MAX_COUNT       4096
+
+// Flags of a summary
+#define ADC_SUMMARY_OVERRUN         0x0001  // Frames lost before this one
+
+// Summary of one frame, 4 words as stored in the flash log. The mean and
+// RMS are last, and never all ones, so a summary whose last word is still
+// erased was not completely written.
+typedef struct {
+  uint32_t sequence;        // Frame number, set by the log
+  uint16_t count;           // Samples in the frame
+  uint16_t flags;
+  uint16_t min;
+  uint16_t max;
+  uint16_t mean;            // In 1/16 LSB
+  uint16_t rms;             // In 1/16 LSB, RMS of the samples about the mean,
+                            // i.e. of the signal without its DC part
+} adcSummary_TypeDef;
+
+void adcSummarise(const uint16_t *samples, uint32_t count,
+                  adcSummary_TypeDef *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_SUMMARY_H
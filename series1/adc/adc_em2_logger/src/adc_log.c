@@ -0,0 +1,174 @@
+/***************************************************************************//**
+ * @file adc_log.c
+ * @brief Append-only flash log of ADC frame summaries.
+ *
+ * Summaries are written one after the other into a ring of flash pages.
+ * The page after the last one is erased when the log reaches it, so the
+ * oldest page of summaries is dropped and a page erase is only needed once
+ * per pageSize / 16 summaries. Each summary carries a sequence number, and
+ * the newest one is found again after a reset by looking for the largest.
+ * A summary is written first word first and its last word is never all
+ * ones, so one cut short by a reset is recognized and skipped.
+ *
+ * The flash is only changed through the erase and write functions given to
+ * adcLogInit(), so the log runs as is on a host, with RAM for the pages.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "adc_log.h"
+
+#define ERASED          0xFFFFFFFFUL
+#define SLOT_WORDS      (sizeof(adcSummary_TypeDef) / sizeof(uint32_t))
+
+static const uint32_t *slot(const adcLog_TypeDef *log, uint32_t index)
+{
+  return log->config.base + index * SLOT_WORDS;
+}
+
+static bool slotUsed(const adcLog_TypeDef *log, uint32_t index)
+{
+  const uint32_t *words = slot(log, index);
+  uint32_t i;
+
+  for (i = 0; i < SLOT_WORDS; i++) {
+    if (words[i] != ERASED) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Erase the page starting at slot 'index' unless it is blank, and
+ *    account for the summaries it held
+ *****************************************************************************/
+static void erasePage(adcLog_TypeDef *log, uint32_t index)
+{
+  uint32_t used = 0;
+  uint32_t i;
+
+  for (i = index; i < index + log->slotsPerPage; i++) {
+    if (slotUsed(log, i)) {
+      used++;
+    }
+  }
+  if (used != 0) {
+    log->config.erase((uint32_t *)slot(log, index));
+    log->erases++;
+    log->count -= used;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Find the newest summary in the pages and carry on after it
+ *****************************************************************************/
+adcLogStatus_TypeDef adcLogInit(adcLog_TypeDef *log,
+                                const adcLogConfig_TypeDef *config)
+{
+  uint32_t i, sequence;
+  bool found = false;
+
+  if ((config->pageCount < 2) || (config->base == NULL)
+      || (config->pageSize < sizeof(adcSummary_TypeDef))
+      || ((config->pageSize % sizeof(adcSummary_TypeDef)) != 0)) {
+    return adcLogBadConfig;
+  }
+
+  log->config = *config;
+  log->slotsPerPage = config->pageSize / sizeof(adcSummary_TypeDef);
+  log->slotCount = log->slotsPerPage * config->pageCount;
+  log->next = 0;
+  log->sequence = 0;
+  log->count = 0;
+  log->appended = 0;
+  log->erases = 0;
+  log->wordsWritten = 0;
+
+  for (i = 0; i < log->slotCount; i++) {
+    if (!slotUsed(log, i)) {
+      continue;
+    }
+    log->count++;
+    sequence = slot(log, i)[0];
+    if ((sequence != ERASED) && (!found || (sequence >= log->sequence))) {
+      found = true;
+      log->sequence = sequence + 1;
+      log->next = (i + 1) % log->slotCount;
+    }
+  }
+
+  // Summaries are written in order, so the slots after the newest one are
+  // blank, unless it was the last of its page: the next page is erased
+  // before it is used
+  if ((log->next % log->slotsPerPage) == 0) {
+    erasePage(log, log->next);
+  }
+  return adcLogOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Append a summary, and set its sequence number
+ *
+ * @details
+ *    Blocks for the flash write, and for a page erase once per page of
+ *    summaries.
+ *****************************************************************************/
+void adcLogAppend(adcLog_TypeDef *log, adcSummary_TypeDef *summary)
+{
+  summary->sequence = log->sequence++;
+  log->config.write((uint32_t *)slot(log, log->next), (const uint32_t *)summary,
+                    sizeof(*summary));
+  log->wordsWritten += SLOT_WORDS;
+  log->appended++;
+  log->count++;
+
+  log->next = (log->next + 1) % log->slotCount;
+  if ((log->next % log->slotsPerPage) == 0) {
+    erasePage(log, log->next);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Number of summaries in the log, including any cut short by a reset
+ *****************************************************************************/
+uint32_t adcLogCount(const adcLog_TypeDef *log)
+{
+  return log->count;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Read a summary, 0 for the newest, adcLogCount() - 1 for the oldest
+ *****************************************************************************/
+adcLogStatus_TypeDef adcLogRead(const adcLog_TypeDef *log, uint32_t age,
+                                adcSummary_TypeDef *summary)
+{
+  uint32_t index;
+  const uint32_t *words;
+
+  if (age >= log->count) {
+    return adcLogEmpty;
+  }
+  index = (log->next + log->slotCount - 1 - age) % log->slotCount;
+  words = slot(log, index);
+  if (words[SLOT_WORDS - 1] == ERASED) {
+    return adcLogTorn;
+  }
+  memcpy(summary, words, sizeof(*summary));
+  return adcLogOk;
+}
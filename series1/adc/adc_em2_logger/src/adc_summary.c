@@ -0,0 +1,113 @@
+/***************************************************************************//**
+ * @file adc_summary.c
+ * @brief Min/max/mean/RMS summary of a frame of ADC samples.
+ *
+ * One pass over the frame, with integer arithmetic only: the sums fit in
+ * 64 bits for any frame of up to ADC_SUMMARY_MAX_COUNT 16-bit samples, and
+ * the RMS is an integer square root, so the summary is the same on a host
+ * and on a device without an FPU. The RMS is taken about the mean, from
+ * count * sum(x^2) - sum(x)^2, which keeps a small noise exact next to a
+ * large DC level; the RMS of the samples themselves is sqrt(mean^2 +
+ * rms^2).
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "adc_summary.h"
+
+// Largest mean or RMS stored, so the last word of a summary is never erased
+#define MAX_FIXED   0xFFFEUL
+
+/**************************************************************************//**
+ * @brief
+ *    Square root rounded to the nearest integer
+ *****************************************************************************/
+static uint32_t squareRoot(uint64_t value)
+{
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  // value is now the remainder: round up when it is above root
+  if (value > root) {
+    root++;
+  }
+  return (uint32_t)root;
+}
+
+static uint16_t saturate(uint64_t value)
+{
+  return (uint16_t)((value > MAX_FIXED) ? MAX_FIXED : value);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Summarise a frame of up to ADC_SUMMARY_MAX_COUNT samples
+ *
+ * @details
+ *    The mean and RMS are rounded to 1/16 LSB, and saturate for samples of
+ *    more than 12 bits. The sequence number and flags are left to the
+ *    caller. An empty frame gives all zeros.
+ *****************************************************************************/
+void adcSummarise(const uint16_t *samples, uint32_t count,
+                  adcSummary_TypeDef *summary)
+{
+  uint32_t min = 0xFFFF, max = 0;
+  uint32_t i, x;
+  uint64_t sum = 0, squares = 0, deviation;
+
+  if (count > ADC_SUMMARY_MAX_COUNT) {
+    count = ADC_SUMMARY_MAX_COUNT;
+  }
+  if (count == 0) {
+    summary->count = 0;
+    summary->min = 0;
+    summary->max = 0;
+    summary->mean = 0;
+    summary->rms = 0;
+    return;
+  }
+
+  for (i = 0; i < count; i++) {
+    x = samples[i];
+    if (x < min) {
+      min = x;
+    }
+    if (x > max) {
+      max = x;
+    }
+    sum += x;
+    squares += x * x;
+  }
+
+  summary->count = (uint16_t)count;
+  summary->min = (uint16_t)min;
+  summary->max = (uint16_t)max;
+  summary->mean = saturate(((sum << ADC_SUMMARY_FRACTION_BITS) + count / 2) / count);
+
+  // Sum of the squared deviations from the mean, then the RMS in 1/16 LSB:
+  // sqrt(deviation / count) << 4 = sqrt((deviation << 8) / count)
+  deviation = (count * squares - sum * sum) / count;
+  summary->rms = saturate(squareRoot(((deviation << (2 * ADC_SUMMARY_FRACTION_BITS))
+                                      + count / 2) / count));
+}
@@ -0,0 +1,375 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC logger in EM2, summaries of large DMA frames in a flash log
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "em_timer.h"
+#include "em_msc.h"
+#include "ldma_stream.h"
+#include "adc_summary.h"
+#include "adc_log.h"
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired sample frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// The ADC requests the LDMA once ADC_DVL results are in the single FIFO,
+// and the LDMA reads them in one block
+#define ADC_DVL         4
+
+// Double buffering of frames of FRAME_LENGTH samples, about 2 s at 1 kHz;
+// the CPU only wakes up when a frame is full
+#define BUFFER_COUNT    2
+#define FRAME_LENGTH    2048
+
+// The log uses the last LOG_PAGES pages of the main flash
+#define LOG_PAGES       4
+#define LOG_BASE        ((uint32_t*)(FLASH_BASE + FLASH_SIZE - LOG_PAGES * FLASH_PAGE_SIZE))
+
+// Typical charges and currents at 3.3 V, only used for the report
+#define EM2_CURRENT         1700    // nA, EM2 with the LFRCO and LETIMER
+#define CONVERSION_CHARGE   4       // nC, ADC on demand, about 20 us at 200 uA
+#define REQUEST_CHARGE      5       // nC, LDMA request served from EM2
+#define WAKEUP_CHARGE       20      // nC, CPU wake-up from EM2 and back
+#define KCYCLE_CHARGE       63      // nC per 1000 core cycles at 63 uA/MHz
+#define WRITE_WORD_CHARGE   55      // nC, about 20 us at 9 mA
+#define ERASE_CHARGE        45000   // nC, about 20 ms at 2.3 mA
+
+// The summary is timed in TIMER_PRESCALE cycles so it fits in 16 bits
+#define TIMER_PRESCALE      4
+
+typedef struct {
+  float averageCurrent;     // uA, in EM2 with a wake-up per frame
+  float chargePerSample;    // nC
+  float perRequestCurrent;  // uA, with a wake-up per LDMA request instead
+  uint32_t summaryCycles;   // Core cycles to summarise the last frame
+} loggerReport_TypeDef;
+
+// Stream of ADC samples
+ldmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][FRAME_LENGTH];
+
+// Log of frame summaries
+adcLog_TypeDef flashLog;
+
+// Values to watch in the debugger
+adcSummary_TypeDef lastSummary;
+loggerReport_TypeDef report;
+volatile uint32_t frameCount;
+volatile uint32_t gapCount;
+
+// Charge used so far, and the samples it was used for
+static float totalCharge;
+static float requestCharge;
+static uint32_t totalSamples;
+
+/**************************************************************************//**
+ * @brief  Erase one page
+ *****************************************************************************/
+static void flashErase(uint32_t *page)
+{
+  MSC_ErasePage(page);
+}
+
+/**************************************************************************//**
+ * @brief  Program words
+ *****************************************************************************/
+static void flashWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  MSC_WriteWord(dst, src, bytes);
+}
+
+static const adcLogConfig_TypeDef logConfig = {
+  LOG_BASE,
+  LOG_PAGES,
+  FLASH_PAGE_SIZE,
+  flashErase,
+  flashWrite
+};
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are logged in the main loop
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/**************************************************************************//**
+ * @brief Add the charge used for a frame to the energy report
+ *****************************************************************************/
+static void account(uint32_t length, uint32_t cycles, uint32_t words,
+                    uint32_t erases)
+{
+  float charge;
+  float requests = (float)length / ADC_DVL;
+
+  // Sleeping, converting and moving the samples
+  charge = (float)EM2_CURRENT * length / letimerDesired / 1000.0f
+           + (float)CONVERSION_CHARGE * length
+           + REQUEST_CHARGE * requests;
+
+  // Waking up once to summarise and log the frame
+  charge += WAKEUP_CHARGE
+            + (float)KCYCLE_CHARGE * cycles / 1000.0f
+            + (float)WRITE_WORD_CHARGE * words
+            + (float)ERASE_CHARGE * erases;
+
+  totalCharge += charge;
+  totalSamples += length;
+
+  // Without the large frames the CPU would wake up on every request, as in
+  // adc_scan_letimer_prs_dma
+  requestCharge += charge + WAKEUP_CHARGE * (requests - 1);
+
+  report.chargePerSample = totalCharge / totalSamples;
+  report.averageCurrent = report.chargePerSample * letimerDesired / 1000.0f;
+  report.perRequestCurrent = requestCharge / totalSamples
+                             * letimerDesired / 1000.0f;
+  report.summaryCycles = cycles;
+}
+
+/**************************************************************************//**
+ * @brief Stream consumer, summarises each frame into the flash log
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  uint32_t start, cycles, words, erases;
+
+  (void)user;
+
+  // TIMER0 counts HFPERCLK cycles, the core clock as HFPERCLK is not divided
+  start = TIMER_CounterGet(TIMER0);
+  adcSummarise(data, length, &lastSummary);
+  cycles = ((TIMER_CounterGet(TIMER0) - start) & 0xFFFF) * TIMER_PRESCALE;
+
+  // Samples were lost before this frame
+  if (overrun)
+  {
+    gapCount++;
+    lastSummary.flags |= ADC_SUMMARY_OVERRUN;
+  }
+
+  words = flashLog.wordsWritten;
+  erases = flashLog.erases;
+  adcLogAppend(&flashLog, &lastSummary);
+  frameCount++;
+
+  account(length, cycles, flashLog.wordsWritten - words,
+          flashLog.erases - erases);
+}
+
+/**************************************************************************//**
+ * @brief TIMER initialization, free running to count cycles
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  timerInit.prescale = timerPrescale4;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+  TIMER_Init(TIMER0, &timerInit);
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization, streams the ADC results into frames
+ *****************************************************************************/
+void initLdma(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+
+  // ADC_DVL 16-bit results per request, the low half of SINGLEDATA
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = ldmaCtrlSizeHalf;
+  config.blockSize   = (LDMA_CtrlBlockSize_t)(ADC_DVL - 1);
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = FRAME_LENGTH;
+  config.length      = FRAME_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if (ldmaStreamInit(&stream, &config) == ldmaStreamOk)
+  {
+    ldmaStreamStart(&stream);
+  }
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *****************************************************************************/
+void initAdc(void)
+{
+  // Declare init structs
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock on demand in EM2
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  // Internal temperature sensor
+  initSingle.posSel     = adcPosSelTEMP;
+  initSingle.reference  = adcRef1V25;
+  initSingle.resolution = adcRes12Bit;
+  initSingle.acqTime    = adcAcqTime256;
+
+  // Conversions are started by PRS, and the LDMA wakes up in EM2 to read
+  // the results
+  initSingle.prsEnable      = true;
+  initSingle.prsSel         = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  initSingle.singleDmaEm2Wu = true;
+
+  // Initialize ADC
+  ADC_Init(ADC0, &init);
+  ADC_InitSingle(ADC0, &initSingle);
+
+  // Set the single data valid level (DVL), the LDMA request waits for
+  // ADC_DVL results
+  ADC0->SINGLECTRLX = (ADC0->SINGLECTRLX & ~_ADC_SINGLECTRLX_DVL_MASK)
+                      | ((ADC_DVL - 1) << _ADC_SINGLECTRLX_DVL_SHIFT);
+
+  // Clear the single FIFO
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  // Init DCDC regulator if available
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  // Carry on with the log left by the last reset
+  MSC_Init();
+  adcLogInit(&flashLog, &logConfig);
+
+  // Count summary cycles
+  initTimer();
+
+  // Setup ADC to perform conversions via PRS
+  initAdc();
+  // Setup the LDMA to stream the results into frames
+  initLdma();
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while(1)
+  {
+    // Enter EM2 until the next frame is filled
+    EMU_EnterEM2(false);
+
+    // Summarise and log the filled frames
+    ldmaStreamProcess(&stream);
+  }
+}
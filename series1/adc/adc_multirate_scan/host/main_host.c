@@ -0,0 +1,414 @@
+/**************************************************************************//**
+ * @file
+ * @brief Multi-rate ADC schedule on a host: checks
+ *
+ * Build on its own, see readme.txt. The schedule of the kit is checked
+ * field by field, then schedules of hand-picked rates that end in each
+ * status. Random sets of rates are then scheduled, and every schedule that
+ * is found is checked over two of its cycles: each scan channel is
+ * converted every divider scans from its phase and never in between, no
+ * scan is empty or holds more than the scan FIFO, and the ADC on-time of
+ * the plan matches a timeline of the triggers in which a trigger that
+ * finds the ADC busy needs no warm-up.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "adc_sched.h"
+#include "host_check.h"
+
+/* Clocks of the kit: 16 MHz ADC, 19 MHz HFPERCLK, 32768 Hz LFA */
+#define ADC_HZ              16000000
+#define CONVERSION_CYCLES   29
+#define WARMUP_NS           5000
+#define HFPER_HZ            19000000
+#define LFA_HZ              32768
+#define TOLERANCE_PPM       1000
+
+/* Scan rate, in mHz, that every random divider divides: 24 Hz, slow enough
+   for the LFA to give the scan rates within the tolerance */
+#define RANDOM_BASE         24000
+
+static const char *statusNames[] =
+{
+  "adcSchedOk",
+  "adcSchedBadConfig",
+  "adcSchedBadRate",
+  "adcSchedTooManySlots",
+  "adcSchedScanFull",
+  "adcSchedTooFast",
+};
+
+#define STATUS_COUNT        (sizeof(statusNames) / sizeof(statusNames[0]))
+
+static const uint32_t randomDividers[] = { 1, 2, 3, 4, 5, 6, 8, 10, 12, 16 };
+
+#define DIVIDER_COUNT       (sizeof(randomDividers) / sizeof(randomDividers[0]))
+
+static const uint32_t randomFastRates[] = { 1000000, 10000000, 50000000 };
+
+#define FAST_COUNT          (sizeof(randomFastRates) / sizeof(randomFastRates[0]))
+
+static uint32_t seed = 1;
+
+static adcSchedStatus_TypeDef compute(const uint32_t *rates, uint32_t count,
+                                      adcSchedPlan_TypeDef *plan)
+{
+  adcSchedConfig_TypeDef config =
+  {
+    rates, count, ADC_HZ, CONVERSION_CYCLES, WARMUP_NS,
+    HFPER_HZ, LFA_HZ, 0xFFFF, TOLERANCE_PPM
+  };
+
+  return adcSchedCompute(&config, plan);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   ADC on-time, per million, of a timeline of the triggers
+ *
+ * @details
+ *   The scans start a third of a fast period late, so that some fast
+ *   triggers find a scan in progress; those queue behind it with no warm-up.
+ *   The timeline runs for a cycle of the schedule, which may not be a whole
+ *   number of fast periods: 'edge' is the on-time of a trigger, per million
+ *   of the cycle.
+ ******************************************************************************/
+static double timelinePpm(const adcSchedPlan_TypeDef *plan, double *edge)
+{
+  double fastPeriod = 0, scanPeriod = 0, horizon, fastNext, scanNext;
+  double busyUntil = 0, on = 0, length, t;
+  uint32_t scan = 0;
+
+  if ( plan->fastChannel >= 0 )
+  {
+    fastPeriod = (plan->fastTop + 1) * 1e9 / HFPER_HZ;
+  }
+  if ( plan->slotCount > 0 )
+  {
+    scanPeriod = (double)(plan->scanTop + 1) * plan->scanPrescale * 1e9 / LFA_HZ;
+    horizon = scanPeriod * plan->slotCount;
+  }
+  else
+  {
+    horizon = 1e9;
+  }
+  *edge = (WARMUP_NS + (ADC_SCHED_SCAN_FIFO + 1.0) * plan->conversionNs) * 1e6
+          / horizon;
+
+  fastNext = (fastPeriod > 0) ? 0 : horizon;
+  scanNext = (scanPeriod > 0) ? fastPeriod / 3 : horizon;
+  while ( (fastNext < horizon) || (scanNext < horizon) )
+  {
+    if ( fastNext <= scanNext )
+    {
+      t = fastNext;
+      length = plan->conversionNs;
+      fastNext += fastPeriod;
+    }
+    else
+    {
+      t = scanNext;
+      length = (double)plan->slotLength[scan] * plan->conversionNs;
+      scan++;
+      scanNext += scanPeriod;
+    }
+
+    if ( t >= busyUntil )
+    {
+      length += WARMUP_NS;
+      busyUntil = t + length;
+    }
+    else
+    {
+      busyUntil += length;
+    }
+    on += length;
+  }
+  return on * 1e6 / horizon;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check a schedule against its rates
+ ******************************************************************************/
+static void checkSchedule(const uint32_t *rates, uint32_t count,
+                          const adcSchedPlan_TypeDef *plan)
+{
+  uint32_t last[ADC_SCHED_MAX_CHANNELS];
+  uint32_t c, s, k, length, scanRate = 0, masks = 0, maxRate = 0;
+  uint64_t sum = 0;
+  double ppm, slack, edge;
+
+  for ( c = 0; c < count; c++ )
+  {
+    sum += rates[c];
+    if ( rates[c] > maxRate )
+    {
+      maxRate = rates[c];
+    }
+    if ( ((int32_t)c != plan->fastChannel) && (rates[c] > scanRate) )
+    {
+      scanRate = rates[c];
+    }
+  }
+
+  /* The fast channel is the only one at the fastest rate, and its timer
+     gives that rate */
+  if ( plan->fastChannel >= 0 )
+  {
+    CHECK(rates[plan->fastChannel] == maxRate);
+    CHECK(scanRate < maxRate);
+    CHECK(fabs((double)HFPER_HZ * 1000 / (plan->fastTop + 1) - maxRate)
+          <= maxRate * TOLERANCE_PPM / 1e6);
+  }
+
+  /* Every scan channel every divider scans from its phase, and never in
+     between */
+  if ( plan->slotCount > 0 )
+  {
+    CHECK(plan->slotCount <= ADC_SCHED_MAX_SLOTS);
+    CHECK(fabs((double)LFA_HZ * 1000 / ((plan->scanTop + 1.0) * plan->scanPrescale)
+               - scanRate) <= scanRate * TOLERANCE_PPM / 1e6);
+    for ( c = 0; c < count; c++ )
+    {
+      last[c] = UINT32_MAX;
+      if ( (int32_t)c != plan->fastChannel )
+      {
+        CHECK(plan->divider[c] * rates[c] == scanRate);
+        CHECK(plan->slotCount % plan->divider[c] == 0);
+        CHECK(plan->phase[c] < plan->divider[c]);
+      }
+    }
+    for ( k = 0; k < 2 * plan->slotCount; k++ )
+    {
+      s = k % plan->slotCount;
+      length = 0;
+      for ( c = 0; c < count; c++ )
+      {
+        if ( !(plan->slotMask[s] & (1UL << c)) )
+        {
+          continue;
+        }
+        length++;
+        masks |= 1UL << c;
+        CHECK((int32_t)c != plan->fastChannel);
+        if ( last[c] == UINT32_MAX )
+        {
+          CHECK(k == plan->phase[c]);
+        }
+        else
+        {
+          CHECK(k - last[c] == plan->divider[c]);
+        }
+        last[c] = k;
+      }
+      CHECK(length == plan->slotLength[s]);
+      CHECK((length >= 1) && (length <= ADC_SCHED_SCAN_FIFO));
+    }
+  }
+  for ( c = 0; c < count; c++ )
+  {
+    CHECK(((masks >> c) & 1) == ((int32_t)c != plan->fastChannel));
+  }
+
+  /* Conversions and on-time */
+  CHECK(plan->conversions == (sum + 500) / 1000);
+  CHECK(plan->flatConversions == ((uint64_t)maxRate * count + 500) / 1000);
+  CHECK(plan->conversions <= plan->flatConversions);
+
+  /* A warm-up per scan saved at most when a scan finds the ADC on */
+  ppm = timelinePpm(plan, &edge);
+  slack = (double)plan->scanRate * WARMUP_NS / 1e6;
+  CHECK((plan->onTimePpm + 1.0 + edge >= ppm)
+        && (plan->onTimePpm <= ppm + 1.0 + edge + slack));
+}
+
+static void checkKit(void)
+{
+  /* Vibration at 10 kHz, battery at 1 Hz, core supply at 0.1 Hz */
+  static const uint32_t rates[] = { 10000000, 1000, 100 };
+  static const uint32_t scanIds[] = { 0, 5, 9 };
+  adcSchedPlan_TypeDef plan;
+  uint32_t s;
+
+  CHECK(compute(rates, 3, &plan) == adcSchedOk);
+  CHECK(plan.fastChannel == 0);
+  CHECK(plan.fastTop == 1899);
+  CHECK(plan.fastRate == 10000000);
+  CHECK(plan.scanPrescale == 1);
+  CHECK(plan.scanTop == 32767);
+  CHECK(plan.scanRate == 1000);
+  CHECK(plan.slotCount == 10);
+  CHECK((plan.divider[1] == 1) && (plan.divider[2] == 10));
+  CHECK((plan.phase[1] == 0) && (plan.phase[2] == 0));
+  CHECK((plan.slotMask[0] == 0x6) && (plan.slotLength[0] == 2));
+  for ( s = 1; s < 10; s++ )
+  {
+    CHECK((plan.slotMask[s] == 0x2) && (plan.slotLength[s] == 1));
+  }
+  CHECK(plan.conversionNs == 1813);
+  CHECK(plan.fastDelayNs == 1813);
+  CHECK(plan.conversions == 10001);
+  CHECK(plan.flatConversions == 30000);
+
+  /* 10 kHz of 6813 ns, and 10 scans of 5000 ns plus 11 conversions in 10 s */
+  CHECK(plan.onTimePpm == 68137);
+  CHECK(plan.flatOnTimePpm == 104390);
+  checkSchedule(rates, 3, &plan);
+
+  /* Scan masks from the scan input IDs */
+  CHECK(adcSchedScanMask(&plan, 0, scanIds) == ((1UL << 5) | (1UL << 9)));
+  CHECK(adcSchedScanMask(&plan, 3, scanIds) == (1UL << 5));
+  CHECK(adcSchedScanMask(&plan, 10, scanIds) == ((1UL << 5) | (1UL << 9)));
+
+  printf("Kit: fast channel %d top %u, scans top %u prescale %u, %u slots\n",
+         (int)plan.fastChannel, (unsigned)plan.fastTop, (unsigned)plan.scanTop,
+         (unsigned)plan.scanPrescale, (unsigned)plan.slotCount);
+  printf("     %u conversions/s, ADC on %.2f%%, against %u and %.2f%% "
+         "in one scan at 10 kHz\n", (unsigned)plan.conversions,
+         plan.onTimePpm / 1e4, (unsigned)plan.flatConversions,
+         plan.flatOnTimePpm / 1e4);
+}
+
+static void checkStatuses(void)
+{
+  static const uint32_t allScan[] = { 1000, 500, 250 };
+  static const uint32_t spread[] = { 1000, 500, 500, 500, 500 };
+  static const uint32_t full[] = { 1000, 1000, 1000, 1000, 1000 };
+  static const uint32_t fastFull[] = { 10000000, 1000, 1000, 1000, 1000, 1000 };
+  static const uint32_t notDivided[] = { 10000000, 1000, 300 };
+  static const uint32_t tooLong[] = { 10000000, 35000, 5000, 7000 };
+  static const uint32_t tooFast[] = { 500000000, 1000 };
+  static const uint32_t slow[] = { 10000000, 10 };
+  static const uint32_t alone[] = { 10000000 };
+  static const uint32_t zero[] = { 1000, 0 };
+  static const uint32_t many[ADC_SCHED_MAX_CHANNELS + 1] = { 1000 };
+  adcSchedPlan_TypeDef plan;
+
+  /* Slow rates only: every channel scanned, the mask changing per scan */
+  CHECK(compute(allScan, 3, &plan) == adcSchedOk);
+  CHECK(plan.fastChannel == -1);
+  CHECK(plan.slotCount == 4);
+  CHECK((plan.slotMask[0] == 0x7) && (plan.slotMask[1] == 0x1)
+        && (plan.slotMask[2] == 0x3) && (plan.slotMask[3] == 0x1));
+  CHECK(plan.scanTop == 32767);
+  checkSchedule(allScan, 3, &plan);
+
+  /* The fourth channel at half rate does not fit in the first scan */
+  CHECK(compute(spread, 5, &plan) == adcSchedOk);
+  CHECK((plan.phase[1] == 0) && (plan.phase[2] == 0) && (plan.phase[3] == 0)
+        && (plan.phase[4] == 1));
+  CHECK((plan.slotLength[0] == 4) && (plan.slotLength[1] == 2));
+  checkSchedule(spread, 5, &plan);
+
+  /* Five channels in every scan */
+  CHECK(compute(full, 5, &plan) == adcSchedScanFull);
+  CHECK(compute(fastFull, 6, &plan) == adcSchedScanFull);
+
+  /* 0.3 Hz is not a whole number of times less than 1 Hz */
+  CHECK(compute(notDivided, 3, &plan) == adcSchedBadRate);
+
+  /* One scan in 5 and one scan in 7 repeat after 35 scans */
+  CHECK(compute(tooLong, 4, &plan) == adcSchedTooManySlots);
+
+  /* 500 kHz, 2 us between single conversions */
+  CHECK(compute(tooFast, 2, &plan) == adcSchedTooFast);
+
+  /* 0.01 Hz needs the LETIMER prescaler */
+  CHECK(compute(slow, 2, &plan) == adcSchedOk);
+  CHECK((plan.scanPrescale == 64) && (plan.scanTop == 51199));
+  CHECK(plan.scanRate == 10);
+  checkSchedule(slow, 2, &plan);
+
+  /* The LETIMER cannot give 10 kHz, TIMER0 can */
+  CHECK(compute(alone, 1, &plan) == adcSchedOk);
+  CHECK((plan.fastChannel == 0) && (plan.slotCount == 0));
+  CHECK(plan.onTimePpm == 68130);
+  checkSchedule(alone, 1, &plan);
+
+  CHECK(compute(zero, 2, &plan) == adcSchedBadConfig);
+  CHECK(compute(many, ADC_SCHED_MAX_CHANNELS + 1, &plan) == adcSchedBadConfig);
+  CHECK(compute(allScan, 0, &plan) == adcSchedBadConfig);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Random rates: scan channels at RANDOM_BASE over a divider, and maybe a
+ *   fast channel
+ ******************************************************************************/
+static void checkRandom(uint32_t trials)
+{
+  uint32_t rates[ADC_SCHED_MAX_CHANNELS];
+  uint32_t counts[STATUS_COUNT] = { 0 };
+  adcSchedPlan_TypeDef plan;
+  adcSchedStatus_TypeDef status;
+  uint32_t t, c, count, fast;
+
+  for ( t = 0; t < trials; t++ )
+  {
+    count = 1 + hostRandom(&seed) % ADC_SCHED_MAX_CHANNELS;
+    fast = (hostRandom(&seed) % 2) ? hostRandom(&seed) % count : count;
+    for ( c = 0; c < count; c++ )
+    {
+      rates[c] = (c == fast) ? randomFastRates[hostRandom(&seed) % FAST_COUNT]
+                 : RANDOM_BASE / randomDividers[hostRandom(&seed) % DIVIDER_COUNT];
+    }
+
+    status = compute(rates, count, &plan);
+    CHECK(status < STATUS_COUNT);
+    CHECK(status != adcSchedBadConfig);
+    counts[status]++;
+    if ( status == adcSchedOk )
+    {
+      checkSchedule(rates, count, &plan);
+    }
+  }
+
+  printf("%u random sets:", (unsigned)trials);
+  for ( t = 0; t < STATUS_COUNT; t++ )
+  {
+    printf(" %s %u", statusNames[t], (unsigned)counts[t]);
+  }
+  printf("\n");
+  CHECK(counts[adcSchedOk] > trials / 4);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t trials = 10000;
+  int option;
+
+  while ( (option = getopt(argc, argv, "n:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'n':
+        trials = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("usage: %s [-n random sets]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  checkKit();
+  checkStatuses();
+  checkRandom(trials);
+
+  hostCheckReport();
+  return 0;
+}
@@ -0,0 +1,95 @@
+/***************************************************************************//**
+ * @file  adc_sched.h
+ * @brief Schedule of ADC channels sampled at different rates
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_SCHED_H
+#define ADC_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change these to allow more channels or longer schedules
+#define ADC_SCHED_MAX_CHANNELS    8
+#define ADC_SCHED_MAX_SLOTS       32
+
+// Results the scan FIFO holds, so a scan is read at once when it ends
+#define ADC_SCHED_SCAN_FIFO       4
+
+typedef enum {
+  adcSchedOk,
+  adcSchedBadConfig,        // No channel, too many, or a rate or clock of 0
+  adcSchedBadRate,          // A scan rate is not a whole number of times
+                            // the rate of a scan channel, or a timer cannot
+                            // count a period within the tolerance
+  adcSchedTooManySlots,     // The schedule repeats after more than
+                            // ADC_SCHED_MAX_SLOTS scans
+  adcSchedScanFull,         // A channel does not fit in the scan FIFO of
+                            // any scan
+  adcSchedTooFast           // A trigger comes before the ADC is done with
+                            // the previous one
+} adcSchedStatus_TypeDef;
+
+typedef struct {
+  const uint32_t *rates;    // Samples per 1000 s of each channel (mHz)
+  uint32_t channelCount;
+  uint32_t adcHz;           // ADC clock
+  uint32_t conversionCycles;  // ADC clock cycles per conversion, with the
+                              // acquisition time
+  uint32_t warmupNs;        // ADC warm-up before the first conversion of
+                            // each trigger
+  uint32_t fastTimerHz;     // Clock of the timer starting single conversions
+  uint32_t scanTimerHz;     // Clock of the timer starting scans, before its
+                            // prescaler
+  uint32_t timerMaxTop;     // Largest top of both timers, e.g. 0xFFFF
+  uint32_t tolerancePpm;    // Largest error of a timer rate, per million
+} adcSchedConfig_TypeDef;
+
+typedef struct {
+  int32_t fastChannel;      // Converted by the single sequencer, -1 if none
+  uint32_t fastTop;         // Fast timer clocks per conversion - 1
+  uint32_t fastRate;        // Conversions per 1000 s the fast timer gives
+  uint32_t scanPrescale;    // Scan timer prescaler, a power of 2
+  uint32_t scanTop;         // Prescaled scan timer clocks per scan - 1
+  uint32_t scanRate;        // Scans per 1000 s the scan timer gives
+  uint32_t slotCount;       // Scans before the schedule repeats, 0 if none
+  uint32_t divider[ADC_SCHED_MAX_CHANNELS];   // Scans per sample of each
+                                              // scan channel
+  uint32_t phase[ADC_SCHED_MAX_CHANNELS];     // First scan of each
+  uint32_t slotMask[ADC_SCHED_MAX_SLOTS];     // Channels of each scan
+  uint32_t slotLength[ADC_SCHED_MAX_SLOTS];   // Results of each scan
+  uint32_t conversionNs;    // Time of a conversion
+  uint32_t fastDelayNs;     // Longest delay of a single conversion by the
+                            // scan conversion in progress
+  uint32_t conversions;     // Conversions per second, rounded
+  uint32_t flatConversions; // Same with every channel in one scan at the
+                            // fastest rate
+  uint32_t onTimePpm;       // Share of the time the ADC is on, per million
+  uint32_t flatOnTimePpm;   // Same with every channel in one scan at the
+                            // fastest rate
+} adcSchedPlan_TypeDef;
+
+adcSchedStatus_TypeDef adcSchedCompute(const adcSchedConfig_TypeDef *config,
+                                       adcSchedPlan_TypeDef *plan);
+
+uint32_t adcSchedScanMask(const adcSchedPlan_TypeDef *plan, uint32_t slot,
+                          const uint32_t *scanIds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_SCHED_H
@@ -0,0 +1,315 @@
+/***************************************************************************//**
+ * @file adc_sched.c
+ * @brief Schedule of ADC channels sampled at different rates.
+ *
+ * The Series 1 ADC has two sequencers, each with its own PRS trigger: the
+ * single sequencer converts one input, the scan sequencer converts the
+ * inputs of SCANMASK one after the other, and a single conversion goes
+ * ahead of the rest of a scan. Channels are given by their rates, and the
+ * schedule places them so that none is converted more often than asked:
+ *   - if the rates of all channels fit in one schedule of scans, and the
+ *     scan timer counts the fastest within tolerancePpm, every channel is
+ *     scanned: the scans run at the fastest rate, a slower channel is only
+ *     in every divider-th scan, and the scan mask changes from one scan to
+ *     the next along slotCount slots
+ *   - otherwise the fastest channel, if there is only one, is converted by
+ *     the single sequencer from its own timer, e.g. vibration at 10 kHz, and
+ *     the others are scheduled in scans from a slow timer, e.g. temperature
+ *     and battery at 1 Hz
+ *
+ * The channels of a scan are read from the scan FIFO when the scan ends, so
+ * a scan converts at most ADC_SCHED_SCAN_FIFO of them. Each channel goes in
+ * the first phase where it fits, slowest channels last, so that channels
+ * share scans, and the ADC warm-up of each scan, as much as the FIFO
+ * allows.
+ *
+ * The plan gives the ADC on-time, a warm-up per trigger plus the
+ * conversions, against that of one scan of all channels at the fastest
+ * rate.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "adc_sched.h"
+
+// Largest prescaler of the scan timer, e.g. LFA to LETIMER0
+#define MAX_PRESCALE    32768
+
+static uint64_t divRound(uint64_t num, uint64_t den)
+{
+  return (num + den / 2) / den;
+}
+
+// True if 'ticks' clocks of 'clockHz' make a period of 'rate' mHz within
+// the tolerance
+static bool withinTolerance(const adcSchedConfig_TypeDef *config,
+                            uint32_t clockHz, uint64_t ticks, uint32_t rate)
+{
+  uint64_t exact = (uint64_t)clockHz * 1000;
+  uint64_t actual = ticks * rate;
+  uint64_t error = (actual > exact) ? actual - exact : exact - actual;
+
+  return error * 1000000 <= exact * config->tolerancePpm;
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+  uint32_t t;
+
+  while (b != 0) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+// Fits the channels other than 'fast' in a schedule of scans
+static adcSchedStatus_TypeDef scheduleScans(const adcSchedConfig_TypeDef *config,
+                                            adcSchedPlan_TypeDef *plan,
+                                            int32_t fast)
+{
+  uint32_t c, s, p, d, rate, slots, longest;
+  uint64_t ticks, prescaled, periodNs;
+  bool placed[ADC_SCHED_MAX_CHANNELS] = { false };
+  int32_t next;
+
+  memset(plan, 0, sizeof(*plan));
+  plan->fastChannel = fast;
+
+  // The scans run at the fastest rate of the scan channels
+  rate = 0;
+  for (c = 0; c < config->channelCount; c++) {
+    if (((int32_t)c != fast) && (config->rates[c] > rate)) {
+      rate = config->rates[c];
+    }
+  }
+  if (rate == 0) {
+    return adcSchedOk;
+  }
+
+  // Scans per sample of each channel, and scans before the schedule repeats
+  slots = 1;
+  for (c = 0; c < config->channelCount; c++) {
+    if ((int32_t)c == fast) {
+      continue;
+    }
+    if (rate % config->rates[c] != 0) {
+      return adcSchedBadRate;
+    }
+    d = rate / config->rates[c];
+    plan->divider[c] = d;
+    if (d > ADC_SCHED_MAX_SLOTS) {
+      return adcSchedTooManySlots;
+    }
+    slots = slots / gcd(slots, d) * d;
+    if (slots > ADC_SCHED_MAX_SLOTS) {
+      return adcSchedTooManySlots;
+    }
+  }
+  plan->slotCount = slots;
+
+  // Channels by increasing divider, each in the first phase with room in
+  // all its scans
+  while (1) {
+    next = -1;
+    for (c = 0; c < config->channelCount; c++) {
+      if (((int32_t)c != fast) && !placed[c]
+          && ((next < 0) || (plan->divider[c] < plan->divider[next]))) {
+        next = (int32_t)c;
+      }
+    }
+    if (next < 0) {
+      break;
+    }
+    d = plan->divider[next];
+    for (p = 0; p < d; p++) {
+      for (s = p; s < slots; s += d) {
+        if (plan->slotLength[s] >= ADC_SCHED_SCAN_FIFO) {
+          break;
+        }
+      }
+      if (s >= slots) {
+        break;
+      }
+    }
+    if (p == d) {
+      return adcSchedScanFull;
+    }
+    for (s = p; s < slots; s += d) {
+      plan->slotMask[s] |= 1UL << next;
+      plan->slotLength[s]++;
+    }
+    plan->phase[next] = p;
+    placed[next] = true;
+  }
+
+  // Scan timer period, prescaled until it fits
+  ticks = divRound((uint64_t)config->scanTimerHz * 1000, rate);
+  plan->scanPrescale = 1;
+  while ((divRound(ticks, plan->scanPrescale) > (uint64_t)config->timerMaxTop + 1)
+         && (plan->scanPrescale < MAX_PRESCALE)) {
+    plan->scanPrescale <<= 1;
+  }
+  prescaled = divRound(ticks, plan->scanPrescale);
+  if ((prescaled == 0) || (prescaled > (uint64_t)config->timerMaxTop + 1)
+      || !withinTolerance(config, config->scanTimerHz,
+                          prescaled * plan->scanPrescale, rate)) {
+    return adcSchedBadRate;
+  }
+  plan->scanTop = (uint32_t)(prescaled - 1);
+  plan->scanRate = (uint32_t)divRound((uint64_t)config->scanTimerHz * 1000,
+                                      prescaled * plan->scanPrescale);
+
+  // The longest scan must end before the next one starts
+  longest = 0;
+  for (s = 0; s < slots; s++) {
+    if (plan->slotLength[s] > longest) {
+      longest = plan->slotLength[s];
+    }
+  }
+  periodNs = prescaled * plan->scanPrescale * 1000000000ULL / config->scanTimerHz;
+  if (periodNs < (uint64_t)config->warmupNs
+      + (uint64_t)longest * config->conversionCycles * 1000000000ULL
+      / config->adcHz) {
+    return adcSchedTooFast;
+  }
+  return adcSchedOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Compute the schedule of a configuration
+ *
+ * @details
+ *   With adcSchedOk, scan s of the schedule converts the channels of
+ *   slotMask[s], and the scan after the last one is scan 0 again; channel
+ *   c, if not the fast one, is in scans phase[c], phase[c] + divider[c] and
+ *   so on.
+ ******************************************************************************/
+adcSchedStatus_TypeDef adcSchedCompute(const adcSchedConfig_TypeDef *config,
+                                       adcSchedPlan_TypeDef *plan)
+{
+  adcSchedStatus_TypeDef status;
+  uint32_t c, s, maxRate, atMax, conversionNs;
+  uint64_t ticks, periodNs, sum, scanNs;
+  int32_t fastest;
+
+  if ((config->channelCount == 0)
+      || (config->channelCount > ADC_SCHED_MAX_CHANNELS)
+      || (config->adcHz == 0) || (config->conversionCycles == 0)
+      || (config->fastTimerHz == 0) || (config->scanTimerHz == 0)
+      || (config->timerMaxTop == 0)) {
+    return adcSchedBadConfig;
+  }
+  maxRate = 0;
+  atMax = 0;
+  fastest = -1;
+  for (c = 0; c < config->channelCount; c++) {
+    if (config->rates[c] == 0) {
+      return adcSchedBadConfig;
+    }
+    if (config->rates[c] > maxRate) {
+      maxRate = config->rates[c];
+      atMax = 0;
+      fastest = (int32_t)c;
+    }
+    if (config->rates[c] == maxRate) {
+      atMax++;
+    }
+  }
+
+  // All channels in scans, or else the fastest on the single sequencer
+  status = scheduleScans(config, plan, -1);
+  if ((status != adcSchedOk) && (atMax == 1)) {
+    status = scheduleScans(config, plan, fastest);
+  }
+  if (status != adcSchedOk) {
+    return status;
+  }
+
+  conversionNs = (uint32_t)(((uint64_t)config->conversionCycles * 1000000000ULL
+                             + config->adcHz - 1) / config->adcHz);
+  plan->conversionNs = conversionNs;
+
+  // Fast timer period, long enough to wait for a scan conversion in progress
+  if (plan->fastChannel >= 0) {
+    ticks = divRound((uint64_t)config->fastTimerHz * 1000, maxRate);
+    if ((ticks == 0) || (ticks > (uint64_t)config->timerMaxTop + 1)
+        || !withinTolerance(config, config->fastTimerHz, ticks, maxRate)) {
+      return adcSchedBadRate;
+    }
+    plan->fastTop = (uint32_t)(ticks - 1);
+    plan->fastRate = (uint32_t)divRound((uint64_t)config->fastTimerHz * 1000,
+                                        ticks);
+    plan->fastDelayNs = (plan->slotCount > 0) ? conversionNs : 0;
+
+    periodNs = ticks * 1000000000ULL / config->fastTimerHz;
+    if (periodNs < (uint64_t)config->warmupNs + conversionNs
+                   + plan->fastDelayNs) {
+      return adcSchedTooFast;
+    }
+  }
+
+  // Conversions, and time on, a warm-up per trigger
+  sum = 0;
+  for (c = 0; c < config->channelCount; c++) {
+    sum += config->rates[c];
+  }
+  plan->conversions = (uint32_t)divRound(sum, 1000);
+  plan->flatConversions = (uint32_t)divRound((uint64_t)maxRate
+                                             * config->channelCount, 1000);
+
+  sum = 0;
+  if (plan->fastChannel >= 0) {
+    sum = (uint64_t)plan->fastRate * (config->warmupNs + conversionNs);
+  }
+  if (plan->slotCount > 0) {
+    scanNs = 0;
+    for (s = 0; s < plan->slotCount; s++) {
+      scanNs += config->warmupNs + (uint64_t)plan->slotLength[s] * conversionNs;
+    }
+    sum += divRound(scanNs * plan->scanRate, plan->slotCount);
+  }
+  plan->onTimePpm = (uint32_t)divRound(sum, 1000000);
+  plan->flatOnTimePpm = (uint32_t)divRound((uint64_t)maxRate
+                                           * (config->warmupNs
+                                              + (uint64_t)config->channelCount
+                                              * conversionNs), 1000000);
+  return adcSchedOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan mask of a scan of the schedule
+ *
+ * @details
+ *   scanIds[c] is the scan input ID of channel c, as returned by
+ *   ADC_ScanSingleEndedInputAdd(); the mask is for ADC0->SCANMASK.
+ ******************************************************************************/
+uint32_t adcSchedScanMask(const adcSchedPlan_TypeDef *plan, uint32_t slot,
+                          const uint32_t *scanIds)
+{
+  uint32_t c, channels, mask;
+
+  if (plan->slotCount == 0) {
+    return 0;
+  }
+  channels = plan->slotMask[slot % plan->slotCount];
+  mask = 0;
+  for (c = 0; channels != 0; c++, channels >>= 1) {
+    if (channels & 1) {
+      mask |= 1UL << scanIds[c];
+    }
+  }
+  return mask;
+}
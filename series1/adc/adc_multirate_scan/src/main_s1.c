@@ -0,0 +1,412 @@
+/**************************************************************************//**
+ * @file
+ * @brief Multi-rate ADC sampling: a fast channel converted by the single
+ * sequencer and streamed by the LDMA, and slow channels in scans whose mask
+ * follows a schedule, each channel converted only at its own rate.
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "em_timer.h"
+#include "ldma_stream.h"
+#include "adc_sched.h"
+
+// ADC clock, the AUXHFRCO at 16 MHz: the shorter the conversions, the
+// shorter the ADC is on
+#define ADC_FREQ        16000000
+
+// Acquisition time of 16 cycles, plus 13 cycles for 12 bits
+#define CONVERSION_CYCLES 29
+
+// Warm-up of the ADC at each trigger, as it is off between conversions
+#define WARMUP_NS       5000
+
+// Largest error of the conversion rates, per million
+#define RATE_TOLERANCE_PPM  1000
+
+#define LDMA_CHANNEL    0
+#define PRS_FAST        0
+#define PRS_SCAN        1
+
+// The channels, see README for the corresponding EXP header pin
+#define CHANNEL_COUNT   3
+
+typedef struct {
+  ADC_ScanInputGroup_TypeDef group;   // Scan input group, if scanned
+  ADC_PosSel_TypeDef posSel;
+} channelInput_TypeDef;
+
+static const channelInput_TypeDef channelInputs[CHANNEL_COUNT] = {
+  { adcScanInputGroup0, adcPosSelAPORT2XCH9 },  // Vibration sensor
+  { adcScanInputGroup1, adcPosSelAVDD },        // Battery
+  { adcScanInputGroup1, adcPosSelDVDD },        // Core supply
+};
+
+// Samples per 1000 s: 10 kHz, 1 Hz and 0.1 Hz
+static const uint32_t channelRates[CHANNEL_COUNT] = {
+  10000000, 1000, 100
+};
+
+// The single FIFO is read by the LDMA once ADC_DVL results are in
+#define ADC_DVL         4
+
+// Double buffering of frames of a tenth of a second at 10 kHz
+#define BUFFER_COUNT    2
+#define FRAME_LENGTH    1000
+
+// Stream of the fast channel
+ldmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][FRAME_LENGTH];
+
+// Scan of the slow channels: the scan input ID of each channel, the channel
+// of each ID, and the scan mask of each slot of the schedule
+static uint32_t scanIds[CHANNEL_COUNT];
+static uint8_t idChannels[32];
+static uint32_t scanMasks[ADC_SCHED_MAX_SLOTS];
+static volatile uint32_t slot;
+
+adcSchedConfig_TypeDef schedConfig = {
+  channelRates, CHANNEL_COUNT, ADC_FREQ, CONVERSION_CYCLES, WARMUP_NS,
+  0, 32768, 0xFFFF, RATE_TOLERANCE_PPM
+};
+
+// Values to watch in the debugger
+adcSchedPlan_TypeDef plan;
+adcSchedStatus_TypeDef schedStatus;
+uint32_t channelCodes[CHANNEL_COUNT];     // Last result of each channel
+uint32_t channelSamples[CHANNEL_COUNT];   // Results of each channel
+uint32_t vibrationMean;
+uint32_t vibrationPeakToPeak;
+volatile uint32_t frameCount;
+volatile uint32_t scanCount;
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are read in the main loop
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/**************************************************************************//**
+ * @brief ADC Handler, reads a scan and sets up the next one
+ *
+ * The scan has just ended, and the next one is a whole scan period away.
+ *****************************************************************************/
+void ADC0_IRQHandler(void)
+{
+  uint32_t i, id, data, channel, next;
+
+  ADC_IntClear(ADC0, ADC_IF_SCAN);
+
+  for (i = 0; i < plan.slotLength[slot]; i++)
+  {
+    data = ADC_DataIdScanGet(ADC0, &id);
+    channel = idChannels[id];
+    channelCodes[channel] = data;
+    channelSamples[channel]++;
+  }
+  scanCount++;
+
+  // Channels and data valid level of the next scan of the schedule
+  next = (slot + 1 == plan.slotCount) ? 0 : slot + 1;
+  ADC0->SCANMASK = scanMasks[next];
+  ADC0->SCANCTRLX = (ADC0->SCANCTRLX & ~_ADC_SCANCTRLX_DVL_MASK)
+                    | ((plan.slotLength[next] - 1) << _ADC_SCANCTRLX_DVL_SHIFT);
+  slot = next;
+}
+
+/**************************************************************************//**
+ * @brief Stream consumer, mean and peak-to-peak of the fast channel
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint16_t *codes = data;
+  uint32_t sum = 0;
+  uint32_t low = 0xFFFF;
+  uint32_t high = 0;
+  uint32_t i;
+
+  (void)overrun;
+  (void)user;
+
+  for (i = 0; i < length; i++)
+  {
+    sum += codes[i];
+    if (codes[i] < low)
+    {
+      low = codes[i];
+    }
+    if (codes[i] > high)
+    {
+      high = codes[i];
+    }
+  }
+  vibrationMean = sum / length;
+  vibrationPeakToPeak = high - low;
+  channelCodes[plan.fastChannel] = codes[length - 1];
+  channelSamples[plan.fastChannel] += length;
+  frameCount++;
+}
+
+/**************************************************************************//**
+ * @brief Clock initialization, the timer clocks of the schedule
+ *****************************************************************************/
+void initClocks(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  schedConfig.fastTimerHz = CMU_ClockFreqGet(cmuClock_HFPER);
+  schedConfig.scanTimerHz = CMU_ClockFreqGet(cmuClock_LFA);
+}
+
+/**************************************************************************//**
+ * @brief TIMER0 initialization, overflows once per fast conversion and
+ * pulses PRS_FAST
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  TIMER_TopSet(TIMER0, plan.fastTop);
+  TIMER_Init(TIMER0, &timerInit);
+
+  PRS_SourceSignalSet(PRS_FAST, PRS_CH_CTRL_SOURCESEL_TIMER0,
+                      PRS_CH_CTRL_SIGSEL_TIMER0OF, prsEdgeOff);
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization, underflows once per scan and pulses
+ * PRS_SCAN
+ *****************************************************************************/
+void initLetimer(void)
+{
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Prescaler of the schedule, for scans slower than 1 Hz
+  CMU_ClockDivSet(cmuClock_LETIMER0, (CMU_ClkDiv_TypeDef)plan.scanPrescale);
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Prescaled LFA cycles per scan
+  LETIMER_CompareSet(LETIMER0, 0, plan.scanTop);
+
+  PRS_SourceAsyncSignalSet(PRS_SCAN, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization, streams the fast channel into frames
+ *****************************************************************************/
+void initLdma(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+
+  // ADC_DVL 16-bit results per request, the low half of SINGLEDATA
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = ldmaCtrlSizeHalf;
+  config.blockSize   = (LDMA_CtrlBlockSize_t)(ADC_DVL - 1);
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = FRAME_LENGTH;
+  config.length      = FRAME_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if (ldmaStreamInit(&stream, &config) == ldmaStreamOk)
+  {
+    ldmaStreamStart(&stream);
+  }
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *
+ * Both sequencers use the same reference, so that a single conversion in
+ * the middle of a scan does not switch it.
+ *****************************************************************************/
+void initAdc(void)
+{
+  // Declare init structs
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+  ADC_InitScan_TypeDef initScan = ADC_INITSCAN_DEFAULT;
+  uint32_t c, s;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_16M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // The ADC is off between triggers
+  init.warmUpMode = adcWarmupNormal;
+  ADC_Init(ADC0, &init);
+
+  // Fast channel, started by PRS_FAST and read by the LDMA
+  if (plan.fastChannel >= 0)
+  {
+    initSingle.posSel     = channelInputs[plan.fastChannel].posSel;
+    initSingle.reference  = adcRef2V5;
+    initSingle.resolution = adcRes12Bit;
+    initSingle.acqTime    = adcAcqTime16;
+    initSingle.prsEnable  = true;
+    initSingle.prsSel     = (ADC_PRSSEL_TypeDef) PRS_FAST;
+    ADC_InitSingle(ADC0, &initSingle);
+
+    ADC0->SINGLECTRLX = (ADC0->SINGLECTRLX & ~_ADC_SINGLECTRLX_DVL_MASK)
+                        | ((ADC_DVL - 1) << _ADC_SINGLECTRLX_DVL_SHIFT);
+    ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+  }
+
+  // Slow channels, started by PRS_SCAN and read in ADC0_IRQHandler()
+  if (plan.slotCount > 0)
+  {
+    initScan.reference  = adcRef2V5;
+    initScan.resolution = adcRes12Bit;
+    initScan.acqTime    = adcAcqTime16;
+    initScan.prsEnable  = true;
+    initScan.prsSel     = (ADC_PRSSEL_TypeDef) PRS_SCAN;
+
+    for (c = 0; c < CHANNEL_COUNT; c++)
+    {
+      if ((int32_t)c != plan.fastChannel)
+      {
+        scanIds[c] = ADC_ScanSingleEndedInputAdd(&initScan,
+                                                 channelInputs[c].group,
+                                                 channelInputs[c].posSel);
+        idChannels[scanIds[c]] = (uint8_t)c;
+      }
+    }
+    ADC_InitScan(ADC0, &initScan);
+
+    // Scan mask of each slot, starting with the channels of the first
+    for (s = 0; s < plan.slotCount; s++)
+    {
+      scanMasks[s] = adcSchedScanMask(&plan, s, scanIds);
+    }
+    slot = 0;
+    ADC0->SCANMASK = scanMasks[0];
+    ADC0->SCANCTRLX = (ADC0->SCANCTRLX & ~_ADC_SCANCTRLX_DVL_MASK)
+                      | ((plan.slotLength[0] - 1) << _ADC_SCANCTRLX_DVL_SHIFT);
+    ADC0->SCANFIFOCLEAR = ADC_SCANFIFOCLEAR_SCANFIFOCLEAR;
+
+    ADC_IntClear(ADC0, ADC_IF_SCAN);
+    ADC_IntEnable(ADC0, ADC_IEN_SCAN);
+    NVIC_ClearPendingIRQ(ADC0_IRQn);
+    NVIC_EnableIRQ(ADC0_IRQn);
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  // Init DCDC regulator if available
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  initClocks();
+
+  // Which sequencer converts each channel, and when
+  schedStatus = adcSchedCompute(&schedConfig, &plan);
+  if (schedStatus != adcSchedOk)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  initAdc();
+  if (plan.fastChannel >= 0)
+  {
+    initLdma();
+    initTimer();
+  }
+  if (plan.slotCount > 0)
+  {
+    initLetimer();
+  }
+
+  // Infinite loop
+  while(1)
+  {
+    // TIMER0 stops in EM2, so enter EM1 until the next frame or scan
+    EMU_EnterEM1();
+
+    // Read the filled frames
+    ldmaStreamProcess(&stream);
+  }
+}
@@ -0,0 +1,299 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC decimation filters on a host: checks and benchmark
+ *
+ * Build on its own, see readme.txt. The filters are first checked on
+ * constant and split inputs. Each configuration then filters a noise
+ * recording of a constant input: either a trace recorded from the kit,
+ * given with -f, or a synthetic one. The effective resolution of the
+ * output is printed next to the host time per input sample.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "adc_decim.h"
+#include "host_check.h"
+
+#define MAX_SAMPLES         65536
+#define BLOCK_LENGTH        64
+
+/* Synthetic recording: 12-bit samples of a constant input, with white
+   noise of this RMS in LSB */
+#define SYNTHETIC_LEVEL     2048.3
+#define SYNTHETIC_NOISE     1.5
+
+/* Outputs skipped while the filter fills up */
+#define SETTLE_OUTPUTS      8
+
+static const adcDecimConfig_TypeDef configs[] =
+{
+  { adcDecimNone, 1,  0, 0 },
+  { adcDecimCic,  4,  1, 0 },
+  { adcDecimCic,  16, 1, 0 },
+  { adcDecimCic,  64, 1, 0 },
+  { adcDecimCic,  16, 2, 0 },
+  { adcDecimCic,  16, 3, 0 },
+  { adcDecimCic,  64, 3, 0 },
+  { adcDecimFir,  2,  0, 0 },
+  { adcDecimFir,  4,  0, 0 },
+  { adcDecimFir,  8,  0, 0 },
+};
+
+#define CONFIG_COUNT        (sizeof(configs) / sizeof(configs[0]))
+
+static uint16_t trace[MAX_SAMPLES];
+static uint16_t output[MAX_SAMPLES + 1];
+static uint32_t traceLength;
+static uint32_t seed = 1;
+
+static void synthesize(void)
+{
+  double value;
+  uint32_t i;
+
+  for (i = 0; i < MAX_SAMPLES; i++)
+  {
+    value = floor(SYNTHETIC_LEVEL + SYNTHETIC_NOISE * hostGaussian(&seed) + 0.5);
+    trace[i] = (uint16_t)((value < 0) ? 0 : (value > 4095) ? 4095 : value);
+  }
+  traceLength = MAX_SAMPLES;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read a recorded trace, one sample per line or separated by spaces
+ ******************************************************************************/
+static int load(const char *name)
+{
+  FILE *file = fopen(name, "r");
+  unsigned long value;
+
+  if ( file == NULL )
+  {
+    perror(name);
+    return -1;
+  }
+  traceLength = 0;
+  while ( (traceLength < MAX_SAMPLES) && (fscanf(file, "%lu", &value) == 1) )
+  {
+    trace[traceLength++] = (uint16_t)value;
+  }
+  fclose(file);
+  return (traceLength > 0) ? 0 : -1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Filter the whole trace in blocks, as the LDMA would fill them
+ ******************************************************************************/
+static uint32_t filterTrace(adcDecim_TypeDef *decim, const uint16_t *in,
+                            uint32_t length, uint32_t block, uint16_t *out)
+{
+  uint32_t produced = 0;
+  uint32_t i, n;
+
+  for (i = 0; i < length; i += n)
+  {
+    n = (length - i < block) ? length - i : block;
+    produced += adcDecimRun(decim, in + i, n, out + produced);
+  }
+  return produced;
+}
+
+static void checkFilters(void)
+{
+  adcDecimConfig_TypeDef config;
+  adcDecim_TypeDef decim;
+  static uint16_t constant[4096], whole[4096], split[4096], inPlace[4096];
+  uint32_t c, i, n, m;
+
+  /* Ratios and widths not supported */
+  config = (adcDecimConfig_TypeDef){ adcDecimCic, 12, 2, 12 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimBadConfig);
+  config = (adcDecimConfig_TypeDef){ adcDecimCic, 256, 3, 16 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimBadConfig);
+  config = (adcDecimConfig_TypeDef){ adcDecimCic, 256, 2, 16 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimOk);
+  config = (adcDecimConfig_TypeDef){ adcDecimCic, 4, 5, 12 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimBadConfig);
+  config = (adcDecimConfig_TypeDef){ adcDecimFir, 16, 0, 12 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimBadConfig);
+  config = (adcDecimConfig_TypeDef){ adcDecimNone, 2, 0, 12 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimBadConfig);
+  config = (adcDecimConfig_TypeDef){ adcDecimNone, 1, 0, 17 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimBadConfig);
+
+  for (i = 0; i < 4096; i++)
+  {
+    constant[i] = 1000;
+  }
+
+  for (c = 0; c < CONFIG_COUNT; c++)
+  {
+    config = configs[c];
+    config.inBits = 12;
+    CHECK(adcDecimInit(&decim, &config) == adcDecimOk);
+
+    /* A constant input gives the same value on 16 bits once settled */
+    n = adcDecimRun(&decim, constant, 4096, whole);
+    CHECK(n == 4096 / config.ratio);
+    for (i = SETTLE_OUTPUTS; i < n; i++)
+    {
+      CHECK(whole[i] == 1000 << 4);
+    }
+
+    /* Blocks of any length, or in place, give the same outputs */
+    adcDecimReset(&decim);
+    n = filterTrace(&decim, trace, 4096, 4096, whole);
+    adcDecimReset(&decim);
+    m = filterTrace(&decim, trace, 4096, 37, split);
+    CHECK((m == n) && (memcmp(whole, split, n * sizeof(whole[0])) == 0));
+    memcpy(inPlace, trace, sizeof(inPlace));
+    adcDecimReset(&decim);
+    m = filterTrace(&decim, inPlace, 4096, BLOCK_LENGTH, inPlace);
+    CHECK((m == n) && (memcmp(whole, inPlace, n * sizeof(whole[0])) == 0));
+  }
+
+  /* 16-bit input from hardware oversampling: full scale stays full scale */
+  for (i = 0; i < 256; i++)
+  {
+    constant[i] = 0xFFFF;
+  }
+  config = (adcDecimConfig_TypeDef){ adcDecimCic, 16, 3, 16 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimOk);
+  n = adcDecimRun(&decim, constant, 256, whole);
+  CHECK((n == 16) && (whole[15] == 0xFFFF));
+  config = (adcDecimConfig_TypeDef){ adcDecimFir, 8, 0, 16 };
+  CHECK(adcDecimInit(&decim, &config) == adcDecimOk);
+  n = adcDecimRun(&decim, constant, 256, whole);
+  CHECK((n == 32) && (whole[31] == 0xFFFF));
+}
+
+static double now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static const char *typeName(adcDecimType_TypeDef type)
+{
+  return (type == adcDecimCic) ? "CIC" : (type == adcDecimFir) ? "FIR" : "none";
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Effective resolution and host time per input sample of each filter
+ ******************************************************************************/
+static void benchmark(uint32_t inBits)
+{
+  adcDecimConfig_TypeDef config;
+  adcDecim_TypeDef decim;
+  double start, elapsed, ideal;
+  float raw, bits;
+  uint32_t c, n, runs;
+
+  /* The raw samples, on 16 bits */
+  config = (adcDecimConfig_TypeDef){ adcDecimNone, 1, 0, inBits };
+  adcDecimInit(&decim, &config);
+  n = filterTrace(&decim, trace, traceLength, BLOCK_LENGTH, output);
+  raw = adcDecimEffectiveBits(output, n);
+
+  printf("%u samples of %u bits, %.2f effective bits\n",
+         (unsigned)traceLength, (unsigned)inBits, raw);
+  printf("filter ratio order  outputs  bits  ideal  ns/sample\n");
+
+  for (c = 0; c < CONFIG_COUNT; c++)
+  {
+    config = configs[c];
+    config.inBits = inBits;
+    if ( adcDecimInit(&decim, &config) != adcDecimOk )
+    {
+      printf("%-6s %5u %5u  not supported for %u-bit input\n",
+             typeName(config.type), (unsigned)config.ratio,
+             (unsigned)config.order, (unsigned)inBits);
+      continue;
+    }
+
+    n = filterTrace(&decim, trace, traceLength, BLOCK_LENGTH, output);
+    bits = (n > 2 * SETTLE_OUTPUTS)
+           ? adcDecimEffectiveBits(output + SETTLE_OUTPUTS, n - SETTLE_OUTPUTS)
+           : 0.0f;
+
+    /* White noise: half a bit per doubling of the ratio */
+    ideal = raw + 0.5 * log2(config.ratio);
+    if ( ideal > 16.0 )
+    {
+      ideal = 16.0;
+    }
+
+    /* Time enough runs for a stable figure */
+    runs = 0;
+    start = now();
+    do
+    {
+      adcDecimReset(&decim);
+      filterTrace(&decim, trace, traceLength, BLOCK_LENGTH, output);
+      runs++;
+      elapsed = now() - start;
+    } while ( elapsed < 0.2 );
+
+    printf("%-6s %5u %5u  %7u %5.2f  %5.2f  %9.2f\n",
+           typeName(config.type), (unsigned)config.ratio,
+           (unsigned)config.order, (unsigned)n, bits, ideal,
+           elapsed * 1e9 / ((double)runs * traceLength));
+
+    /* Averaging must not lose resolution on noisy input */
+    CHECK(bits >= raw - 0.25f);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t inBits = 12;
+  int option;
+
+  synthesize();
+  checkFilters();
+
+  while ( (option = getopt(argc, argv, "f:b:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'f':
+        if ( load(optarg) != 0 )
+        {
+          return 1;
+        }
+        break;
+
+      case 'b':
+        inBits = (uint32_t)atoi(optarg);
+        break;
+
+      default:
+        printf("usage: %s [-f trace] [-b input bits]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  benchmark(inBits);
+
+  hostCheckReport();
+  return 0;
+}
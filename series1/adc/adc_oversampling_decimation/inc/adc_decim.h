@@ -0,0 +1,72 @@
+/***************************************************************************//**
+ * @file  adc_decim.h
+ * @brief CIC and FIR decimation of ADC sample blocks
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_DECIM_H
+#define ADC_DECIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_DECIM_MAX_ORDER       4     // CIC stages
+#define ADC_DECIM_MAX_CIC_RATIO   256
+#define ADC_DECIM_MAX_TAPS        64    // FIR taps, for a ratio of 8
+
+typedef enum {
+  adcDecimOk,
+  adcDecimBadConfig         // Ratio, order or input width not supported
+} adcDecimStatus_TypeDef;
+
+typedef enum {
+  adcDecimNone,             // No decimation, only scaled to 16 bits
+  adcDecimCic,              // Cascaded integrator-comb, any power of 2 ratio
+  adcDecimFir               // Windowed-sinc low-pass, ratios 2, 4 and 8
+} adcDecimType_TypeDef;
+
+typedef struct {
+  adcDecimType_TypeDef type;
+  uint32_t ratio;           // Input samples per output sample, 1 for none
+  uint32_t order;           // CIC stages, 1 to ADC_DECIM_MAX_ORDER
+  uint32_t inBits;          // Input width: 12 for adcRes12Bit, 16 for
+                            // adcResOVS, 6 to 16
+} adcDecimConfig_TypeDef;
+
+typedef struct {
+  adcDecimConfig_TypeDef config;
+  uint32_t phase;           // Inputs since the last output
+  int32_t shift;            // Output scaling, right shift if positive
+  uint32_t integrator[ADC_DECIM_MAX_ORDER];
+  uint32_t comb[ADC_DECIM_MAX_ORDER];
+  const int16_t *taps;      // Q15, with a gain of 1
+  uint32_t tapCount;
+  uint32_t position;        // Newest sample in history[]
+  uint16_t history[2 * ADC_DECIM_MAX_TAPS];
+} adcDecim_TypeDef;
+
+adcDecimStatus_TypeDef adcDecimInit(adcDecim_TypeDef *decim,
+                                    const adcDecimConfig_TypeDef *config);
+void adcDecimReset(adcDecim_TypeDef *decim);
+uint32_t adcDecimRun(adcDecim_TypeDef *decim, const uint16_t *in,
+                     uint32_t count, uint16_t *out);
+
+float adcDecimEffectiveBits(const uint16_t *samples, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_DECIM_H
@@ -0,0 +1,320 @@
+/***************************************************************************//**
+ * @file adc_decim.c
+ * @brief CIC and FIR decimation of ADC sample blocks.
+ *
+ * Oversampling and averaging white noise gains half a bit of resolution per
+ * doubling of the ratio. The ADC does part of it in hardware (OVSRSEL); the
+ * filters here go further on the blocks the LDMA has filled:
+ * - a CIC decimator, with only additions per input sample, whose
+ *   wrap-around arithmetic is exact as long as the result fits in 32 bits
+ * - a windowed-sinc FIR low-pass, computed only for the samples kept, with
+ *   a sharper cut-off but 8 multiply-accumulates per input sample
+ * Outputs are scaled to 16 bits whatever the input width and ratio, so the
+ * extra bits show up below the input resolution.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <math.h>
+#include "adc_decim.h"
+
+// Hamming windowed-sinc low-pass filters, cut-off at 0.4 times the output
+// rate, 8 taps per unit of ratio, Q15 with a sum of 32768
+
+// Ratio 2, 16 taps
+static const int16_t fir2[16] = {
+  0, 183, 259, -541, -1665, 0, 6025, 12123,
+  12123, 6025, 0, -1665, -541, 259, 183, 0
+};
+
+// Ratio 4, 32 taps
+static const int16_t fir4[32] = {
+  -17, 20, 73, 135, 164, 91, -129, -466,
+  -783, -850, -435, 588, 2141, 3927, 5501, 6424,
+  6424, 5501, 3927, 2141, 588, -435, -850, -783,
+  -466, -129, 91, 164, 135, 73, 20, -17
+};
+
+// Ratio 8, 64 taps
+static const int16_t fir8[64] = {
+  -12, -4, 5, 17, 31, 48, 65, 79,
+  86, 83, 64, 26, -31, -106, -194, -284,
+  -366, -424, -442, -405, -300, -120, 139, 470,
+  862, 1295, 1744, 2182, 2578, 2904, 3137, 3257,
+  3257, 3137, 2904, 2578, 2182, 1744, 1295, 862,
+  470, 139, -120, -300, -405, -442, -424, -366,
+  -284, -194, -106, -31, 26, 64, 83, 86,
+  79, 65, 48, 31, 17, 5, -4, -12
+};
+
+static uint32_t log2Of(uint32_t ratio)
+{
+  uint32_t bits = 0;
+
+  while ((1UL << bits) < ratio) {
+    bits++;
+  }
+  return bits;
+}
+
+static uint16_t saturate(int64_t value)
+{
+  if (value < 0) {
+    return 0;
+  }
+  if (value > 0xFFFF) {
+    return 0xFFFF;
+  }
+  return (uint16_t)value;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Check the configuration and clear the filter state
+ *
+ * @details
+ *    A CIC filter grows by 'order' bits per doubling of the ratio, and the
+ *    input plus this growth must fit in 32 bits, e.g. order 3 up to a ratio
+ *    of 64 for 12-bit input, or of 16 for 16-bit input.
+ *****************************************************************************/
+adcDecimStatus_TypeDef adcDecimInit(adcDecim_TypeDef *decim,
+                                    const adcDecimConfig_TypeDef *config)
+{
+  uint32_t bits = log2Of(config->ratio);
+  uint32_t width;
+
+  if ((config->inBits < 6) || (config->inBits > 16)
+      || (config->ratio == 0) || ((1UL << bits) != config->ratio)) {
+    return adcDecimBadConfig;
+  }
+
+  decim->taps = NULL;
+  decim->tapCount = 0;
+  switch (config->type) {
+    case adcDecimNone:
+      if (config->ratio != 1) {
+        return adcDecimBadConfig;
+      }
+      decim->shift = (int32_t)config->inBits - 16;
+      break;
+
+    case adcDecimCic:
+      if ((config->ratio < 2) || (config->ratio > ADC_DECIM_MAX_CIC_RATIO)
+          || (config->order < 1) || (config->order > ADC_DECIM_MAX_ORDER)) {
+        return adcDecimBadConfig;
+      }
+      width = config->inBits + config->order * bits;
+      if (width > 32) {
+        return adcDecimBadConfig;
+      }
+      decim->shift = (int32_t)width - 16;
+      break;
+
+    case adcDecimFir:
+      if (config->ratio == 2) {
+        decim->taps = fir2;
+      } else if (config->ratio == 4) {
+        decim->taps = fir4;
+      } else if (config->ratio == 8) {
+        decim->taps = fir8;
+      } else {
+        return adcDecimBadConfig;
+      }
+      decim->tapCount = 8 * config->ratio;
+      // Q15 products of inBits samples, to 16 bits
+      decim->shift = 15 + (int32_t)config->inBits - 16;
+      break;
+
+    default:
+      return adcDecimBadConfig;
+  }
+
+  decim->config = *config;
+  adcDecimReset(decim);
+  return adcDecimOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Clear the filter state, e.g. after samples were lost
+ *****************************************************************************/
+void adcDecimReset(adcDecim_TypeDef *decim)
+{
+  uint32_t i;
+
+  decim->phase = 0;
+  decim->position = 0;
+  for (i = 0; i < ADC_DECIM_MAX_ORDER; i++) {
+    decim->integrator[i] = 0;
+    decim->comb[i] = 0;
+  }
+  for (i = 0; i < 2 * ADC_DECIM_MAX_TAPS; i++) {
+    decim->history[i] = 0;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Scale a filter result to 16 bits, rounded
+ *****************************************************************************/
+static uint16_t scale(const adcDecim_TypeDef *decim, int64_t value)
+{
+  if (decim->shift > 0) {
+    return saturate((value + (1LL << (decim->shift - 1))) >> decim->shift);
+  }
+  return saturate(value << -decim->shift);
+}
+
+static uint32_t runCic(adcDecim_TypeDef *decim, const uint16_t *in,
+                       uint32_t count, uint16_t *out)
+{
+  uint32_t order = decim->config.order;
+  uint32_t ratio = decim->config.ratio;
+  uint32_t *integrator = decim->integrator;
+  uint32_t *comb = decim->comb;
+  uint32_t phase = decim->phase;
+  uint32_t produced = 0;
+  uint32_t i, s, value, delayed;
+
+  for (i = 0; i < count; i++) {
+    // Integrators at the input rate
+    value = in[i];
+    for (s = 0; s < order; s++) {
+      integrator[s] += value;
+      value = integrator[s];
+    }
+    if (++phase < ratio) {
+      continue;
+    }
+    phase = 0;
+
+    // Combs at the output rate, the differences are exact modulo 2^32
+    for (s = 0; s < order; s++) {
+      delayed = comb[s];
+      comb[s] = value;
+      value -= delayed;
+    }
+    out[produced++] = scale(decim, value);
+  }
+  decim->phase = phase;
+  return produced;
+}
+
+static uint32_t runFir(adcDecim_TypeDef *decim, const uint16_t *in,
+                       uint32_t count, uint16_t *out)
+{
+  const int16_t *taps = decim->taps;
+  uint32_t tapCount = decim->tapCount;
+  uint32_t ratio = decim->config.ratio;
+  uint16_t *history = decim->history;
+  uint32_t position = decim->position;
+  uint32_t phase = decim->phase;
+  uint32_t produced = 0;
+  uint32_t i, t;
+  const uint16_t *window;
+  int64_t sum;
+
+  for (i = 0; i < count; i++) {
+    // The history is kept twice, so the newest tapCount samples are always
+    // in one piece from history[position]
+    position = (position == 0) ? tapCount - 1 : position - 1;
+    history[position] = in[i];
+    history[position + tapCount] = in[i];
+    if (++phase < ratio) {
+      continue;
+    }
+    phase = 0;
+
+    window = &history[position];
+    sum = 0;
+    for (t = 0; t < tapCount; t++) {
+      sum += (int32_t)taps[t] * window[t];
+    }
+    out[produced++] = scale(decim, sum);
+  }
+  decim->position = position;
+  decim->phase = phase;
+  return produced;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Filter a block of samples
+ *
+ * @details
+ *    The state is kept from one block to the next, so blocks need not hold a
+ *    multiple of the ratio. 'out' has room for count / ratio + 1 samples,
+ *    and can be 'in' to filter in place.
+ *
+ * @return
+ *    The number of 16-bit samples written to 'out'
+ *****************************************************************************/
+uint32_t adcDecimRun(adcDecim_TypeDef *decim, const uint16_t *in,
+                     uint32_t count, uint16_t *out)
+{
+  uint32_t i;
+
+  switch (decim->config.type) {
+    case adcDecimCic:
+      return runCic(decim, in, count, out);
+
+    case adcDecimFir:
+      return runFir(decim, in, count, out);
+
+    default:
+      for (i = 0; i < count; i++) {
+        out[i] = scale(decim, in[i]);
+      }
+      return count;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Estimate the effective resolution from the noise of 16-bit samples of
+ *    a constant input
+ *
+ * @details
+ *    The noise of an ideal N-bit converter is its quantization noise, of
+ *    RMS 2^(16-N) / sqrt(12) on a 16-bit scale, so N = 16 - log2(RMS *
+ *    sqrt(12)). A slow change of the input during the samples counts as
+ *    noise.
+ *
+ * @return
+ *    The effective number of bits, at most 16
+ *****************************************************************************/
+float adcDecimEffectiveBits(const uint16_t *samples, uint32_t count)
+{
+  uint64_t total = 0;
+  float mean, delta, variance = 0.0f, bits;
+  uint32_t i;
+
+  if (count < 2) {
+    return 0.0f;
+  }
+  for (i = 0; i < count; i++) {
+    total += samples[i];
+  }
+  mean = (float)total / count;
+  for (i = 0; i < count; i++) {
+    delta = samples[i] - mean;
+    variance += delta * delta;
+  }
+  variance /= count - 1;
+
+  // Less noise than a 16-bit converter cannot be told apart from it
+  if (variance * 12.0f <= 1.0f) {
+    return 16.0f;
+  }
+  bits = 16.0f - 0.5f * log2f(variance * 12.0f);
+  return (bits < 0.0f) ? 0.0f : bits;
+}
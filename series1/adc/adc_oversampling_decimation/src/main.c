@@ -0,0 +1,346 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC hardware oversampling and software decimation in EM2
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "em_timer.h"
+#include "ldma_stream.h"
+#include "adc_decim.h"
+
+// Hardware oversampling, each result is the average of 16 conversions on
+// 16 bits
+#define ADC_OVS_RATE    adcOvsRateSel16
+#define ADC_OVS_BITS    16
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired sample frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// Triple buffering of blocks of BLOCK_LENGTH samples
+#define BUFFER_COUNT    3
+#define BLOCK_LENGTH    64
+
+// Outputs of each filter used to estimate its resolution, after the first
+// SETTLE_OUTPUTS while it fills up
+#define ENOB_OUTPUTS    64
+#define SETTLE_OUTPUTS  8
+
+// Raw samples kept for the host benchmark
+#define TRACE_LENGTH    4096
+
+// Filters compared in turn, on 16-bit input
+static const adcDecimConfig_TypeDef configs[] = {
+  { adcDecimNone, 1,  0, ADC_OVS_BITS },
+  { adcDecimCic,  16, 1, ADC_OVS_BITS },
+  { adcDecimCic,  64, 1, ADC_OVS_BITS },
+  { adcDecimCic,  16, 2, ADC_OVS_BITS },
+  { adcDecimCic,  16, 3, ADC_OVS_BITS },
+  { adcDecimFir,  2,  0, ADC_OVS_BITS },
+  { adcDecimFir,  4,  0, ADC_OVS_BITS },
+  { adcDecimFir,  8,  0, ADC_OVS_BITS },
+};
+
+#define CONFIG_COUNT    (sizeof(configs) / sizeof(configs[0]))
+
+typedef struct {
+  float effectiveBits;      // Estimated from the output noise
+  float cyclesPerSample;    // Filter cycles per input sample
+  float cpuLoad;            // Percent of the core at letimerDesired
+} filterReport_TypeDef;
+
+// Stream of ADC samples
+ldmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][BLOCK_LENGTH];
+
+// Filter being measured, and its outputs
+adcDecim_TypeDef decim;
+uint16_t filtered[SETTLE_OUTPUTS + ENOB_OUTPUTS + BLOCK_LENGTH + 1];
+uint32_t filteredCount;
+uint32_t inputCount;
+uint32_t filterCycles;
+
+// Values to watch in the debugger
+filterReport_TypeDef report[CONFIG_COUNT];
+volatile uint32_t currentConfig;
+volatile uint32_t rounds;
+volatile uint32_t gapCount;
+uint16_t rawTrace[TRACE_LENGTH];
+volatile uint32_t rawCount;
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the blocks filled, they are filtered in the main loop
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/**************************************************************************//**
+ * @brief Start measuring the next filter
+ *****************************************************************************/
+static void nextConfig(void)
+{
+  currentConfig++;
+  if (currentConfig == CONFIG_COUNT)
+  {
+    currentConfig = 0;
+    rounds++;
+  }
+  adcDecimInit(&decim, &configs[currentConfig]);
+  filteredCount = 0;
+  inputCount = 0;
+  filterCycles = 0;
+}
+
+/**************************************************************************//**
+ * @brief Stream consumer, filters each block and times the filter
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint16_t *samples = data;
+  filterReport_TypeDef *r = &report[currentConfig];
+  uint32_t start, i;
+
+  (void)user;
+
+  // Samples were lost, start this filter again
+  if (overrun)
+  {
+    gapCount++;
+    adcDecimReset(&decim);
+    filteredCount = 0;
+    inputCount = 0;
+    filterCycles = 0;
+  }
+
+  // Keep the first raw samples, e.g. to export them for the host benchmark
+  for (i = 0; (i < length) && (rawCount < TRACE_LENGTH); i++)
+  {
+    rawTrace[rawCount++] = samples[i];
+  }
+
+  // TIMER0 counts HFPERCLK cycles, the core clock as HFPERCLK is not divided
+  start = TIMER_CounterGet(TIMER0);
+  filteredCount += adcDecimRun(&decim, samples, length, &filtered[filteredCount]);
+  filterCycles += (TIMER_CounterGet(TIMER0) - start) & 0xFFFF;
+  inputCount += length;
+
+  // Enough outputs: report on this filter and go on with the next one
+  if (filteredCount >= SETTLE_OUTPUTS + ENOB_OUTPUTS)
+  {
+    r->effectiveBits = adcDecimEffectiveBits(&filtered[SETTLE_OUTPUTS],
+                                             filteredCount - SETTLE_OUTPUTS);
+    r->cyclesPerSample = (float)filterCycles / inputCount;
+    r->cpuLoad = r->cyclesPerSample * letimerDesired * 100.0f
+                 / CMU_ClockFreqGet(cmuClock_CORE);
+    nextConfig();
+  }
+}
+
+/**************************************************************************//**
+ * @brief TIMER initialization, free running to count cycles
+ *****************************************************************************/
+void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+  TIMER_Init(TIMER0, &timerInit);
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization, streams the ADC results into blocks
+ *****************************************************************************/
+void initLdma(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+
+  // One 16-bit result per request, the low half of SINGLEDATA
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = ldmaCtrlSizeHalf;
+  config.blockSize   = ldmaCtrlBlockSizeUnit1;
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = BLOCK_LENGTH;
+  config.length      = BLOCK_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if (ldmaStreamInit(&stream, &config) == ldmaStreamOk)
+  {
+    ldmaStreamStart(&stream);
+  }
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *****************************************************************************/
+void initAdc(void)
+{
+  // Declare init structs
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock on demand in EM2
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  // Oversampling rate, OVSRSEL in ADC_CTRL
+  init.ovsRateSel = ADC_OVS_RATE;
+
+  // Internal temperature sensor, a slow input whose noise is measured
+  initSingle.posSel     = adcPosSelTEMP;
+  initSingle.reference  = adcRef1V25;
+  initSingle.resolution = adcResOVS;    // oversampled, 16-bit results
+  initSingle.acqTime    = adcAcqTime64; // 16 conversions fit in a sample period
+
+  // Conversions are started by PRS, and the LDMA wakes up in EM2 to read
+  // each result
+  initSingle.prsEnable      = true;
+  initSingle.prsSel         = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  initSingle.singleDmaEm2Wu = true;
+
+  // Initialize ADC
+  ADC_Init(ADC0, &init);
+  ADC_InitSingle(ADC0, &initSingle);
+
+  // Clear the single FIFO
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  // Init DCDC regulator if available
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  // Count filter cycles, and start with the first filter
+  initTimer();
+  adcDecimInit(&decim, &configs[0]);
+
+  // Setup ADC to perform oversampled conversions via PRS
+  initAdc();
+  // Setup the LDMA to stream the results into blocks
+  initLdma();
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while(1)
+  {
+    // Enter EM2 until the next block is filled
+    EMU_EnterEM2(false);
+
+    // Filter the filled blocks
+    ldmaStreamProcess(&stream);
+  }
+}
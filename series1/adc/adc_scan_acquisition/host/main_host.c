@@ -0,0 +1,334 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC Scan Acquisition on the host LDMA model, with synthetic scans
+ *
+ * Build with the models and the runner of ../../../ldma/ldma_host_model, see
+ * readme.txt. The demultiplexer is first checked on its own, with frames of
+ * synthetic SCANDATAX words: aligned or not with the scan, with a result
+ * missing, with an unknown ID, and with lost frames.
+ *
+ * Then hostProducer() plays a scan of three inputs: each call puts the next
+ * result, with its scan input ID, in a data register and raises the LDMA
+ * request. The frames are streamed as on the kit and de-interleaved in the
+ * callback, which checks the samples of each channel, the frame numbers
+ * across a stall of the consumer, and the slip of a result that is never
+ * sent.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "host.h"
+#include "ldma_stream.h"
+#include "adc_demux.h"
+#include "host_check.h"
+
+#define LDMA_CHANNEL        0
+
+/* Three inputs, converted in ID order 1, 8, 10 */
+#define INPUT_COUNT         3
+#define SCANS_PER_FRAME     8
+#define FRAME_LENGTH        (SCANS_PER_FRAME * INPUT_COUNT)
+#define CAPACITY            ADC_DEMUX_CAPACITY(FRAME_LENGTH, INPUT_COUNT)
+
+/* Frames sent: consumed, then not consumed, then consumed; one result is
+   never sent, so the last frame is not filled */
+#define STALL_START         (10 * FRAME_LENGTH)
+#define STALL_END           (15 * FRAME_LENGTH)
+#define MISSING_RESULT      (18 * FRAME_LENGTH + 4)
+#define RESULT_COUNT        (24 * FRAME_LENGTH)
+#define FULL_FRAMES         23
+
+static const uint8_t scanIds[INPUT_COUNT] = { 1, 8, 10 };
+
+ldmaStream_TypeDef stream;
+uint32_t frames[2][FRAME_LENGTH];
+adcDemux_TypeDef demux;
+uint16_t views[INPUT_COUNT * CAPACITY];
+uint32_t overrunsSeen;
+
+/* Simulated ADC0->SCANDATAX */
+volatile uint32_t scanDataX;
+volatile uint32_t results;
+
+/* What the consumer saw */
+uint32_t framesSeen;
+uint32_t lastScan[INPUT_COUNT];
+uint32_t skips[INPUT_COUNT];
+uint32_t samplesSeen;
+
+static uint32_t word(uint32_t id, uint32_t data)
+{
+  return (id << ADC_DEMUX_ID_SHIFT) | data;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The demultiplexer on its own
+ ******************************************************************************/
+static void checkDemux(void)
+{
+  static const uint8_t repeated[3] = { 1, 8, 1 };
+  static const uint8_t tooLarge[2] = { 1, 32 };
+  static const uint8_t unordered[3] = { 10, 1, 8 };
+  adcDemux_TypeDef d;
+  adcDemuxFrame_TypeDef f;
+  uint16_t storage[3 * 5];
+  uint32_t w[16];
+  uint32_t i, n;
+
+  /* Bad tables and storage */
+  CHECK(adcDemuxInit(&d, scanIds, 0, storage, 5) == adcDemuxBadConfig);
+  CHECK(adcDemuxInit(&d, scanIds, ADC_DEMUX_MAX_CHANNELS + 1, storage, 5)
+        == adcDemuxBadConfig);
+  CHECK(adcDemuxInit(&d, repeated, 3, storage, 5) == adcDemuxBadConfig);
+  CHECK(adcDemuxInit(&d, tooLarge, 2, storage, 5) == adcDemuxBadConfig);
+  CHECK(adcDemuxInit(&d, scanIds, 3, NULL, 5) == adcDemuxBadConfig);
+  CHECK(adcDemuxInit(&d, scanIds, 3, storage, 0) == adcDemuxBadConfig);
+  CHECK(adcDemuxInit(&d, scanIds, 3, storage, 5) == adcDemuxOk);
+
+  /* Four whole scans */
+  for (i = 0; i < 12; i++)
+  {
+    w[i] = word(scanIds[i % 3], 100 * (i % 3) + i / 3);
+  }
+  adcDemuxFrame(&d, w, 12, 0, &f);
+  CHECK(f.channelCount == 3);
+  CHECK((f.sequence == 0) && (f.lost == 0));
+  CHECK((f.unknown == 0) && (f.dropped == 0) && (f.slips == 0));
+  for (i = 0; i < 3; i++)
+  {
+    CHECK(f.count[i] == 4);
+    CHECK((f.data[i][0] == 100 * i) && (f.data[i][3] == 100 * i + 3));
+  }
+
+  /* The next frame goes on from the last scan, the one after starts within
+     a scan: neither slips */
+  w[0] = word(1, 7);
+  w[1] = word(8, 7);
+  adcDemuxFrame(&d, w, 2, 0, &f);
+  CHECK((f.sequence == 1) && (f.slips == 0));
+  w[0] = word(10, 7);
+  w[1] = word(1, 8);
+  adcDemuxFrame(&d, w, 2, 0, &f);
+  CHECK((f.sequence == 2) && (f.slips == 0));
+  CHECK((f.count[0] == 1) && (f.count[1] == 0) && (f.count[2] == 1));
+  CHECK((f.data[0][0] == 8) && (f.data[2][0] == 7));
+
+  /* Result of ID 10 missing: one slip, the other channels go on */
+  n = 0;
+  w[n++] = word(8, 1);
+  w[n++] = word(1, 2);
+  w[n++] = word(8, 2);
+  w[n++] = word(10, 2);
+  adcDemuxFrame(&d, w, n, 0, &f);
+  CHECK((f.slips == 1) && (f.count[0] == 1) && (f.count[1] == 2) && (f.count[2] == 1));
+
+  /* Unknown ID: counted and skipped, the scan order is found again */
+  n = 0;
+  w[n++] = word(1, 3);
+  w[n++] = word(5, 3);
+  w[n++] = word(10, 3);
+  w[n++] = word(1, 4);
+  adcDemuxFrame(&d, w, n, 0, &f);
+  CHECK((f.unknown == 1) && (f.slips == 0));
+  CHECK((f.count[0] == 2) && (f.count[1] == 0) && (f.count[2] == 1));
+
+  /* Frames lost: numbered after them, no slip across the gap */
+  w[0] = word(10, 9);
+  adcDemuxFrame(&d, w, 1, 3, &f);
+  CHECK((f.sequence == 8) && (f.lost == 3) && (f.slips == 0));
+  CHECK((d.sequence == 9) && (d.lost == 3) && (d.slips == 1) && (d.unknown == 1));
+
+  /* One channel only: samples beyond the capacity are dropped */
+  for (i = 0; i < 7; i++)
+  {
+    w[i] = word(8, i);
+  }
+  adcDemuxFrame(&d, w, 7, 0, &f);
+  CHECK((f.count[1] == 5) && (f.dropped == 2) && (f.data[1][4] == 4));
+
+  /* Reset restarts the numbers and totals */
+  adcDemuxReset(&d);
+  adcDemuxFrame(&d, w, 1, 0, &f);
+  CHECK((f.sequence == 0) && (d.dropped == 0) && (d.slips == 0));
+
+  /* Table not in ID order: the scan order is still by ID */
+  CHECK(adcDemuxInit(&d, unordered, 3, storage, 5) == adcDemuxOk);
+  for (i = 0; i < 6; i++)
+  {
+    w[i] = word(scanIds[i % 3], 100 * (i % 3) + i / 3);
+  }
+  adcDemuxFrame(&d, w, 6, 0, &f);
+  CHECK(f.slips == 0);
+  CHECK((f.count[0] == 2) && (f.data[0][1] == 201));
+  CHECK((f.count[1] == 2) && (f.data[1][1] == 1));
+  CHECK((f.count[2] == 2) && (f.data[2][1] == 101));
+}
+
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  CHECK(!(pending & LDMA_IF_ERROR));
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   De-interleave a frame and check it, as adc_acq.c does on the kit
+ ******************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  adcDemuxFrame_TypeDef f;
+  uint32_t lost = 0;
+  uint32_t c, i, scan;
+
+  (void)user;
+
+  if ( overrun )
+  {
+    lost = ldmaStreamOverruns(&stream) - overrunsSeen;
+    overrunsSeen += lost;
+  }
+  adcDemuxFrame(&demux, data, length, lost, &f);
+
+  CHECK(f.sequence == framesSeen + demux.lost);
+  CHECK((f.unknown == 0) && (f.dropped == 0));
+  for (c = 0; c < INPUT_COUNT; c++)
+  {
+    for (i = 0; i < f.count[c]; i++)
+    {
+      scan = f.data[c][i];
+
+      /* Before the missing result, frame n holds scans 8n to 8n + 7 */
+      if ( (f.sequence + 1) * FRAME_LENGTH <= MISSING_RESULT )
+      {
+        CHECK(scan == f.sequence * SCANS_PER_FRAME + i);
+      }
+
+      /* Consecutive scans, except after lost frames */
+      if ( (framesSeen > 0) && (scan != lastScan[c] + 1)
+           && !((lost != 0) && (i == 0)) )
+      {
+        skips[c]++;
+      }
+      lastScan[c] = scan;
+    }
+    samplesSeen += f.count[c];
+  }
+  framesSeen++;
+}
+
+static void report(void)
+{
+  dmaModelStats_TypeDef stats;
+
+  while ( ldmaStreamReady(&stream) != 0 )
+  {
+    ldmaStreamProcess(&stream);
+  }
+  ldmaModelGetStats(&stats);
+
+  /* Every full frame was seen or counted lost, once the consumer stalled */
+  CHECK(framesSeen + demux.lost == FULL_FRAMES);
+  CHECK(demux.lost == ldmaStreamOverruns(&stream));
+  CHECK(demux.lost > 0);
+  CHECK(samplesSeen == framesSeen * FRAME_LENGTH);
+
+  /* Only the result of ID 8 in scan MISSING_RESULT / 3 was never sent */
+  CHECK(demux.slips == 1);
+  CHECK((skips[0] == 0) && (skips[1] == 1) && (skips[2] == 0));
+
+  /* One interrupt and one wake-up per frame */
+  CHECK(stats.doneCount[LDMA_CHANNEL] == FULL_FRAMES);
+  CHECK(hostWakeups == FULL_FRAMES);
+
+  printf("frames %lu, lost %lu, samples %lu, slips %lu, wake-ups %lu\n",
+         (unsigned long)framesSeen, (unsigned long)demux.lost,
+         (unsigned long)samplesSeen, (unsigned long)demux.slips,
+         (unsigned long)hostWakeups);
+  hostCheckReport();
+}
+
+bool hostProducer(void)
+{
+  if ( results == MISSING_RESULT )
+  {
+    results++;
+  }
+  if ( results == RESULT_COUNT )
+  {
+    report();
+    return false;
+  }
+
+  /* Result of input results % 3 in scan results / 3, 12-bit */
+  scanDataX = word(scanIds[results % INPUT_COUNT], (results / INPUT_COUNT) & 0xFFF);
+  results++;
+  ldmaModelSignal(ldmaPeripheralSignal_ADC0_SCAN, false);
+  return true;
+}
+
+int main(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  CHIP_Init();
+
+  checkDemux();
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  /* As adcAcqInit(), but with DVL 1: the model reads the same register
+     value for each unit of a block, where the FIFO would give the next */
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SCAN;
+  config.source      = &scanDataX;
+  config.size        = ldmaCtrlSizeWord;
+  config.blockSize   = ldmaCtrlBlockSizeUnit1;
+  config.ignoreSrec  = true;
+  config.storage     = frames;
+  config.bufferCount = 2;
+  config.maxLength   = FRAME_LENGTH;
+  config.length      = FRAME_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if ( (ldmaStreamInit(&stream, &config) != ldmaStreamOk)
+       || (adcDemuxInit(&demux, scanIds, INPUT_COUNT, views, CAPACITY) != adcDemuxOk) )
+  {
+    printf("init failed\n");
+    return 1;
+  }
+  ldmaStreamStart(&stream);
+
+  /* The run ends when the producer is done */
+  while (1)
+  {
+    EMU_EnterEM1();
+
+    /* The consumer is too slow between STALL_START and STALL_END */
+    if ( (results <= STALL_START) || (results >= STALL_END) )
+    {
+      ldmaStreamProcess(&stream);
+    }
+  }
+}
@@ -0,0 +1,85 @@
+/***************************************************************************//**
+ * @file  adc_acq.h
+ * @brief Continuous multi-channel ADC scan acquisition into ping-pong frames
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_ACQ_H
+#define ADC_ACQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_adc.h"
+#include "ldma_stream.h"
+#include "adc_demux.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Words of ADC0->SCANDATAX in the two frames
+#define ADC_ACQ_STORAGE(frameLength)    (2 * (frameLength))
+
+// Samples of the per-channel views of a frame
+#define ADC_ACQ_VIEWS(frameLength, inputCount) \
+  ((inputCount) * ADC_DEMUX_CAPACITY(frameLength, inputCount))
+
+typedef enum {
+  adcAcqOk,
+  adcAcqBadConfig           // Inputs, DVL, frame length or storage not usable
+} adcAcqStatus_TypeDef;
+
+// Called from adcAcqProcess() with each frame, de-interleaved
+typedef void (*adcAcqCallback_TypeDef)(const adcDemuxFrame_TypeDef *frame,
+                                       void *user);
+
+// A single-ended scan input, as given to ADC_ScanSingleEndedInputAdd()
+typedef struct {
+  ADC_ScanInputGroup_TypeDef group;
+  ADC_PosSel_TypeDef posSel;
+} adcAcqInput_TypeDef;
+
+typedef struct {
+  const adcAcqInput_TypeDef *inputs;  // Channel c is inputs[c]
+  uint32_t inputCount;                // Up to ADC_DEMUX_MAX_CHANNELS
+  ADC_Ref_TypeDef reference;
+  ADC_AcqTime_TypeDef acqTime;
+  ADC_PRSSEL_TypeDef prsSel;          // PRS channel starting each scan
+  int channel;                        // LDMA channel
+  uint32_t dvl;                       // Results per LDMA request, 1 to 4
+  uint32_t *frames;                   // ADC_ACQ_STORAGE(frameLength) words
+  uint32_t frameLength;               // Words per frame, a multiple of dvl
+  uint16_t *views;                    // ADC_ACQ_VIEWS(frameLength, inputCount)
+  adcAcqCallback_TypeDef callback;
+  void *user;                         // Passed to the callback
+} adcAcqConfig_TypeDef;
+
+typedef struct {
+  ldmaStream_TypeDef stream;
+  adcDemux_TypeDef demux;
+  adcAcqCallback_TypeDef callback;
+  void *user;
+  uint32_t overruns;        // Stream overruns already reported
+} adcAcq_TypeDef;
+
+adcAcqStatus_TypeDef adcAcqInit(adcAcq_TypeDef *acq,
+                                const adcAcqConfig_TypeDef *config);
+void adcAcqStart(adcAcq_TypeDef *acq);
+void adcAcqStop(adcAcq_TypeDef *acq);
+
+void adcAcqIrqHandler(adcAcq_TypeDef *acq, uint32_t pending);
+uint32_t adcAcqProcess(adcAcq_TypeDef *acq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_ACQ_H
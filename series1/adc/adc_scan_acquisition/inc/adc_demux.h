@@ -0,0 +1,87 @@
+/***************************************************************************//**
+ * @file  adc_demux.h
+ * @brief De-interleaving of ADC scan results by their scan input ID
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_DEMUX_H
+#define ADC_DEMUX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change this to demultiplex more scan inputs
+#define ADC_DEMUX_MAX_CHANNELS    8
+
+// Scan input IDs, and the fields of a ADC0->SCANDATAX word, as
+// _ADC_SCANDATAX_DATA_* and _ADC_SCANDATAX_SCANINPUTID_*
+#define ADC_DEMUX_IDS             32
+#define ADC_DEMUX_DATA_MASK       0xFFFFUL
+#define ADC_DEMUX_ID_SHIFT        16
+#define ADC_DEMUX_ID_MASK         0x1FUL
+
+// Samples each channel can hold for frames of 'length' words of 'count'
+// channels, to size the storage given to adcDemuxInit(): one more than its
+// share, as a frame that slipped can end with the channel it started with
+#define ADC_DEMUX_CAPACITY(length, count)   ((length) / (count) + 1)
+
+typedef enum {
+  adcDemuxOk,
+  adcDemuxBadConfig         // No or too many channels, ID repeated or too
+                            // large, or no storage
+} adcDemuxStatus_TypeDef;
+
+// One frame, de-interleaved. data[c] points to the count[c] samples of
+// channel c, oldest first, in the storage given to adcDemuxInit(); they are
+// overwritten by the next frame.
+typedef struct {
+  const uint16_t *data[ADC_DEMUX_MAX_CHANNELS];
+  uint32_t count[ADC_DEMUX_MAX_CHANNELS];
+  uint32_t channelCount;
+  uint32_t sequence;        // Frame number, from 0, counting lost frames
+  uint32_t lost;            // Frames lost just before this one
+  uint32_t unknown;         // Words with an ID not in the table
+  uint32_t dropped;         // Samples beyond the capacity of a channel
+  uint32_t slips;           // Words not in scan order, i.e. results missing
+} adcDemuxFrame_TypeDef;
+
+typedef struct {
+  uint8_t channelOf[ADC_DEMUX_IDS];       // Channel of each ID, or 0xFF
+  uint8_t nextOf[ADC_DEMUX_MAX_CHANNELS]; // Channel converted after each one
+  uint32_t channelCount;
+  uint16_t *storage;                      // channelCount * capacity samples
+  uint32_t capacity;
+  uint32_t expected;        // Channel of the next word, or channelCount
+                            // before the first one
+  uint32_t sequence;        // Number of the next frame
+  uint32_t lost;            // Totals over all frames
+  uint32_t unknown;
+  uint32_t dropped;
+  uint32_t slips;
+} adcDemux_TypeDef;
+
+adcDemuxStatus_TypeDef adcDemuxInit(adcDemux_TypeDef *demux,
+                                    const uint8_t *ids, uint32_t count,
+                                    uint16_t *storage, uint32_t capacity);
+void adcDemuxReset(adcDemux_TypeDef *demux);
+void adcDemuxFrame(adcDemux_TypeDef *demux, const uint32_t *words,
+                   uint32_t length, uint32_t lost,
+                   adcDemuxFrame_TypeDef *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_DEMUX_H
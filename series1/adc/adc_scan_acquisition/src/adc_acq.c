@@ -0,0 +1,162 @@
+/***************************************************************************//**
+ * @file adc_acq.c
+ * @brief Continuous multi-channel ADC scan acquisition into ping-pong frames.
+ *
+ * Each PRS pulse starts a scan of the input table. The LDMA moves the
+ * results, DVL at a time, from ADC0->SCANDATAX into two frames with the
+ * ldma_stream driver, so the CPU only wakes up once per frame. Frames are
+ * de-interleaved in adcAcqProcess() using the scan input ID of each result,
+ * and the per-channel views are passed to the callback.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "em_device.h"
+#include "adc_acq.h"
+
+#if (ADC_DEMUX_ID_SHIFT != _ADC_SCANDATAX_SCANINPUTID_SHIFT) \
+  || ((ADC_DEMUX_ID_MASK << ADC_DEMUX_ID_SHIFT) != _ADC_SCANDATAX_SCANINPUTID_MASK)
+#error "adc_demux.h does not match the SCANDATAX fields of this device"
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *    Stream callback, de-interleaves a frame for the acquisition callback
+ *****************************************************************************/
+static void frameDone(const void *data, uint32_t length, bool overrun, void *user)
+{
+  adcAcq_TypeDef *acq = user;
+  adcDemuxFrame_TypeDef frame;
+  uint32_t lost = 0;
+
+  if (overrun) {
+    lost = ldmaStreamOverruns(&acq->stream) - acq->overruns;
+    acq->overruns += lost;
+  }
+  adcDemuxFrame(&acq->demux, data, length, lost, &frame);
+  acq->callback(&frame, acq->user);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Configure the scan of ADC0 and the LDMA stream of its results
+ *
+ * @note
+ *    ADC0 must already be initialized with ADC_Init(), the LDMA with
+ *    LDMA_Init(). The scan is started with adcAcqStart().
+ *****************************************************************************/
+adcAcqStatus_TypeDef adcAcqInit(adcAcq_TypeDef *acq,
+                                const adcAcqConfig_TypeDef *config)
+{
+  ADC_InitScan_TypeDef initScan = ADC_INITSCAN_DEFAULT;
+  ldmaStreamConfig_TypeDef stream;
+  uint8_t ids[ADC_DEMUX_MAX_CHANNELS];
+  uint32_t i;
+
+  if ((config->inputCount == 0) || (config->inputCount > ADC_DEMUX_MAX_CHANNELS)
+      || (config->dvl < 1) || (config->dvl > 4) || (config->callback == NULL)
+      || (config->frameLength % config->dvl != 0)) {
+    return adcAcqBadConfig;
+  }
+
+  for (i = 0; i < config->inputCount; i++) {
+    ids[i] = (uint8_t)ADC_ScanSingleEndedInputAdd(&initScan,
+                                                  config->inputs[i].group,
+                                                  config->inputs[i].posSel);
+  }
+  if (adcDemuxInit(&acq->demux, ids, config->inputCount, config->views,
+                   ADC_DEMUX_CAPACITY(config->frameLength, config->inputCount))
+      != adcDemuxOk) {
+    return adcAcqBadConfig;
+  }
+
+  // One request per DVL results, both frames filled in turn
+  stream.channel     = config->channel;
+  stream.signal      = ldmaPeripheralSignal_ADC0_SCAN;
+  stream.source      = &ADC0->SCANDATAX;
+  stream.size        = ldmaCtrlSizeWord;
+  stream.blockSize   = (LDMA_CtrlBlockSize_t)(config->dvl - 1);
+  stream.ignoreSrec  = true;
+  stream.storage     = config->frames;
+  stream.bufferCount = 2;
+  stream.maxLength   = config->frameLength;
+  stream.length      = config->frameLength;
+  stream.callback    = frameDone;
+  stream.user        = acq;
+  if (ldmaStreamInit(&acq->stream, &stream) != ldmaStreamOk) {
+    return adcAcqBadConfig;
+  }
+  acq->callback = config->callback;
+  acq->user = config->user;
+  acq->overruns = 0;
+
+  // Scans started by PRS, the LDMA wakes up in EM2 to read the results
+  initScan.diff         = false;
+  initScan.reference    = config->reference;
+  initScan.resolution   = adcRes12Bit;
+  initScan.acqTime      = config->acqTime;
+  initScan.prsEnable    = true;
+  initScan.prsSel       = config->prsSel;
+  initScan.scanDmaEm2Wu = true;
+  ADC_InitScan(ADC0, &initScan);
+
+  ADC0->SCANCTRLX = (ADC0->SCANCTRLX & ~_ADC_SCANCTRLX_DVL_MASK)
+                    | (((config->dvl - 1) << _ADC_SCANCTRLX_DVL_SHIFT)
+                       & _ADC_SCANCTRLX_DVL_MASK);
+  return adcAcqOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start filling the frames, with an empty scan FIFO
+ *****************************************************************************/
+void adcAcqStart(adcAcq_TypeDef *acq)
+{
+  ADC0->SCANFIFOCLEAR = ADC_SCANFIFOCLEAR_SCANFIFOCLEAR;
+  adcDemuxReset(&acq->demux);
+  acq->overruns = ldmaStreamOverruns(&acq->stream);
+  ldmaStreamStart(&acq->stream);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Stop the LDMA channel, the frames filled so far can still be processed
+ *
+ * @note
+ *    PRS pulses still start scans, whose results stay in the scan FIFO
+ *    until the next adcAcqStart()
+ *****************************************************************************/
+void adcAcqStop(adcAcq_TypeDef *acq)
+{
+  ldmaStreamStop(&acq->stream);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Call from LDMA_IRQHandler() with the pending interrupt flags
+ *****************************************************************************/
+void adcAcqIrqHandler(adcAcq_TypeDef *acq, uint32_t pending)
+{
+  ldmaStreamIrqHandler(&acq->stream, pending);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    De-interleave the filled frames and pass them to the callback
+ *
+ * @return
+ *    The number of frames passed to the callback
+ *****************************************************************************/
+uint32_t adcAcqProcess(adcAcq_TypeDef *acq)
+{
+  return ldmaStreamProcess(&acq->stream);
+}
@@ -0,0 +1,155 @@
+/***************************************************************************//**
+ * @file adc_demux.c
+ * @brief De-interleaving of ADC scan results by their scan input ID.
+ *
+ * Read from ADC0->SCANDATAX, each scan result carries the ID of its scan
+ * input next to the data, so a frame of interleaved results is split into
+ * one array per channel without assuming where the frame starts in the
+ * scan. The scan converts its inputs in increasing ID order: a word that
+ * does not follow the previous one in that order is counted as a slip, as
+ * results were lost, e.g. to a full scan FIFO.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "adc_demux.h"
+
+#define UNUSED_ID   0xFF
+
+/**************************************************************************//**
+ * @brief
+ *    Map scan input IDs to channels
+ *
+ * @details
+ *    Channel c holds the results of scan input ids[c], e.g. as returned by
+ *    ADC_ScanSingleEndedInputAdd(). Each channel keeps up to 'capacity'
+ *    samples of a frame in 'storage', which holds count * capacity samples.
+ *****************************************************************************/
+adcDemuxStatus_TypeDef adcDemuxInit(adcDemux_TypeDef *demux,
+                                    const uint8_t *ids, uint32_t count,
+                                    uint16_t *storage, uint32_t capacity)
+{
+  uint32_t c, id;
+
+  if ((count == 0) || (count > ADC_DEMUX_MAX_CHANNELS)
+      || (storage == NULL) || (capacity == 0)) {
+    return adcDemuxBadConfig;
+  }
+
+  for (id = 0; id < ADC_DEMUX_IDS; id++) {
+    demux->channelOf[id] = UNUSED_ID;
+  }
+  for (c = 0; c < count; c++) {
+    if ((ids[c] >= ADC_DEMUX_IDS) || (demux->channelOf[ids[c]] != UNUSED_ID)) {
+      return adcDemuxBadConfig;
+    }
+    demux->channelOf[ids[c]] = (uint8_t)c;
+  }
+
+  // The channel converted after channel c has the next larger ID, the scan
+  // wraps from the largest to the smallest
+  for (c = 0; c < count; c++) {
+    id = ids[c];
+    do {
+      id = (id + 1) % ADC_DEMUX_IDS;
+    } while (demux->channelOf[id] == UNUSED_ID);
+    demux->nextOf[c] = demux->channelOf[id];
+  }
+
+  demux->channelCount = count;
+  demux->storage = storage;
+  demux->capacity = capacity;
+  adcDemuxReset(demux);
+  return adcDemuxOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Restart the frame numbers and totals, e.g. when the scan is restarted
+ *****************************************************************************/
+void adcDemuxReset(adcDemux_TypeDef *demux)
+{
+  demux->expected = demux->channelCount;
+  demux->sequence = 0;
+  demux->lost = 0;
+  demux->unknown = 0;
+  demux->dropped = 0;
+  demux->slips = 0;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Split a frame of SCANDATAX words into its channels
+ *
+ * @details
+ *    'lost' is the number of frames lost since the previous call: the
+ *    sequence number skips them, and the scan order is not checked across
+ *    the gap. The samples keep the resolution and alignment of the ADC
+ *    data, i.e. the low 16 bits of each word.
+ *****************************************************************************/
+void adcDemuxFrame(adcDemux_TypeDef *demux, const uint32_t *words,
+                   uint32_t length, uint32_t lost,
+                   adcDemuxFrame_TypeDef *frame)
+{
+  const uint8_t *channelOf = demux->channelOf;
+  const uint8_t *nextOf = demux->nextOf;
+  uint32_t count = demux->channelCount;
+  uint32_t capacity = demux->capacity;
+  uint32_t expected = demux->expected;
+  uint32_t unknown = 0, dropped = 0, slips = 0;
+  uint32_t c, i, word, n;
+
+  for (c = 0; c < count; c++) {
+    frame->count[c] = 0;
+    frame->data[c] = demux->storage + c * capacity;
+  }
+  if (lost != 0) {
+    expected = count;
+  }
+
+  for (i = 0; i < length; i++) {
+    word = words[i];
+    c = channelOf[(word >> ADC_DEMUX_ID_SHIFT) & ADC_DEMUX_ID_MASK];
+    if (c == UNUSED_ID) {
+      // Not from this scan, find the scan order again from the next word
+      unknown++;
+      expected = count;
+      continue;
+    }
+    if ((expected != count) && (c != expected)) {
+      slips++;
+    }
+    expected = nextOf[c];
+
+    n = frame->count[c];
+    if (n == capacity) {
+      dropped++;
+      continue;
+    }
+    demux->storage[c * capacity + n] = (uint16_t)(word & ADC_DEMUX_DATA_MASK);
+    frame->count[c] = n + 1;
+  }
+
+  frame->channelCount = count;
+  frame->sequence = demux->sequence + lost;
+  frame->lost = lost;
+  frame->unknown = unknown;
+  frame->dropped = dropped;
+  frame->slips = slips;
+
+  demux->expected = expected;
+  demux->sequence += lost + 1;
+  demux->lost += lost;
+  demux->unknown += unknown;
+  demux->dropped += dropped;
+  demux->slips += slips;
+}
@@ -0,0 +1,238 @@
+/**************************************************************************//**
+ * @file
+ * @brief Continuous multi-channel ADC scan acquisition into DMA frames in EM2
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "adc_acq.h"
+
+// Scans per frame, each scan converts every input of the table once
+#define SCANS_PER_FRAME 64
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired scan frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// Scan inputs, see README for the EXP header pin of the external input
+static const adcAcqInput_TypeDef inputs[] = {
+  { adcScanInputGroup0, adcPosSelAPORT0XCH2 },
+  { adcScanInputGroup1, adcPosSelAVDD },
+  { adcScanInputGroup1, adcPosSelDVDD },
+};
+
+#define INPUT_COUNT     (sizeof(inputs) / sizeof(inputs[0]))
+#define FRAME_LENGTH    (SCANS_PER_FRAME * INPUT_COUNT)
+
+// Two frames of SCANDATAX words, and the per-channel views of one frame
+adcAcq_TypeDef acq;
+uint32_t adcFrames[ADC_ACQ_STORAGE(FRAME_LENGTH)];
+uint16_t adcViews[ADC_ACQ_VIEWS(FRAME_LENGTH, INPUT_COUNT)];
+
+// Values to watch in the debugger
+volatile uint32_t channelAverage[INPUT_COUNT];
+volatile uint32_t frameCount;
+volatile uint32_t lostFrames;
+volatile uint32_t slips;
+adcAcqStatus_TypeDef acqStatus;
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are processed in the main loop
+  adcAcqIrqHandler(&acq, pending);
+}
+
+/**************************************************************************//**
+ * @brief Frame consumer, averages each channel
+ *****************************************************************************/
+static void consume(const adcDemuxFrame_TypeDef *frame, void *user)
+{
+  uint32_t c, i, sum;
+
+  (void)user;
+
+  for (c = 0; c < frame->channelCount; c++)
+  {
+    if (frame->count[c] == 0)
+    {
+      continue;
+    }
+    sum = 0;
+    for (i = 0; i < frame->count[c]; i++)
+    {
+      sum += frame->data[c][i];
+    }
+    channelAverage[c] = sum / frame->count[c];
+  }
+
+  frameCount++;
+  lostFrames += frame->lost;
+  slips += frame->slips;
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization
+ *****************************************************************************/
+void initLdma(void)
+{
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *****************************************************************************/
+void initAdc(void)
+{
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  adcAcqConfig_TypeDef config;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock on demand in EM2
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  ADC_Init(ADC0, &init);
+
+  // Scan the input table on each PRS pulse, one LDMA request per scan
+  config.inputs      = inputs;
+  config.inputCount  = INPUT_COUNT;
+  config.reference   = adcRef2V5;
+  config.acqTime     = adcAcqTime4;
+  config.prsSel      = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  config.channel     = LDMA_CHANNEL;
+  config.dvl         = INPUT_COUNT;
+  config.frames      = adcFrames;
+  config.frameLength = FRAME_LENGTH;
+  config.views       = adcViews;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  acqStatus = adcAcqInit(&acq, &config);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  // Set up the LDMA, then the ADC scan and the stream of its frames
+  initLdma();
+  initAdc();
+  if (acqStatus == adcAcqOk)
+  {
+    adcAcqStart(&acq);
+  }
+
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while(1)
+  {
+    // Enter EM2 until the next frame is filled
+    EMU_EnterEM2(false);
+
+    // De-interleave and average the filled frames
+    adcAcqProcess(&acq);
+  }
+}
@@ -0,0 +1,453 @@
+/**************************************************************************//**
+ * @file
+ * @brief Differential ADC decoding on a host: checks and benchmark
+ *
+ * Build on its own, see readme.txt. Every result of each resolution is
+ * decoded from the three layouts the data field can have: right adjusted
+ * with or without its sign extended, and left adjusted. Results and sums
+ * of results are converted to units and compared with the exact value,
+ * rounded half up. Frames of synthetic SCANDATAX words of three pairs are
+ * then de-interleaved and decoded as in adc_diff.c. Last, the decoding and
+ * conversion of a frame are timed against per-result code with a branch on
+ * the sign and against float.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "adc_demux.h"
+#include "adc_diff_decode.h"
+#include "host_check.h"
+
+#define MAX_SAMPLES         65536
+
+/* Pairs of the frames, converted in ID order 0, 4, 9 */
+#define PAIR_COUNT          3
+#define SCANS_PER_FRAME     8
+#define FRAME_LENGTH        (SCANS_PER_FRAME * PAIR_COUNT)
+#define CAPACITY            ADC_DEMUX_CAPACITY(FRAME_LENGTH, PAIR_COUNT)
+
+/* Full scales tried against the exact conversion */
+#define RANDOM_SCALES       200
+
+typedef enum
+{
+  methodBranch,
+  methodFloat,
+  methodFloatRounded,
+  methodKernels,
+} method_TypeDef;
+
+static const char *methodNames[] =
+{
+  "branch on sign, divide",
+  "branch on sign, float",
+  "branch on sign, float to int",
+  "decode and scale kernels",
+};
+
+static const uint32_t resolutions[] = { 6, 8, 12, 16 };
+
+#define RESOLUTION_COUNT    (sizeof(resolutions) / sizeof(resolutions[0]))
+
+/* Microvolts for the 2.5V reference, uV/V of a ratiometric bridge */
+static const int32_t fixedScales[] =
+{
+  2500000, 1000000, -1000000, 1250000, 5000000, 1, -1, 0, 2047, 65535,
+};
+
+#define FIXED_SCALE_COUNT   (sizeof(fixedScales) / sizeof(fixedScales[0]))
+
+static const uint8_t pairIds[PAIR_COUNT] = { 0, 4, 9 };
+
+static uint16_t raw[MAX_SAMPLES];
+static int16_t decoded[MAX_SAMPLES];
+static int32_t units[MAX_SAMPLES];
+static float floatUnits[MAX_SAMPLES];
+static uint32_t seed = 1;
+static volatile int32_t sink;
+
+/***************************************************************************//**
+ * @brief
+ *   value * fullScale / 2^shift rounded half up, on 64 bits
+ ******************************************************************************/
+static int64_t exactUnits(int64_t value, int32_t fullScale, uint32_t shift)
+{
+  int64_t product = value * fullScale + ((int64_t)1 << (shift - 1));
+  int64_t unit = (int64_t)1 << shift;
+
+  /* Floor division */
+  return (product >= 0) ? product / unit : -((-product + unit - 1) / unit);
+}
+
+static void checkDecode(void)
+{
+  adcDiffFormat_TypeDef right, left;
+  uint32_t r, bits, count;
+  int32_t v, low, high;
+  uint16_t mask;
+  bool ok;
+
+  /* Only the resolutions of the ADC */
+  CHECK(adcDiffFormatInit(&right, 10, false) == adcDiffDecodeBadFormat);
+  CHECK(adcDiffFormatInit(&right, 0, false) == adcDiffDecodeBadFormat);
+  CHECK(adcDiffFormatInit(&right, 32, true) == adcDiffDecodeBadFormat);
+
+  for (r = 0; r < RESOLUTION_COUNT; r++)
+  {
+    bits = resolutions[r];
+    CHECK(adcDiffFormatInit(&right, bits, false) == adcDiffDecodeOk);
+    CHECK(adcDiffFormatInit(&left, bits, true) == adcDiffDecodeOk);
+    low = -(1 << (bits - 1));
+    high = (1 << (bits - 1)) - 1;
+    mask = (uint16_t)((1UL << bits) - 1);
+
+    /* Every result, sign extended to bit 15 or not, and left adjusted */
+    ok = true;
+    for (v = low; v <= high; v++)
+    {
+      ok = ok && (adcDiffDecodeSample(&right, (uint16_t)v & mask) == v);
+      ok = ok && (adcDiffDecodeSample(&right, (uint16_t)v) == v);
+      ok = ok && (adcDiffDecodeSample(&left, (uint16_t)(v * (1 << (16 - bits))))
+                  == v);
+    }
+    CHECK(ok);
+
+    /* The block kernel, in place, gives the same */
+    count = 0;
+    for (v = low; v <= high; v++)
+    {
+      raw[count++] = (uint16_t)v & mask;
+    }
+    adcDiffDecodeBlock(&right, raw, count, (int16_t *)raw);
+    ok = true;
+    for (v = low; v <= high; v++)
+    {
+      ok = ok && (((int16_t *)raw)[v - low] == v);
+    }
+    CHECK(ok);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check the conversion of every result, and of sums, at one full scale
+ ******************************************************************************/
+static bool checkScaleAt(const adcDiffFormat_TypeDef *format, int32_t fullScale)
+{
+  adcDiffScale_TypeDef scale;
+  uint32_t shift = format->bits - 1;
+  int32_t low = -(1 << shift);
+  int32_t high = (1 << shift) - 1;
+  int32_t v, sumLimit;
+  int64_t exact;
+  uint32_t count = 0;
+  uint32_t i;
+  bool ok = true;
+
+  adcDiffScaleInit(&scale, format, fullScale);
+
+  for (v = low; v <= high; v++)
+  {
+    decoded[count++] = (int16_t)v;
+    ok = ok && (adcDiffScaleSample(&scale, v) == exactUnits(v, fullScale, shift));
+  }
+  adcDiffScaleBlock(&scale, decoded, count, units);
+  for (i = 0; i < count; i++)
+  {
+    ok = ok && (units[i] == exactUnits(decoded[i], fullScale, shift));
+  }
+
+  /* Sums up to 2^(31 - bits), as long as the units fit with room for the
+     sum, see adcDiffScaleSample() */
+  sumLimit = 1 << (31 - format->bits);
+  for (i = 0; i < 1000; i++)
+  {
+    v = (int32_t)(hostRandom(&seed) % (2UL * sumLimit + 1)) - sumLimit;
+    exact = exactUnits(v, fullScale, shift);
+    if ( (exact + sumLimit > INT32_MAX) || (exact - sumLimit < INT32_MIN) )
+    {
+      continue;
+    }
+    ok = ok && (adcDiffScaleSample(&scale, v) == exact);
+  }
+  return ok;
+}
+
+static void checkScale(void)
+{
+  adcDiffFormat_TypeDef format;
+  int32_t fullScale;
+  uint32_t r, s;
+  bool ok;
+
+  for (r = 0; r < RESOLUTION_COUNT; r++)
+  {
+    adcDiffFormatInit(&format, resolutions[r], false);
+
+    ok = true;
+    for (s = 0; s < FIXED_SCALE_COUNT; s++)
+    {
+      ok = ok && checkScaleAt(&format, fixedScales[s]);
+    }
+    CHECK(ok);
+
+    /* Random full scales, of either sign, whose results fit in 32 bits */
+    ok = true;
+    for (s = 0; s < RANDOM_SCALES; s++)
+    {
+      fullScale = (int32_t)(hostRandom(&seed) % 0x7FFFFFUL)
+                  * (((s & 1) != 0) ? -1 : 1) * (int32_t)(1 + s % 100);
+      ok = ok && checkScaleAt(&format, fullScale);
+    }
+    CHECK(ok);
+  }
+
+  /* The kit: 2048 results to 2.5V, one result 1220.7 uV */
+  adcDiffFormatInit(&format, 12, false);
+  {
+    adcDiffScale_TypeDef scale;
+
+    adcDiffScaleInit(&scale, &format, 2500000);
+    CHECK(adcDiffScaleSample(&scale, 1) == 1221);
+    CHECK(adcDiffScaleSample(&scale, -1) == -1221);
+    CHECK(adcDiffScaleSample(&scale, -2048) == -2500000);
+    CHECK(adcDiffScaleSample(&scale, 2047) == 2498779);
+    CHECK(adcDiffScaleSample(&scale, 64 * 2047) == 64 * 2500000 - 78125);
+  }
+}
+
+static uint32_t word(uint32_t id, int32_t data)
+{
+  /* Series 1 extends the sign of a differential result to bit 15 */
+  return (id << ADC_DEMUX_ID_SHIFT) | ((uint32_t)data & ADC_DEMUX_DATA_MASK);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Frames of SCANDATAX words de-interleaved and decoded, as in adc_diff.c
+ ******************************************************************************/
+static void checkFrames(void)
+{
+  static uint16_t views[PAIR_COUNT * CAPACITY];
+  adcDiffFormat_TypeDef format;
+  adcDemux_TypeDef demux;
+  adcDemuxFrame_TypeDef viewFrame;
+  adcDiffFrame_TypeDef frame;
+  uint32_t words[FRAME_LENGTH];
+  int32_t expected;
+  uint32_t i, p, n;
+  bool ok;
+
+  adcDiffFormatInit(&format, 12, false);
+  CHECK(adcDemuxInit(&demux, pairIds, PAIR_COUNT, views, CAPACITY) == adcDemuxOk);
+
+  /* Pair p reads (p - 1) * 1000 + scan: negative, around 0 and positive */
+  for (i = 0; i < FRAME_LENGTH; i++)
+  {
+    p = i % PAIR_COUNT;
+    words[i] = word(pairIds[p], ((int32_t)p - 1) * 1000 + (int32_t)(i / PAIR_COUNT));
+  }
+  adcDemuxFrame(&demux, words, FRAME_LENGTH, 0, &viewFrame);
+  adcDiffDecodeFrame(&format, &viewFrame, &frame);
+  CHECK((frame.pairCount == PAIR_COUNT) && (frame.sequence == 0));
+  CHECK((frame.lost == 0) && (frame.slips == 0) && (frame.unknown == 0));
+  ok = true;
+  for (p = 0; p < PAIR_COUNT; p++)
+  {
+    ok = ok && (frame.count[p] == SCANS_PER_FRAME);
+    for (i = 0; i < frame.count[p]; i++)
+    {
+      expected = ((int32_t)p - 1) * 1000 + (int32_t)i;
+      ok = ok && (frame.data[p][i] == expected);
+    }
+  }
+  CHECK(ok);
+
+  /* Full scale both ways, a result of pair 1 missing, frames lost */
+  n = 0;
+  words[n++] = word(0, -2048);
+  words[n++] = word(4, 2047);
+  words[n++] = word(9, -1);
+  words[n++] = word(0, 5);
+  words[n++] = word(9, 6);
+  adcDemuxFrame(&demux, words, n, 2, &viewFrame);
+  adcDiffDecodeFrame(&format, &viewFrame, &frame);
+  CHECK((frame.sequence == 3) && (frame.lost == 2) && (frame.slips == 1));
+  CHECK((frame.count[0] == 2) && (frame.data[0][0] == -2048) && (frame.data[0][1] == 5));
+  CHECK((frame.count[1] == 1) && (frame.data[1][0] == 2047));
+  CHECK((frame.count[2] == 2) && (frame.data[2][0] == -1) && (frame.data[2][1] == 6));
+
+  /* A result without its sign extended decodes the same */
+  words[0] = (4UL << ADC_DEMUX_ID_SHIFT) | 0xFFFUL;
+  adcDemuxFrame(&demux, words, 1, 0, &viewFrame);
+  adcDiffDecodeFrame(&format, &viewFrame, &frame);
+  CHECK((frame.count[1] == 1) && (frame.data[1][0] == -1));
+}
+
+static double now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Results of a bridge near zero, right adjusted without their sign
+ *   extended
+ ******************************************************************************/
+static void synthesize(uint32_t bits)
+{
+  int32_t range = 1 << (bits - 1);
+  int32_t v;
+  uint32_t i;
+
+  for (i = 0; i < MAX_SAMPLES; i++)
+  {
+    v = (int32_t)(hostRandom(&seed) % 401) - 200;
+    v = (v < -range) ? -range : (v >= range) ? range - 1 : v;
+    raw[i] = (uint16_t)v & (uint16_t)((1UL << bits) - 1);
+  }
+}
+
+static void run(method_TypeDef method, const adcDiffFormat_TypeDef *format,
+                const adcDiffScale_TypeDef *scale, int32_t fullScale)
+{
+  uint32_t bits = format->bits;
+  uint32_t signBit = 1UL << (bits - 1);
+  int32_t range = 1L << bits;
+  float perResult = (float)fullScale / (float)signBit;
+  int32_t v;
+  uint32_t i;
+
+  switch ( method )
+  {
+    case methodBranch:
+      /* As an application would write it */
+      for (i = 0; i < MAX_SAMPLES; i++)
+      {
+        v = raw[i];
+        if ( v & signBit )
+        {
+          v -= range;
+        }
+        units[i] = (int32_t)((int64_t)v * fullScale / (int32_t)signBit);
+      }
+      sink = units[MAX_SAMPLES / 2];
+      break;
+
+    case methodFloat:
+      for (i = 0; i < MAX_SAMPLES; i++)
+      {
+        v = raw[i];
+        if ( v & signBit )
+        {
+          v -= range;
+        }
+        floatUnits[i] = (float)v * perResult;
+      }
+      sink = (int32_t)floatUnits[MAX_SAMPLES / 2];
+      break;
+
+    case methodFloatRounded:
+      for (i = 0; i < MAX_SAMPLES; i++)
+      {
+        v = raw[i];
+        if ( v & signBit )
+        {
+          v -= range;
+        }
+        units[i] = (int32_t)lrintf((float)v * perResult);
+      }
+      sink = units[MAX_SAMPLES / 2];
+      break;
+
+    case methodKernels:
+      adcDiffDecodeBlock(format, raw, MAX_SAMPLES, decoded);
+      adcDiffScaleBlock(scale, decoded, MAX_SAMPLES, units);
+      sink = units[MAX_SAMPLES / 2];
+      break;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Host time per result of each method, decoding a frame to microvolts
+ ******************************************************************************/
+static void benchmark(uint32_t bits)
+{
+  adcDiffFormat_TypeDef format;
+  adcDiffScale_TypeDef scale;
+  double start, elapsed;
+  uint32_t m, runs;
+
+  if ( adcDiffFormatInit(&format, bits, false) != adcDiffDecodeOk )
+  {
+    printf("%u-bit results not supported\n", (unsigned)bits);
+    hostFailures++;
+    return;
+  }
+  adcDiffScaleInit(&scale, &format, 2500000);
+  synthesize(bits);
+
+  printf("%u results of %u bits to uV\n", MAX_SAMPLES, (unsigned)bits);
+  printf("method                         ns/result\n");
+  for (m = methodBranch; m <= methodKernels; m++)
+  {
+    runs = 0;
+    start = now();
+    do
+    {
+      run((method_TypeDef)m, &format, &scale, 2500000);
+      runs++;
+      elapsed = now() - start;
+    } while ( elapsed < 0.2 );
+
+    printf("%-30s %9.3f\n", methodNames[m],
+           elapsed * 1e9 / ((double)runs * MAX_SAMPLES));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t bits = 12;
+  int option;
+
+  checkDecode();
+  checkScale();
+  checkFrames();
+
+  while ( (option = getopt(argc, argv, "b:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'b':
+        bits = (uint32_t)atoi(optarg);
+        break;
+
+      default:
+        printf("usage: %s [-b result bits]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  benchmark(bits);
+
+  hostCheckReport();
+  return 0;
+}
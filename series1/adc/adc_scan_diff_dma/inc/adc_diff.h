@@ -0,0 +1,90 @@
+/***************************************************************************//**
+ * @file  adc_diff.h
+ * @brief Differential ADC scan of a pair table into DMA frames
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_DIFF_H
+#define ADC_DIFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_adc.h"
+#include "ldma_stream.h"
+#include "adc_demux.h"
+#include "adc_diff_decode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Words of ADC0->SCANDATAX in the two frames
+#define ADC_DIFF_STORAGE(frameLength)   (2 * (frameLength))
+
+// Results of the per-pair views of a frame
+#define ADC_DIFF_VIEWS(frameLength, pairCount) \
+  ((pairCount) * ADC_DEMUX_CAPACITY(frameLength, pairCount))
+
+typedef enum {
+  adcDiffOk,
+  adcDiffBadConfig          // Pairs, resolution, DVL, frame length or
+                            // storage not usable
+} adcDiffStatus_TypeDef;
+
+// Called from adcDiffProcess() with each frame, de-interleaved and decoded
+typedef void (*adcDiffCallback_TypeDef)(const adcDiffFrame_TypeDef *frame,
+                                        void *user);
+
+// A differential scan input, as given to ADC_ScanDifferentialInputAdd()
+typedef struct {
+  ADC_ScanInputGroup_TypeDef group;
+  ADC_PosSel_TypeDef posSel;
+  ADC_ScanNegInput_TypeDef negInput;
+} adcDiffPair_TypeDef;
+
+typedef struct {
+  const adcDiffPair_TypeDef *pairs;   // Pair p is pairs[p]
+  uint32_t pairCount;                 // Up to ADC_DIFF_MAX_PAIRS
+  ADC_Ref_TypeDef reference;
+  ADC_AcqTime_TypeDef acqTime;
+  ADC_Res_TypeDef resolution;         // adcResOVS gives 16-bit results
+  ADC_PRSSEL_TypeDef prsSel;          // PRS channel starting each scan
+  int channel;                        // LDMA channel
+  uint32_t dvl;                       // Results per LDMA request, 1 to 4
+  uint32_t *frames;                   // ADC_DIFF_STORAGE(frameLength) words
+  uint32_t frameLength;               // Words per frame, a multiple of dvl
+  uint16_t *views;                    // ADC_DIFF_VIEWS(frameLength, pairCount)
+  adcDiffCallback_TypeDef callback;
+  void *user;                         // Passed to the callback
+} adcDiffConfig_TypeDef;
+
+typedef struct {
+  ldmaStream_TypeDef stream;
+  adcDemux_TypeDef demux;
+  adcDiffFormat_TypeDef format;
+  adcDiffCallback_TypeDef callback;
+  void *user;
+  uint32_t overruns;        // Stream overruns already reported
+} adcDiff_TypeDef;
+
+adcDiffStatus_TypeDef adcDiffInit(adcDiff_TypeDef *diff,
+                                  const adcDiffConfig_TypeDef *config);
+void adcDiffStart(adcDiff_TypeDef *diff);
+void adcDiffStop(adcDiff_TypeDef *diff);
+
+void adcDiffIrqHandler(adcDiff_TypeDef *diff, uint32_t pending);
+uint32_t adcDiffProcess(adcDiff_TypeDef *diff);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_DIFF_H
@@ -0,0 +1,83 @@
+/***************************************************************************//**
+ * @file  adc_diff_decode.h
+ * @brief Decoding of signed differential ADC results
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_DIFF_DECODE_H
+#define ADC_DIFF_DECODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "adc_demux.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Differential pairs of a frame, one per demultiplexer channel
+#define ADC_DIFF_MAX_PAIRS      ADC_DEMUX_MAX_CHANNELS
+
+typedef enum {
+  adcDiffDecodeOk,
+  adcDiffDecodeBadFormat    // Not 6, 8, 12 or 16 bits
+} adcDiffDecodeStatus_TypeDef;
+
+// Layout of a result in the 16-bit data field, see adcDiffFormatInit()
+typedef struct {
+  uint32_t bits;            // 6, 8, 12, or 16 when oversampling
+  bool leftAdjust;          // Result in the top bits of the field
+  uint32_t up;              // Shifts moving the sign bit to bit 15, and
+  uint32_t down;            // the result back to bit 0
+} adcDiffFormat_TypeDef;
+
+// Conversion of results to units, see adcDiffScaleInit()
+typedef struct {
+  int32_t whole;            // Units per result, rounded down
+  int32_t part;             // and the rest, in 1/2^shift units
+  uint32_t shift;
+} adcDiffScale_TypeDef;
+
+// One frame, de-interleaved and decoded. data[p] points to the count[p]
+// results of pair p, oldest first, in the views given to the demultiplexer;
+// they are overwritten by the next frame.
+typedef struct {
+  const int16_t *data[ADC_DIFF_MAX_PAIRS];
+  uint32_t count[ADC_DIFF_MAX_PAIRS];
+  uint32_t pairCount;
+  uint32_t sequence;        // As in adcDemuxFrame_TypeDef
+  uint32_t lost;
+  uint32_t unknown;
+  uint32_t dropped;
+  uint32_t slips;
+} adcDiffFrame_TypeDef;
+
+adcDiffDecodeStatus_TypeDef adcDiffFormatInit(adcDiffFormat_TypeDef *format,
+                                              uint32_t bits, bool leftAdjust);
+int16_t adcDiffDecodeSample(const adcDiffFormat_TypeDef *format,
+                            uint16_t raw);
+void adcDiffDecodeBlock(const adcDiffFormat_TypeDef *format,
+                        const uint16_t *raw, uint32_t count, int16_t *out);
+void adcDiffDecodeFrame(const adcDiffFormat_TypeDef *format,
+                        const adcDemuxFrame_TypeDef *views,
+                        adcDiffFrame_TypeDef *frame);
+
+void adcDiffScaleInit(adcDiffScale_TypeDef *scale,
+                      const adcDiffFormat_TypeDef *format, int32_t fullScale);
+int32_t adcDiffScaleSample(const adcDiffScale_TypeDef *scale, int32_t value);
+void adcDiffScaleBlock(const adcDiffScale_TypeDef *scale, const int16_t *in,
+                       uint32_t count, int32_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_DIFF_DECODE_H
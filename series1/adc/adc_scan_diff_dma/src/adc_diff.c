@@ -0,0 +1,191 @@
+/***************************************************************************//**
+ * @file adc_diff.c
+ * @brief Differential ADC scan of a pair table into DMA frames.
+ *
+ * Each PRS pulse starts a scan that converts every differential pair of
+ * the table back to back. The LDMA moves the results, DVL at a time, from
+ * ADC0->SCANDATAX into two frames with the ldma_stream driver, so no
+ * interrupt runs per conversion or per scan, only one per frame. Frames
+ * are de-interleaved by scan input ID and decoded to signed results in
+ * adcDiffProcess(), and passed to the callback.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "em_device.h"
+#include "adc_diff.h"
+
+#if (ADC_DEMUX_ID_SHIFT != _ADC_SCANDATAX_SCANINPUTID_SHIFT) \
+  || ((ADC_DEMUX_ID_MASK << ADC_DEMUX_ID_SHIFT) != _ADC_SCANDATAX_SCANINPUTID_MASK)
+#error "adc_demux.h does not match the SCANDATAX fields of this device"
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *    Stream callback, de-interleaves and decodes a frame for the callback
+ *****************************************************************************/
+static void frameDone(const void *data, uint32_t length, bool overrun, void *user)
+{
+  adcDiff_TypeDef *diff = user;
+  adcDemuxFrame_TypeDef views;
+  adcDiffFrame_TypeDef frame;
+  uint32_t lost = 0;
+
+  if (overrun) {
+    lost = ldmaStreamOverruns(&diff->stream) - diff->overruns;
+    diff->overruns += lost;
+  }
+  adcDemuxFrame(&diff->demux, data, length, lost, &views);
+  adcDiffDecodeFrame(&diff->format, &views, &frame);
+  diff->callback(&frame, diff->user);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Bits of a result at a resolution, 0 if not supported
+ *****************************************************************************/
+static uint32_t resultBits(ADC_Res_TypeDef resolution)
+{
+  switch (resolution) {
+    case adcRes12Bit:
+      return 12;
+    case adcRes8Bit:
+      return 8;
+    case adcRes6Bit:
+      return 6;
+    case adcResOVS:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Configure the differential scan of ADC0 and the LDMA stream of its
+ *    results
+ *
+ * @note
+ *    ADC0 must already be initialized with ADC_Init(), with the
+ *    oversampling rate for adcResOVS, and the LDMA with LDMA_Init(). The
+ *    scan is started with adcDiffStart().
+ *****************************************************************************/
+adcDiffStatus_TypeDef adcDiffInit(adcDiff_TypeDef *diff,
+                                  const adcDiffConfig_TypeDef *config)
+{
+  ADC_InitScan_TypeDef initScan = ADC_INITSCAN_DEFAULT;
+  ldmaStreamConfig_TypeDef stream;
+  uint8_t ids[ADC_DIFF_MAX_PAIRS];
+  uint32_t i;
+
+  if ((config->pairCount == 0) || (config->pairCount > ADC_DIFF_MAX_PAIRS)
+      || (config->dvl < 1) || (config->dvl > 4) || (config->callback == NULL)
+      || (config->frameLength % config->dvl != 0)
+      || (adcDiffFormatInit(&diff->format, resultBits(config->resolution),
+                            false) != adcDiffDecodeOk)) {
+    return adcDiffBadConfig;
+  }
+
+  for (i = 0; i < config->pairCount; i++) {
+    ids[i] = (uint8_t)ADC_ScanDifferentialInputAdd(&initScan,
+                                                   config->pairs[i].group,
+                                                   config->pairs[i].posSel,
+                                                   config->pairs[i].negInput);
+  }
+  if (adcDemuxInit(&diff->demux, ids, config->pairCount, config->views,
+                   ADC_DEMUX_CAPACITY(config->frameLength, config->pairCount))
+      != adcDemuxOk) {
+    return adcDiffBadConfig;
+  }
+
+  // One request per DVL results, both frames filled in turn
+  stream.channel     = config->channel;
+  stream.signal      = ldmaPeripheralSignal_ADC0_SCAN;
+  stream.source      = &ADC0->SCANDATAX;
+  stream.size        = ldmaCtrlSizeWord;
+  stream.blockSize   = (LDMA_CtrlBlockSize_t)(config->dvl - 1);
+  stream.ignoreSrec  = true;
+  stream.storage     = config->frames;
+  stream.bufferCount = 2;
+  stream.maxLength   = config->frameLength;
+  stream.length      = config->frameLength;
+  stream.callback    = frameDone;
+  stream.user        = diff;
+  if (ldmaStreamInit(&diff->stream, &stream) != ldmaStreamOk) {
+    return adcDiffBadConfig;
+  }
+  diff->callback = config->callback;
+  diff->user = config->user;
+  diff->overruns = 0;
+
+  // Scans started by PRS, the LDMA wakes up in EM2 to read the results
+  initScan.diff         = true;
+  initScan.reference    = config->reference;
+  initScan.resolution   = config->resolution;
+  initScan.acqTime      = config->acqTime;
+  initScan.prsEnable    = true;
+  initScan.prsSel       = config->prsSel;
+  initScan.scanDmaEm2Wu = true;
+  ADC_InitScan(ADC0, &initScan);
+
+  ADC0->SCANCTRLX = (ADC0->SCANCTRLX & ~_ADC_SCANCTRLX_DVL_MASK)
+                    | (((config->dvl - 1) << _ADC_SCANCTRLX_DVL_SHIFT)
+                       & _ADC_SCANCTRLX_DVL_MASK);
+  return adcDiffOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start filling the frames, with an empty scan FIFO
+ *****************************************************************************/
+void adcDiffStart(adcDiff_TypeDef *diff)
+{
+  ADC0->SCANFIFOCLEAR = ADC_SCANFIFOCLEAR_SCANFIFOCLEAR;
+  adcDemuxReset(&diff->demux);
+  diff->overruns = ldmaStreamOverruns(&diff->stream);
+  ldmaStreamStart(&diff->stream);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Stop the LDMA channel, the frames filled so far can still be processed
+ *
+ * @note
+ *    PRS pulses still start scans, whose results stay in the scan FIFO
+ *    until the next adcDiffStart()
+ *****************************************************************************/
+void adcDiffStop(adcDiff_TypeDef *diff)
+{
+  ldmaStreamStop(&diff->stream);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Call from LDMA_IRQHandler() with the pending interrupt flags
+ *****************************************************************************/
+void adcDiffIrqHandler(adcDiff_TypeDef *diff, uint32_t pending)
+{
+  ldmaStreamIrqHandler(&diff->stream, pending);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    De-interleave and decode the filled frames and pass them to the
+ *    callback
+ *
+ * @return
+ *    The number of frames passed to the callback
+ *****************************************************************************/
+uint32_t adcDiffProcess(adcDiff_TypeDef *diff)
+{
+  return ldmaStreamProcess(&diff->stream);
+}
@@ -0,0 +1,154 @@
+/***************************************************************************//**
+ * @file adc_diff_decode.c
+ * @brief Decoding of signed differential ADC results.
+ *
+ * A differential result is a two's complement number of 6, 8 or 12 bits,
+ * or 16 when oversampling, in the 16-bit data field of SCANDATAX. Whether
+ * or not the ADC already extended its sign to bit 15, a shift up moves the
+ * sign bit of the result to bit 15 and an arithmetic shift down brings the
+ * result back, sign extended, so decoding takes two shifts per result.
+ * Left-adjusted results only need the shift down.
+ *
+ * Results are converted to units with a full scale, the units of a result
+ * of 2^(bits - 1), e.g. 2500000 uV for the 2.5 V reference, or 1000000
+ * uV/V for a ratiometric bridge on the VDD reference. The full scale is
+ * split into whole units per result and a rest in 1/2^(bits - 1) units,
+ * so a conversion is two multiplies and a shift on 32 bits, and gives the
+ * exact result rounded half up.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "adc_diff_decode.h"
+
+// Width of the data field
+#define FIELD_BITS    16
+
+/***************************************************************************//**
+ * @brief
+ *   Set up the decoding of results of bits bits, right or left adjusted
+ ******************************************************************************/
+adcDiffDecodeStatus_TypeDef adcDiffFormatInit(adcDiffFormat_TypeDef *format,
+                                              uint32_t bits, bool leftAdjust)
+{
+  if ((bits != 6) && (bits != 8) && (bits != 12) && (bits != 16)) {
+    return adcDiffDecodeBadFormat;
+  }
+  format->bits = bits;
+  format->leftAdjust = leftAdjust;
+  format->up = leftAdjust ? 0 : FIELD_BITS - bits;
+  format->down = FIELD_BITS - bits;
+  return adcDiffDecodeOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode one result, from -2^(bits - 1) to 2^(bits - 1) - 1
+ *
+ * @note
+ *   Relies on the arithmetic right shift of negative numbers of the ARM
+ *   compilers and of GCC.
+ ******************************************************************************/
+int16_t adcDiffDecodeSample(const adcDiffFormat_TypeDef *format, uint16_t raw)
+{
+  return (int16_t)((int16_t)(uint16_t)(raw << format->up) >> format->down);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode count results, out may be raw
+ ******************************************************************************/
+void adcDiffDecodeBlock(const adcDiffFormat_TypeDef *format,
+                        const uint16_t *raw, uint32_t count, int16_t *out)
+{
+  uint32_t up = format->up;
+  uint32_t down = format->down;
+  uint32_t i;
+
+  for (i = 0; i < count; i++) {
+    out[i] = (int16_t)((int16_t)(uint16_t)(raw[i] << up) >> down);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode the views of a de-interleaved frame, in place
+ *
+ * @details
+ *   The views point into the storage given to adcDemuxInit(), which holds
+ *   the decoded results afterwards.
+ ******************************************************************************/
+void adcDiffDecodeFrame(const adcDiffFormat_TypeDef *format,
+                        const adcDemuxFrame_TypeDef *views,
+                        adcDiffFrame_TypeDef *frame)
+{
+  int16_t *data;
+  uint32_t p;
+
+  for (p = 0; p < views->channelCount; p++) {
+    data = (int16_t *)views->data[p];
+    adcDiffDecodeBlock(format, views->data[p], views->count[p], data);
+    frame->data[p] = data;
+    frame->count[p] = views->count[p];
+  }
+  frame->pairCount = views->channelCount;
+  frame->sequence = views->sequence;
+  frame->lost = views->lost;
+  frame->unknown = views->unknown;
+  frame->dropped = views->dropped;
+  frame->slips = views->slips;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set up the conversion of decoded results to units, fullScale being the
+ *   units of a result of 2^(bits - 1)
+ ******************************************************************************/
+void adcDiffScaleInit(adcDiffScale_TypeDef *scale,
+                      const adcDiffFormat_TypeDef *format, int32_t fullScale)
+{
+  scale->shift = format->bits - 1;
+  scale->whole = fullScale >> scale->shift;
+  scale->part = fullScale - scale->whole * ((int32_t)1 << scale->shift);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Units of value results, rounded half up
+ *
+ * @details
+ *   value may also be a sum of decoded results, e.g. of up to 256 results
+ *   of 12 bits: |value| must be at most 2^(31 - bits), and the units plus
+ *   or minus |value| must fit in 32 bits.
+ ******************************************************************************/
+int32_t adcDiffScaleSample(const adcDiffScale_TypeDef *scale, int32_t value)
+{
+  return value * scale->whole
+         + ((value * scale->part + ((int32_t)1 << (scale->shift - 1))) >> scale->shift);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Units of count decoded results
+ ******************************************************************************/
+void adcDiffScaleBlock(const adcDiffScale_TypeDef *scale, const int16_t *in,
+                       uint32_t count, int32_t *out)
+{
+  int32_t whole = scale->whole;
+  int32_t part = scale->part;
+  uint32_t shift = scale->shift;
+  int32_t half = (int32_t)1 << (shift - 1);
+  uint32_t i;
+
+  for (i = 0; i < count; i++) {
+    out[i] = in[i] * whole + ((in[i] * part + half) >> shift);
+  }
+}
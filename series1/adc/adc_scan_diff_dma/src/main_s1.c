@@ -0,0 +1,257 @@
+/**************************************************************************//**
+ * @file
+ * @brief Differential ADC scan of several pairs per PRS trigger, moved into
+ * DMA frames in EM2 and decoded to signed microvolts
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "adc_diff.h"
+
+// Scans per frame, each scan converts every pair of the table once
+#define SCANS_PER_FRAME 64
+
+// Microvolts of a result of 2048, the 2.5V reference: differential results
+// go from -2.5V to 2.5V
+#define FULL_SCALE_UV   2500000
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired scan frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// Differential pairs, converted back to back on each trigger: the external
+// pair, see README for the EXP header pins, then VSS against VSS, which
+// reads the offset of the ADC. Note: add the pairs of the bridges here.
+static const adcDiffPair_TypeDef pairs[] = {
+  { adcScanInputGroup0, adcPosSelAPORT2XCH9, adcScanNegInput10 },
+  { adcScanInputGroup1, adcPosSelVSS,        adcScanNegInputDefault },
+};
+
+#define PAIR_COUNT      (sizeof(pairs) / sizeof(pairs[0]))
+#define FRAME_LENGTH    (SCANS_PER_FRAME * PAIR_COUNT)
+
+// Two frames of SCANDATAX words, and the per-pair views of one frame
+adcDiff_TypeDef diff;
+uint32_t adcFrames[ADC_DIFF_STORAGE(FRAME_LENGTH)];
+uint16_t adcViews[ADC_DIFF_VIEWS(FRAME_LENGTH, PAIR_COUNT)];
+
+// Results to microvolts
+adcDiffScale_TypeDef scale;
+
+// Values to watch in the debugger
+volatile int32_t pairMicrovolts[PAIR_COUNT];
+volatile uint32_t frameCount;
+volatile uint32_t lostFrames;
+volatile uint32_t slips;
+adcDiffStatus_TypeDef diffStatus;
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are processed in the main loop
+  adcDiffIrqHandler(&diff, pending);
+}
+
+/**************************************************************************//**
+ * @brief Frame consumer, averages each pair in microvolts
+ *
+ * The results are already signed: the sum of a pair is scaled at once,
+ * then divided by the number of results.
+ *****************************************************************************/
+static void consume(const adcDiffFrame_TypeDef *frame, void *user)
+{
+  uint32_t p, i;
+  int32_t sum;
+
+  (void)user;
+
+  for (p = 0; p < frame->pairCount; p++)
+  {
+    if (frame->count[p] == 0)
+    {
+      continue;
+    }
+    sum = 0;
+    for (i = 0; i < frame->count[p]; i++)
+    {
+      sum += frame->data[p][i];
+    }
+    pairMicrovolts[p] = adcDiffScaleSample(&scale, sum)
+                        / (int32_t)frame->count[p];
+  }
+
+  frameCount++;
+  lostFrames += frame->lost;
+  slips += frame->slips;
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization
+ *****************************************************************************/
+void initLdma(void)
+{
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *****************************************************************************/
+void initAdc(void)
+{
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  adcDiffConfig_TypeDef config;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock on demand in EM2
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  ADC_Init(ADC0, &init);
+
+  // Scan the pair table on each PRS pulse, one LDMA request per scan
+  config.pairs       = pairs;
+  config.pairCount   = PAIR_COUNT;
+  config.reference   = adcRef2V5;
+  config.acqTime     = adcAcqTime4;
+  config.resolution  = adcRes12Bit;
+  config.prsSel      = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  config.channel     = LDMA_CHANNEL;
+  config.dvl         = PAIR_COUNT;
+  config.frames      = adcFrames;
+  config.frameLength = FRAME_LENGTH;
+  config.views       = adcViews;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  diffStatus = adcDiffInit(&diff, &config);
+  if (diffStatus == adcDiffOk)
+  {
+    adcDiffScaleInit(&scale, &diff.format, FULL_SCALE_UV);
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  // Set up the LDMA, then the ADC scan and the stream of its frames
+  initLdma();
+  initAdc();
+  if (diffStatus == adcDiffOk)
+  {
+    adcDiffStart(&diff);
+  }
+
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while(1)
+  {
+    // Enter EM2 until the next frame is filled
+    EMU_EnterEM2(false);
+
+    // De-interleave, decode and average the filled frames
+    adcDiffProcess(&diff);
+  }
+}
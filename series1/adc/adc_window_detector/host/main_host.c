@@ -0,0 +1,348 @@
+/**************************************************************************//**
+ * @file
+ * @brief ADC window and change detection on a host: checks and benchmark
+ *
+ * Build on its own, see readme.txt. The block scan is checked against a
+ * plain sample by sample detector on synthetic signals, in blocks of any
+ * length, then timed against it. The number of events per frame shows how
+ * many wake-ups of the application are left when it is only notified of
+ * events instead of every frame.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "adc_detect.h"
+#include "host_check.h"
+
+#define SIGNAL_LENGTH       65536
+#define FRAME_LENGTH        64
+#define MAX_EVENTS          SIGNAL_LENGTH
+
+typedef struct
+{
+  const char *name;
+  adcDetectLimits_TypeDef limits;
+  uint16_t samples[SIGNAL_LENGTH];
+} signal_TypeDef;
+
+/* Sample by sample detector, written from the definition */
+typedef struct
+{
+  int region;
+  int reference;
+} reference_TypeDef;
+
+static signal_TypeDef signals[4];
+static adcDetectEvent_TypeDef events[MAX_EVENTS];
+static adcDetectEvent_TypeDef expected[MAX_EVENTS];
+static uint32_t seed = 1;
+
+static uint16_t quantize(double value)
+{
+  value = floor(value + 0.5);
+  return (uint16_t)((value < 0) ? 0 : (value > 4095) ? 4095 : value);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Synthetic 12-bit signals: a quiet supply with a few dips, a slow
+ *   drift with noise, a slow sine crossing the window, and a noisy signal
+ *   sitting on the window edge
+ ******************************************************************************/
+static void synthesize(void)
+{
+  signal_TypeDef *s;
+  double drift = 2000;
+  uint32_t i;
+
+  s = &signals[0];
+  s->name = "supply dips";
+  s->limits = (adcDetectLimits_TypeDef){ 3000, 4095, 10, 0 };
+  for (i = 0; i < SIGNAL_LENGTH; i++)
+  {
+    s->samples[i] = quantize(3300 + 1.5 * hostGaussian(&seed)
+                             - (((i % 20000) > 15000 && (i % 20000) < 15200)
+                                ? 500 : 0));
+  }
+
+  s = &signals[1];
+  s->name = "drift";
+  s->limits = (adcDetectLimits_TypeDef){ 0, 4095, 0, 20 };
+  for (i = 0; i < SIGNAL_LENGTH; i++)
+  {
+    drift += 0.05 * hostGaussian(&seed);
+    s->samples[i] = quantize(drift + 1.5 * hostGaussian(&seed));
+  }
+
+  s = &signals[2];
+  s->name = "slow sine";
+  s->limits = (adcDetectLimits_TypeDef){ 1000, 3000, 8, 200 };
+  for (i = 0; i < SIGNAL_LENGTH; i++)
+  {
+    s->samples[i] = quantize(2048 + 1500 * sin(2 * M_PI * i / 10000.0)
+                             + 1.5 * hostGaussian(&seed));
+  }
+
+  s = &signals[3];
+  s->name = "edge noise";
+  s->limits = (adcDetectLimits_TypeDef){ 1000, 2000, 0, 0 };
+  for (i = 0; i < SIGNAL_LENGTH; i++)
+  {
+    s->samples[i] = quantize(2000 + 3 * hostGaussian(&seed));
+  }
+}
+
+static int referenceRegion(const adcDetectLimits_TypeDef *l, int region,
+                           int value)
+{
+  int low = l->low, high = l->high, h = l->hysteresis;
+
+  if ( region == adcDetectUnknown )
+  {
+    return (value < low) ? adcDetectBelow
+           : (value > high) ? adcDetectAbove : adcDetectInside;
+  }
+  if ( (region == adcDetectBelow) && (value < low + h) )
+  {
+    return adcDetectBelow;
+  }
+  if ( (region == adcDetectAbove) && (value > high - h) )
+  {
+    return adcDetectAbove;
+  }
+  if ( value < low - h )
+  {
+    return adcDetectBelow;
+  }
+  if ( value > high + h )
+  {
+    return adcDetectAbove;
+  }
+  return adcDetectInside;
+}
+
+static uint32_t referenceDetect(const adcDetectLimits_TypeDef *l,
+                                reference_TypeDef *state,
+                                const uint16_t *samples, uint32_t count,
+                                adcDetectEvent_TypeDef *out)
+{
+  uint32_t found = 0;
+  uint32_t i;
+  int region;
+
+  for (i = 0; i < count; i++)
+  {
+    region = referenceRegion(l, state->region, samples[i]);
+    if ( (region != state->region)
+         || ((l->delta != 0) && (abs(samples[i] - state->reference) > l->delta)) )
+    {
+      out[found].index = i;
+      out[found].value = samples[i];
+      out[found].channel = 0;
+      out[found].type = (region != state->region) ? region : adcDetectChange;
+      found++;
+      state->region = region;
+      state->reference = samples[i];
+    }
+  }
+  return found;
+}
+
+static int sameEvents(const adcDetectEvent_TypeDef *a,
+                      const adcDetectEvent_TypeDef *b, uint32_t n)
+{
+  uint32_t i;
+
+  for (i = 0; i < n; i++)
+  {
+    if ( (a[i].index != b[i].index) || (a[i].value != b[i].value)
+         || (a[i].channel != b[i].channel) || (a[i].type != b[i].type) )
+    {
+      printf("event %u: %u/%u/%u, expected %u/%u/%u\n", (unsigned)i,
+             (unsigned)a[i].index, (unsigned)a[i].value, (unsigned)a[i].type,
+             (unsigned)b[i].index, (unsigned)b[i].value, (unsigned)b[i].type);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Scan a whole signal in blocks of 'block' samples
+ ******************************************************************************/
+static uint32_t scan(adcDetect_TypeDef *detect, uint32_t channel,
+                     const uint16_t *samples, uint32_t length, uint32_t block)
+{
+  uint32_t found = 0;
+  uint32_t i, n;
+
+  for (i = 0; i < length; i += n)
+  {
+    n = (length - i < block) ? length - i : block;
+    found += adcDetectBlock(detect, channel, samples + i, n, i,
+                            events + found, MAX_EVENTS - found);
+  }
+  return found;
+}
+
+static void checkDetector(void)
+{
+  static const uint32_t blocks[] = { 1, 2, 3, 5, 17, 64, SIGNAL_LENGTH };
+  static const uint16_t edges[] = { 0, 4095, 0, 1, 4094, 2048, 0x7FFF, 0 };
+  adcDetectLimits_TypeDef limits[2];
+  adcDetect_TypeDef detect;
+  reference_TypeDef state;
+  adcDetectEvent_TypeDef few[2];
+  uint16_t lower, upper;
+  uint32_t s, b, n, m;
+
+  /* Configurations not supported */
+  limits[0] = (adcDetectLimits_TypeDef){ 2000, 1000, 0, 0 };
+  CHECK(adcDetectInit(&detect, limits, 1) == adcDetectBadConfig);
+  limits[0] = (adcDetectLimits_TypeDef){ 0, 0x8000, 0, 0 };
+  CHECK(adcDetectInit(&detect, limits, 1) == adcDetectBadConfig);
+  CHECK(adcDetectInit(&detect, limits, 0) == adcDetectBadConfig);
+  CHECK(adcDetectInit(&detect, limits, ADC_DETECT_MAX_CHANNELS + 1)
+        == adcDetectBadConfig);
+
+  for (s = 0; s < sizeof(signals) / sizeof(signals[0]); s++)
+  {
+    state.region = adcDetectUnknown;
+    state.reference = 0;
+    m = referenceDetect(&signals[s].limits, &state, signals[s].samples,
+                        SIGNAL_LENGTH, expected);
+    CHECK(m > 0);
+
+    /* The same events whatever the block length */
+    for (b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++)
+    {
+      CHECK(adcDetectInit(&detect, &signals[s].limits, 1) == adcDetectOk);
+      n = scan(&detect, 0, signals[s].samples, SIGNAL_LENGTH, blocks[b]);
+      CHECK((n == m) && sameEvents(events, expected, n));
+      CHECK((detect.events == m) && (detect.missed == 0));
+      CHECK(detect.samples == SIGNAL_LENGTH);
+    }
+  }
+
+  /* Full scale and 15-bit samples, on a second channel, with no window */
+  limits[0] = (adcDetectLimits_TypeDef){ 0, ADC_DETECT_MAX_VALUE, 0, 0 };
+  limits[1] = (adcDetectLimits_TypeDef){ 1, 4094, 0, 1 };
+  CHECK(adcDetectInit(&detect, limits, 2) == adcDetectOk);
+  n = adcDetectBlock(&detect, 0, edges, 8, 0, events, MAX_EVENTS);
+  CHECK((n == 1) && (events[0].type == adcDetectInside));
+  state.region = adcDetectUnknown;
+  state.reference = 0;
+  m = referenceDetect(&limits[1], &state, edges, 8, expected);
+  n = adcDetectBlock(&detect, 1, edges, 8, 0, events, MAX_EVENTS);
+  for (b = 0; b < m; b++)
+  {
+    expected[b].channel = 1;
+  }
+  CHECK((n == m) && (n == 8) && sameEvents(events, expected, n));
+  CHECK((events[1].channel == 1) && (events[1].type == adcDetectAbove));
+  CHECK(adcDetectBlock(&detect, 2, edges, 8, 0, events, MAX_EVENTS) == 0);
+
+  /* Events beyond maxEvents are counted, and the state still follows */
+  adcDetectReset(&detect);
+  n = adcDetectBlock(&detect, 1, edges, 8, 100, few, 2);
+  CHECK((n == 2) && (few[1].index == 101) && (detect.missed == 6));
+
+  /* Window for the comparator: nothing is quiet before the first sample,
+     then the window within delta */
+  limits[0] = (adcDetectLimits_TypeDef){ 1000, 3000, 10, 50 };
+  CHECK(adcDetectInit(&detect, limits, 1) == adcDetectOk);
+  adcDetectWindow(&detect, 0, &lower, &upper);
+  CHECK(lower > upper);
+  n = adcDetectBlock(&detect, 0, &edges[5], 1, 0, events, MAX_EVENTS);
+  adcDetectWindow(&detect, 0, &lower, &upper);
+  CHECK((n == 1) && (lower == 1998) && (upper == 2098));
+}
+
+static double now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Host time per sample of the block scan and of the plain detector, and
+ *   the wake-ups left when only events are reported
+ ******************************************************************************/
+static void benchmark(void)
+{
+  adcDetect_TypeDef detect;
+  reference_TypeDef state;
+  double start, blockTime, plainTime;
+  uint32_t s, i, n, runs, frames, eventFrames;
+
+  printf("signal        events  frames with events  block ns  plain ns\n");
+  for (s = 0; s < sizeof(signals) / sizeof(signals[0]); s++)
+  {
+    /* Frames of FRAME_LENGTH samples that hold at least one event */
+    adcDetectInit(&detect, &signals[s].limits, 1);
+    eventFrames = 0;
+    frames = SIGNAL_LENGTH / FRAME_LENGTH;
+    for (i = 0; i < SIGNAL_LENGTH; i += FRAME_LENGTH)
+    {
+      if ( adcDetectBlock(&detect, 0, signals[s].samples + i, FRAME_LENGTH, i,
+                          events, MAX_EVENTS) > 0 )
+      {
+        eventFrames++;
+      }
+    }
+    n = detect.events;
+
+    runs = 0;
+    start = now();
+    do
+    {
+      adcDetectReset(&detect);
+      scan(&detect, 0, signals[s].samples, SIGNAL_LENGTH, FRAME_LENGTH);
+      runs++;
+    } while ( now() - start < 0.1 );
+    blockTime = (now() - start) / runs;
+
+    runs = 0;
+    start = now();
+    do
+    {
+      state.region = adcDetectUnknown;
+      state.reference = 0;
+      referenceDetect(&signals[s].limits, &state, signals[s].samples,
+                      SIGNAL_LENGTH, expected);
+      runs++;
+    } while ( now() - start < 0.1 );
+    plainTime = (now() - start) / runs;
+
+    printf("%-12s %7u %8u of %5u %9.2f %9.2f\n", signals[s].name,
+           (unsigned)n, (unsigned)eventFrames, (unsigned)frames,
+           blockTime * 1e9 / SIGNAL_LENGTH, plainTime * 1e9 / SIGNAL_LENGTH);
+  }
+}
+
+int main(void)
+{
+  synthesize();
+  checkDetector();
+  benchmark();
+
+  hostCheckReport();
+  return 0;
+}
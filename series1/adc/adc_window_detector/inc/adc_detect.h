@@ -0,0 +1,88 @@
+/***************************************************************************//**
+ * @file  adc_detect.h
+ * @brief Window and change detection on blocks of ADC samples
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef ADC_DETECT_H
+#define ADC_DETECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_DETECT_MAX_CHANNELS   8
+
+// Largest sample value, 12-bit and 15-bit oversampled results fit
+#define ADC_DETECT_MAX_VALUE      0x7FFF
+
+typedef enum {
+  adcDetectOk,
+  adcDetectBadConfig        // Channel count or limits not usable
+} adcDetectStatus_TypeDef;
+
+typedef enum {
+  adcDetectBelow,           // Entered the region below the window
+  adcDetectInside,          // Entered the window
+  adcDetectAbove,           // Entered the region above the window
+  adcDetectChange,          // Moved by more than delta in the same region
+  adcDetectUnknown          // State before the first sample
+} adcDetectType_TypeDef;
+
+// Window [low, high] of a channel. A region is only left once the sample
+// is past its edge by more than the hysteresis. With a delta, a change of
+// more than delta from the sample of the last event is also an event;
+// 0 disables it.
+typedef struct {
+  uint16_t low;
+  uint16_t high;
+  uint16_t hysteresis;
+  uint16_t delta;
+} adcDetectLimits_TypeDef;
+
+typedef struct {
+  uint32_t index;           // Sample index, from the first index of the block
+  uint16_t value;
+  uint8_t channel;
+  uint8_t type;             // adcDetectType_TypeDef
+} adcDetectEvent_TypeDef;
+
+typedef struct {
+  adcDetectLimits_TypeDef limits[ADC_DETECT_MAX_CHANNELS];
+  uint32_t channelCount;
+  uint8_t region[ADC_DETECT_MAX_CHANNELS];
+  uint16_t reference[ADC_DETECT_MAX_CHANNELS];  // Sample of the last event
+  uint16_t lower[ADC_DETECT_MAX_CHANNELS];      // Samples in [lower, upper]
+  uint16_t upper[ADC_DETECT_MAX_CHANNELS];      // are not events
+  uint32_t samples;         // Samples scanned
+  uint32_t events;          // Events found
+  uint32_t missed;          // Events found with no room left to report them
+} adcDetect_TypeDef;
+
+adcDetectStatus_TypeDef adcDetectInit(adcDetect_TypeDef *detect,
+                                      const adcDetectLimits_TypeDef *limits,
+                                      uint32_t channelCount);
+void adcDetectReset(adcDetect_TypeDef *detect);
+uint32_t adcDetectBlock(adcDetect_TypeDef *detect, uint32_t channel,
+                        const uint16_t *samples, uint32_t count,
+                        uint32_t firstIndex, adcDetectEvent_TypeDef *events,
+                        uint32_t maxEvents);
+void adcDetectWindow(const adcDetect_TypeDef *detect, uint32_t channel,
+                     uint16_t *lower, uint16_t *upper);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_DETECT_H
@@ -0,0 +1,272 @@
+/***************************************************************************//**
+ * @file adc_detect.c
+ * @brief Window and change detection on blocks of ADC samples.
+ *
+ * Each channel is in one of three regions, below, inside or above its
+ * window, and remembers the sample of its last event. Together these give
+ * an interval of quiet samples: samples in it are not events. The block
+ * scan looks for the first sample outside the interval two samples at a
+ * time, in the two 16-bit halves of a 32-bit word: adding 0x7FFF - upper
+ * to a half sets its top bit when the sample is above the interval, and
+ * adding 0x8000 - lower sets it when the sample is at or above the lower
+ * edge. Neither addition carries into the other half for samples up to
+ * ADC_DETECT_MAX_VALUE, so a quiet block costs a few instructions per pair
+ * of samples, on any core. Only the sample found is handled one by one:
+ * the event is reported, the region and last sample are updated, and the
+ * scan goes on with the new interval.
+ *
+ * The interval can also be programmed in the ADC window comparator, see
+ * adcDetectWindow(), so a single channel only wakes the core on events.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "adc_detect.h"
+
+#define HIGH_BITS       0x80008000UL
+
+static int32_t clamp(int32_t value)
+{
+  return (value < 0) ? 0
+         : (value > ADC_DETECT_MAX_VALUE) ? ADC_DETECT_MAX_VALUE : value;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Region of a sample, given the region of the channel so far
+ *****************************************************************************/
+static uint8_t regionOf(const adcDetectLimits_TypeDef *limits, uint8_t region,
+                        int32_t value)
+{
+  int32_t low = limits->low;
+  int32_t high = limits->high;
+  int32_t hysteresis = limits->hysteresis;
+
+  switch (region) {
+    case adcDetectBelow:
+      if (value < low + hysteresis) {
+        return adcDetectBelow;
+      }
+      return (value > high + hysteresis) ? adcDetectAbove : adcDetectInside;
+
+    case adcDetectAbove:
+      if (value > high - hysteresis) {
+        return adcDetectAbove;
+      }
+      return (value < low - hysteresis) ? adcDetectBelow : adcDetectInside;
+
+    case adcDetectInside:
+      if (value < low - hysteresis) {
+        return adcDetectBelow;
+      }
+      return (value > high + hysteresis) ? adcDetectAbove : adcDetectInside;
+
+    default:
+      return (value < low) ? adcDetectBelow
+             : (value > high) ? adcDetectAbove : adcDetectInside;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Quiet interval of a channel: its region, within delta of the sample of
+ *    the last event
+ *****************************************************************************/
+static void updateInterval(adcDetect_TypeDef *detect, uint32_t channel)
+{
+  const adcDetectLimits_TypeDef *limits = &detect->limits[channel];
+  int32_t hysteresis = limits->hysteresis;
+  int32_t lower, upper;
+
+  switch (detect->region[channel]) {
+    case adcDetectBelow:
+      lower = 0;
+      upper = limits->low + hysteresis - 1;
+      break;
+
+    case adcDetectAbove:
+      lower = limits->high - hysteresis + 1;
+      upper = ADC_DETECT_MAX_VALUE;
+      break;
+
+    case adcDetectInside:
+      lower = limits->low - hysteresis;
+      upper = limits->high + hysteresis;
+      break;
+
+    default:
+      // No sample yet, the first one is an event
+      detect->lower[channel] = ADC_DETECT_MAX_VALUE;
+      detect->upper[channel] = 0;
+      return;
+  }
+
+  if (limits->delta != 0) {
+    if (lower < detect->reference[channel] - limits->delta) {
+      lower = detect->reference[channel] - limits->delta;
+    }
+    if (upper > detect->reference[channel] + limits->delta) {
+      upper = detect->reference[channel] + limits->delta;
+    }
+  }
+  detect->lower[channel] = (uint16_t)clamp(lower);
+  detect->upper[channel] = (uint16_t)clamp(upper);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Index of the first sample outside [lower, upper], or count if none
+ *****************************************************************************/
+static uint32_t quietSpan(const uint16_t *samples, uint32_t i, uint32_t count,
+                          uint32_t lower, uint32_t upper)
+{
+  uint32_t addUpper = (ADC_DETECT_MAX_VALUE - upper) * 0x00010001UL;
+  uint32_t addLower = (0x8000 - lower) * 0x00010001UL;
+  uint32_t a, b;
+
+  // Four samples per pass, in two words
+  for (; i + 4 <= count; i += 4) {
+    a = samples[i] | ((uint32_t)samples[i + 1] << 16);
+    b = samples[i + 2] | ((uint32_t)samples[i + 3] << 16);
+    if ((((a + addUpper) | ~(a + addLower)
+          | (b + addUpper) | ~(b + addLower)) & HIGH_BITS) != 0) {
+      break;
+    }
+  }
+  for (; i < count; i++) {
+    if ((samples[i] < lower) || (samples[i] > upper)) {
+      break;
+    }
+  }
+  return i;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Set up the channels, with no sample seen yet
+ *
+ * @note
+ *    Samples must not be above ADC_DETECT_MAX_VALUE
+ *****************************************************************************/
+adcDetectStatus_TypeDef adcDetectInit(adcDetect_TypeDef *detect,
+                                      const adcDetectLimits_TypeDef *limits,
+                                      uint32_t channelCount)
+{
+  uint32_t c;
+
+  if ((channelCount == 0) || (channelCount > ADC_DETECT_MAX_CHANNELS)) {
+    return adcDetectBadConfig;
+  }
+  for (c = 0; c < channelCount; c++) {
+    if ((limits[c].low > limits[c].high)
+        || (limits[c].high > ADC_DETECT_MAX_VALUE)
+        || (limits[c].hysteresis > ADC_DETECT_MAX_VALUE)
+        || (limits[c].delta > ADC_DETECT_MAX_VALUE)) {
+      return adcDetectBadConfig;
+    }
+    detect->limits[c] = limits[c];
+  }
+  detect->channelCount = channelCount;
+  adcDetectReset(detect);
+  return adcDetectOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Forget the state of the channels, e.g. after samples were lost: the
+ *    next sample of each channel is an event
+ *****************************************************************************/
+void adcDetectReset(adcDetect_TypeDef *detect)
+{
+  uint32_t c;
+
+  for (c = 0; c < detect->channelCount; c++) {
+    detect->region[c] = adcDetectUnknown;
+    detect->reference[c] = 0;
+    updateInterval(detect, c);
+  }
+  detect->samples = 0;
+  detect->events = 0;
+  detect->missed = 0;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Scan a block of samples of one channel for events
+ *
+ * @details
+ *    An event is reported when a sample enters another region, or moves by
+ *    more than delta from the sample of the last event. The first sample
+ *    after adcDetectInit() or adcDetectReset() reports its region.
+ *
+ * @return
+ *    Events written to 'events', at most maxEvents; events beyond that are
+ *    only counted in 'missed'
+ *****************************************************************************/
+uint32_t adcDetectBlock(adcDetect_TypeDef *detect, uint32_t channel,
+                        const uint16_t *samples, uint32_t count,
+                        uint32_t firstIndex, adcDetectEvent_TypeDef *events,
+                        uint32_t maxEvents)
+{
+  uint32_t found = 0;
+  uint32_t i = 0;
+  uint8_t region;
+
+  if (channel >= detect->channelCount) {
+    return 0;
+  }
+
+  while (i < count) {
+    i = quietSpan(samples, i, count, detect->lower[channel],
+                  detect->upper[channel]);
+    if (i == count) {
+      break;
+    }
+
+    region = regionOf(&detect->limits[channel], detect->region[channel],
+                      samples[i]);
+    if (found < maxEvents) {
+      events[found].index = firstIndex + i;
+      events[found].value = samples[i];
+      events[found].channel = (uint8_t)channel;
+      events[found].type = (region != detect->region[channel])
+                           ? region : adcDetectChange;
+      found++;
+    } else {
+      detect->missed++;
+    }
+    detect->events++;
+
+    detect->region[channel] = region;
+    detect->reference[channel] = samples[i];
+    updateInterval(detect, channel);
+    i++;
+  }
+  detect->samples += count;
+  return found;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Interval of samples of a channel that are not events
+ *
+ * @details
+ *    For a window comparator that flags samples outside [lower, upper].
+ *    Before the first sample, lower is above upper: every sample is an
+ *    event.
+ *****************************************************************************/
+void adcDetectWindow(const adcDetect_TypeDef *detect, uint32_t channel,
+                     uint16_t *lower, uint16_t *upper)
+{
+  *lower = detect->lower[channel];
+  *upper = detect->upper[channel];
+}
@@ -0,0 +1,379 @@
+/**************************************************************************//**
+ * @file
+ * @brief Wake the application only on ADC events: the window comparator
+ * watches a single channel, a block scan watches multi-channel frames.
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "adc_acq.h"
+#include "adc_detect.h"
+
+// Scans per frame, each scan converts every input of the table once
+#define SCANS_PER_FRAME 64
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired scan frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// Scan inputs, see README for the EXP header pin of the external input
+static const adcAcqInput_TypeDef inputs[] = {
+  { adcScanInputGroup0, adcPosSelAPORT2XCH9 },
+  { adcScanInputGroup1, adcPosSelAVDD },
+  { adcScanInputGroup1, adcPosSelDVDD },
+};
+
+#define INPUT_COUNT     (sizeof(inputs) / sizeof(inputs[0]))
+#define FRAME_LENGTH    (SCANS_PER_FRAME * INPUT_COUNT)
+
+// Limits of each scan input, in ADC codes: the external input has a
+// window, the supplies report changes
+static const adcDetectLimits_TypeDef limits[INPUT_COUNT] = {
+  { 1000, 3000, 20, 0 },
+  { 0, 4095, 0, 40 },
+  { 0, 4095, 0, 40 },
+};
+
+// The temperature sensor is converted on its own after each scan, and
+// watched by the window comparator; it reports changes of about 2 C
+static const adcDetectLimits_TypeDef tempLimits = { 0, 4095, 0, 12 };
+
+// Events kept for the debugger
+#define EVENT_LOG       16
+
+// Two frames of SCANDATAX words, and the per-channel views of one frame
+adcAcq_TypeDef acq;
+uint32_t adcFrames[ADC_ACQ_STORAGE(FRAME_LENGTH)];
+uint16_t adcViews[ADC_ACQ_VIEWS(FRAME_LENGTH, INPUT_COUNT)];
+adcAcqStatus_TypeDef acqStatus;
+
+// The scan inputs are scanned in the main loop, the temperature in the
+// ADC interrupt
+adcDetect_TypeDef detect;
+adcDetect_TypeDef tempDetect;
+
+// Values to watch in the debugger
+adcDetectEvent_TypeDef eventLog[EVENT_LOG];
+volatile uint32_t notifications;  // Application wake-ups, one per batch
+volatile uint32_t frameWakeups;   // LDMA interrupts, one per frame
+volatile uint32_t adcWakeups;     // Window comparator interrupts
+volatile uint32_t conversions;    // Results, scan and single
+volatile float wakeReduction;     // Conversions per core wake-up
+volatile uint32_t lostFrames;
+
+static uint32_t eventCount;
+
+/**************************************************************************//**
+ * @brief The application: only called with events
+ *****************************************************************************/
+static void notify(const adcDetectEvent_TypeDef *events, uint32_t count)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    eventLog[eventCount++ % EVENT_LOG] = events[i];
+  }
+  notifications++;
+}
+
+/**************************************************************************//**
+ * @brief Program the window comparator with the quiet interval of the
+ * temperature channel
+ *
+ * @details With ADGT above ADLT, SINGLECMP is set for results at or above
+ * ADGT, or at or below ADLT. Before the first result the interval is empty,
+ * and ADGT = ADLT = 0 flags every result. Results the comparator flags are
+ * checked again by the detector, so an interval starting at 0 only costs a
+ * wake-up on a result of 0.
+ *****************************************************************************/
+static void setWindow(void)
+{
+  uint16_t lower, upper;
+  uint32_t adgt = 0, adlt = 0;
+
+  adcDetectWindow(&tempDetect, 0, &lower, &upper);
+  if (lower <= upper)
+  {
+    adgt = upper + 1;
+    adlt = (lower > 0) ? lower - 1 : 0;
+  }
+  ADC0->CMPTHR = (adgt << _ADC_CMPTHR_ADGT_SHIFT)
+                 | (adlt << _ADC_CMPTHR_ADLT_SHIFT);
+}
+
+static void updateStats(void)
+{
+  uint32_t wakeups = frameWakeups + adcWakeups;
+
+  if (wakeups != 0)
+  {
+    wakeReduction = (float)conversions / wakeups;
+  }
+}
+
+/**************************************************************************//**
+ * @brief ADC Handler, a temperature result left the quiet interval
+ *****************************************************************************/
+void ADC0_IRQHandler(void)
+{
+  adcDetectEvent_TypeDef events[4];
+  uint16_t results[4];
+  uint32_t count = 0;
+  uint32_t found;
+
+  ADC_IntClear(ADC0, ADC_IntGet(ADC0));
+  adcWakeups++;
+
+  // The single FIFO holds the last results, the newest last
+  while (((ADC0->SINGLEFIFOCOUNT & _ADC_SINGLEFIFOCOUNT_SINGLEDC_MASK) != 0)
+         && (count < 4))
+  {
+    results[count++] = (uint16_t)ADC0->SINGLEDATA;
+  }
+
+  found = adcDetectBlock(&tempDetect, 0, results, count, conversions, events,
+                         4);
+  setWindow();
+  if (found != 0)
+  {
+    notify(events, found);
+  }
+  updateStats();
+}
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are scanned in the main loop
+  adcAcqIrqHandler(&acq, pending);
+}
+
+/**************************************************************************//**
+ * @brief Frame consumer, scans each channel and notifies on events only
+ *****************************************************************************/
+static void consume(const adcDemuxFrame_TypeDef *frame, void *user)
+{
+  static adcDetectEvent_TypeDef events[EVENT_LOG];
+  uint32_t c, found = 0;
+
+  (void)user;
+
+  // Samples were lost: start again from the next sample of each channel
+  if (frame->lost != 0)
+  {
+    lostFrames += frame->lost;
+    adcDetectReset(&detect);
+  }
+
+  for (c = 0; c < frame->channelCount; c++)
+  {
+    found += adcDetectBlock(&detect, c, frame->data[c], frame->count[c],
+                            frame->sequence * SCANS_PER_FRAME,
+                            &events[found], EVENT_LOG - found);
+    conversions += frame->count[c];
+  }
+
+  // And one temperature conversion per scan
+  conversions += SCANS_PER_FRAME;
+
+  frameWakeups++;
+  if (found != 0)
+  {
+    notify(events, found);
+  }
+  updateStats();
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization
+ *****************************************************************************/
+void initLdma(void)
+{
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+}
+
+/**************************************************************************//**
+ * @brief ADC initialization
+ *****************************************************************************/
+void initAdc(void)
+{
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+  adcAcqConfig_TypeDef config;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock on demand in EM2
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  ADC_Init(ADC0, &init);
+
+  // Scan the input table on each PRS pulse, one LDMA request per scan
+  config.inputs      = inputs;
+  config.inputCount  = INPUT_COUNT;
+  config.reference   = adcRef2V5;
+  config.acqTime     = adcAcqTime4;
+  config.prsSel      = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  config.channel     = LDMA_CHANNEL;
+  config.dvl         = INPUT_COUNT;
+  config.frames      = adcFrames;
+  config.frameLength = FRAME_LENGTH;
+  config.views       = adcViews;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  acqStatus = adcAcqInit(&acq, &config);
+
+  // The same PRS pulse starts a single conversion of the temperature
+  // sensor once the scan is done. Nothing reads the single FIFO until the
+  // comparator fires, so it keeps the newest results.
+  initSingle.posSel        = adcPosSelTEMP;
+  initSingle.reference     = adcRef1V25;
+  initSingle.resolution    = adcRes12Bit;
+  initSingle.acqTime       = adcAcqTime64;
+  initSingle.prsEnable     = true;
+  initSingle.prsSel        = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  initSingle.fifoOverwrite = true;
+  ADC_InitSingle(ADC0, &initSingle);
+
+  // Window compare on the single results only, the scan has the block scan
+  setWindow();
+  ADC0->SINGLECTRL |= ADC_SINGLECTRL_CMPEN;
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+
+  // The ADC interrupt wakes the core from EM2 in ASYNC mode
+  ADC_IntClear(ADC0, _ADC_IF_MASK);
+  ADC_IntEnable(ADC0, ADC_IEN_SINGLECMP);
+  NVIC_ClearPendingIRQ(ADC0_IRQn);
+  NVIC_EnableIRQ(ADC0_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CHIP_Init();
+
+  adcDetectInit(&detect, limits, INPUT_COUNT);
+  adcDetectInit(&tempDetect, &tempLimits, 1);
+
+  // Set up the LDMA, then the ADC scan and the stream of its frames
+  initLdma();
+  initAdc();
+  if (acqStatus == adcAcqOk)
+  {
+    adcAcqStart(&acq);
+  }
+
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while(1)
+  {
+    // Enter EM2 until the next frame is filled or the comparator fires
+    EMU_EnterEM2(false);
+
+    // Scan the filled frames for events
+    adcAcqProcess(&acq);
+  }
+}
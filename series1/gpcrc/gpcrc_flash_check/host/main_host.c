@@ -0,0 +1,247 @@
+/**************************************************************************//**
+ * @file
+ * @brief Flash check scheduler on a host against an in-memory flash image
+ *
+ * Build on its own, see readme.txt. The CRC engine hooks are a software
+ * CRC-32 with the GPCRC preset: feed() only records the chunk, as the LDMA
+ * would start a transfer, and the test then plays the LDMA interrupt by
+ * running the CRC over the chunk and calling flashCheckChunkDone(). The
+ * chunks must follow each other over the whole region, none larger than
+ * chunkWords, and the result must match the CRC of the image computed in
+ * one go: no reference on the first check, a match once the reference is
+ * stored, and a mismatch after a bit of the image is flipped. This is done
+ * for a few fixed cases and for random region and chunk sizes.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "flash_check.h"
+#include "host_check.h"
+
+#define IMAGE_WORDS         4096
+
+static uint32_t image[IMAGE_WORDS];
+static uint32_t seed = 1;
+
+/* State of the software CRC engine */
+static uint32_t crcValue;
+static const uint32_t *chunkSrc;
+static uint32_t chunkWords;
+static bool chunkPending;
+static const uint32_t *expectedSrc;
+static uint32_t maxChunkWords;
+
+/* Results handed to the callback */
+static uint32_t doneCount;
+static flashCheckStatus_TypeDef doneStatus;
+static uint32_t doneCrc;
+
+/* CRC-32 (IEEE 802.3 polynomial, reflected) of words, from 'crc' */
+static uint32_t crc32Words(uint32_t crc, const uint32_t *src, uint32_t words)
+{
+  uint32_t i;
+  int bit;
+
+  for ( i = 0; i < words; i++ )
+  {
+    crc ^= src[i];
+    for ( bit = 0; bit < 32; bit++ )
+    {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+    }
+  }
+  return crc;
+}
+
+static void crcReset(void)
+{
+  crcValue = 0xFFFFFFFF;
+}
+
+/* Start of a transfer: only remember the chunk, it is consumed later */
+static void crcFeed(const uint32_t *src, uint32_t words)
+{
+  CHECK(!chunkPending);
+  CHECK(src == expectedSrc);
+  CHECK((words > 0) && (words <= maxChunkWords));
+  chunkSrc = src;
+  chunkWords = words;
+  chunkPending = true;
+  expectedSrc = src + words;
+}
+
+static uint32_t crcRead(void)
+{
+  return crcValue;
+}
+
+static const flashCheckPort_TypeDef softPort =
+{
+  crcReset, crcFeed, crcRead
+};
+
+static void checkDone(flashCheckStatus_TypeDef status, uint32_t crc)
+{
+  CHECK(!flashCheckBusy());
+  doneCount++;
+  doneStatus = status;
+  doneCrc = crc;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run a check to the end, playing the LDMA interrupt for every chunk.
+ *   Returns the status handed to the callback.
+ ******************************************************************************/
+static flashCheckStatus_TypeDef runCheck(const flashCheckRegion_TypeDef *region,
+                                         const flashCheckRef_TypeDef *ref)
+{
+  uint32_t chunks = (region->words + region->chunkWords - 1)
+                    / region->chunkWords;
+  uint32_t fed = 0;
+  uint32_t count = doneCount;
+
+  expectedSrc = region->start;
+  maxChunkWords = region->chunkWords;
+  chunkPending = false;
+  CHECK(flashCheckStart(region, ref, checkDone));
+  CHECK(flashCheckBusy());
+
+  /* Nothing else may start while the check runs */
+  CHECK(!flashCheckStart(region, ref, checkDone));
+
+  while ( chunkPending )
+  {
+    fed++;
+    CHECK(flashCheckChunksLeft() == chunks - fed);
+    crcValue = crc32Words(crcValue, chunkSrc, chunkWords);
+    chunkPending = false;
+    flashCheckChunkDone();
+  }
+  CHECK(fed == chunks);
+  CHECK(expectedSrc == region->start + region->words);
+  CHECK(!flashCheckBusy());
+  CHECK(flashCheckChunksLeft() == 0);
+  CHECK(doneCount == count + 1);
+
+  /* A late interrupt after the end does nothing */
+  flashCheckChunkDone();
+  CHECK(doneCount == count + 1);
+  return doneStatus;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check a region: no reference, then a match with the reference made from
+ *   the first check, then a mismatch with a bit of the region flipped
+ ******************************************************************************/
+static void checkRegion(uint32_t offset, uint32_t words, uint32_t chunk)
+{
+  flashCheckRegion_TypeDef region = { &image[offset], words, chunk };
+  flashCheckRegion_TypeDef other = region;
+  flashCheckRef_TypeDef ref;
+  uint32_t expected = crc32Words(0xFFFFFFFF, &image[offset], words);
+  uint32_t flip, mask;
+
+  CHECK(runCheck(&region, NULL) == flashCheckNoReference);
+  CHECK(doneCrc == expected);
+
+  flashCheckRefMake(&ref, &region, doneCrc);
+  CHECK(flashCheckRefValid(&ref, &region));
+  CHECK(runCheck(&region, &ref) == flashCheckOk);
+  CHECK(doneCrc == expected);
+
+  /* The reference of another region is not used */
+  other.words = words + 1;
+  CHECK(!flashCheckRefValid(&ref, &other));
+  ref.magic = 0xFFFFFFFF;
+  CHECK(runCheck(&region, &ref) == flashCheckNoReference);
+  ref.magic = FLASH_CHECK_REF_MAGIC;
+
+  flip = offset + hostRandom(&seed) % words;
+  mask = 1UL << (hostRandom(&seed) % 32);
+  image[flip] ^= mask;
+  CHECK(runCheck(&region, &ref) == flashCheckMismatch);
+  CHECK(doneCrc != expected);
+  image[flip] ^= mask;
+}
+
+/* Regions flashCheckStart() must refuse */
+static void checkInvalid(void)
+{
+  flashCheckRegion_TypeDef region = { image, 16, 4 };
+
+  region.words = 0;
+  CHECK(!flashCheckStart(&region, NULL, checkDone));
+  region.words = 16;
+  region.chunkWords = 0;
+  CHECK(!flashCheckStart(&region, NULL, checkDone));
+  region.chunkWords = 4;
+  region.start = (const uint32_t *)((const uint8_t *)image + 2);
+  CHECK(!flashCheckStart(&region, NULL, checkDone));
+  CHECK(!flashCheckBusy());
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t trials = 1000;
+  uint32_t t, words, offset, chunk, i;
+  int option;
+
+  while ( (option = getopt(argc, argv, "n:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'n':
+        trials = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("usage: %s [-n random regions]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  for ( i = 0; i < IMAGE_WORDS; i++ )
+  {
+    image[i] = hostRandom(&seed) ^ (hostRandom(&seed) << 16);
+  }
+
+  /* Not initialized yet */
+  {
+    flashCheckRegion_TypeDef region = { image, 16, 4 };
+    CHECK(!flashCheckStart(&region, NULL, checkDone));
+  }
+  flashCheckInit(&softPort);
+  checkInvalid();
+
+  /* One chunk, whole chunks, a short last chunk, one word per chunk, and a
+     chunk larger than the region */
+  checkRegion(0, 1024, 1024);
+  checkRegion(0, IMAGE_WORDS, 1024);
+  checkRegion(3, 1000, 256);
+  checkRegion(100, 37, 1);
+  checkRegion(7, 100, 4096);
+
+  for ( t = 0; t < trials; t++ )
+  {
+    words = 1 + hostRandom(&seed) % IMAGE_WORDS;
+    offset = hostRandom(&seed) % (IMAGE_WORDS - words + 1);
+    chunk = 1 + hostRandom(&seed) % ((hostRandom(&seed) & 1) ? 64 : 2048);
+    checkRegion(offset, words, chunk);
+  }
+  printf("%u random regions\n", (unsigned)trials);
+
+  hostCheckReport();
+  return 0;
+}
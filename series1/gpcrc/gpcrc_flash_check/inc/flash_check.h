@@ -0,0 +1,79 @@
+/***************************************************************************//**
+ * @file  flash_check.h
+ * @brief Chunked flash image CRC check scheduler
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef FLASH_CHECK_H
+#define FLASH_CHECK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Marks a valid reference record ("FCK1")
+#define FLASH_CHECK_REF_MAGIC   0x46434B31UL
+
+// Result reported to the completion callback
+typedef enum {
+  flashCheckOk,           // Computed CRC matches the reference
+  flashCheckMismatch,     // Computed CRC differs from the reference
+  flashCheckNoReference   // No valid reference for this region
+} flashCheckStatus_TypeDef;
+
+// Region of flash to check. Must be word aligned.
+typedef struct {
+  const uint32_t *start;  // First word of the region
+  uint32_t words;         // Region length in words
+  uint32_t chunkWords;    // Words handed to the CRC engine per chunk
+} flashCheckRegion_TypeDef;
+
+// Reference record, e.g. stored in the USERDATA page
+typedef struct {
+  uint32_t magic;         // FLASH_CHECK_REF_MAGIC if valid
+  uint32_t start;         // Region start address
+  uint32_t words;         // Region length in words
+  uint32_t crc;           // Expected CRC of the region
+} flashCheckRef_TypeDef;
+
+// Hooks to the CRC engine. feed() starts an asynchronous transfer of
+// 'words' words into the engine and flashCheckChunkDone() must be called
+// once it has completed.
+typedef struct {
+  void     (*reset)(void);
+  void     (*feed)(const uint32_t *src, uint32_t words);
+  uint32_t (*read)(void);
+} flashCheckPort_TypeDef;
+
+typedef void (*flashCheckCallback_TypeDef)(flashCheckStatus_TypeDef status,
+                                           uint32_t crc);
+
+void flashCheckInit(const flashCheckPort_TypeDef *port);
+bool flashCheckStart(const flashCheckRegion_TypeDef *region,
+                     const flashCheckRef_TypeDef *ref,
+                     flashCheckCallback_TypeDef callback);
+void flashCheckChunkDone(void);
+bool flashCheckBusy(void);
+uint32_t flashCheckChunksLeft(void);
+bool flashCheckRefValid(const flashCheckRef_TypeDef *ref,
+                        const flashCheckRegion_TypeDef *region);
+void flashCheckRefMake(flashCheckRef_TypeDef *ref,
+                       const flashCheckRegion_TypeDef *region,
+                       uint32_t crc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLASH_CHECK_H
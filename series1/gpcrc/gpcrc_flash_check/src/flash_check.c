@@ -0,0 +1,180 @@
+/***************************************************************************//**
+ * @file flash_check.c
+ * @brief Chunked flash image CRC check scheduler. The region is handed to
+ * the CRC engine one chunk at a time so that the core can sleep while the
+ * transfer runs. This file has no device dependencies.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "flash_check.h"
+
+// CRC engine hooks
+static const flashCheckPort_TypeDef *checkPort;
+
+// State of the check in progress
+static const uint32_t *nextChunk;
+static uint32_t wordsLeft;
+static uint32_t chunkWords;
+static uint32_t expectedCrc;
+static bool haveReference;
+static flashCheckCallback_TypeDef doneCallback;
+static volatile bool checkBusy;
+
+/**************************************************************************//**
+ * @brief
+ *    Hand the next chunk of the region to the CRC engine
+ *****************************************************************************/
+static void feedNextChunk(void)
+{
+  uint32_t words = (wordsLeft < chunkWords) ? wordsLeft : chunkWords;
+  const uint32_t *src = nextChunk;
+
+  nextChunk += words;
+  wordsLeft -= words;
+  checkPort->feed(src, words);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Set up the CRC engine hooks used by all following checks
+ *****************************************************************************/
+void flashCheckInit(const flashCheckPort_TypeDef *port)
+{
+  checkPort = port;
+  checkBusy = false;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start checking a region of flash
+ *
+ * @param[in] region
+ *    Region to check. Start must be word aligned and chunkWords non-zero.
+ *
+ * @param[in] ref
+ *    Reference record for the region, or NULL if there is none
+ *
+ * @param[in] callback
+ *    Called with the result once the last chunk has been processed
+ *
+ * @return
+ *    false if a check is already running or the region is invalid
+ *****************************************************************************/
+bool flashCheckStart(const flashCheckRegion_TypeDef *region,
+                     const flashCheckRef_TypeDef *ref,
+                     flashCheckCallback_TypeDef callback)
+{
+  if (checkBusy || (checkPort == NULL)) {
+    return false;
+  }
+  if ((region->words == 0) || (region->chunkWords == 0)
+      || (((uintptr_t)region->start & 0x3) != 0)) {
+    return false;
+  }
+
+  // Latch the reference now so that it may live in the page being updated
+  haveReference = flashCheckRefValid(ref, region);
+  expectedCrc = haveReference ? ref->crc : 0;
+
+  nextChunk = region->start;
+  wordsLeft = region->words;
+  chunkWords = region->chunkWords;
+  doneCallback = callback;
+  checkBusy = true;
+
+  checkPort->reset();
+  feedNextChunk();
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Notify the scheduler that the last chunk fed to the engine is done.
+ *    Called from the DMA completion interrupt.
+ *****************************************************************************/
+void flashCheckChunkDone(void)
+{
+  uint32_t crc;
+  flashCheckStatus_TypeDef status;
+
+  if (!checkBusy) {
+    return;
+  }
+
+  if (wordsLeft > 0) {
+    feedNextChunk();
+    return;
+  }
+
+  crc = checkPort->read();
+  if (!haveReference) {
+    status = flashCheckNoReference;
+  } else if (crc == expectedCrc) {
+    status = flashCheckOk;
+  } else {
+    status = flashCheckMismatch;
+  }
+
+  checkBusy = false;
+  if (doneCallback != NULL) {
+    doneCallback(status, crc);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Returns true while a check is in progress
+ *****************************************************************************/
+bool flashCheckBusy(void)
+{
+  return checkBusy;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Number of chunks still to be fed for the check in progress
+ *****************************************************************************/
+uint32_t flashCheckChunksLeft(void)
+{
+  if (!checkBusy) {
+    return 0;
+  }
+  return (wordsLeft + chunkWords - 1) / chunkWords;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Returns true if the reference record is valid for the given region
+ *****************************************************************************/
+bool flashCheckRefValid(const flashCheckRef_TypeDef *ref,
+                        const flashCheckRegion_TypeDef *region)
+{
+  return (ref != NULL)
+         && (ref->magic == FLASH_CHECK_REF_MAGIC)
+         && (ref->start == (uint32_t)(uintptr_t)region->start)
+         && (ref->words == region->words);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Fill in a reference record for a region from a computed CRC
+ *****************************************************************************/
+void flashCheckRefMake(flashCheckRef_TypeDef *ref,
+                       const flashCheckRegion_TypeDef *region,
+                       uint32_t crc)
+{
+  ref->magic = FLASH_CHECK_REF_MAGIC;
+  ref->start = (uint32_t)(uintptr_t)region->start;
+  ref->words = region->words;
+  ref->crc = crc;
+}
@@ -0,0 +1,292 @@
+/**************************************************************************//**
+ * @file
+ * @brief Check the flash image with the GPCRC fed by the LDMA in EM1
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silicon Labs Software License Agreement. See
+ * "http://developer.silabs.com/legal/version/v11/Silicon_Labs_Software_License_Agreement.txt"
+ * for details. Before using this software for any purpose, you must agree to the
+ * terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_core.h"
+#include "em_gpcrc.h"
+#include "em_ldma.h"
+#include "em_msc.h"
+#include "em_cryotimer.h"
+#include "flash_check.h"
+
+#define USERDATA ((uint32_t*)USERDATA_BASE)
+
+// Note: change this to the size of the application image to check
+#define CHECK_SIZE          (32 * 1024)
+
+// Words fed to the GPCRC per LDMA transfer (at most LDMA_DESCRIPTOR_MAX_XFER_SIZE)
+#define CHUNK_WORDS         1024
+
+// Word offset of the reference record in the USERDATA page
+#define REF_OFFSET          0
+
+// Preset of the GPCRC
+#define PRESET              0xFFFFFFFF
+
+// DMA channel used
+#define LDMA_CHANNEL        0
+#define LDMA_CH_MASK        (1 << LDMA_CHANNEL)
+
+// Note: the check is repeated every CRYOTIMER period (about 8 s with the ULFRCO)
+#define CRYOTIMER_PERIOD    cryotimerPeriod_8k
+
+// Descriptor for the chunk being fed to the GPCRC
+LDMA_Descriptor_t desc;
+
+// Region covered by the check
+const flashCheckRegion_TypeDef region = {
+  (const uint32_t *)FLASH_BASE,
+  CHECK_SIZE / 4,
+  CHUNK_WORDS
+};
+
+// Results of the last check, watch these in the debugger
+volatile flashCheckStatus_TypeDef lastStatus;
+volatile uint32_t lastCrc;
+volatile uint32_t checkCount;
+volatile uint32_t failCount;
+
+// Set by the CRYOTIMER to request a new check
+volatile bool checkRequested;
+
+// Set when a check found no reference, the main loop then stores storeCrc
+volatile bool storeRequested;
+volatile uint32_t storeCrc;
+
+/***************************************************************************//**
+ * @brief
+ *   Reset the GPCRC to its preset value
+ ******************************************************************************/
+static void crcReset(void)
+{
+  GPCRC_Start(GPCRC);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Start an LDMA transfer of a chunk of flash into GPCRC_INPUTDATA
+ ******************************************************************************/
+static void crcFeed(const uint32_t *src, uint32_t words)
+{
+  LDMA_TransferCfg_t transferConfig = LDMA_TRANSFER_CFG_MEMORY();
+
+  desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2M_WORD(src, &(GPCRC->INPUTDATA), words);
+
+  // Keep writing to the same GPCRC register
+  desc.xfer.dstInc = ldmaCtrlDstIncNone;
+
+  // Arbitrate every 16 words so that other channels are not held off
+  desc.xfer.blockSize = ldmaCtrlBlockSizeUnit16;
+
+  LDMA_StartTransfer(LDMA_CHANNEL, &transferConfig, &desc);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read the result of the GPCRC
+ ******************************************************************************/
+static uint32_t crcRead(void)
+{
+  return GPCRC_DataRead(GPCRC);
+}
+
+const flashCheckPort_TypeDef gpcrcPort = {
+  crcReset,
+  crcFeed,
+  crcRead
+};
+
+/***************************************************************************//**
+ * @brief
+ *   Store a new reference record in the USERDATA page
+ ******************************************************************************/
+static void storeReference(uint32_t crc)
+{
+  flashCheckRef_TypeDef ref;
+
+  flashCheckRefMake(&ref, &region, crc);
+
+  MSC_Init();
+  MSC_ErasePage(USERDATA);
+  MSC_WriteWord(USERDATA + REF_OFFSET, &ref, sizeof(ref));
+  MSC_Deinit();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Called by the check scheduler once the whole region has been processed.
+ *   This runs in the LDMA interrupt, so the reference is not written here:
+ *   erasing and writing the USERDATA page would stall the interrupt for the
+ *   whole page erase.
+ ******************************************************************************/
+static void checkDone(flashCheckStatus_TypeDef status, uint32_t crc)
+{
+  lastStatus = status;
+  lastCrc = crc;
+  checkCount++;
+
+  if (status == flashCheckMismatch) {
+    failCount++;
+  } else if (status == flashCheckNoReference) {
+    // First boot after programming, the main loop records the image CRC
+    storeCrc = crc;
+    storeRequested = true;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler.
+ ******************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read interrupt source
+  pending = LDMA_IntGet();
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR) {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Clear interrupts
+  LDMA_IntClear(pending);
+
+  // Feed the next chunk or finish the check
+  if (pending & LDMA_CH_MASK) {
+    flashCheckChunkDone();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Cryotimer interrupt service routine
+ *****************************************************************************/
+void CRYOTIMER_IRQHandler(void)
+{
+  // Acknowledge the interrupt
+  uint32_t flags = CRYOTIMER_IntGet();
+  CRYOTIMER_IntClear(flags);
+
+  checkRequested = true;
+
+  // Put a barrier here to ensure interrupts are not retriggered
+  __DSB();
+}
+
+/**************************************************************************//**
+ * @brief  GPCRC Initializer
+ *****************************************************************************/
+void initGpcrc(void)
+{
+  // Enable clocks required
+  CMU_ClockEnable(cmuClock_GPCRC, true);
+
+  // Declare init structs
+  GPCRC_Init_TypeDef init = GPCRC_INIT_DEFAULT;
+
+  // Starting value in GPCRC_DATA
+  init.initValue = PRESET;
+
+  // The running CRC must be kept across chunks, so no auto init on read
+  init.autoInit = false;
+
+  // Initialize GPCRC
+  GPCRC_Init(GPCRC, &init);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the LDMA controller
+ ******************************************************************************/
+void initLdma(void)
+{
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init(&init);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Initialize the CRYOTIMER to request periodic checks
+ *****************************************************************************/
+void initCryotimer(void)
+{
+  // Enable cryotimer clock
+  CMU_ClockEnable(cmuClock_CRYOTIMER, true);
+
+  // Initialize cryotimer
+  CRYOTIMER_Init_TypeDef init = CRYOTIMER_INIT_DEFAULT;
+  init.osc    = cryotimerOscULFRCO;
+  init.presc  = cryotimerPresc_1;
+  init.period = CRYOTIMER_PERIOD;
+  CRYOTIMER_Init(&init);
+
+  // Enable Cryotimer interrupts
+  CRYOTIMER_IntEnable(CRYOTIMER_IF_PERIOD);
+  NVIC_EnableIRQ(CRYOTIMER_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CHIP_Init();
+
+  // Initialize GPCRC and LDMA
+  initGpcrc();
+  initLdma();
+
+  // Hand the GPCRC/LDMA hooks to the check scheduler
+  flashCheckInit(&gpcrcPort);
+
+  // Check the image once at boot against the stored reference
+  checkRequested = true;
+
+  // Repeat the check periodically
+  initCryotimer();
+
+  // Infinite loop
+  while(1) {
+    if (storeRequested) {
+      storeRequested = false;
+      storeReference(storeCrc);
+    }
+
+    if (checkRequested && !flashCheckBusy()) {
+      checkRequested = false;
+      flashCheckStart(&region, (const flashCheckRef_TypeDef *)(USERDATA + REF_OFFSET), checkDone);
+    }
+
+    // Sleep only if no interrupt has asked for work since the checks above.
+    // An interrupt that comes in between stays pending and wakes the core
+    // from EM1, it is then taken when interrupts are enabled again. The
+    // LDMA and GPCRC keep running in EM1.
+    CORE_ENTER_ATOMIC();
+    if (!storeRequested && !(checkRequested && !flashCheckBusy())) {
+      EMU_EnterEM1();
+    }
+    CORE_EXIT_ATOMIC();
+  }
+}
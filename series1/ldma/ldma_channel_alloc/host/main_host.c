@@ -0,0 +1,195 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA channel allocator on the host
+ *
+ * Build with the models and the runner of ../../ldma_host_model, see
+ * readme.txt. The allocator is checked on its own first: class ranges,
+ * running out of channels, borrowing from lower classes, freeing and the
+ * counters. Then one channel of each class starts a copy at the same time
+ * on the LDMA model, and the copies must end in priority order.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "ldma_alloc.h"
+#include "host_check.h"
+
+#define BUFFER_SIZE         1024
+
+uint32_t srcBuffer[ldmaAllocClassCount][BUFFER_SIZE];
+uint32_t dstBuffer[ldmaAllocClassCount][BUFFER_SIZE];
+
+/* The LDMA model reads descriptors from the data sections only */
+LDMA_Descriptor_t desc[ldmaAllocClassCount];
+
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  CHECK(!(pending & LDMA_IF_ERROR));
+  ldmaAllocIrqHandler(pending);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The allocator alone, 2 high, 3 normal and the rest bulk channels
+ ******************************************************************************/
+static void checkAllocator(void)
+{
+  ldmaAllocConfig_TypeDef config = { 2, 3 };
+  ldmaAllocConfig_TypeDef tooMany = { LDMA_ALLOC_CHANNELS, 1 };
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  ldmaAllocStats_TypeDef stats;
+  int bulk = LDMA_ALLOC_CHANNELS - 5;
+
+  CHECK(ldmaAllocInit(&tooMany, &init) == ldmaAllocBadConfig);
+  CHECK(ldmaAllocInit(&config, &init) == ldmaAllocOk);
+  CHECK(init.ldmaInitCtrlNumFixed == 5);
+
+  /* Not a class, while every channel is free */
+  CHECK(ldmaAllocChannel(ldmaAllocClassCount, true) == -1);
+  CHECK(ldmaAllocChannel((ldmaAllocClass_TypeDef)100, false) == -1);
+  CHECK(ldmaAllocUsed() == 0);
+
+  CHECK(ldmaAllocChannel(ldmaAllocClassHigh, false) == 0);
+  CHECK(ldmaAllocChannel(ldmaAllocClassHigh, false) == 1);
+  CHECK(ldmaAllocChannel(ldmaAllocClassHigh, false) == -1);
+  CHECK(ldmaAllocChannel(ldmaAllocClassHigh, true) == 2);
+  CHECK(ldmaAllocChannel(ldmaAllocClassNormal, false) == 3);
+  CHECK(ldmaAllocChannel(ldmaAllocClassNormal, false) == 4);
+  CHECK(ldmaAllocChannel(ldmaAllocClassNormal, false) == -1);
+  for (int i = 0; i < bulk; i++)
+  {
+    CHECK(ldmaAllocChannel(ldmaAllocClassBulk, false) == 5 + i);
+  }
+  CHECK(ldmaAllocChannel(ldmaAllocClassBulk, true) == -1);
+  CHECK(ldmaAllocUsed() == (1UL << LDMA_ALLOC_CHANNELS) - 1);
+
+  /* A freed high channel is not handed to a lower class */
+  CHECK(ldmaAllocFree(1) == ldmaAllocOk);
+  CHECK(ldmaAllocFree(1) == ldmaAllocBadChannel);
+  CHECK(ldmaAllocFree(LDMA_ALLOC_CHANNELS) == ldmaAllocBadChannel);
+  CHECK(ldmaAllocChannel(ldmaAllocClassNormal, true) == -1);
+  CHECK(ldmaAllocChannel(ldmaAllocClassHigh, false) == 1);
+
+  CHECK(ldmaAllocClassOf(0) == ldmaAllocClassHigh);
+  CHECK(ldmaAllocClassOf(1) == ldmaAllocClassHigh);
+  CHECK(ldmaAllocClassOf(2) == ldmaAllocClassNormal);
+  CHECK(ldmaAllocClassOf(4) == ldmaAllocClassNormal);
+  CHECK(ldmaAllocClassOf(5) == ldmaAllocClassBulk);
+  CHECK(ldmaAllocClassOf(-1) == ldmaAllocClassCount);
+  CHECK(ldmaAllocClassOf(LDMA_ALLOC_CHANNELS) == ldmaAllocClassCount);
+
+  /* Counters only count allocated channels */
+  CHECK(ldmaAllocFree(3) == ldmaAllocOk);
+  ldmaAllocSample(0x9);
+  ldmaAllocSample(0x1);
+  ldmaAllocSample(0x0);
+  ldmaAllocSample(0x1);
+  ldmaAllocIrqHandler(0x80000009);
+  ldmaAllocGetStats(0, &stats);
+  CHECK((stats.allocations == 1) && (stats.busySamples == 3) && (stats.doneCount == 1));
+  ldmaAllocGetStats(1, &stats);
+  CHECK(stats.allocations == 2);
+  ldmaAllocGetStats(3, &stats);
+  CHECK((stats.busySamples == 0) && (stats.doneCount == 0));
+  CHECK(ldmaAllocUtilisation(0) == 75);
+  CHECK(ldmaAllocUtilisation(3) == 0);
+
+  /* No such channel */
+  memset(&stats, 0xFF, sizeof(stats));
+  ldmaAllocGetStats(LDMA_ALLOC_CHANNELS, &stats);
+  CHECK((stats.allocations == 0) && (stats.busySamples == 0) && (stats.doneCount == 0));
+  ldmaAllocGetStats(-1, &stats);
+  CHECK(stats.allocations == 0);
+  CHECK(ldmaAllocUtilisation(LDMA_ALLOC_CHANNELS) == 0);
+  CHECK(ldmaAllocUtilisation(-1) == 0);
+
+  /* No fixed channels: every class is round robin */
+  config.highChannels = 0;
+  config.normalChannels = 0;
+  CHECK(ldmaAllocInit(&config, &init) == ldmaAllocOk);
+  CHECK(init.ldmaInitCtrlNumFixed == 0);
+  CHECK(ldmaAllocChannel(ldmaAllocClassHigh, false) == -1);
+  CHECK(ldmaAllocChannel(ldmaAllocClassHigh, true) == 0);
+  CHECK(ldmaAllocClassOf(0) == ldmaAllocClassBulk);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   One copy per class, started together, bulk taken first: the high copy
+ *   ends first and the bulk one last
+ ******************************************************************************/
+static void checkPriority(void)
+{
+  ldmaAllocConfig_TypeDef config = { 1, 1 };
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_TransferCfg_t cfg = LDMA_TRANSFER_CFG_MEMORY();
+  dmaModelStats_TypeDef stats;
+  ldmaAllocStats_TypeDef allocStats;
+  int ch[ldmaAllocClassCount];
+
+  CHECK(ldmaAllocInit(&config, &init) == ldmaAllocOk);
+  LDMA_Init( &init );
+
+  for (int cls = ldmaAllocClassBulk; cls >= ldmaAllocClassHigh; cls--)
+  {
+    ch[cls] = ldmaAllocChannel((ldmaAllocClass_TypeDef)cls, false);
+    desc[cls] = (LDMA_Descriptor_t)
+      LDMA_DESCRIPTOR_SINGLE_M2M_WORD(srcBuffer[cls], dstBuffer[cls], BUFFER_SIZE);
+    desc[cls].xfer.blockSize = ldmaCtrlBlockSizeUnit4;
+  }
+
+  /* Enable all, then request all at once */
+  for (int cls = ldmaAllocClassHigh; cls < ldmaAllocClassCount; cls++)
+  {
+    LDMA_StartTransfer(ch[cls], &cfg, &desc[cls]);
+  }
+  while ( LDMA_TransferDone(ch[ldmaAllocClassBulk]) == false )
+  {
+    EMU_EnterEM1();
+  }
+
+  ldmaModelGetStats(&stats);
+  printf("high ch%d done at %llu, normal ch%d at %llu, bulk ch%d at %llu\n",
+         ch[0], (unsigned long long)stats.doneCycle[ch[0]],
+         ch[1], (unsigned long long)stats.doneCycle[ch[1]],
+         ch[2], (unsigned long long)stats.doneCycle[ch[2]]);
+  CHECK(stats.doneCycle[ch[0]] < stats.doneCycle[ch[1]]);
+  CHECK(stats.doneCycle[ch[1]] < stats.doneCycle[ch[2]]);
+  for (int cls = ldmaAllocClassHigh; cls < ldmaAllocClassCount; cls++)
+  {
+    ldmaAllocGetStats(ch[cls], &allocStats);
+    CHECK(allocStats.doneCount == 1);
+    CHECK(ldmaAllocFree(ch[cls]) == ldmaAllocOk);
+  }
+}
+
+int main(void)
+{
+  CHIP_Init();
+
+  checkAllocator();
+  checkPriority();
+
+  hostCheckReport();
+  return 0;
+}
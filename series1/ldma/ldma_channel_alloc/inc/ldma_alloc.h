@@ -0,0 +1,75 @@
+/***************************************************************************//**
+ * @file  ldma_alloc.h
+ * @brief LDMA channel allocator by priority class, with utilisation counters
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef LDMA_ALLOC_H
+#define LDMA_ALLOC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_device.h"
+#include "em_ldma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LDMA_ALLOC_CHANNELS   DMA_CHAN_COUNT
+
+// Classes from the highest priority. High and normal channels have fixed
+// priorities, high ones above normal ones; bulk channels share the rest of
+// the bandwidth round robin.
+typedef enum {
+  ldmaAllocClassHigh,
+  ldmaAllocClassNormal,
+  ldmaAllocClassBulk,
+  ldmaAllocClassCount
+} ldmaAllocClass_TypeDef;
+
+typedef enum {
+  ldmaAllocOk,
+  ldmaAllocBadConfig,     // More fixed channels than the LDMA has
+  ldmaAllocBadChannel     // Channel not allocated
+} ldmaAllocStatus_TypeDef;
+
+// Channels 0 to highChannels - 1 are high, the next normalChannels are
+// normal, and the others are bulk
+typedef struct {
+  uint8_t highChannels;
+  uint8_t normalChannels;
+} ldmaAllocConfig_TypeDef;
+
+typedef struct {
+  uint32_t allocations;     // Times the channel was handed out
+  uint32_t doneCount;       // Done interrupts seen by ldmaAllocIrqHandler()
+  uint32_t busySamples;     // Samples of ldmaAllocSample() it was busy in
+} ldmaAllocStats_TypeDef;
+
+ldmaAllocStatus_TypeDef ldmaAllocInit(const ldmaAllocConfig_TypeDef *config,
+                                      LDMA_Init_t *init);
+int ldmaAllocChannel(ldmaAllocClass_TypeDef cls, bool allowLower);
+ldmaAllocStatus_TypeDef ldmaAllocFree(int ch);
+ldmaAllocClass_TypeDef ldmaAllocClassOf(int ch);
+uint32_t ldmaAllocUsed(void);
+
+void ldmaAllocIrqHandler(uint32_t pending);
+void ldmaAllocSample(uint32_t busy);
+void ldmaAllocGetStats(int ch, ldmaAllocStats_TypeDef *stats);
+uint32_t ldmaAllocUtilisation(int ch);
+void ldmaAllocClearStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LDMA_ALLOC_H
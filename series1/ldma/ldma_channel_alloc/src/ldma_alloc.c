@@ -0,0 +1,218 @@
+/***************************************************************************//**
+ * @file ldma_alloc.c
+ * @brief LDMA channel allocator by priority class, with utilisation counters.
+ *
+ * The LDMA serves channels below NUMFIXED in fixed priority, the lowest
+ * number first, and the others round robin when no fixed channel is
+ * ready. The allocator splits the channels in three ranges, so that a
+ * channel of a class always wins over channels of lower classes:
+ *
+ *   0 .. high-1                  high, fixed priority
+ *   high .. high+normal-1        normal, fixed priority
+ *   high+normal .. count-1       bulk, round robin
+ *
+ * and sets NUMFIXED of the LDMA_Init_t to high + normal. Within a class
+ * the lowest free channel is handed out.
+ *
+ * The counters are fed from outside: ldmaAllocIrqHandler() with the
+ * interrupt flags, and ldmaAllocSample() with LDMA->CHBUSY from a periodic
+ * interrupt, so the allocator does not touch the LDMA and can be tested on
+ * a host.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "em_core.h"
+#include "ldma_alloc.h"
+
+// First channel of each class, and the end of the last one
+static uint32_t first[ldmaAllocClassCount + 1];
+static uint32_t used;
+static uint32_t samples;
+static ldmaAllocStats_TypeDef stats[LDMA_ALLOC_CHANNELS];
+
+static bool channelValid(int ch)
+{
+  return (ch >= 0) && (ch < LDMA_ALLOC_CHANNELS);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Split the channels in classes, and set the number of fixed priority
+ *    channels of 'init', to be passed to LDMA_Init()
+ *
+ * @note
+ *    Frees all channels and clears the counters
+ *****************************************************************************/
+ldmaAllocStatus_TypeDef ldmaAllocInit(const ldmaAllocConfig_TypeDef *config,
+                                      LDMA_Init_t *init)
+{
+  uint32_t fixed = (uint32_t)config->highChannels + config->normalChannels;
+
+  if (fixed > LDMA_ALLOC_CHANNELS) {
+    return ldmaAllocBadConfig;
+  }
+
+  first[ldmaAllocClassHigh] = 0;
+  first[ldmaAllocClassNormal] = config->highChannels;
+  first[ldmaAllocClassBulk] = fixed;
+  first[ldmaAllocClassCount] = LDMA_ALLOC_CHANNELS;
+  used = 0;
+  ldmaAllocClearStats();
+
+  init->ldmaInitCtrlNumFixed = (uint8_t)fixed;
+  return ldmaAllocOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Take the lowest free channel of class 'cls'
+ *
+ * @param[in] allowLower
+ *    If the class has no free channel, take one of a lower class rather
+ *    than fail. A higher class is never used, so that a request does not
+ *    delay the channels of more urgent ones.
+ *
+ * @return
+ *    The channel, or -1 if none is free or 'cls' is not a class
+ *****************************************************************************/
+int ldmaAllocChannel(ldmaAllocClass_TypeDef cls, bool allowLower)
+{
+  uint32_t last;
+  int ch = -1;
+
+  if ((uint32_t)cls >= ldmaAllocClassCount) {
+    return -1;
+  }
+  last = allowLower ? ldmaAllocClassCount : (uint32_t)cls + 1;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  for (uint32_t i = first[cls]; (i < first[last]) && (ch < 0); i++) {
+    if (!(used & (1UL << i))) {
+      used |= 1UL << i;
+      stats[i].allocations++;
+      ch = (int)i;
+    }
+  }
+  CORE_EXIT_ATOMIC();
+  return ch;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Give channel 'ch' back, once its transfers are stopped
+ *****************************************************************************/
+ldmaAllocStatus_TypeDef ldmaAllocFree(int ch)
+{
+  ldmaAllocStatus_TypeDef status = ldmaAllocBadChannel;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (channelValid(ch) && (used & (1UL << ch))) {
+    used &= ~(1UL << ch);
+    status = ldmaAllocOk;
+  }
+  CORE_EXIT_ATOMIC();
+  return status;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Class of channel 'ch', ldmaAllocClassCount if there is no such channel
+ *****************************************************************************/
+ldmaAllocClass_TypeDef ldmaAllocClassOf(int ch)
+{
+  uint32_t cls = ldmaAllocClassHigh;
+
+  if (!channelValid(ch)) {
+    return ldmaAllocClassCount;
+  }
+
+  while ((cls < ldmaAllocClassBulk) && ((uint32_t)ch >= first[cls + 1])) {
+    cls++;
+  }
+  return (ldmaAllocClass_TypeDef)cls;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Mask of the allocated channels
+ *****************************************************************************/
+uint32_t ldmaAllocUsed(void)
+{
+  return used;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Call from LDMA_IRQHandler() with the pending interrupt flags, counts
+ *    the done interrupts of the allocated channels
+ *****************************************************************************/
+void ldmaAllocIrqHandler(uint32_t pending)
+{
+  pending &= used;
+  for (uint32_t ch = 0; pending != 0; ch++, pending >>= 1) {
+    if (pending & 1) {
+      stats[ch].doneCount++;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Count one sample of the busy channels, e.g. LDMA->CHBUSY read from a
+ *    periodic interrupt
+ *****************************************************************************/
+void ldmaAllocSample(uint32_t busy)
+{
+  samples++;
+  busy &= used;
+  for (uint32_t ch = 0; busy != 0; ch++, busy >>= 1) {
+    if (busy & 1) {
+      stats[ch].busySamples++;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Counters of channel 'ch', all 0 if there is no such channel
+ *****************************************************************************/
+void ldmaAllocGetStats(int ch, ldmaAllocStats_TypeDef *channelStats)
+{
+  if (!channelValid(ch)) {
+    memset(channelStats, 0, sizeof(*channelStats));
+    return;
+  }
+  *channelStats = stats[ch];
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Percentage of the samples channel 'ch' was busy in, 0 if there is no
+ *    such channel
+ *****************************************************************************/
+uint32_t ldmaAllocUtilisation(int ch)
+{
+  if (!channelValid(ch) || (samples == 0)) {
+    return 0;
+  }
+  return (uint32_t)(((uint64_t)stats[ch].busySamples * 100) / samples);
+}
+
+void ldmaAllocClearStats(void)
+{
+  memset(stats, 0, sizeof(stats));
+  samples = 0;
+}
@@ -0,0 +1,121 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Channel Allocator Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_alloc.h"
+
+/* One high and one normal priority channel, the others are bulk */
+#define HIGH_CHANNELS       1
+#define NORMAL_CHANNELS     1
+
+/* Words copied by each class */
+#define BUFFER_SIZE         1024
+
+uint32_t srcBuffer[ldmaAllocClassCount][BUFFER_SIZE];
+uint32_t dstBuffer[ldmaAllocClassCount][BUFFER_SIZE];
+LDMA_Descriptor_t desc[ldmaAllocClassCount];
+
+/* Values to watch in the debugger */
+int channel[ldmaAllocClassCount];
+int doneOrder[ldmaAllocClassCount];
+volatile uint32_t doneCount;
+uint32_t utilisation[ldmaAllocClassCount];
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler.
+ ******************************************************************************/
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+  int cls;
+
+  /* Read interrupt source */
+  pending = LDMA_IntGet();
+
+  /* Clear interrupts */
+  LDMA_IntClear(pending);
+
+  /* Check for LDMA error */
+  if ( pending & LDMA_IF_ERROR )
+  {
+    /* Loop here to enable the debugger to see what has happened */
+    while (1);
+  }
+
+  ldmaAllocIrqHandler(pending);
+
+  /* Record which class finished first */
+  for (cls = 0; cls < ldmaAllocClassCount; cls++)
+  {
+    if ( (pending & (1 << channel[cls])) && (doneCount < ldmaAllocClassCount) )
+    {
+      doneOrder[doneCount++] = cls;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  ldmaAllocConfig_TypeDef config = { HIGH_CHANNELS, NORMAL_CHANNELS };
+  LDMA_TransferCfg_t transfer = LDMA_TRANSFER_CFG_MEMORY();
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  int cls;
+
+  /* Chip errata */
+  CHIP_Init();
+
+  /* The allocator sets the number of fixed priority channels */
+  ldmaAllocInit(&config, &init);
+  LDMA_Init( &init );
+
+  /* Take the channels from the lowest class up, the class still decides */
+  for (cls = ldmaAllocClassBulk; cls >= ldmaAllocClassHigh; cls--)
+  {
+    channel[cls] = ldmaAllocChannel((ldmaAllocClass_TypeDef)cls, false);
+    desc[cls] = (LDMA_Descriptor_t)
+      LDMA_DESCRIPTOR_SINGLE_M2M_WORD(srcBuffer[cls], dstBuffer[cls], BUFFER_SIZE);
+    desc[cls].xfer.blockSize = ldmaCtrlBlockSizeUnit4;
+  }
+
+  /* Start the three copies together */
+  for (cls = ldmaAllocClassHigh; cls < ldmaAllocClassCount; cls++)
+  {
+    LDMA_StartTransfer(channel[cls], &transfer, &desc[cls]);
+  }
+
+  /* Sample the busy channels until all copies are done */
+  while ( doneCount < ldmaAllocClassCount )
+  {
+    ldmaAllocSample(LDMA->CHBUSY);
+  }
+  for (cls = ldmaAllocClassHigh; cls < ldmaAllocClassCount; cls++)
+  {
+    utilisation[cls] = ldmaAllocUtilisation(channel[cls]);
+    ldmaAllocFree(channel[cls]);
+  }
+
+  while (1)
+  {
+    EMU_EnterEM1();
+  }
+}
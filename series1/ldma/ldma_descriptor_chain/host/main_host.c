@@ -0,0 +1,443 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Descriptor Chain on the host LDMA model
+ *
+ * Build with the models and the runner of ../../ldma_host_model, see
+ * readme.txt. First checks the pool: first fit, fragmentation after chains
+ * are deleted, and the free count. Then the link fields the builder writes
+ * for appends, counted and endless loops and the end of a chain, and every
+ * error it returns. Last, the two chains of the example are built the same
+ * way and started three times, and after each run the destinations, the
+ * number of writes the model made and the done interrupts are checked.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "ldma_chain.h"
+#include "host_check.h"
+
+/* Same channels, buffers and chains as src/main.c */
+#define LOOP_CHANNEL        0
+#define LIST_CHANNEL        1
+#define BUFFER_SIZE         4
+#define NUM_ITERATIONS      4
+#define NUM_RUNS            3
+#define LIST_SIZE           4
+
+/* Words per descriptor, the unit of the relative link address */
+#define DESC_WORDS          (sizeof(LDMA_Descriptor_t) / 4)
+
+ldmaChain_TypeDef loopChain;
+ldmaChain_TypeDef listChain;
+
+uint8_t dstBuffer[BUFFER_SIZE];
+uint8_t srcA[BUFFER_SIZE] = "AAaa";
+uint8_t srcB[BUFFER_SIZE] = "BBbb";
+uint8_t srcC[BUFFER_SIZE] = "CCcc";
+
+uint16_t srcList[LIST_SIZE][BUFFER_SIZE];
+uint16_t dstList[LIST_SIZE][BUFFER_SIZE];
+
+/* Words the descriptors of the checks point at */
+uint32_t words[4];
+
+volatile uint32_t loopRuns;
+volatile uint32_t listRuns;
+
+/* Set once every check has run */
+bool finished;
+
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  CHECK(!(pending & LDMA_IF_ERROR));
+  if ( pending & (1 << LOOP_CHANNEL) )
+  {
+    loopRuns++;
+  }
+  if ( pending & (1 << LIST_CHANNEL) )
+  {
+    listRuns++;
+  }
+}
+
+/* Appends a word copy of words[0] to words[1] */
+static ldmaChainStatus_TypeDef appendWord(ldmaChain_TypeDef *chain)
+{
+  LDMA_Descriptor_t desc = LDMA_DESCRIPTOR_SINGLE_M2M_WORD(&words[0], &words[1], 1);
+
+  return ldmaChainAppend(chain, &desc);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Blocks are taken first fit, and a request larger than every hole fails
+ *   even when enough descriptors are free in all
+ ******************************************************************************/
+static void checkPool(void)
+{
+  ldmaChain_TypeDef a, b, c, d, e, f, g;
+  LDMA_Descriptor_t *base;
+
+  ldmaChainPoolInit();
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE);
+
+  CHECK(ldmaChainCreate(&a, 0) == ldmaChainNoMemory);
+  CHECK(ldmaChainCreate(&a, LDMA_CHAIN_POOL_SIZE + 1) == ldmaChainNoMemory);
+  CHECK((a.desc == NULL) && (a.capacity == 0));
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE);
+
+  /* a, b and c side by side from the start of the pool */
+  CHECK(ldmaChainCreate(&a, 8) == ldmaChainOk);
+  base = a.desc;
+  CHECK(ldmaChainCreate(&b, 8) == ldmaChainOk);
+  CHECK(ldmaChainCreate(&c, 8) == ldmaChainOk);
+  CHECK((a.capacity == 8) && (a.count == 0) && (a.loopEnd == -1) && !a.closed);
+  CHECK((b.desc == base + 8) && (c.desc == base + 16));
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE - 24);
+
+  /* Holes of 8 where b was and at the end: 16 free, but not 9 in a row */
+  ldmaChainDelete(&b);
+  CHECK((b.desc == NULL) && (b.capacity == 0));
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE - 16);
+  CHECK(ldmaChainCreate(&f, 9) == ldmaChainNoMemory);
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE - 16);
+
+  /* Deleting a deleted chain frees nothing more */
+  ldmaChainDelete(&b);
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE - 16);
+
+  /* First fit: d goes in the first hole, e in what is left of it, f at the
+     end, and then no hole is left for 5 */
+  CHECK(ldmaChainCreate(&d, 5) == ldmaChainOk);
+  CHECK(d.desc == base + 8);
+  CHECK(ldmaChainCreate(&e, 3) == ldmaChainOk);
+  CHECK(e.desc == base + 13);
+  CHECK(ldmaChainCreate(&f, 6) == ldmaChainOk);
+  CHECK(f.desc == base + 24);
+  CHECK(ldmaChainPoolFree() == 2);
+  CHECK(ldmaChainCreate(&b, 5) == ldmaChainNoMemory);
+  CHECK(ldmaChainCreate(&b, 2) == ldmaChainOk);
+  CHECK(b.desc == base + 30);
+  CHECK(ldmaChainPoolFree() == 0);
+  CHECK(ldmaChainCreate(&g, 1) == ldmaChainNoMemory);
+  CHECK(g.desc == NULL);
+
+  /* Freeing a and d joins them into one hole of 13 */
+  ldmaChainDelete(&a);
+  ldmaChainDelete(&d);
+  CHECK(ldmaChainPoolFree() == 13);
+  CHECK(ldmaChainCreate(&a, 13) == ldmaChainOk);
+  CHECK(a.desc == base);
+  ldmaChainDelete(&a);
+  ldmaChainDelete(&b);
+  ldmaChainDelete(&c);
+  ldmaChainDelete(&e);
+  ldmaChainDelete(&f);
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE);
+  CHECK(ldmaChainCreate(&a, LDMA_CHAIN_POOL_SIZE) == ldmaChainOk);
+  CHECK(a.desc == base);
+  ldmaChainPoolInit();
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Link fields written by the builder, whatever the appended descriptors
+ *   held in them
+ ******************************************************************************/
+static void checkLinks(void)
+{
+  ldmaChain_TypeDef chain;
+  LDMA_Descriptor_t desc = LDMA_DESCRIPTOR_SINGLE_M2M_WORD(&words[0], &words[1], 1);
+  LDMA_Descriptor_t *at;
+  uint32_t i;
+
+  ldmaChainPoolInit();
+  CHECK(ldmaChainCreate(&chain, 6) == ldmaChainOk);
+  if ( chain.desc == NULL )
+  {
+    return;
+  }
+
+  /* Link fields of the source descriptor are ignored */
+  desc.xfer.link = 1;
+  desc.xfer.linkAddr = 20;
+  desc.xfer.decLoopCnt = 1;
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+  at = ldmaChainAt(&chain, 0);
+  CHECK((at == chain.desc) && (at->xfer.link == 0) && (at->xfer.linkAddr == 0)
+        && (at->xfer.decLoopCnt == 0));
+  CHECK(at->xfer.srcAddr == LDMA_HOST_ADDRESS(&words[0]));
+  CHECK(ldmaChainAt(&chain, 1) == NULL);
+
+  /* Each append links the previous descriptor to the new one */
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+  for ( i = 0; i < 2; i++ )
+  {
+    CHECK((chain.desc[i].xfer.link == 1) && (chain.desc[i].xfer.linkMode == ldmaLinkModeRel));
+    CHECK((chain.desc[i].xfer.linkAddr == DESC_WORDS)
+          && (chain.desc[i].xfer.decLoopCnt == 0));
+  }
+  CHECK((chain.desc[2].xfer.link == 0) && (chain.desc[2].xfer.linkAddr == 0));
+
+  /* A counted loop from 2 back to 1 */
+  CHECK(ldmaChainLoop(&chain, 1, 5) == ldmaChainOk);
+  CHECK((chain.desc[2].xfer.link == 1) && (chain.desc[2].xfer.linkMode == ldmaLinkModeRel));
+  CHECK((chain.desc[2].xfer.linkAddr == -(int32_t)DESC_WORDS)
+        && (chain.desc[2].xfer.decLoopCnt == 1));
+  CHECK((chain.loopCount == 5) && (chain.loopEnd == 2) && !chain.closed);
+
+  /* The exit of the loop falls through: the loop end is not linked again */
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+  CHECK((chain.desc[2].xfer.linkAddr == -(int32_t)DESC_WORDS)
+        && (chain.desc[2].xfer.decLoopCnt == 1));
+  CHECK((chain.desc[3].xfer.link == 0) && (chain.desc[3].xfer.decLoopCnt == 0));
+
+  /* An endless loop from 4 back to 0 closes the chain */
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+  CHECK((chain.desc[3].xfer.link == 1) && (chain.desc[3].xfer.linkAddr == DESC_WORDS));
+  CHECK(ldmaChainLoop(&chain, 0, 0) == ldmaChainOk);
+  CHECK((chain.desc[4].xfer.link == 1)
+        && (chain.desc[4].xfer.linkAddr == -4 * (int32_t)DESC_WORDS));
+  CHECK((chain.desc[4].xfer.decLoopCnt == 0) && chain.closed && (chain.loopCount == 5));
+
+  /* Reset keeps the block, and the chain is built again from its start */
+  ldmaChainReset(&chain);
+  CHECK((chain.count == 0) && (chain.capacity == 6) && (chain.loopEnd == -1)
+        && (chain.loopCount == 0) && !chain.closed);
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+  CHECK(ldmaChainTerminate(&chain) == ldmaChainOk);
+  CHECK((chain.desc[0].xfer.link == 0) && (chain.desc[0].xfer.linkAddr == 0) && chain.closed);
+  ldmaChainDelete(&chain);
+}
+
+/* Every error of the builder, none of which changes the chain */
+static void checkErrors(void)
+{
+  LDMA_TransferCfg_t config = LDMA_TRANSFER_CFG_MEMORY();
+  ldmaChain_TypeDef chain;
+  LDMA_Descriptor_t desc;
+
+  ldmaChainPoolInit();
+  CHECK(ldmaChainCreate(&chain, 3) == ldmaChainOk);
+  if ( chain.desc == NULL )
+  {
+    return;
+  }
+
+  /* Empty */
+  CHECK(ldmaChainLoop(&chain, 0, 1) == ldmaChainEmpty);
+  CHECK(ldmaChainTerminate(&chain) == ldmaChainEmpty);
+  CHECK(ldmaChainStart(&chain, 0, &config) == ldmaChainEmpty);
+
+  /* Addresses not aligned to the unit size */
+  desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2M_WORD((uint8_t *)&words[0] + 2, &words[1], 1);
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainMisaligned);
+  desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2M_HALF(&words[0], (uint8_t *)&words[1] + 1, 1);
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainMisaligned);
+  desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_WRITE(0x12345678, (uint8_t *)&words[2] + 2);
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainMisaligned);
+  CHECK(chain.count == 0);
+  /* Bytes have no alignment */
+  desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2M_BYTE((uint8_t *)&words[0] + 1,
+                                                           (uint8_t *)&words[1] + 3, 1);
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+  desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_WRITE(0x12345678, &words[2]);
+  CHECK(ldmaChainAppend(&chain, &desc) == ldmaChainOk);
+
+  /* Open */
+  CHECK(ldmaChainStart(&chain, 0, &config) == ldmaChainOpen);
+
+  /* Loop targets past the last descriptor */
+  CHECK(ldmaChainLoop(&chain, 2, 1) == ldmaChainBadLoop);
+  CHECK(ldmaChainLoop(&chain, 0, _LDMA_CH_LOOP_LOOPCNT_MASK + 1) == ldmaChainBadLoop);
+
+  /* Terminate right after a counted loop, and a second loop on its end */
+  CHECK(ldmaChainLoop(&chain, 0, 2) == ldmaChainOk);
+  CHECK(ldmaChainTerminate(&chain) == ldmaChainBadLoop);
+  CHECK(ldmaChainLoop(&chain, 0, 0) == ldmaChainBadLoop);
+  CHECK(ldmaChainLoop(&chain, 1, 1) == ldmaChainBadLoop);
+  CHECK((chain.desc[1].xfer.linkAddr == -(int32_t)DESC_WORDS) && !chain.closed);
+
+  /* A second counted loop further on, there is one loop counter */
+  CHECK(appendWord(&chain) == ldmaChainOk);
+  CHECK(ldmaChainLoop(&chain, 2, 1) == ldmaChainBadLoop);
+  CHECK((chain.desc[2].xfer.link == 0) && (chain.loopCount == 2) && (chain.loopEnd == 1));
+
+  /* Full */
+  CHECK(appendWord(&chain) == ldmaChainFull);
+  CHECK(chain.count == 3);
+
+  /* Closed */
+  CHECK(ldmaChainTerminate(&chain) == ldmaChainOk);
+  CHECK(ldmaChainTerminate(&chain) == ldmaChainClosed);
+  CHECK(ldmaChainLoop(&chain, 0, 0) == ldmaChainClosed);
+  ldmaChainReset(&chain);
+  CHECK(appendWord(&chain) == ldmaChainOk);
+  CHECK(ldmaChainLoop(&chain, 0, 0) == ldmaChainOk);
+  CHECK(appendWord(&chain) == ldmaChainClosed);
+  CHECK(ldmaChainTerminate(&chain) == ldmaChainClosed);
+  ldmaChainDelete(&chain);
+}
+
+/* As buildLoopChain() of src/main.c: A, B, A, B, A, B, A, B, C */
+static ldmaChainStatus_TypeDef buildLoopChain(void)
+{
+  LDMA_Descriptor_t descA =
+    LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(srcA, dstBuffer, BUFFER_SIZE);
+  LDMA_Descriptor_t descB =
+    LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(srcB, dstBuffer, BUFFER_SIZE);
+  LDMA_Descriptor_t descC =
+    LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(srcC, dstBuffer, BUFFER_SIZE);
+
+  descA.xfer.doneIfs = false;
+  descB.xfer.doneIfs = false;
+
+  CHECK(ldmaChainCreate(&loopChain, 3) == ldmaChainOk);
+  CHECK(ldmaChainAppend(&loopChain, &descA) == ldmaChainOk);
+  CHECK(ldmaChainAppend(&loopChain, &descB) == ldmaChainOk);
+  CHECK(ldmaChainLoop(&loopChain, 0, NUM_ITERATIONS - 1) == ldmaChainOk);
+  CHECK(ldmaChainAppend(&loopChain, &descC) == ldmaChainOk);
+  return ldmaChainTerminate(&loopChain);
+}
+
+/* As buildListChain() of src/main.c */
+static ldmaChainStatus_TypeDef buildListChain(void)
+{
+  uint32_t i;
+
+  CHECK(ldmaChainCreate(&listChain, LIST_SIZE) == ldmaChainOk);
+  for ( i = 0; i < LIST_SIZE; i++ )
+  {
+    LDMA_Descriptor_t desc =
+      LDMA_DESCRIPTOR_SINGLE_M2M_HALF(&srcList[i], &dstList[i], BUFFER_SIZE);
+
+    desc.xfer.doneIfs = (i == LIST_SIZE - 1);
+    CHECK(ldmaChainAppend(&listChain, &desc) == ldmaChainOk);
+  }
+  return ldmaChainTerminate(&listChain);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Build the chains of the example, then start them NUM_RUNS times without
+ *   building them again, clearing the destinations before each run
+ ******************************************************************************/
+static void checkExample(void)
+{
+  LDMA_TransferCfg_t memTransfer = LDMA_TRANSFER_CFG_MEMORY();
+  dmaModelStats_TypeDef before, after;
+  uint32_t run, i;
+
+  for ( i = 0; i < LIST_SIZE * BUFFER_SIZE; i++ )
+  {
+    srcList[i / BUFFER_SIZE][i % BUFFER_SIZE] = i;
+  }
+
+  ldmaChainPoolInit();
+  CHECK(buildLoopChain() == ldmaChainOk);
+  CHECK(buildListChain() == ldmaChainOk);
+  CHECK(ldmaChainPoolFree() == LDMA_CHAIN_POOL_SIZE - 7);
+  if ( (loopChain.count != 3) || (listChain.count != LIST_SIZE) )
+  {
+    return;
+  }
+
+  /* A links to B, B back to A three times, then falls through to C */
+  CHECK((loopChain.desc[0].xfer.link == 1) && (loopChain.desc[0].xfer.linkAddr == DESC_WORDS));
+  CHECK((loopChain.desc[1].xfer.link == 1)
+        && (loopChain.desc[1].xfer.linkAddr == -(int32_t)DESC_WORDS));
+  CHECK((loopChain.desc[1].xfer.decLoopCnt == 1) && (loopChain.desc[2].xfer.link == 0));
+  CHECK(loopChain.loopCount == NUM_ITERATIONS - 1);
+  for ( i = 0; i < LIST_SIZE; i++ )
+  {
+    CHECK(listChain.desc[i].xfer.link == (i < LIST_SIZE - 1));
+    CHECK(listChain.desc[i].xfer.linkAddr == ((i < LIST_SIZE - 1) ? DESC_WORDS : 0));
+  }
+
+  /* A chain built wrong may never end, so it is not started */
+  if ( hostFailures != 0 )
+  {
+    return;
+  }
+
+  for ( run = 0; run < NUM_RUNS; run++ )
+  {
+    memset(dstBuffer, 0, sizeof(dstBuffer));
+    memset(dstList, 0, sizeof(dstList));
+    ldmaModelGetStats(&before);
+
+    /* The config asks for no loops: the chain's own count replaces it */
+    CHECK(ldmaChainStart(&loopChain, LOOP_CHANNEL, &memTransfer) == ldmaChainOk);
+    CHECK(ldmaChainStart(&listChain, LIST_CHANNEL, &memTransfer) == ldmaChainOk);
+    while ( (loopRuns <= run) || (listRuns <= run) )
+    {
+      EMU_EnterEM1();
+    }
+    ldmaModelGetStats(&after);
+
+    CHECK((loopRuns == run + 1) && (listRuns == run + 1));
+    CHECK(memcmp(dstBuffer, "CCcc", BUFFER_SIZE) == 0);
+    CHECK(memcmp(dstList, srcList, sizeof(dstList)) == 0);
+
+    /* 2 * NUM_ITERATIONS + 1 byte copies, LIST_SIZE halfword copies, and
+       the model reads descriptors a word at a time */
+    CHECK(after.dataWrites - before.dataWrites
+          == (2 * NUM_ITERATIONS + 1) * BUFFER_SIZE + LIST_SIZE * BUFFER_SIZE);
+    CHECK(after.descriptorReads - before.descriptorReads
+          == (2 * NUM_ITERATIONS + 1 + LIST_SIZE) * DESC_WORDS);
+    CHECK(after.doneCount[LOOP_CHANNEL] - before.doneCount[LOOP_CHANNEL] == 1);
+    CHECK(after.doneCount[LIST_CHANNEL] - before.doneCount[LIST_CHANNEL] == 1);
+    CHECK(after.busErrors == before.busErrors);
+  }
+}
+
+/* Called when the runner returns, also when it ended the run early */
+static void report(void)
+{
+  if ( !finished )
+  {
+    printf("run ended before all checks were done: FAIL\n");
+    hostFailures++;
+  }
+  hostCheckReport();
+}
+
+int main(void)
+{
+  CHIP_Init();
+  atexit(report);
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  checkPool();
+  checkLinks();
+  checkErrors();
+  checkExample();
+
+  finished = true;
+  return 0;
+}
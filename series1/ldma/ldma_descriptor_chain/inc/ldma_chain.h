@@ -0,0 +1,72 @@
+/***************************************************************************//**
+ * @file  ldma_chain.h
+ * @brief LDMA descriptor chain builder backed by a descriptor pool
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef LDMA_CHAIN_H
+#define LDMA_CHAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_ldma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change this to set the number of descriptors shared by all chains
+#define LDMA_CHAIN_POOL_SIZE  32
+
+typedef enum {
+  ldmaChainOk,
+  ldmaChainNoMemory,      // Pool has no free block of the requested size
+  ldmaChainFull,          // All descriptors of the chain are in use
+  ldmaChainClosed,        // Chain was terminated or loops forever
+  ldmaChainMisaligned,    // Address not aligned to the transfer unit size
+  ldmaChainBadLoop,       // Bad loop target, or a second counted loop
+  ldmaChainOpen,          // Chain must be terminated before it is started
+  ldmaChainEmpty
+} ldmaChainStatus_TypeDef;
+
+// A chain owns a contiguous block of pool descriptors, so the descriptor
+// after a counted loop is also the next one in memory, as the LDMA requires
+typedef struct {
+  LDMA_Descriptor_t *desc;  // First descriptor of the block
+  uint16_t capacity;        // Descriptors in the block
+  uint16_t count;           // Descriptors appended
+  uint16_t loopCount;       // Extra passes of the counted loop, 0 if none
+  int16_t loopEnd;          // Descriptor ending the counted loop, -1 if none
+  bool closed;              // Terminated, or ends in an endless loop
+} ldmaChain_TypeDef;
+
+void ldmaChainPoolInit(void);
+uint32_t ldmaChainPoolFree(void);
+
+ldmaChainStatus_TypeDef ldmaChainCreate(ldmaChain_TypeDef *chain, uint32_t capacity);
+void ldmaChainDelete(ldmaChain_TypeDef *chain);
+void ldmaChainReset(ldmaChain_TypeDef *chain);
+
+ldmaChainStatus_TypeDef ldmaChainAppend(ldmaChain_TypeDef *chain,
+                                        const LDMA_Descriptor_t *desc);
+ldmaChainStatus_TypeDef ldmaChainLoop(ldmaChain_TypeDef *chain,
+                                      uint32_t target, uint32_t loopCount);
+ldmaChainStatus_TypeDef ldmaChainTerminate(ldmaChain_TypeDef *chain);
+LDMA_Descriptor_t *ldmaChainAt(ldmaChain_TypeDef *chain, uint32_t index);
+
+ldmaChainStatus_TypeDef ldmaChainStart(ldmaChain_TypeDef *chain, int channel,
+                                       const LDMA_TransferCfg_t *config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LDMA_CHAIN_H
@@ -0,0 +1,303 @@
+/***************************************************************************//**
+ * @file ldma_chain.c
+ * @brief LDMA descriptor chain builder backed by a descriptor pool.
+ *
+ * Descriptors are copied into blocks taken from a fixed-size pool, and the
+ * builder fills in the relative links:
+ *
+ *   ldmaChainAppend()     links the previous descriptor to the new one
+ *   ldmaChainLoop()       links the last descriptor back to an earlier one,
+ *                         either a fixed number of times using the channel
+ *                         loop counter or forever
+ *   ldmaChainTerminate()  ends the chain after the last descriptor
+ *
+ * The LDMA only reads descriptors, so a built chain can be started any
+ * number of times without building it again.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "em_core.h"
+#include "ldma_chain.h"
+
+// Words per descriptor, the unit of the relative link address is one word
+#define DESC_WORDS    (sizeof(LDMA_Descriptor_t) / 4)
+
+static LDMA_Descriptor_t pool[LDMA_CHAIN_POOL_SIZE];
+static bool poolUsed[LDMA_CHAIN_POOL_SIZE];
+
+static void poolMark(uint32_t first, uint32_t count, bool used)
+{
+  for (uint32_t i = first; i < first + count; i++) {
+    poolUsed[i] = used;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Link descriptor 'from' of the chain to descriptor 'to'
+ *****************************************************************************/
+static void linkTo(ldmaChain_TypeDef *chain, uint32_t from, uint32_t to)
+{
+  LDMA_Descriptor_t *desc = &chain->desc[from];
+
+  desc->xfer.linkMode = ldmaLinkModeRel;
+  desc->xfer.link = 1;
+  desc->xfer.linkAddr = ((int32_t)to - (int32_t)from) * (int32_t)DESC_WORDS;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Returns true if the addresses of the descriptor suit its unit size
+ *****************************************************************************/
+static bool aligned(const LDMA_Descriptor_t *desc)
+{
+  uint32_t mask;
+
+  switch (desc->xfer.structType) {
+    case ldmaCtrlStructTypeXfer:
+      mask = (1UL << desc->xfer.size) - 1;
+      return ((desc->xfer.srcAddr | desc->xfer.dstAddr) & mask) == 0;
+
+    case ldmaCtrlStructTypeWrite:
+      // The immediate value is written as a word
+      return (desc->wri.dstAddr & 3) == 0;
+
+    default:
+      return true;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Free all pool descriptors. Chains created before are no longer valid.
+ *****************************************************************************/
+void ldmaChainPoolInit(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  poolMark(0, LDMA_CHAIN_POOL_SIZE, false);
+  CORE_EXIT_ATOMIC();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Number of free pool descriptors
+ *****************************************************************************/
+uint32_t ldmaChainPoolFree(void)
+{
+  uint32_t count = 0;
+
+  for (uint32_t i = 0; i < LDMA_CHAIN_POOL_SIZE; i++) {
+    if (!poolUsed[i]) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Take a block of 'capacity' contiguous descriptors from the pool
+ *****************************************************************************/
+ldmaChainStatus_TypeDef ldmaChainCreate(ldmaChain_TypeDef *chain, uint32_t capacity)
+{
+  uint32_t run = 0;
+  CORE_DECLARE_IRQ_STATE;
+
+  chain->desc = NULL;
+  chain->capacity = 0;
+  ldmaChainReset(chain);
+  if ((capacity == 0) || (capacity > LDMA_CHAIN_POOL_SIZE)) {
+    return ldmaChainNoMemory;
+  }
+
+  // First fit
+  CORE_ENTER_ATOMIC();
+  for (uint32_t i = 0; i < LDMA_CHAIN_POOL_SIZE; i++) {
+    run = poolUsed[i] ? 0 : run + 1;
+    if (run == capacity) {
+      i -= capacity - 1;
+      poolMark(i, capacity, true);
+      chain->desc = &pool[i];
+      chain->capacity = (uint16_t)capacity;
+      break;
+    }
+  }
+  CORE_EXIT_ATOMIC();
+
+  return (chain->desc != NULL) ? ldmaChainOk : ldmaChainNoMemory;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Return the descriptors of a chain to the pool. The chain must not be
+ *    running.
+ *****************************************************************************/
+void ldmaChainDelete(ldmaChain_TypeDef *chain)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  if (chain->desc != NULL) {
+    CORE_ENTER_ATOMIC();
+    poolMark((uint32_t)(chain->desc - pool), chain->capacity, false);
+    CORE_EXIT_ATOMIC();
+  }
+  chain->desc = NULL;
+  chain->capacity = 0;
+  ldmaChainReset(chain);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Empty the chain so it can be built again, keeping its descriptors
+ *****************************************************************************/
+void ldmaChainReset(ldmaChain_TypeDef *chain)
+{
+  chain->count = 0;
+  chain->loopCount = 0;
+  chain->loopEnd = -1;
+  chain->closed = false;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copy a descriptor to the end of the chain
+ *
+ * @details
+ *    The link fields of 'desc' are ignored. The previous descriptor is linked
+ *    to the new one unless it ends a counted loop, whose exit already falls
+ *    through to the next descriptor in memory.
+ *****************************************************************************/
+ldmaChainStatus_TypeDef ldmaChainAppend(ldmaChain_TypeDef *chain,
+                                        const LDMA_Descriptor_t *desc)
+{
+  uint32_t index = chain->count;
+
+  if (chain->closed) {
+    return ldmaChainClosed;
+  }
+  if (index >= chain->capacity) {
+    return ldmaChainFull;
+  }
+  if (!aligned(desc)) {
+    return ldmaChainMisaligned;
+  }
+
+  chain->desc[index] = *desc;
+  chain->desc[index].xfer.link = 0;
+  chain->desc[index].xfer.linkAddr = 0;
+  chain->desc[index].xfer.decLoopCnt = 0;
+
+  if ((index > 0) && ((int32_t)index - 1 != chain->loopEnd)) {
+    linkTo(chain, index - 1, index);
+  }
+  chain->count++;
+  return ldmaChainOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Link the last descriptor back to descriptor 'target'
+ *
+ * @param[in] loopCount
+ *    Number of times the link is taken, so descriptors target..last run
+ *    loopCount + 1 times before the chain continues with the next appended
+ *    descriptor. There is one loop counter per channel, so a chain can have
+ *    one counted loop. 0 loops forever and closes the chain.
+ *****************************************************************************/
+ldmaChainStatus_TypeDef ldmaChainLoop(ldmaChain_TypeDef *chain,
+                                      uint32_t target, uint32_t loopCount)
+{
+  uint32_t last;
+
+  if (chain->closed) {
+    return ldmaChainClosed;
+  }
+  if (chain->count == 0) {
+    return ldmaChainEmpty;
+  }
+
+  last = chain->count - 1;
+  if ((target > last) || ((int32_t)last == chain->loopEnd)
+      || ((loopCount > 0) && (chain->loopEnd >= 0))
+      || (loopCount > (_LDMA_CH_LOOP_LOOPCNT_MASK >> _LDMA_CH_LOOP_LOOPCNT_SHIFT))) {
+    return ldmaChainBadLoop;
+  }
+
+  linkTo(chain, last, target);
+  if (loopCount > 0) {
+    chain->desc[last].xfer.decLoopCnt = 1;
+    chain->loopCount = (uint16_t)loopCount;
+    chain->loopEnd = (int16_t)last;
+  } else {
+    chain->desc[last].xfer.decLoopCnt = 0;
+    chain->closed = true;
+  }
+  return ldmaChainOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    End the chain after the last descriptor
+ *****************************************************************************/
+ldmaChainStatus_TypeDef ldmaChainTerminate(ldmaChain_TypeDef *chain)
+{
+  if (chain->closed) {
+    return ldmaChainClosed;
+  }
+  if (chain->count == 0) {
+    return ldmaChainEmpty;
+  }
+  // The exit of a counted loop needs a descriptor to fall through to
+  if ((int32_t)chain->count - 1 == chain->loopEnd) {
+    return ldmaChainBadLoop;
+  }
+
+  chain->closed = true;
+  return ldmaChainOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Descriptor 'index' of the chain, e.g. to set doneIfs, NULL if there is
+ *    no such descriptor. The link fields must not be changed.
+ *****************************************************************************/
+LDMA_Descriptor_t *ldmaChainAt(ldmaChain_TypeDef *chain, uint32_t index)
+{
+  return (index < chain->count) ? &chain->desc[index] : NULL;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the chain on a channel. The loop count of 'config' is replaced by
+ *    the one of the chain, so the same chain can be started again at any
+ *    time once the channel is done.
+ *****************************************************************************/
+ldmaChainStatus_TypeDef ldmaChainStart(ldmaChain_TypeDef *chain, int channel,
+                                       const LDMA_TransferCfg_t *config)
+{
+  LDMA_TransferCfg_t cfg;
+
+  if (chain->count == 0) {
+    return ldmaChainEmpty;
+  }
+  if (!chain->closed) {
+    return ldmaChainOpen;
+  }
+
+  cfg = *config;
+  cfg.ldmaLoopCnt = chain->loopCount;
+  LDMA_StartTransfer(channel, &cfg, chain->desc);
+  return ldmaChainOk;
+}
@@ -0,0 +1,226 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Descriptor Chain Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_chain.h"
+
+/* DMA channels used for the examples */
+#define LOOP_CHANNEL        0
+#define LIST_CHANNEL        1
+
+/* Memory to memory transfer buffer size */
+#define BUFFER_SIZE         4
+
+/* Number of iterations of A and B */
+#define NUM_ITERATIONS      4
+
+/* Number of times each chain is started */
+#define NUM_RUNS            3
+
+/* Linked list size */
+#define LIST_SIZE           4
+
+/* Chains built from the descriptor pool */
+ldmaChain_TypeDef loopChain;
+ldmaChain_TypeDef listChain;
+
+/* Buffers for the looped chain */
+uint8_t dstBuffer[BUFFER_SIZE];
+uint8_t srcA[BUFFER_SIZE] = "AAaa";
+uint8_t srcB[BUFFER_SIZE] = "BBbb";
+uint8_t srcC[BUFFER_SIZE] = "CCcc";
+
+/* Buffers for the linked list chain */
+uint16_t srcList[LIST_SIZE][BUFFER_SIZE];
+uint16_t dstList[LIST_SIZE][BUFFER_SIZE];
+
+/* Values to watch in the debugger */
+volatile uint32_t loopRuns;
+volatile uint32_t listRuns;
+uint32_t poolFree;
+ldmaChainStatus_TypeDef buildStatus;
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler.
+ ******************************************************************************/
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  /* Read interrupt source */
+  pending = LDMA_IntGet();
+
+  /* Clear interrupts */
+  LDMA_IntClear(pending);
+
+  /* Check for LDMA error */
+  if ( pending & LDMA_IF_ERROR )
+  {
+    /* Loop here to enable the debugger to see what has happened */
+    while (1);
+  }
+
+  if ( pending & (1 << LOOP_CHANNEL) )
+  {
+    loopRuns++;
+  }
+  if ( pending & (1 << LIST_CHANNEL) )
+  {
+    listRuns++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Build a chain that copies A and B NUM_ITERATIONS times, then C, like the
+ *   ldma_linked_list_looped example: A, B, A, B, A, B, A, B, C
+ ******************************************************************************/
+static ldmaChainStatus_TypeDef buildLoopChain(void)
+{
+  ldmaChainStatus_TypeDef status;
+
+  LDMA_Descriptor_t descA =
+    LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(srcA, dstBuffer, BUFFER_SIZE);
+  LDMA_Descriptor_t descB =
+    LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(srcB, dstBuffer, BUFFER_SIZE);
+  LDMA_Descriptor_t descC =
+    LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(srcC, dstBuffer, BUFFER_SIZE);
+
+  /* Interrupt only when the whole chain is done */
+  descA.xfer.doneIfs = false;
+  descB.xfer.doneIfs = false;
+
+  status = ldmaChainCreate(&loopChain, 3);
+  if ( status == ldmaChainOk )
+  {
+    status = ldmaChainAppend(&loopChain, &descA);
+  }
+  if ( status == ldmaChainOk )
+  {
+    status = ldmaChainAppend(&loopChain, &descB);
+  }
+  if ( status == ldmaChainOk )
+  {
+    /* B links back to A NUM_ITERATIONS - 1 times, then falls through to C */
+    status = ldmaChainLoop(&loopChain, 0, NUM_ITERATIONS - 1);
+  }
+  if ( status == ldmaChainOk )
+  {
+    status = ldmaChainAppend(&loopChain, &descC);
+  }
+  if ( status == ldmaChainOk )
+  {
+    status = ldmaChainTerminate(&loopChain);
+  }
+  return status;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Build a chain of LIST_SIZE descriptors, like the ldma_linked_list example
+ ******************************************************************************/
+static ldmaChainStatus_TypeDef buildListChain(void)
+{
+  ldmaChainStatus_TypeDef status;
+  uint32_t i;
+
+  status = ldmaChainCreate(&listChain, LIST_SIZE);
+
+  for (i = 0; (i < LIST_SIZE) && (status == ldmaChainOk); i++)
+  {
+    LDMA_Descriptor_t desc =
+      LDMA_DESCRIPTOR_SINGLE_M2M_HALF(&srcList[i], &dstList[i], BUFFER_SIZE);
+
+    /* Interrupt after the last descriptor only */
+    desc.xfer.doneIfs = (i == LIST_SIZE - 1);
+    status = ldmaChainAppend(&listChain, &desc);
+  }
+  if ( status == ldmaChainOk )
+  {
+    status = ldmaChainTerminate(&listChain);
+  }
+  return status;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the LDMA and build the chains
+ ******************************************************************************/
+void initLdma(void)
+{
+  uint32_t i;
+
+  /* Fill buffers */
+  for (i = 0; i < LIST_SIZE * BUFFER_SIZE; i++){
+    srcList[i / BUFFER_SIZE][i % BUFFER_SIZE] = i;
+    dstList[i / BUFFER_SIZE][i % BUFFER_SIZE] = 0;
+  }
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  ldmaChainPoolInit();
+
+  buildStatus = buildLoopChain();
+  if ( buildStatus == ldmaChainOk )
+  {
+    buildStatus = buildListChain();
+  }
+  poolFree = ldmaChainPoolFree();
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t run;
+
+  /* Chip errata */
+  CHIP_Init();
+
+  /* Init DCDC regulator if available */
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  /* Initialize LDMA and build the chains once */
+  initLdma();
+
+  /* Use memory transfer configuration macro, the loop count is set by the
+     chain */
+  LDMA_TransferCfg_t memTransfer = LDMA_TRANSFER_CFG_MEMORY();
+
+  /* Start both chains again each time they are done, without rebuilding */
+  for (run = 0; (run < NUM_RUNS) && (buildStatus == ldmaChainOk); run++)
+  {
+    ldmaChainStart(&loopChain, LOOP_CHANNEL, &memTransfer);
+    ldmaChainStart(&listChain, LIST_CHANNEL, &memTransfer);
+
+    while ( (loopRuns <= run) || (listRuns <= run) )
+    {
+      EMU_EnterEM1();
+    }
+  }
+
+  while (1)
+  {
+    EMU_EnterEM1();
+  }
+}
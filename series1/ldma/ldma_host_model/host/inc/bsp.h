@@ -0,0 +1,29 @@
+/***************************************************************************//**
+ * @file  bsp.h
+ * @brief Host stand-in for bsp.h, with the SLSTK3401A push buttons and LEDs
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef BSP_H
+#define BSP_H
+
+#include "em_gpio.h"
+
+#define BSP_GPIO_PB0_PORT   gpioPortF
+#define BSP_GPIO_PB0_PIN    6
+#define BSP_GPIO_PB1_PORT   gpioPortF
+#define BSP_GPIO_PB1_PIN    7
+#define BSP_GPIO_LED0_PORT  gpioPortF
+#define BSP_GPIO_LED0_PIN   4
+#define BSP_GPIO_LED1_PORT  gpioPortF
+#define BSP_GPIO_LED1_PIN   5
+
+#endif // BSP_H
@@ -0,0 +1,31 @@
+/***************************************************************************//**
+ * @file  dmactrl.h
+ * @brief Host stand-in for dmactrl.h, the DMA control block
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef DMACTRL_H
+#define DMACTRL_H
+
+#include "em_dma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Primary descriptors, then the alternate ones at 0x100 as on the device
+extern DMA_DESCRIPTOR_TypeDef dmaControlBlock[];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DMACTRL_H
@@ -0,0 +1,24 @@
+/***************************************************************************//**
+ * @file  em_chip.h
+ * @brief Host stand-in for em_chip.h
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_CHIP_H
+#define EM_CHIP_H
+
+#include "em_device.h"
+
+static inline void CHIP_Init(void)
+{
+}
+
+#endif // EM_CHIP_H
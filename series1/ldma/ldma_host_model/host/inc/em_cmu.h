@@ -0,0 +1,36 @@
+/***************************************************************************//**
+ * @file  em_cmu.h
+ * @brief Host stand-in for em_cmu.h, clocks are always on
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_CMU_H
+#define EM_CMU_H
+
+#include "em_device.h"
+
+typedef enum {
+  cmuClock_HF,
+  cmuClock_CORE,
+  cmuClock_HFPER,
+  cmuClock_GPIO,
+  cmuClock_PRS,
+  cmuClock_LDMA,
+  cmuClock_DMA
+} CMU_Clock_TypeDef;
+
+static inline void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void)clock;
+  (void)enable;
+}
+
+#endif // EM_CMU_H
@@ -0,0 +1,25 @@
+/***************************************************************************//**
+ * @file  em_core.h
+ * @brief Host stand-in for em_core.h, the host has no interrupts to mask
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_CORE_H
+#define EM_CORE_H
+
+#define CORE_DECLARE_IRQ_STATE    int irqState = 0
+#define CORE_ENTER_ATOMIC()       (void)irqState
+#define CORE_EXIT_ATOMIC()        (void)irqState
+#define CORE_ENTER_CRITICAL()     (void)irqState
+#define CORE_EXIT_CRITICAL()      (void)irqState
+#define CORE_ATOMIC_SECTION(yourcode) { yourcode }
+
+#endif // EM_CORE_H
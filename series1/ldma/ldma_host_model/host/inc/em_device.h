@@ -0,0 +1,71 @@
+/***************************************************************************//**
+ * @file  em_device.h
+ * @brief Host stand-in for em_device.h, with the registers the LDMA and DMA examples use
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Registers written by the examples. The host runner passes them on to the
+// models.
+typedef struct {
+  volatile uint32_t SWREQ;
+  volatile uint32_t IEN;
+} LDMA_TypeDef;
+
+typedef struct {
+  volatile uint32_t CHSWREQ;
+  volatile uint32_t IEN;
+} DMA_TypeDef;
+
+typedef struct {
+  volatile uint32_t DMAREQ0;
+  volatile uint32_t DMAREQ1;
+} PRS_TypeDef;
+
+// System control block, only SLEEPONEXIT is modelled
+typedef struct {
+  volatile uint32_t SCR;
+} SCB_Type;
+
+extern LDMA_TypeDef hostLdma;
+extern DMA_TypeDef hostDma;
+extern PRS_TypeDef hostPrs;
+extern SCB_Type hostScb;
+
+#define LDMA                          (&hostLdma)
+#define DMA                           (&hostDma)
+#define PRS                           (&hostPrs)
+#define SCB                           (&hostScb)
+
+#define LDMA_IF_ERROR                 0x80000000UL
+#define LDMA_IEN_ERROR                0x80000000UL
+#define DMA_IF_ERR                    0x80000000UL
+#define DMA_IEN_ERR                   0x80000000UL
+#define DMA_CHAN_COUNT                12
+
+#define SCB_SCR_SLEEPONEXIT_Msk       (1UL << 1)
+
+#define PRS_DMAREQ0_PRSSEL_PRSCH0     (0UL << 6)
+#define PRS_DMAREQ0_PRSSEL_PRSCH1     (1UL << 6)
+#define PRS_DMAREQ0_PRSSEL_PRSCH2     (2UL << 6)
+#define PRS_DMAREQ0_PRSSEL_PRSCH3     (3UL << 6)
+#define PRS_CH_CTRL_SOURCESEL_GPIOL   (0x6UL << 8)
+#define PRS_CH_CTRL_SOURCESEL_GPIOH   (0x7UL << 8)
+
+#define __DSB()
+#define __NOP()
+
+#endif // EM_DEVICE_H
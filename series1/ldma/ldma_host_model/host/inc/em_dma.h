@@ -0,0 +1,147 @@
+/***************************************************************************//**
+ * @file  em_dma.h
+ * @brief Host stand-in for em_dma.h, implemented on the PL230 model
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_DMA_H
+#define EM_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Word fields, descriptors hold bus addresses, see dmaModelBusAddress()
+typedef struct {
+  volatile uint32_t SRCEND;
+  volatile uint32_t DSTEND;
+  volatile uint32_t CTRL;
+  volatile uint32_t USER;
+} DMA_DESCRIPTOR_TypeDef;
+
+// Remaining transfers minus 1, in DMA_DESCRIPTOR_TypeDef CTRL
+#define _DMA_CTRL_N_MINUS_1_SHIFT   4
+#define _DMA_CTRL_N_MINUS_1_MASK    0x3FF0UL
+
+typedef enum {
+  dmaDataInc1    = 0,
+  dmaDataInc2    = 1,
+  dmaDataInc4    = 2,
+  dmaDataIncNone = 3
+} DMA_DataInc_TypeDef;
+
+typedef enum {
+  dmaDataSize1 = 0,
+  dmaDataSize2 = 1,
+  dmaDataSize4 = 2
+} DMA_DataSize_TypeDef;
+
+typedef enum {
+  dmaCycleCtrlBasic            = 1,
+  dmaCycleCtrlAuto             = 2,
+  dmaCycleCtrlPingPong         = 3,
+  dmaCycleCtrlMemScatterGather = 4,
+  dmaCycleCtrlPerScatterGather = 6
+} DMA_CycleCtrl_TypeDef;
+
+typedef enum {
+  dmaArbitrate1    = 0,
+  dmaArbitrate2    = 1,
+  dmaArbitrate4    = 2,
+  dmaArbitrate8    = 3,
+  dmaArbitrate16   = 4,
+  dmaArbitrate32   = 5,
+  dmaArbitrate64   = 6,
+  dmaArbitrate128  = 7,
+  dmaArbitrate256  = 8,
+  dmaArbitrate512  = 9,
+  dmaArbitrate1024 = 10
+} DMA_ArbiterConfig_TypeDef;
+
+typedef void (*DMA_FuncPtr_TypeDef)(unsigned int channel, bool primary, void *user);
+
+typedef struct {
+  DMA_FuncPtr_TypeDef cbFunc;
+  void                *userPtr;
+  uint8_t             primary;
+} DMA_CB_TypeDef;
+
+typedef struct {
+  bool            highPri;
+  bool            enableInt;
+  uint32_t        select;
+  DMA_CB_TypeDef  *cb;
+} DMA_CfgChannel_TypeDef;
+
+typedef struct {
+  DMA_DataInc_TypeDef       dstInc;
+  DMA_DataInc_TypeDef       srcInc;
+  DMA_DataSize_TypeDef      size;
+  DMA_ArbiterConfig_TypeDef arbRate;
+  uint8_t                   hprot;
+} DMA_CfgDescr_TypeDef;
+
+typedef struct {
+  void                      *dst;
+  void                      *src;
+  uint16_t                  nMinus1;
+  DMA_DataInc_TypeDef       dstInc;
+  DMA_DataInc_TypeDef       srcInc;
+  DMA_DataSize_TypeDef      size;
+  DMA_ArbiterConfig_TypeDef arbRate;
+  uint8_t                   hprot;
+  bool                      peripheral;
+} DMA_CfgDescrSGAlt_TypeDef;
+
+typedef struct {
+  bool      enable;
+  uint16_t  nMinus1;
+} DMA_CfgLoop_TypeDef;
+
+typedef struct {
+  uint8_t                 hprot;
+  DMA_DESCRIPTOR_TypeDef  *controlBlock;
+} DMA_Init_TypeDef;
+
+#define DMA_CHANNEL_MASK  ((1UL << DMA_CHAN_COUNT) - 1)
+
+void DMA_Init(DMA_Init_TypeDef *init);
+void DMA_Reset(void);
+void DMA_CfgChannel(unsigned int channel, DMA_CfgChannel_TypeDef *cfg);
+void DMA_CfgDescr(unsigned int channel, bool primary, DMA_CfgDescr_TypeDef *cfg);
+void DMA_CfgLoop(unsigned int channel, DMA_CfgLoop_TypeDef *cfg);
+void DMA_CfgDescrScatterGather(DMA_DESCRIPTOR_TypeDef *descr, unsigned int indx,
+                               DMA_CfgDescrSGAlt_TypeDef *cfg);
+void DMA_ActivateBasic(unsigned int channel, bool primary, bool useBurst,
+                       void *dst, const void *src, unsigned int nMinus1);
+void DMA_ActivateAuto(unsigned int channel, bool primary, void *dst,
+                      const void *src, unsigned int nMinus1);
+void DMA_ActivatePingPong(unsigned int channel, bool useBurst,
+                          void *primDst, const void *primSrc, unsigned int primNMinus1,
+                          void *altDst, const void *altSrc, unsigned int altNMinus1);
+void DMA_ActivateScatterGather(unsigned int channel, bool useBurst,
+                               DMA_DESCRIPTOR_TypeDef *altDescr, unsigned int count);
+void DMA_RefreshPingPong(unsigned int channel, bool primary, bool useBurst,
+                         void *dst, const void *src, unsigned int nMinus1, bool stop);
+bool DMA_ChannelEnabled(unsigned int channel);
+void DMA_ChannelEnable(unsigned int channel, bool enable);
+void DMA_IntClear(uint32_t flags);
+void DMA_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EM_DMA_H
@@ -0,0 +1,51 @@
+/***************************************************************************//**
+ * @file  em_emu.h
+ * @brief Host stand-in for em_emu.h, sleeping runs the DMA models
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_EMU_H
+#define EM_EMU_H
+
+#include "em_device.h"
+
+typedef struct {
+  int unused;
+} EMU_DCDCInit_TypeDef;
+
+#define EMU_DCDCINIT_DEFAULT  { 0 }
+
+// Runs the models until an interrupt has been handled, see run_example.c
+void hostSleep(void);
+
+static inline void EMU_DCDCInit(const EMU_DCDCInit_TypeDef *init)
+{
+  (void)init;
+}
+
+static inline void EMU_EnterEM1(void)
+{
+  hostSleep();
+}
+
+static inline void EMU_EnterEM2(bool restore)
+{
+  (void)restore;
+  hostSleep();
+}
+
+static inline void EMU_EnterEM3(bool restore)
+{
+  (void)restore;
+  hostSleep();
+}
+
+#endif // EM_EMU_H
@@ -0,0 +1,51 @@
+/***************************************************************************//**
+ * @file  em_gpio.h
+ * @brief Host stand-in for em_gpio.h
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_GPIO_H
+#define EM_GPIO_H
+
+#include "em_device.h"
+
+typedef enum {
+  gpioPortA, gpioPortB, gpioPortC, gpioPortD, gpioPortE, gpioPortF
+} GPIO_Port_TypeDef;
+
+typedef enum {
+  gpioModeDisabled,
+  gpioModeInput,
+  gpioModeInputPull,
+  gpioModeInputPullFilter,
+  gpioModePushPull
+} GPIO_Mode_TypeDef;
+
+static inline void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+                                   GPIO_Mode_TypeDef mode, unsigned int out)
+{
+  (void)port;
+  (void)pin;
+  (void)mode;
+  (void)out;
+}
+
+static inline void GPIO_IntConfig(GPIO_Port_TypeDef port, unsigned int pin,
+                                  bool risingEdge, bool fallingEdge, bool enable)
+{
+  (void)port;
+  (void)pin;
+  (void)risingEdge;
+  (void)fallingEdge;
+  (void)enable;
+}
+
+#endif // EM_GPIO_H
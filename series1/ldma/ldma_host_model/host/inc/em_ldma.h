@@ -0,0 +1,389 @@
+/***************************************************************************//**
+ * @file  em_ldma.h
+ * @brief Host stand-in for em_ldma.h, implemented on the LDMA model
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_LDMA_H
+#define EM_LDMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Descriptors hold bus addresses, see dmaModelBusAddress()
+#define LDMA_HOST_ADDRESS(p)            ((uint32_t)(uintptr_t)(p))
+
+#define LDMA_DESCRIPTOR_MAX_XFER_SIZE   2048
+#define _LDMA_CH_LOOP_LOOPCNT_MASK      0xFFUL
+#define _LDMA_CH_LOOP_LOOPCNT_SHIFT     0
+#define _LDMA_CTRL_NUMFIXED_DEFAULT     0
+
+typedef enum {
+  ldmaCtrlBlockSizeUnit1    = 0,
+  ldmaCtrlBlockSizeUnit2    = 1,
+  ldmaCtrlBlockSizeUnit3    = 2,
+  ldmaCtrlBlockSizeUnit4    = 3,
+  ldmaCtrlBlockSizeUnit6    = 4,
+  ldmaCtrlBlockSizeUnit8    = 5,
+  ldmaCtrlBlockSizeUnit16   = 7,
+  ldmaCtrlBlockSizeUnit32   = 9,
+  ldmaCtrlBlockSizeUnit64   = 10,
+  ldmaCtrlBlockSizeUnit128  = 11,
+  ldmaCtrlBlockSizeUnit256  = 12,
+  ldmaCtrlBlockSizeUnit512  = 13,
+  ldmaCtrlBlockSizeUnit1024 = 14,
+  ldmaCtrlBlockSizeAll      = 15
+} LDMA_CtrlBlockSize_t;
+
+typedef enum {
+  ldmaCtrlStructTypeXfer  = 0,
+  ldmaCtrlStructTypeSync  = 1,
+  ldmaCtrlStructTypeWrite = 2
+} LDMA_CtrlStructType_t;
+
+typedef enum {
+  ldmaCtrlReqModeBlock = 0,
+  ldmaCtrlReqModeAll   = 1
+} LDMA_CtrlReqMode_t;
+
+typedef enum {
+  ldmaCtrlSrcIncOne  = 0,
+  ldmaCtrlSrcIncTwo  = 1,
+  ldmaCtrlSrcIncFour = 2,
+  ldmaCtrlSrcIncNone = 3
+} LDMA_CtrlSrcInc_t;
+
+typedef enum {
+  ldmaCtrlSizeByte = 0,
+  ldmaCtrlSizeHalf = 1,
+  ldmaCtrlSizeWord = 2
+} LDMA_CtrlSize_t;
+
+typedef enum {
+  ldmaCtrlDstIncOne  = 0,
+  ldmaCtrlDstIncTwo  = 1,
+  ldmaCtrlDstIncFour = 2,
+  ldmaCtrlDstIncNone = 3
+} LDMA_CtrlDstInc_t;
+
+typedef enum {
+  ldmaCtrlSrcAddrModeAbs = 0,
+  ldmaCtrlSrcAddrModeRel = 1
+} LDMA_CtrlSrcAddrMode_t;
+
+typedef enum {
+  ldmaCtrlDstAddrModeAbs = 0,
+  ldmaCtrlDstAddrModeRel = 1
+} LDMA_CtrlDstAddrMode_t;
+
+typedef enum {
+  ldmaLinkModeAbs = 0,
+  ldmaLinkModeRel = 1
+} LDMA_LinkMode_t;
+
+typedef enum {
+  ldmaCfgArbSlotsAs1 = 0,
+  ldmaCfgArbSlotsAs2 = 1,
+  ldmaCfgArbSlotsAs4 = 2,
+  ldmaCfgArbSlotsAs8 = 3
+} LDMA_CfgArbSlots_t;
+
+typedef enum {
+  ldmaCfgSrcIncSignPos = 0,
+  ldmaCfgSrcIncSignNeg = 1
+} LDMA_CfgSrcIncSign_t;
+
+typedef enum {
+  ldmaCfgDstIncSignPos = 0,
+  ldmaCfgDstIncSignNeg = 1
+} LDMA_CfgDstIncSign_t;
+
+// The model only compares signals, the values need not match the device
+typedef enum {
+  ldmaPeripheralSignal_NONE = 0,
+  ldmaPeripheralSignal_PRS_REQ0,
+  ldmaPeripheralSignal_PRS_REQ1,
+  ldmaPeripheralSignal_ADC0_SCAN,
+  ldmaPeripheralSignal_ADC0_SINGLE,
+  ldmaPeripheralSignal_LEUART0_RXDATAV,
+  ldmaPeripheralSignal_LEUART0_TXBL,
+  ldmaPeripheralSignal_MSC_WDATA,
+  ldmaPeripheralSignal_TIMER0_CC0,
+  ldmaPeripheralSignal_TIMER0_UFOF,
+  ldmaPeripheralSignal_TIMER1_CC0,
+  ldmaPeripheralSignal_TIMER1_UFOF,
+  ldmaPeripheralSignal_WTIMER0_CC0,
+  ldmaPeripheralSignal_USART0_RXDATAV,
+  ldmaPeripheralSignal_USART0_TXBL,
+  ldmaPeripheralSignal_USART1_RXDATAV,
+  ldmaPeripheralSignal_USART1_TXBL,
+  ldmaPeripheralSignal_USART2_RXDATAV,
+  ldmaPeripheralSignal_USART2_TXBL,
+  ldmaPeripheralSignal_USART3_RXDATAV,
+  ldmaPeripheralSignal_USART3_TXBL
+} LDMA_PeripheralSignal_t;
+
+typedef union {
+  struct {
+    uint32_t  structType : 2;
+    uint32_t  reserved0 : 1;
+    uint32_t  structReq : 1;
+    uint32_t  xferCnt : 11;
+    uint32_t  byteSwap : 1;
+    uint32_t  blockSize : 4;
+    uint32_t  doneIfs : 1;
+    uint32_t  reqMode : 1;
+    uint32_t  decLoopCnt : 1;
+    uint32_t  ignoreSrec : 1;
+    uint32_t  srcInc : 2;
+    uint32_t  size : 2;
+    uint32_t  dstInc : 2;
+    uint32_t  srcAddrMode : 1;
+    uint32_t  dstAddrMode : 1;
+
+    uint32_t  srcAddr;
+    uint32_t  dstAddr;
+
+    uint32_t  linkMode : 1;
+    uint32_t  link : 1;
+    int32_t   linkAddr : 30;
+  } xfer;
+
+  struct {
+    uint32_t  structType : 2;
+    uint32_t  reserved0 : 1;
+    uint32_t  structReq : 1;
+    uint32_t  xferCnt : 11;
+    uint32_t  byteSwap : 1;
+    uint32_t  blockSize : 4;
+    uint32_t  doneIfs : 1;
+    uint32_t  reqMode : 1;
+    uint32_t  decLoopCnt : 1;
+    uint32_t  ignoreSrec : 1;
+    uint32_t  srcInc : 2;
+    uint32_t  size : 2;
+    uint32_t  dstInc : 2;
+    uint32_t  srcAddrMode : 1;
+    uint32_t  dstAddrMode : 1;
+
+    uint32_t  syncSet : 8;
+    uint32_t  reserved1 : 8;
+    uint32_t  syncClr : 8;
+    uint32_t  reserved2 : 8;
+    uint32_t  matchVal : 8;
+    uint32_t  reserved3 : 8;
+    uint32_t  matchEn : 8;
+    uint32_t  reserved4 : 8;
+
+    uint32_t  linkMode : 1;
+    uint32_t  link : 1;
+    int32_t   linkAddr : 30;
+  } sync;
+
+  struct {
+    uint32_t  structType : 2;
+    uint32_t  reserved0 : 1;
+    uint32_t  structReq : 1;
+    uint32_t  xferCnt : 11;
+    uint32_t  byteSwap : 1;
+    uint32_t  blockSize : 4;
+    uint32_t  doneIfs : 1;
+    uint32_t  reqMode : 1;
+    uint32_t  decLoopCnt : 1;
+    uint32_t  ignoreSrec : 1;
+    uint32_t  srcInc : 2;
+    uint32_t  size : 2;
+    uint32_t  dstInc : 2;
+    uint32_t  srcAddrMode : 1;
+    uint32_t  dstAddrMode : 1;
+
+    uint32_t  immVal;
+    uint32_t  dstAddr;
+
+    uint32_t  linkMode : 1;
+    uint32_t  link : 1;
+    int32_t   linkAddr : 30;
+  } wri;
+} LDMA_Descriptor_t;
+
+typedef struct {
+  uint8_t   ldmaInitCtrlNumFixed;
+  uint8_t   ldmaInitCtrlSyncPrsClrEn;
+  uint8_t   ldmaInitCtrlSyncPrsSetEn;
+  uint8_t   ldmaInitIrqPriority;
+} LDMA_Init_t;
+
+typedef struct {
+  uint32_t              ldmaReqSel;
+  uint8_t               ldmaCtrlSyncPrsClrOff;
+  uint8_t               ldmaCtrlSyncPrsClrOn;
+  uint8_t               ldmaCtrlSyncPrsSetOff;
+  uint8_t               ldmaCtrlSyncPrsSetOn;
+  bool                  ldmaReqDis;
+  bool                  ldmaDbgHalt;
+  LDMA_CfgArbSlots_t    ldmaCfgArbSlots;
+  LDMA_CfgSrcIncSign_t  ldmaCfgSrcIncSign;
+  LDMA_CfgDstIncSign_t  ldmaCfgDstIncSign;
+  uint8_t               ldmaLoopCnt;
+} LDMA_TransferCfg_t;
+
+#define LDMA_INIT_DEFAULT \
+  { _LDMA_CTRL_NUMFIXED_DEFAULT, 0, 0, 3 }
+
+#define LDMA_TRANSFER_CFG_MEMORY()                          \
+  { 0, 0, 0, 0, 0, false, false, ldmaCfgArbSlotsAs1,        \
+    ldmaCfgSrcIncSignPos, ldmaCfgDstIncSignPos, 0 }
+
+#define LDMA_TRANSFER_CFG_MEMORY_LOOP(loopCnt)              \
+  { 0, 0, 0, 0, 0, false, false, ldmaCfgArbSlotsAs1,        \
+    ldmaCfgSrcIncSignPos, ldmaCfgDstIncSignPos, loopCnt }
+
+#define LDMA_TRANSFER_CFG_PERIPHERAL(signal)                \
+  { signal, 0, 0, 0, 0, false, false, ldmaCfgArbSlotsAs1,   \
+    ldmaCfgSrcIncSignPos, ldmaCfgDstIncSignPos, 0 }
+
+// Transfer descriptor with every field given, the emlib macros below differ
+// only in these
+#define LDMA_HOST_XFER(src, dest, count, bs, rm, si, sz, di, lm, lk, la) \
+  {                                                                      \
+    .xfer =                                                              \
+    {                                                                    \
+      .structType   = ldmaCtrlStructTypeXfer,                            \
+      .structReq    = (rm) == ldmaCtrlReqModeAll ? 1 : 0,                \
+      .xferCnt      = (count) - 1,                                       \
+      .byteSwap     = 0,                                                 \
+      .blockSize    = bs,                                                \
+      .doneIfs      = 1,                                                 \
+      .reqMode      = rm,                                                \
+      .decLoopCnt   = 0,                                                 \
+      .ignoreSrec   = 0,                                                 \
+      .srcInc       = si,                                                \
+      .size         = sz,                                                \
+      .dstInc       = di,                                                \
+      .srcAddrMode  = ldmaCtrlSrcAddrModeAbs,                            \
+      .dstAddrMode  = ldmaCtrlDstAddrModeAbs,                            \
+      .srcAddr      = LDMA_HOST_ADDRESS(src),                            \
+      .dstAddr      = LDMA_HOST_ADDRESS(dest),                           \
+      .linkMode     = lm,                                                \
+      .link         = lk,                                                \
+      .linkAddr     = la                                                 \
+    }                                                                    \
+  }
+
+#define LDMA_DESCRIPTOR_SINGLE_M2M_WORD(src, dest, count)                          \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeAll,     \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeWord, ldmaCtrlDstIncOne,           \
+                 ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_SINGLE_M2M_HALF(src, dest, count)                          \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeAll,     \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeHalf, ldmaCtrlDstIncOne,           \
+                 ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(src, dest, count)                          \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeAll,     \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeByte, ldmaCtrlDstIncOne,           \
+                 ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_LINKREL_M2M_WORD(src, dest, count, linkjmp)                \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeAll,     \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeWord, ldmaCtrlDstIncOne,           \
+                 ldmaLinkModeRel, 1, (linkjmp) * 4)
+#define LDMA_DESCRIPTOR_LINKREL_M2M_HALF(src, dest, count, linkjmp)                \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeAll,     \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeHalf, ldmaCtrlDstIncOne,           \
+                 ldmaLinkModeRel, 1, (linkjmp) * 4)
+#define LDMA_DESCRIPTOR_LINKREL_M2M_BYTE(src, dest, count, linkjmp)                \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeAll,     \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeByte, ldmaCtrlDstIncOne,           \
+                 ldmaLinkModeRel, 1, (linkjmp) * 4)
+#define LDMA_DESCRIPTOR_SINGLE_P2M_BYTE(src, dest, count)                          \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeBlock,   \
+                 ldmaCtrlSrcIncNone, ldmaCtrlSizeByte, ldmaCtrlDstIncOne,          \
+                 ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_SINGLE_M2P_BYTE(src, dest, count)                          \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeBlock,   \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeByte, ldmaCtrlDstIncNone,          \
+                 ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_SINGLE_P2P_BYTE(src, dest, count)                          \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeBlock,   \
+                 ldmaCtrlSrcIncNone, ldmaCtrlSizeByte, ldmaCtrlDstIncNone,         \
+                 ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(src, dest, count, linkjmp)                \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeBlock,   \
+                 ldmaCtrlSrcIncNone, ldmaCtrlSizeByte, ldmaCtrlDstIncOne,          \
+                 ldmaLinkModeRel, 1, (linkjmp) * 4)
+#define LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(src, dest, count, linkjmp)                \
+  LDMA_HOST_XFER(src, dest, count, ldmaCtrlBlockSizeUnit1, ldmaCtrlReqModeBlock,   \
+                 ldmaCtrlSrcIncOne, ldmaCtrlSizeByte, ldmaCtrlDstIncNone,          \
+                 ldmaLinkModeRel, 1, (linkjmp) * 4)
+
+#define LDMA_HOST_SYNC(set, clr, matchValue, matchEnable, lm, lk, la) \
+  {                                                                   \
+    .sync =                                                           \
+    {                                                                 \
+      .structType   = ldmaCtrlStructTypeSync,                         \
+      .structReq    = 1,                                              \
+      .doneIfs      = 1,                                              \
+      .syncSet      = set,                                            \
+      .syncClr      = clr,                                            \
+      .matchVal     = matchValue,                                     \
+      .matchEn      = matchEnable,                                    \
+      .linkMode     = lm,                                             \
+      .link         = lk,                                             \
+      .linkAddr     = la                                              \
+    }                                                                 \
+  }
+
+#define LDMA_DESCRIPTOR_SINGLE_SYNC(set, clr, matchValue, matchEnable) \
+  LDMA_HOST_SYNC(set, clr, matchValue, matchEnable, ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_LINKREL_SYNC(set, clr, matchValue, matchEnable, linkjmp) \
+  LDMA_HOST_SYNC(set, clr, matchValue, matchEnable, ldmaLinkModeRel, 1, (linkjmp) * 4)
+
+#define LDMA_HOST_WRITE(value, address, lm, lk, la) \
+  {                                                 \
+    .wri =                                          \
+    {                                               \
+      .structType   = ldmaCtrlStructTypeWrite,      \
+      .structReq    = 1,                            \
+      .doneIfs      = 1,                            \
+      .immVal       = (value),                      \
+      .dstAddr      = LDMA_HOST_ADDRESS(address),   \
+      .linkMode     = lm,                           \
+      .link         = lk,                           \
+      .linkAddr     = la                            \
+    }                                               \
+  }
+
+#define LDMA_DESCRIPTOR_SINGLE_WRITE(value, address) \
+  LDMA_HOST_WRITE(value, address, ldmaLinkModeAbs, 0, 0)
+#define LDMA_DESCRIPTOR_LINKREL_WRITE(value, address, linkjmp) \
+  LDMA_HOST_WRITE(value, address, ldmaLinkModeRel, 1, (linkjmp) * 4)
+
+void LDMA_Init(const LDMA_Init_t *init);
+void LDMA_StartTransfer(int ch, const LDMA_TransferCfg_t *transfer,
+                        const LDMA_Descriptor_t *descriptor);
+void LDMA_StopTransfer(int ch);
+bool LDMA_TransferDone(int ch);
+uint32_t LDMA_IntGet(void);
+uint32_t LDMA_IntGetEnabled(void);
+void LDMA_IntClear(uint32_t flags);
+void LDMA_IntEnable(uint32_t flags);
+void LDMA_IntDisable(uint32_t flags);
+bool LDMA_HostSignal(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EM_LDMA_H
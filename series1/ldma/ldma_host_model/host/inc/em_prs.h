@@ -0,0 +1,36 @@
+/***************************************************************************//**
+ * @file  em_prs.h
+ * @brief Host stand-in for em_prs.h, PRS requests are given to the runner instead
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_PRS_H
+#define EM_PRS_H
+
+#include "em_device.h"
+
+typedef enum {
+  prsEdgeOff,
+  prsEdgePos,
+  prsEdgeNeg,
+  prsEdgeBoth
+} PRS_Edge_TypeDef;
+
+static inline void PRS_SourceSignalSet(unsigned int ch, uint32_t source,
+                                       uint32_t signal, PRS_Edge_TypeDef edge)
+{
+  (void)ch;
+  (void)source;
+  (void)signal;
+  (void)edge;
+}
+
+#endif // EM_PRS_H
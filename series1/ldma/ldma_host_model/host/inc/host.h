@@ -0,0 +1,42 @@
+/***************************************************************************//**
+ * @file  host.h
+ * @brief Shared state of the host runner and the emlib stand-ins
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef HOST_H
+#define HOST_H
+
+#include "dma_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Timing used when the example initializes the LDMA or DMA
+extern dmaModelTiming_TypeDef hostTiming;
+
+// Set by LDMA_Init() and DMA_Init(), the runner reports only these
+extern bool hostLdmaUsed;
+extern bool hostDmaUsed;
+
+// Returns from EMU_EnterEMx() after an interrupt, see SCB_SCR_SLEEPONEXIT
+extern uint32_t hostWakeups;
+
+// Optional, defined by host builds that simulate a peripheral: called when
+// the models are idle, returns false when there is nothing left to send
+bool hostProducer(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_H
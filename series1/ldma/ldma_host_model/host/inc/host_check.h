@@ -0,0 +1,62 @@
+/***************************************************************************//**
+ * @file  host_check.h
+ * @brief Checks and random numbers shared by the host tests of the examples
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Checks that failed so far, in the one test file including this header
+static uint32_t hostFailures;
+
+// Prints the condition and counts a failure when it is false
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);   \
+      hostFailures++;                                                   \
+    }                                                                   \
+  } while (0)
+
+// Prints the verdict of the test, PASS when no check failed
+static inline void hostCheckReport(void)
+{
+  printf("%s\n", (hostFailures == 0) ? "PASS" : "FAIL");
+}
+
+// Next 24-bit number of the linear congruential sequence in *seed
+static inline uint32_t hostRandom(uint32_t *seed)
+{
+  *seed = *seed * 1103515245UL + 12345UL;
+  return *seed >> 8;
+}
+
+// Uniform in ]0, 1[, never 0 so that it can be passed to log()
+static inline double hostUniform(uint32_t *seed)
+{
+  return (hostRandom(seed) + 0.5) / 16777216.0;
+}
+
+// Normal, zero mean and unit variance, by Box-Muller; needs -lm
+static inline double hostGaussian(uint32_t *seed)
+{
+  double u = hostUniform(seed);
+  double v = hostUniform(seed);
+
+  return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+#endif // HOST_CHECK_H
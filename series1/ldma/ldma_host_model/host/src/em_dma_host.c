@@ -0,0 +1,302 @@
+/***************************************************************************//**
+ * @file em_dma_host.c
+ * @brief emlib DMA functions on the PL230 model.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "em_dma.h"
+#include "dmactrl.h"
+#include "pl230_model.h"
+#include "host.h"
+
+// Fields of the descriptor control word
+#define CTRL_CYCLE_CTRL_MASK    0x7UL
+#define CTRL_N_MINUS_1_SHIFT    4
+#define CTRL_N_MINUS_1_MASK     (0x3FFUL << CTRL_N_MINUS_1_SHIFT)
+#define CTRL_R_POWER_SHIFT      14
+#define CTRL_SRC_PROT_SHIFT     18
+#define CTRL_SRC_SIZE_SHIFT     24
+#define CTRL_SRC_INC_SHIFT      26
+#define CTRL_SRC_INC_MASK       (0x3UL << CTRL_SRC_INC_SHIFT)
+#define CTRL_DST_SIZE_SHIFT     28
+#define CTRL_DST_INC_SHIFT      30
+#define CTRL_DST_INC_MASK       (0x3UL << CTRL_DST_INC_SHIFT)
+
+// Alternate descriptors start at 0x100 for up to 16 channels
+#define ALT_INDEX               16
+
+DMA_TypeDef hostDma;
+DMA_DESCRIPTOR_TypeDef dmaControlBlock[2 * ALT_INDEX];
+
+static DMA_DESCRIPTOR_TypeDef *controlBlock;
+static DMA_CB_TypeDef *callbacks[DMA_CHAN_COUNT];
+static uint32_t highPri;
+
+static DMA_DESCRIPTOR_TypeDef *descriptor(unsigned int channel, bool primary)
+{
+  return &controlBlock[channel + (primary ? 0 : ALT_INDEX)];
+}
+
+// End address of a transfer, as the DMA counts down from it
+static uint32_t endAddress(const void *start, uint32_t inc, unsigned int nMinus1)
+{
+  uint32_t address = dmaModelBusAddress(start);
+
+  return (inc == dmaDataIncNone) ? address : address + (nMinus1 << inc);
+}
+
+static void prepare(unsigned int channel, DMA_CycleCtrl_TypeDef cycleCtrl,
+                    bool primary, bool useBurst, void *dst, const void *src,
+                    unsigned int nMinus1)
+{
+  DMA_DESCRIPTOR_TypeDef *descr = descriptor(channel, primary);
+  uint32_t chMask = 1UL << channel;
+
+  if (callbacks[channel] != NULL) {
+    callbacks[channel]->primary = primary;
+  }
+  if (src != NULL) {
+    descr->SRCEND = endAddress(src, (descr->CTRL & CTRL_SRC_INC_MASK) >> CTRL_SRC_INC_SHIFT,
+                               nMinus1);
+  }
+  if (dst != NULL) {
+    descr->DSTEND = endAddress(dst, (descr->CTRL & CTRL_DST_INC_MASK) >> CTRL_DST_INC_SHIFT,
+                               nMinus1);
+  }
+  pl230ModelUseBurstSet(chMask, useBurst);
+  pl230ModelAltSet(chMask, !primary);
+  descr->CTRL = (descr->CTRL & ~(CTRL_CYCLE_CTRL_MASK | CTRL_N_MINUS_1_MASK))
+                | ((uint32_t)nMinus1 << CTRL_N_MINUS_1_SHIFT)
+                | (uint32_t)cycleCtrl;
+}
+
+void DMA_Init(DMA_Init_TypeDef *init)
+{
+  controlBlock = init->controlBlock;
+  for (unsigned int ch = 0; ch < DMA_CHAN_COUNT; ch++) {
+    callbacks[ch] = NULL;
+  }
+  highPri = 0;
+  pl230ModelInit(&hostTiming, dmaModelBusAddress(controlBlock), DMA_CHAN_COUNT);
+  DMA->CHSWREQ = 0;
+  DMA->IEN = DMA_IEN_ERR;
+  hostDmaUsed = true;
+}
+
+void DMA_Reset(void)
+{
+  pl230ModelEnable(DMA_CHANNEL_MASK, false);
+  pl230ModelIntClear(0xFFFFFFFFUL);
+  DMA->IEN = 0;
+}
+
+void DMA_CfgChannel(unsigned int channel, DMA_CfgChannel_TypeDef *cfg)
+{
+  uint32_t chMask = 1UL << channel;
+
+  // Peripheral requests are not modelled here, cfg->select is ignored
+  callbacks[channel] = cfg->cb;
+  pl230ModelPrioritySet(chMask, cfg->highPri);
+  if (cfg->highPri) {
+    highPri |= chMask;
+  } else {
+    highPri &= ~chMask;
+  }
+  if (cfg->enableInt) {
+    DMA->IEN |= chMask;
+  } else {
+    DMA->IEN &= ~chMask;
+  }
+}
+
+void DMA_CfgDescr(unsigned int channel, bool primary, DMA_CfgDescr_TypeDef *cfg)
+{
+  DMA_DESCRIPTOR_TypeDef *descr = descriptor(channel, primary);
+
+  // Count and cycle type are set when the channel is activated
+  descr->CTRL = ((uint32_t)cfg->dstInc << CTRL_DST_INC_SHIFT)
+                | ((uint32_t)cfg->size << CTRL_DST_SIZE_SHIFT)
+                | ((uint32_t)cfg->srcInc << CTRL_SRC_INC_SHIFT)
+                | ((uint32_t)cfg->size << CTRL_SRC_SIZE_SHIFT)
+                | ((uint32_t)cfg->hprot << CTRL_SRC_PROT_SHIFT)
+                | ((uint32_t)cfg->arbRate << CTRL_R_POWER_SHIFT);
+}
+
+// Loop extension of the EFM32GG/LG/WG DMA, channels 0 and 1 only
+void DMA_CfgLoop(unsigned int channel, DMA_CfgLoop_TypeDef *cfg)
+{
+  pl230ModelLoopSet(channel, cfg->enable, cfg->nMinus1);
+}
+
+void DMA_CfgDescrScatterGather(DMA_DESCRIPTOR_TypeDef *descr, unsigned int indx,
+                               DMA_CfgDescrSGAlt_TypeDef *cfg)
+{
+  DMA_CycleCtrl_TypeDef cycleCtrl = cfg->peripheral
+                                    ? dmaCycleCtrlPerScatterGather
+                                    : dmaCycleCtrlMemScatterGather;
+
+  descr += indx;
+  descr->SRCEND = endAddress(cfg->src, cfg->srcInc, cfg->nMinus1);
+  descr->DSTEND = endAddress(cfg->dst, cfg->dstInc, cfg->nMinus1);
+  descr->USER = 0;
+
+  // Tasks use the alternate variant of the cycle type
+  descr->CTRL = ((uint32_t)cfg->dstInc << CTRL_DST_INC_SHIFT)
+                | ((uint32_t)cfg->size << CTRL_DST_SIZE_SHIFT)
+                | ((uint32_t)cfg->srcInc << CTRL_SRC_INC_SHIFT)
+                | ((uint32_t)cfg->size << CTRL_SRC_SIZE_SHIFT)
+                | ((uint32_t)cfg->hprot << CTRL_SRC_PROT_SHIFT)
+                | ((uint32_t)cfg->arbRate << CTRL_R_POWER_SHIFT)
+                | ((uint32_t)cfg->nMinus1 << CTRL_N_MINUS_1_SHIFT)
+                | ((uint32_t)cycleCtrl + 1);
+}
+
+void DMA_ActivateBasic(unsigned int channel, bool primary, bool useBurst,
+                       void *dst, const void *src, unsigned int nMinus1)
+{
+  prepare(channel, dmaCycleCtrlBasic, primary, useBurst, dst, src, nMinus1);
+  pl230ModelEnable(1UL << channel, true);
+}
+
+void DMA_ActivateAuto(unsigned int channel, bool primary, void *dst,
+                      const void *src, unsigned int nMinus1)
+{
+  prepare(channel, dmaCycleCtrlAuto, primary, false, dst, src, nMinus1);
+  pl230ModelEnable(1UL << channel, true);
+  DMA->CHSWREQ |= 1UL << channel;
+}
+
+void DMA_ActivatePingPong(unsigned int channel, bool useBurst,
+                          void *primDst, const void *primSrc, unsigned int primNMinus1,
+                          void *altDst, const void *altSrc, unsigned int altNMinus1)
+{
+  // Alternate first, so that the primary is selected when done
+  prepare(channel, dmaCycleCtrlPingPong, false, useBurst, altDst, altSrc, altNMinus1);
+  prepare(channel, dmaCycleCtrlPingPong, true, useBurst, primDst, primSrc, primNMinus1);
+  pl230ModelEnable(1UL << channel, true);
+}
+
+void DMA_ActivateScatterGather(unsigned int channel, bool useBurst,
+                               DMA_DESCRIPTOR_TypeDef *altDescr, unsigned int count)
+{
+  DMA_DESCRIPTOR_TypeDef *primDescr = descriptor(channel, true);
+  uint32_t chMask = 1UL << channel;
+  uint32_t cycleCtrl;
+
+  if (callbacks[channel] != NULL) {
+    callbacks[channel]->primary = false;
+  }
+
+  // The last task ends the cycle, as a basic or auto-request transfer
+  count--;
+  cycleCtrl = altDescr[count].CTRL & CTRL_CYCLE_CTRL_MASK;
+  if (cycleCtrl == dmaCycleCtrlMemScatterGather + 1) {
+    cycleCtrl = dmaCycleCtrlAuto;
+  } else if (cycleCtrl == dmaCycleCtrlPerScatterGather + 1) {
+    cycleCtrl = dmaCycleCtrlBasic;
+  }
+  altDescr[count].CTRL = (altDescr[count].CTRL & ~CTRL_CYCLE_CTRL_MASK) | cycleCtrl;
+
+  // The primary copies the tasks, 4 words each, into the alternate descriptor
+  cycleCtrl = (cycleCtrl == dmaCycleCtrlBasic)
+              ? dmaCycleCtrlPerScatterGather
+              : dmaCycleCtrlMemScatterGather;
+  primDescr->SRCEND = dmaModelBusAddress((const void *)&altDescr[count].USER);
+  primDescr->DSTEND = dmaModelBusAddress((const void *)&descriptor(channel, false)->USER);
+  primDescr->CTRL = ((uint32_t)dmaDataInc4 << CTRL_DST_INC_SHIFT)
+                    | ((uint32_t)dmaDataSize4 << CTRL_DST_SIZE_SHIFT)
+                    | ((uint32_t)dmaDataInc4 << CTRL_SRC_INC_SHIFT)
+                    | ((uint32_t)dmaDataSize4 << CTRL_SRC_SIZE_SHIFT)
+                    | ((uint32_t)dmaArbitrate4 << CTRL_R_POWER_SHIFT)
+                    | ((uint32_t)(((count + 1) * 4) - 1) << CTRL_N_MINUS_1_SHIFT)
+                    | cycleCtrl;
+
+  pl230ModelUseBurstSet(chMask, useBurst);
+  pl230ModelAltSet(chMask, false);
+  pl230ModelEnable(chMask, true);
+
+  // Memory scatter-gather starts by itself
+  if (cycleCtrl == dmaCycleCtrlMemScatterGather) {
+    DMA->CHSWREQ |= chMask;
+  }
+}
+
+void DMA_RefreshPingPong(unsigned int channel, bool primary, bool useBurst,
+                         void *dst, const void *src, unsigned int nMinus1, bool stop)
+{
+  DMA_DESCRIPTOR_TypeDef *descr = descriptor(channel, primary);
+  uint32_t cycleCtrl = stop ? dmaCycleCtrlBasic : dmaCycleCtrlPingPong;
+
+  if (src != NULL) {
+    descr->SRCEND = endAddress(src, (descr->CTRL & CTRL_SRC_INC_MASK) >> CTRL_SRC_INC_SHIFT,
+                               nMinus1);
+  }
+  if (dst != NULL) {
+    descr->DSTEND = endAddress(dst, (descr->CTRL & CTRL_DST_INC_MASK) >> CTRL_DST_INC_SHIFT,
+                               nMinus1);
+  }
+  descr->CTRL = (descr->CTRL & ~(CTRL_CYCLE_CTRL_MASK | CTRL_N_MINUS_1_MASK))
+                | ((uint32_t)nMinus1 << CTRL_N_MINUS_1_SHIFT)
+                | cycleCtrl;
+  pl230ModelUseBurstSet(1UL << channel, useBurst);
+}
+
+bool DMA_ChannelEnabled(unsigned int channel)
+{
+  return (pl230ModelEnabled() & (1UL << channel)) != 0;
+}
+
+void DMA_ChannelEnable(unsigned int channel, bool enable)
+{
+  pl230ModelEnable(1UL << channel, enable);
+}
+
+void DMA_IntClear(uint32_t flags)
+{
+  pl230ModelIntClear(flags);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Interrupt handler of emlib, calls the callback of each done channel,
+ *    high priority channels first
+ *****************************************************************************/
+void DMA_IRQHandler(void)
+{
+  uint32_t pending = pl230ModelIntGet() & DMA->IEN;
+  uint32_t prio = highPri;
+  DMA_CB_TypeDef *cb;
+  bool primaryCpy;
+
+  pl230ModelIntClear(pending & DMA_IF_ERR);
+  for (int pass = 0; pass < 2; pass++) {
+    for (unsigned int channel = 0; channel < DMA_CHAN_COUNT; channel++) {
+      uint32_t chMask = 1UL << channel;
+
+      if (!(pending & prio & chMask)) {
+        continue;
+      }
+      pl230ModelIntClear(chMask);
+      cb = callbacks[channel];
+      if (cb != NULL) {
+        // Toggle the next descriptor before the callback, which may refresh it
+        primaryCpy = cb->primary;
+        cb->primary ^= 1;
+        if (cb->cbFunc != NULL) {
+          cb->cbFunc(channel, primaryCpy, cb->userPtr);
+        }
+      }
+    }
+    prio = ~highPri;
+  }
+}
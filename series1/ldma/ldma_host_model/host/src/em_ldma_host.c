@@ -0,0 +1,132 @@
+/***************************************************************************//**
+ * @file em_ldma_host.c
+ * @brief emlib LDMA functions on the LDMA model.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "host.h"
+
+LDMA_TypeDef hostLdma;
+
+static const struct {
+  const char *name;
+  LDMA_PeripheralSignal_t signal;
+} signals[] = {
+  { "PRS_REQ0",         ldmaPeripheralSignal_PRS_REQ0 },
+  { "PRS_REQ1",         ldmaPeripheralSignal_PRS_REQ1 },
+  { "ADC0_SCAN",        ldmaPeripheralSignal_ADC0_SCAN },
+  { "ADC0_SINGLE",      ldmaPeripheralSignal_ADC0_SINGLE },
+  { "LEUART0_RXDATAV",  ldmaPeripheralSignal_LEUART0_RXDATAV },
+  { "LEUART0_TXBL",     ldmaPeripheralSignal_LEUART0_TXBL },
+  { "MSC_WDATA",        ldmaPeripheralSignal_MSC_WDATA },
+  { "TIMER0_CC0",       ldmaPeripheralSignal_TIMER0_CC0 },
+  { "TIMER0_UFOF",      ldmaPeripheralSignal_TIMER0_UFOF },
+  { "TIMER1_CC0",       ldmaPeripheralSignal_TIMER1_CC0 },
+  { "TIMER1_UFOF",      ldmaPeripheralSignal_TIMER1_UFOF },
+  { "WTIMER0_CC0",      ldmaPeripheralSignal_WTIMER0_CC0 },
+  { "USART0_RXDATAV",   ldmaPeripheralSignal_USART0_RXDATAV },
+  { "USART0_TXBL",      ldmaPeripheralSignal_USART0_TXBL },
+  { "USART1_RXDATAV",   ldmaPeripheralSignal_USART1_RXDATAV },
+  { "USART1_TXBL",      ldmaPeripheralSignal_USART1_TXBL },
+  { "USART2_RXDATAV",   ldmaPeripheralSignal_USART2_RXDATAV },
+  { "USART2_TXBL",      ldmaPeripheralSignal_USART2_TXBL },
+  { "USART3_RXDATAV",   ldmaPeripheralSignal_USART3_RXDATAV },
+  { "USART3_TXBL",      ldmaPeripheralSignal_USART3_TXBL },
+};
+
+void LDMA_Init(const LDMA_Init_t *init)
+{
+  ldmaModelInit(&hostTiming, init->ldmaInitCtrlNumFixed);
+  LDMA->SWREQ = 0;
+  LDMA->IEN = LDMA_IEN_ERROR;
+  hostLdmaUsed = true;
+}
+
+void LDMA_StartTransfer(int ch, const LDMA_TransferCfg_t *transfer,
+                        const LDMA_Descriptor_t *descriptor)
+{
+  uint32_t chMask = 1UL << ch;
+
+  ldmaModelIntClear(chMask);
+  ldmaModelStart(ch, transfer, LDMA_HOST_ADDRESS(descriptor));
+
+  // Enable the channel interrupt, as emlib does
+  LDMA->IEN |= chMask;
+}
+
+void LDMA_StopTransfer(int ch)
+{
+  uint32_t chMask = 1UL << ch;
+
+  LDMA->IEN &= ~chMask;
+  ldmaModelStop(chMask);
+}
+
+bool LDMA_TransferDone(int ch)
+{
+  return (ldmaModelEnabled() & (1UL << ch)) == 0;
+}
+
+uint32_t LDMA_IntGet(void)
+{
+  return ldmaModelIntGet();
+}
+
+uint32_t LDMA_IntGetEnabled(void)
+{
+  return ldmaModelIntGet() & LDMA->IEN;
+}
+
+void LDMA_IntClear(uint32_t flags)
+{
+  ldmaModelIntClear(flags);
+}
+
+void LDMA_IntEnable(uint32_t flags)
+{
+  LDMA->IEN |= flags;
+}
+
+void LDMA_IntDisable(uint32_t flags)
+{
+  LDMA->IEN &= ~flags;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Raise a peripheral request by name, e.g. "PRS_REQ0"
+ *
+ * @note
+ *    A name ending in "/S" raises a single request instead
+ *
+ * @return
+ *    false if the name is not known
+ *****************************************************************************/
+bool LDMA_HostSignal(const char *name)
+{
+  size_t len = strlen(name);
+  bool single = (len > 2) && (strcmp(name + len - 2, "/S") == 0);
+
+  if (single) {
+    len -= 2;
+  }
+  for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+    if ((strlen(signals[i].name) == len) && (strncmp(signals[i].name, name, len) == 0)) {
+      ldmaModelSignal(signals[i].signal, single);
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,230 @@
+/***************************************************************************//**
+ * @file run_example.c
+ * @brief Runs an unmodified example main() on the host, on the DMA models.
+ *
+ * The example is built with -Dmain=exampleMain and these emlib stand-ins.
+ * Every EMU_EnterEMx() call runs the models until an interrupt is due, and
+ * then calls the example's LDMA_IRQHandler() or the emlib DMA_IRQHandler().
+ * With SCB_SCR_SLEEPONEXIT set, the example goes back to sleep after the
+ * interrupt, as on the device, and EMU_EnterEMx() returns only once a
+ * handler clears it. When the models are idle, the example's hostProducer(),
+ * if any, can act as a peripheral and raise the next request. Once no
+ * requests are left to raise, or the example returns, the run ends and the
+ * transfer statistics are printed.
+ *
+ * usage: run_example [-i irqs] [-r readCycles] [-w writeCycles]
+ *                    [-a arbitrationCycles] [-s signal]...
+ *
+ *   -i  stop after this many interrupts (default 100), for examples that
+ *       restart their transfers forever
+ *   -s  peripheral request raised when the models are idle, in order, e.g.
+ *       "-s PRS_REQ1 -s PRS_REQ0"; add "/S" for a single request
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#undef main
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "em_device.h"
+#include "em_ldma.h"
+#include "em_dma.h"
+#include "ldma_model.h"
+#include "pl230_model.h"
+#include "host.h"
+
+#define MAX_SIGNALS     64
+#define WATCHDOG_S      10
+
+// Run ends
+#define END_RETURN      0
+#define END_IDLE        1
+#define END_IRQS        2
+
+int exampleMain(void);
+
+// Provided by the example, if it uses the LDMA
+void LDMA_IRQHandler(void) __attribute__((weak));
+
+// Provided by host builds that simulate a peripheral, see host.h
+bool hostProducer(void) __attribute__((weak));
+
+// Start and end of the data and bss sections, from the GNU linker
+extern char __data_start[];
+extern char _end[];
+
+PRS_TypeDef hostPrs;
+SCB_Type hostScb;
+dmaModelTiming_TypeDef hostTiming = DMA_MODEL_TIMING_DEFAULT;
+bool hostLdmaUsed;
+bool hostDmaUsed;
+uint32_t hostWakeups;
+
+static jmp_buf runEnd;
+static const char *signalNames[MAX_SIGNALS];
+static int signalCount;
+static int nextSignal;
+static uint32_t irqs;
+static uint32_t maxIrqs = 100;
+
+static void interrupt(void (*handler)(void))
+{
+  if (++irqs > maxIrqs) {
+    longjmp(runEnd, END_IRQS);
+  }
+  handler();
+}
+
+// True if the example resumes after the interrupt, false if it sleeps on
+static bool wakeUp(void)
+{
+  if (SCB->SCR & SCB_SCR_SLEEPONEXIT_Msk) {
+    return false;
+  }
+  hostWakeups++;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Sleep until an interrupt has been handled, and SLEEPONEXIT is clear
+ *****************************************************************************/
+void hostSleep(void)
+{
+  for (;;) {
+    // Software requests written by the example
+    if (LDMA->SWREQ != 0) {
+      ldmaModelRequest(LDMA->SWREQ);
+      LDMA->SWREQ = 0;
+    }
+    if (DMA->CHSWREQ != 0) {
+      pl230ModelRequest(DMA->CHSWREQ);
+      DMA->CHSWREQ = 0;
+    }
+
+    if (hostLdmaUsed && (ldmaModelIntGet() & LDMA->IEN) && (LDMA_IRQHandler != NULL)) {
+      interrupt(LDMA_IRQHandler);
+      if (wakeUp()) {
+        return;
+      }
+      continue;
+    }
+    if (hostDmaUsed && (pl230ModelIntGet() & DMA->IEN)) {
+      interrupt(DMA_IRQHandler);
+      if (wakeUp()) {
+        return;
+      }
+      continue;
+    }
+
+    if ((hostLdmaUsed && ldmaModelStep()) || (hostDmaUsed && pl230ModelStep())) {
+      continue;
+    }
+
+    // Idle, raise the next request
+    if ((hostProducer != NULL) && hostProducer()) {
+      continue;
+    }
+    if (nextSignal < signalCount) {
+      if (!LDMA_HostSignal(signalNames[nextSignal])) {
+        fprintf(stderr, "unknown signal %s\n", signalNames[nextSignal]);
+      }
+      nextSignal++;
+      continue;
+    }
+    longjmp(runEnd, END_IDLE);
+  }
+}
+
+static void printStats(const char *name, const dmaModelStats_TypeDef *stats, int channels)
+{
+  printf("%s\n", name);
+  printf("  cycles              %llu\n", (unsigned long long)stats->cycles);
+  printf("  data reads/writes   %lu/%lu\n",
+         (unsigned long)stats->dataReads, (unsigned long)stats->dataWrites);
+  printf("  descriptor r/w      %lu/%lu\n",
+         (unsigned long)stats->descriptorReads, (unsigned long)stats->descriptorWrites);
+  printf("  arbitration rounds  %lu\n", (unsigned long)stats->arbitrationRounds);
+  printf("  bus errors          %lu\n", (unsigned long)stats->busErrors);
+  for (int ch = 0; ch < channels; ch++) {
+    if (stats->doneCount[ch] != 0) {
+      printf("  ch%-2d done %lu times, last at cycle %llu\n", ch,
+             (unsigned long)stats->doneCount[ch],
+             (unsigned long long)stats->doneCycle[ch]);
+    }
+  }
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: run_example [-i irqs] [-r readCycles] [-w writeCycles]\n"
+                  "                   [-a arbitrationCycles] [-s signal]...\n");
+  exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+  dmaModelStats_TypeDef stats;
+  int opt, end;
+
+  while ((opt = getopt(argc, argv, "i:r:w:a:s:")) != -1) {
+    switch (opt) {
+      case 'i':
+        maxIrqs = strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        hostTiming.readCycles = strtoul(optarg, NULL, 0);
+        break;
+      case 'w':
+        hostTiming.writeCycles = strtoul(optarg, NULL, 0);
+        break;
+      case 'a':
+        hostTiming.arbitrationCycles = strtoul(optarg, NULL, 0);
+        break;
+      case 's':
+        if (signalCount >= MAX_SIGNALS) {
+          usage();
+        }
+        signalNames[signalCount++] = optarg;
+        break;
+      default:
+        usage();
+    }
+  }
+
+  // Descriptors, buffers and the control block are all static in the examples
+  dmaModelBusReset();
+  dmaModelBusMap(__data_start, (uint32_t)(_end - __data_start), 0);
+
+  alarm(WATCHDOG_S);
+  end = setjmp(runEnd);
+  if (end == END_RETURN) {
+    exampleMain();
+  }
+
+  printf("run ended: %s after %lu interrupts\n",
+         (end == END_IRQS) ? "interrupt limit" : (end == END_IDLE) ? "idle" : "return",
+         (unsigned long)irqs);
+  printf("example woken up %lu times\n", (unsigned long)hostWakeups);
+  if (hostLdmaUsed) {
+    ldmaModelGetStats(&stats);
+    printStats("LDMA", &stats, LDMA_MODEL_CHANNELS);
+  }
+  if (hostDmaUsed) {
+    pl230ModelGetStats(&stats);
+    printStats("DMA", &stats, DMA_CHAN_COUNT);
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+/***************************************************************************//**
+ * @file  dma_model.h
+ * @brief Bus and statistics shared by the LDMA and PL230 DMA models
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef DMA_MODEL_H
+#define DMA_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change these to model larger controllers or more memories
+#define DMA_MODEL_CHANNELS      12
+#define DMA_MODEL_REGIONS       8
+
+// Cycles the models charge for each step. A bus access costs readCycles or
+// writeCycles plus the wait states of the region it hits.
+typedef struct {
+  uint32_t arbitrationCycles;   // Per arbitration round
+  uint32_t readCycles;          // Per bus read
+  uint32_t writeCycles;         // Per bus write
+} dmaModelTiming_TypeDef;
+
+#define DMA_MODEL_TIMING_DEFAULT  { 1, 1, 1 }
+
+typedef struct {
+  uint64_t cycles;              // Model time
+  uint32_t dataReads;           // Bus reads of data, one per unit
+  uint32_t dataWrites;          // Bus writes of data, one per unit
+  uint32_t descriptorReads;     // Words read from descriptors
+  uint32_t descriptorWrites;    // Words written back to descriptors
+  uint32_t arbitrationRounds;   // Grants, each moving at most one block
+  uint32_t busErrors;
+  uint32_t doneCount[DMA_MODEL_CHANNELS];   // Done flags raised per channel
+  uint64_t doneCycle[DMA_MODEL_CHANNELS];   // Time of the last one
+} dmaModelStats_TypeDef;
+
+void dmaModelBusReset(void);
+bool dmaModelBusMap(void *host, uint32_t size, uint32_t waitStates);
+uint32_t dmaModelBusAddress(const void *host);
+bool dmaModelBusRead(uint32_t address, void *data, uint32_t size, uint64_t *cycles,
+                     const dmaModelTiming_TypeDef *timing);
+bool dmaModelBusWrite(uint32_t address, const void *data, uint32_t size, uint64_t *cycles,
+                      const dmaModelTiming_TypeDef *timing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DMA_MODEL_H
@@ -0,0 +1,48 @@
+/***************************************************************************//**
+ * @file  ldma_model.h
+ * @brief Cycle-approximate software model of the Series 1 LDMA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef LDMA_MODEL_H
+#define LDMA_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_ldma.h"
+#include "dma_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LDMA_MODEL_CHANNELS     8
+
+// Interrupt flag raised on a bus error, as LDMA_IF_ERROR
+#define LDMA_MODEL_IF_ERROR     0x80000000UL
+
+void ldmaModelInit(const dmaModelTiming_TypeDef *timing, uint32_t numFixed);
+void ldmaModelStart(int ch, const LDMA_TransferCfg_t *config, uint32_t descriptor);
+void ldmaModelStop(uint32_t mask);
+void ldmaModelRequest(uint32_t mask);
+void ldmaModelSignal(uint32_t signal, bool single);
+bool ldmaModelStep(void);
+uint32_t ldmaModelEnabled(void);
+uint32_t ldmaModelSync(void);
+uint32_t ldmaModelIntGet(void);
+void ldmaModelIntClear(uint32_t flags);
+void ldmaModelGetStats(dmaModelStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LDMA_MODEL_H
@@ -0,0 +1,61 @@
+/***************************************************************************//**
+ * @file  pl230_model.h
+ * @brief Cycle-approximate software model of the Series 0 (PL230) DMA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef PL230_MODEL_H
+#define PL230_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dma_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Interrupt flag raised on a bus error, as DMA_IF_ERR
+#define PL230_MODEL_IF_ERROR    0x80000000UL
+
+// Channels with the loop extension of the EFM32GG/LG/WG DMA
+#define PL230_MODEL_LOOP_CHANNELS   2
+
+// Channel descriptor as stored in the control block, see DMA_DESCRIPTOR_TypeDef
+typedef struct {
+  uint32_t srcEnd;
+  uint32_t dstEnd;
+  uint32_t ctrl;
+  uint32_t user;
+} pl230ModelDescriptor_TypeDef;
+
+void pl230ModelInit(const dmaModelTiming_TypeDef *timing, uint32_t ctrlBase,
+                    uint32_t channelCount);
+uint32_t pl230ModelAltOffset(void);
+void pl230ModelEnable(uint32_t mask, bool enable);
+void pl230ModelAltSet(uint32_t mask, bool alternate);
+uint32_t pl230ModelAltGet(void);
+void pl230ModelLoopSet(uint32_t ch, bool enable, uint32_t width);
+void pl230ModelPrioritySet(uint32_t mask, bool high);
+void pl230ModelUseBurstSet(uint32_t mask, bool useBurst);
+void pl230ModelRequest(uint32_t mask);
+void pl230ModelSingleRequest(uint32_t mask);
+bool pl230ModelStep(void);
+uint32_t pl230ModelEnabled(void);
+uint32_t pl230ModelIntGet(void);
+void pl230ModelIntClear(uint32_t flags);
+void pl230ModelGetStats(dmaModelStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PL230_MODEL_H
@@ -0,0 +1,123 @@
+/***************************************************************************//**
+ * @file dma_model.c
+ * @brief Bus of the DMA models.
+ *
+ * Descriptors hold 32-bit addresses. On a 64-bit host an address is the low
+ * 32 bits of a host pointer, and the bus finds the host memory it refers to
+ * in a table of mapped regions. An access outside all regions is a bus
+ * error, as it would be on the device.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "dma_model.h"
+
+typedef struct {
+  uint8_t *host;
+  uint32_t size;
+  uint32_t waitStates;
+} region_TypeDef;
+
+static region_TypeDef regions[DMA_MODEL_REGIONS];
+static uint32_t regionCount;
+
+// The bus is 32 bits wide, larger accesses take one cycle per word
+static uint32_t words(uint32_t size)
+{
+  return (size + 3) / 4;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Host memory for 'size' bytes at bus address 'address', NULL if they are
+ *    not all in one mapped region
+ *****************************************************************************/
+static uint8_t *translate(uint32_t address, uint32_t size, uint32_t *waitStates)
+{
+  uint32_t offset;
+
+  for (uint32_t i = 0; i < regionCount; i++) {
+    // Unsigned arithmetic also handles regions that wrap at 4 GB
+    offset = address - dmaModelBusAddress(regions[i].host);
+    if ((offset < regions[i].size) && (size <= regions[i].size - offset)) {
+      *waitStates = regions[i].waitStates;
+      return regions[i].host + offset;
+    }
+  }
+  return NULL;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Remove all mapped regions
+ *****************************************************************************/
+void dmaModelBusReset(void)
+{
+  regionCount = 0;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Make host memory reachable by the models
+ *
+ * @param[in] waitStates
+ *    Extra cycles per access, e.g. 1 for flash or peripheral registers
+ *****************************************************************************/
+bool dmaModelBusMap(void *host, uint32_t size, uint32_t waitStates)
+{
+  if (regionCount >= DMA_MODEL_REGIONS) {
+    return false;
+  }
+  regions[regionCount].host = host;
+  regions[regionCount].size = size;
+  regions[regionCount].waitStates = waitStates;
+  regionCount++;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Bus address of host memory, as stored in a descriptor
+ *****************************************************************************/
+uint32_t dmaModelBusAddress(const void *host)
+{
+  return (uint32_t)(uintptr_t)host;
+}
+
+bool dmaModelBusRead(uint32_t address, void *data, uint32_t size, uint64_t *cycles,
+                     const dmaModelTiming_TypeDef *timing)
+{
+  uint32_t waitStates;
+  uint8_t *host = translate(address, size, &waitStates);
+
+  if (host == NULL) {
+    return false;
+  }
+  memcpy(data, host, size);
+  *cycles += words(size) * (timing->readCycles + waitStates);
+  return true;
+}
+
+bool dmaModelBusWrite(uint32_t address, const void *data, uint32_t size, uint64_t *cycles,
+                      const dmaModelTiming_TypeDef *timing)
+{
+  uint32_t waitStates;
+  uint8_t *host = translate(address, size, &waitStates);
+
+  if (host == NULL) {
+    return false;
+  }
+  memcpy(host, data, size);
+  *cycles += words(size) * (timing->writeCycles + waitStates);
+  return true;
+}
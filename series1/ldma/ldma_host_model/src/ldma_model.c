@@ -0,0 +1,420 @@
+/***************************************************************************//**
+ * @file ldma_model.c
+ * @brief Cycle-approximate software model of the Series 1 LDMA.
+ *
+ * The model executes the same LDMA_Descriptor_t chains as the LDMA:
+ *
+ *   - descriptors are fetched from the bus, 4 words each
+ *   - transfer, synchronization and write descriptors
+ *   - absolute and relative source, destination and link addresses
+ *   - the channel loop counter (decLoopCnt), used for 2D copies
+ *   - structReq, software requests and peripheral signals, with reqMode
+ *     block or all, single requests and ignoreSrec
+ *   - fixed priority for channels below numFixed and round robin with
+ *     arbSlots weights for the others, re-arbitrating after every block
+ *
+ * Each call to ldmaModelStep() is one arbitration round. Time advances by
+ * the cycles of the bus accesses made, so the completion times in the
+ * statistics are estimates, not cycle exact.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "ldma_model.h"
+
+#define DESC_BYTES      16
+
+typedef struct {
+  bool enabled;
+  uint32_t reqSel;
+  bool reqDis;
+  uint32_t arbSlots;
+  int32_t srcSign;
+  int32_t dstSign;
+  uint32_t loopCnt;
+
+  uint32_t descAddr;          // Address of the loaded descriptor
+  LDMA_Descriptor_t desc;
+  uint32_t src;               // Current source and destination
+  uint32_t dst;
+  uint32_t remaining;         // Units left in the descriptor
+
+  bool request;               // Pending request
+  bool single;                // Pending single request
+  bool active;                // Granted, continues without new requests
+  bool synced;                // Sync set/clear of the descriptor applied
+} channel_TypeDef;
+
+static channel_TypeDef channels[LDMA_MODEL_CHANNELS];
+static dmaModelTiming_TypeDef timing;
+static dmaModelStats_TypeDef stats;
+static uint32_t numFixed;
+static uint32_t intFlags;
+static uint32_t sync;
+
+// Round robin state
+static uint32_t rrLast;
+static uint32_t rrSlots;
+
+// Units per block for each blockSize value, 0 for the whole descriptor
+static const uint16_t blockUnits[16] = {
+  1, 2, 3, 4, 6, 8, 1, 16, 1, 32, 64, 128, 256, 512, 1024, 0
+};
+
+// Address step in units for each srcInc/dstInc value
+static const uint32_t incUnits[4] = { 1, 2, 4, 0 };
+
+static void busError(int ch)
+{
+  intFlags |= LDMA_MODEL_IF_ERROR;
+  channels[ch].enabled = false;
+  stats.busErrors++;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Fetch the descriptor at 'address' and load it into the channel
+ *****************************************************************************/
+static void loadDescriptor(int ch, uint32_t address)
+{
+  channel_TypeDef *c = &channels[ch];
+
+  if (!dmaModelBusRead(address, &c->desc, DESC_BYTES, &stats.cycles, &timing)) {
+    busError(ch);
+    return;
+  }
+  stats.descriptorReads += DESC_BYTES / 4;
+  c->descAddr = address;
+  c->active = false;
+  c->synced = false;
+
+  if (c->desc.xfer.structType == ldmaCtrlStructTypeXfer) {
+    // Relative addresses are added to where the previous descriptor stopped
+    c->src = c->desc.xfer.srcAddrMode == ldmaCtrlSrcAddrModeRel
+             ? c->src + c->desc.xfer.srcAddr : c->desc.xfer.srcAddr;
+    c->dst = c->desc.xfer.dstAddrMode == ldmaCtrlDstAddrModeRel
+             ? c->dst + c->desc.xfer.dstAddr : c->desc.xfer.dstAddr;
+    c->remaining = c->desc.xfer.xferCnt + 1;
+  }
+  if (c->desc.xfer.structReq) {
+    c->request = true;
+  }
+}
+
+static uint32_t linkTarget(const channel_TypeDef *c)
+{
+  if (c->desc.xfer.linkMode == ldmaLinkModeRel) {
+    return c->descAddr + (uint32_t)(c->desc.xfer.linkAddr * 4);
+  }
+  return (uint32_t)c->desc.xfer.linkAddr << 2;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    The loaded descriptor is done: raise its done flag and load the next
+ *    one, or stop the channel
+ *****************************************************************************/
+static void descriptorDone(int ch)
+{
+  channel_TypeDef *c = &channels[ch];
+
+  c->active = false;
+  if (c->desc.xfer.doneIfs) {
+    intFlags |= 1UL << ch;
+    stats.doneCount[ch]++;
+    stats.doneCycle[ch] = stats.cycles;
+  }
+
+  if (c->desc.xfer.decLoopCnt && (c->loopCnt > 0)) {
+    // Loop taken, whether or not link is set
+    c->loopCnt--;
+    loadDescriptor(ch, linkTarget(c));
+  } else if (c->desc.xfer.decLoopCnt) {
+    // Loop exit falls through to the next descriptor in memory
+    if (c->desc.xfer.link) {
+      loadDescriptor(ch, c->descAddr + DESC_BYTES);
+    } else {
+      c->enabled = false;
+    }
+  } else if (c->desc.xfer.link) {
+    loadDescriptor(ch, linkTarget(c));
+  } else {
+    c->enabled = false;
+  }
+}
+
+static bool syncMatched(const channel_TypeDef *c)
+{
+  uint32_t enable = c->desc.sync.matchEn;
+
+  return (sync & enable) == (c->desc.sync.matchVal & enable);
+}
+
+static bool ready(const channel_TypeDef *c)
+{
+  if (!c->enabled) {
+    return false;
+  }
+  switch (c->desc.xfer.structType) {
+    case ldmaCtrlStructTypeSync:
+      return c->synced ? syncMatched(c) : c->request;
+
+    case ldmaCtrlStructTypeWrite:
+      return c->request;
+
+    default:
+      return c->request || c->active || c->single;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Move at most one block of the descriptor loaded in channel 'ch'
+ *****************************************************************************/
+static void serve(int ch)
+{
+  channel_TypeDef *c = &channels[ch];
+  uint32_t unitBytes = 1UL << c->desc.xfer.size;
+  uint32_t units = blockUnits[c->desc.xfer.blockSize];
+  uint32_t srcStep = incUnits[c->desc.xfer.srcInc] * unitBytes;
+  uint32_t dstStep = incUnits[c->desc.xfer.dstInc] * unitBytes;
+  uint32_t data;
+
+  stats.arbitrationRounds++;
+  stats.cycles += timing.arbitrationCycles;
+
+  switch (c->desc.xfer.structType) {
+    case ldmaCtrlStructTypeSync:
+      if (!c->synced) {
+        sync = (sync | c->desc.sync.syncSet) & ~c->desc.sync.syncClr;
+        c->synced = true;
+        c->request = false;
+      }
+      if (syncMatched(c)) {
+        descriptorDone(ch);
+      }
+      return;
+
+    case ldmaCtrlStructTypeWrite:
+      c->request = false;
+      data = c->desc.wri.immVal;
+      if (!dmaModelBusWrite(c->desc.wri.dstAddr, &data, 4, &stats.cycles, &timing)) {
+        busError(ch);
+        return;
+      }
+      stats.dataWrites++;
+      descriptorDone(ch);
+      return;
+
+    default:
+      break;
+  }
+
+  if (c->active) {
+    // Remaining blocks of a descriptor requested as a whole
+  } else if (c->request) {
+    c->request = false;
+    c->active = (c->desc.xfer.reqMode == ldmaCtrlReqModeAll);
+  } else {
+    c->single = false;
+    units = 1;
+  }
+  if ((units == 0) || (units > c->remaining)) {
+    units = c->remaining;
+  }
+
+  for (uint32_t i = 0; i < units; i++) {
+    data = 0;
+    if (!dmaModelBusRead(c->src, &data, unitBytes, &stats.cycles, &timing)
+        || !dmaModelBusWrite(c->dst, &data, unitBytes, &stats.cycles, &timing)) {
+      busError(ch);
+      return;
+    }
+    stats.dataReads++;
+    stats.dataWrites++;
+    c->src += (uint32_t)(c->srcSign * (int32_t)srcStep);
+    c->dst += (uint32_t)(c->dstSign * (int32_t)dstStep);
+  }
+
+  c->remaining -= units;
+  if (c->remaining == 0) {
+    descriptorDone(ch);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Reset the model
+ *
+ * @param[in] fixed
+ *    Channels below this number have fixed priority, as LDMA_CTRL_NUMFIXED
+ *****************************************************************************/
+void ldmaModelInit(const dmaModelTiming_TypeDef *modelTiming, uint32_t fixed)
+{
+  memset(channels, 0, sizeof(channels));
+  memset(&stats, 0, sizeof(stats));
+  timing = *modelTiming;
+  numFixed = (fixed > LDMA_MODEL_CHANNELS) ? LDMA_MODEL_CHANNELS : fixed;
+  intFlags = 0;
+  sync = 0;
+  rrLast = LDMA_MODEL_CHANNELS - 1;
+  rrSlots = 0;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start a channel on the descriptor at bus address 'descriptor', as
+ *    LDMA_StartTransfer()
+ *****************************************************************************/
+void ldmaModelStart(int ch, const LDMA_TransferCfg_t *config, uint32_t descriptor)
+{
+  channel_TypeDef *c = &channels[ch];
+
+  memset(c, 0, sizeof(*c));
+  c->reqSel = config->ldmaReqSel;
+  c->reqDis = config->ldmaReqDis;
+  c->arbSlots = 1UL << config->ldmaCfgArbSlots;
+  c->srcSign = (config->ldmaCfgSrcIncSign == ldmaCfgSrcIncSignNeg) ? -1 : 1;
+  c->dstSign = (config->ldmaCfgDstIncSign == ldmaCfgDstIncSignNeg) ? -1 : 1;
+  c->loopCnt = config->ldmaLoopCnt;
+  c->enabled = true;
+  loadDescriptor(ch, descriptor);
+}
+
+void ldmaModelStop(uint32_t mask)
+{
+  for (int ch = 0; ch < LDMA_MODEL_CHANNELS; ch++) {
+    if (mask & (1UL << ch)) {
+      channels[ch].enabled = false;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Software request for the channels in 'mask', as LDMA->SWREQ
+ *****************************************************************************/
+void ldmaModelRequest(uint32_t mask)
+{
+  for (int ch = 0; ch < LDMA_MODEL_CHANNELS; ch++) {
+    if ((mask & (1UL << ch)) && channels[ch].enabled) {
+      channels[ch].request = true;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Request from a peripheral, to every channel selecting 'signal'
+ *
+ * @param[in] single
+ *    true for a single request (one unit), ignored by descriptors with
+ *    ignoreSrec set
+ *****************************************************************************/
+void ldmaModelSignal(uint32_t signal, bool single)
+{
+  channel_TypeDef *c;
+
+  for (int ch = 0; ch < LDMA_MODEL_CHANNELS; ch++) {
+    c = &channels[ch];
+    if (!c->enabled || c->reqDis || (c->reqSel != signal)) {
+      continue;
+    }
+    if (!single) {
+      c->request = true;
+    } else if (!c->desc.xfer.ignoreSrec) {
+      c->single = true;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    One arbitration round
+ *
+ * @return
+ *    false if no channel was ready, i.e. the model waits for requests
+ *****************************************************************************/
+bool ldmaModelStep(void)
+{
+  int pick = -1;
+  uint32_t rrCount = LDMA_MODEL_CHANNELS - numFixed;
+  uint32_t ch;
+
+  for (ch = 0; ch < numFixed; ch++) {
+    if (ready(&channels[ch])) {
+      pick = (int)ch;
+      break;
+    }
+  }
+
+  if ((pick < 0) && (rrCount > 0)) {
+    if ((rrLast >= numFixed) && (rrSlots > 0) && ready(&channels[rrLast])) {
+      // The last channel has arbitration slots left
+      pick = (int)rrLast;
+      rrSlots--;
+    } else {
+      for (uint32_t i = 1; i <= rrCount; i++) {
+        ch = numFixed + (rrLast - numFixed + i) % rrCount;
+        if (ready(&channels[ch])) {
+          pick = (int)ch;
+          rrLast = ch;
+          rrSlots = channels[ch].arbSlots - 1;
+          break;
+        }
+      }
+    }
+  }
+
+  if (pick < 0) {
+    return false;
+  }
+  serve(pick);
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Mask of channels still running their chain
+ *****************************************************************************/
+uint32_t ldmaModelEnabled(void)
+{
+  uint32_t mask = 0;
+
+  for (int ch = 0; ch < LDMA_MODEL_CHANNELS; ch++) {
+    if (channels[ch].enabled) {
+      mask |= 1UL << ch;
+    }
+  }
+  return mask;
+}
+
+uint32_t ldmaModelSync(void)
+{
+  return sync;
+}
+
+uint32_t ldmaModelIntGet(void)
+{
+  return intFlags;
+}
+
+void ldmaModelIntClear(uint32_t flags)
+{
+  intFlags &= ~flags;
+}
+
+void ldmaModelGetStats(dmaModelStats_TypeDef *modelStats)
+{
+  *modelStats = stats;
+}
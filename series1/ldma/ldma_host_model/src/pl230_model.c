@@ -0,0 +1,397 @@
+/***************************************************************************//**
+ * @file pl230_model.c
+ * @brief Cycle-approximate software model of the Series 0 (PL230) DMA.
+ *
+ * The model works on the primary and alternate descriptors of the control
+ * block in memory, as the DMA does:
+ *
+ *   - basic, auto-request, ping-pong, and memory and peripheral
+ *     scatter-gather cycles
+ *   - addresses computed from the source and destination end pointers
+ *   - re-arbitration after 2^R_power transfers, with the remaining count
+ *     written back to the descriptor
+ *   - high priority channels first, then the lowest channel number
+ *   - burst and single requests, and useburst
+ *   - the loop extension of the EFM32GG/LG/WG DMA on channels 0 and 1: a
+ *     basic or auto-request cycle reloads n_minus_1 from the loop width
+ *     when done, and goes on
+ *
+ * The rectangle (2D copy) extension is not modelled.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "pl230_model.h"
+
+// Fields of the descriptor control word
+#define CYCLE_CTRL(ctrl)    ((ctrl) & 0x7)
+#define N_MINUS_1(ctrl)     (((ctrl) >> 4) & 0x3FF)
+#define R_POWER(ctrl)       (((ctrl) >> 14) & 0xF)
+#define SRC_SIZE(ctrl)      (((ctrl) >> 24) & 0x3)
+#define SRC_INC(ctrl)       (((ctrl) >> 26) & 0x3)
+#define DST_INC(ctrl)       (((ctrl) >> 30) & 0x3)
+#define N_MINUS_1_MASK      (0x3FFUL << 4)
+#define INC_NONE            3
+
+// Cycle types
+#define CYCLE_STOP          0
+#define CYCLE_BASIC         1
+#define CYCLE_AUTO          2
+#define CYCLE_PINGPONG      3
+#define CYCLE_MEM_SG_PRI    4
+#define CYCLE_MEM_SG_ALT    5
+#define CYCLE_PER_SG_PRI    6
+#define CYCLE_PER_SG_ALT    7
+
+typedef struct {
+  bool enabled;
+  bool alternate;
+  bool highPri;
+  bool useBurst;
+  bool request;
+  bool single;
+  bool active;          // Auto-request cycle, runs without new requests
+  bool loop;            // Loop extension enabled, see pl230ModelLoopSet()
+  uint32_t loopWidth;   // n_minus_1 reloaded when the cycle is done
+} channel_TypeDef;
+
+static channel_TypeDef channels[DMA_MODEL_CHANNELS];
+static dmaModelTiming_TypeDef timing;
+static dmaModelStats_TypeDef stats;
+static uint32_t base;
+static uint32_t altOffset;
+static uint32_t count;
+static uint32_t intFlags;
+
+static uint32_t descriptorAddress(int ch)
+{
+  return base + (channels[ch].alternate ? altOffset : 0) + 16 * (uint32_t)ch;
+}
+
+static void busError(int ch)
+{
+  intFlags |= PL230_MODEL_IF_ERROR;
+  channels[ch].enabled = false;
+  stats.busErrors++;
+}
+
+static void channelDone(int ch)
+{
+  intFlags |= 1UL << ch;
+  stats.doneCount[ch]++;
+  stats.doneCycle[ch] = stats.cycles;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Serve one grant of channel 'ch': at most 2^R_power transfers
+ *****************************************************************************/
+static void serve(int ch)
+{
+  channel_TypeDef *c = &channels[ch];
+  pl230ModelDescriptor_TypeDef desc;
+  uint32_t addr = descriptorAddress(ch);
+  uint32_t cycle, n, units, size, src, dst, data, next;
+  bool sgPrimary, reload;
+
+  stats.arbitrationRounds++;
+  stats.cycles += timing.arbitrationCycles;
+
+  if (!dmaModelBusRead(addr, &desc, 12, &stats.cycles, &timing)) {
+    busError(ch);
+    return;
+  }
+  stats.descriptorReads += 3;
+
+  cycle = CYCLE_CTRL(desc.ctrl);
+  if (cycle == CYCLE_STOP) {
+    // Invalid descriptor ends the cycle
+    c->enabled = false;
+    c->active = false;
+    return;
+  }
+  sgPrimary = (cycle == CYCLE_MEM_SG_PRI) || (cycle == CYCLE_PER_SG_PRI);
+
+  // Requests
+  if (c->active) {
+    units = 1UL << R_POWER(desc.ctrl);
+  } else if (c->request) {
+    c->request = false;
+    units = 1UL << R_POWER(desc.ctrl);
+    c->active = (cycle == CYCLE_AUTO) || (cycle == CYCLE_MEM_SG_PRI)
+                || (cycle == CYCLE_MEM_SG_ALT) || (cycle == CYCLE_PER_SG_PRI);
+  } else {
+    c->single = false;
+    units = 1;
+  }
+
+  n = N_MINUS_1(desc.ctrl) + 1;
+  if (units > n) {
+    units = n;
+  }
+  size = 1UL << SRC_SIZE(desc.ctrl);
+
+  for (uint32_t i = 0; i < units; i++, n--) {
+    src = (SRC_INC(desc.ctrl) == INC_NONE)
+          ? desc.srcEnd : desc.srcEnd - ((n - 1) << SRC_INC(desc.ctrl));
+    // The scatter-gather primary writes the 4 words of the alternate
+    // descriptor over and over
+    dst = (DST_INC(desc.ctrl) == INC_NONE)
+          ? desc.dstEnd
+          : desc.dstEnd - ((sgPrimary ? ((n - 1) & 3) : (n - 1)) << DST_INC(desc.ctrl));
+    data = 0;
+    if (!dmaModelBusRead(src, &data, size, &stats.cycles, &timing)
+        || !dmaModelBusWrite(dst, &data, size, &stats.cycles, &timing)) {
+      busError(ch);
+      return;
+    }
+    stats.dataReads++;
+    stats.dataWrites++;
+  }
+
+  // Write back the remaining count, the loop width when a looped cycle is
+  // done, or the stop cycle type
+  reload = c->loop && ((cycle == CYCLE_BASIC) || (cycle == CYCLE_AUTO));
+  if (n > 0) {
+    desc.ctrl = (desc.ctrl & ~N_MINUS_1_MASK) | ((n - 1) << 4);
+  } else if (reload) {
+    desc.ctrl = (desc.ctrl & ~N_MINUS_1_MASK) | (c->loopWidth << 4);
+  } else {
+    desc.ctrl &= ~(N_MINUS_1_MASK | 0x7);
+  }
+  if (!dmaModelBusWrite(addr + 8, &desc.ctrl, 4, &stats.cycles, &timing)) {
+    busError(ch);
+    return;
+  }
+  stats.descriptorWrites++;
+
+  if (sgPrimary) {
+    // A task has been copied to the alternate descriptor, run it
+    c->alternate = true;
+    c->active = (cycle == CYCLE_MEM_SG_PRI);
+    return;
+  }
+  if (n > 0) {
+    return;
+  }
+
+  c->active = false;
+  switch (cycle) {
+    case CYCLE_PINGPONG:
+      channelDone(ch);
+      c->alternate = !c->alternate;
+      // The cycle ends if the other descriptor is not ready
+      if (!dmaModelBusRead(descriptorAddress(ch) + 8, &next, 4, &stats.cycles, &timing)) {
+        busError(ch);
+        return;
+      }
+      stats.descriptorReads++;
+      if (CYCLE_CTRL(next) == CYCLE_STOP) {
+        c->enabled = false;
+      }
+      break;
+
+    case CYCLE_MEM_SG_ALT:
+    case CYCLE_PER_SG_ALT:
+      // Back to the primary for the next task
+      c->alternate = false;
+      c->active = true;
+      break;
+
+    default:
+      // Basic or auto-request, also the last task of a scatter-gather
+      channelDone(ch);
+      c->enabled = reload;
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Reset the model
+ *
+ * @param[in] ctrlBase
+ *    Bus address of the control block, as DMA->CTRLBASE
+ *****************************************************************************/
+void pl230ModelInit(const dmaModelTiming_TypeDef *modelTiming, uint32_t ctrlBase,
+                    uint32_t channelCount)
+{
+  memset(channels, 0, sizeof(channels));
+  memset(&stats, 0, sizeof(stats));
+  timing = *modelTiming;
+  base = ctrlBase;
+  count = (channelCount > DMA_MODEL_CHANNELS) ? DMA_MODEL_CHANNELS : channelCount;
+  intFlags = 0;
+
+  // The alternate descriptors follow the primary ones, at the next power of
+  // two of the channel count, as DMA->ALTCTRLBASE
+  altOffset = 16;
+  while (altOffset < 16 * count) {
+    altOffset <<= 1;
+  }
+}
+
+uint32_t pl230ModelAltOffset(void)
+{
+  return altOffset;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Enable or disable channels, as DMA->CHENS and DMA->CHENC
+ *****************************************************************************/
+void pl230ModelEnable(uint32_t mask, bool enable)
+{
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if (mask & (1UL << ch)) {
+      channels[ch].enabled = enable;
+      channels[ch].active = false;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Select the primary or alternate descriptor, as DMA->CHALTS and CHALTC
+ *****************************************************************************/
+void pl230ModelAltSet(uint32_t mask, bool alternate)
+{
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if (mask & (1UL << ch)) {
+      channels[ch].alternate = alternate;
+    }
+  }
+}
+
+uint32_t pl230ModelAltGet(void)
+{
+  uint32_t mask = 0;
+
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if (channels[ch].alternate) {
+      mask |= 1UL << ch;
+    }
+  }
+  return mask;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Enable or disable the loop extension of channel 'ch', as DMA->LOOP0
+ *    and DMA->LOOP1
+ *****************************************************************************/
+void pl230ModelLoopSet(uint32_t ch, bool enable, uint32_t width)
+{
+  if (ch < PL230_MODEL_LOOP_CHANNELS) {
+    channels[ch].loop = enable;
+    channels[ch].loopWidth = width & 0x3FF;
+  }
+}
+
+void pl230ModelPrioritySet(uint32_t mask, bool high)
+{
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if (mask & (1UL << ch)) {
+      channels[ch].highPri = high;
+    }
+  }
+}
+
+void pl230ModelUseBurstSet(uint32_t mask, bool useBurst)
+{
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if (mask & (1UL << ch)) {
+      channels[ch].useBurst = useBurst;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Burst request, from a peripheral or DMA->CHSWREQ
+ *****************************************************************************/
+void pl230ModelRequest(uint32_t mask)
+{
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if ((mask & (1UL << ch)) && channels[ch].enabled) {
+      channels[ch].request = true;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Single request from a peripheral, ignored by channels using bursts only
+ *****************************************************************************/
+void pl230ModelSingleRequest(uint32_t mask)
+{
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if ((mask & (1UL << ch)) && channels[ch].enabled && !channels[ch].useBurst) {
+      channels[ch].single = true;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    One arbitration round
+ *
+ * @return
+ *    false if no channel was ready, i.e. the model waits for requests
+ *****************************************************************************/
+bool pl230ModelStep(void)
+{
+  int pick = -1;
+  channel_TypeDef *c;
+
+  for (uint32_t ch = 0; ch < count; ch++) {
+    c = &channels[ch];
+    if (c->enabled && (c->request || c->single || c->active)
+        && ((pick < 0) || (c->highPri && !channels[pick].highPri))) {
+      pick = (int)ch;
+    }
+  }
+
+  if (pick < 0) {
+    return false;
+  }
+  serve(pick);
+  return true;
+}
+
+uint32_t pl230ModelEnabled(void)
+{
+  uint32_t mask = 0;
+
+  for (uint32_t ch = 0; ch < count; ch++) {
+    if (channels[ch].enabled) {
+      mask |= 1UL << ch;
+    }
+  }
+  return mask;
+}
+
+uint32_t pl230ModelIntGet(void)
+{
+  return intFlags;
+}
+
+void pl230ModelIntClear(uint32_t flags)
+{
+  intFlags &= ~flags;
+}
+
+void pl230ModelGetStats(dmaModelStats_TypeDef *modelStats)
+{
+  *modelStats = stats;
+}
@@ -0,0 +1,207 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA memcpy on the host LDMA model
+ *
+ * Build with the models and the runner of ../../ldma_host_model, see
+ * readme.txt. Copies and fills of many sizes and alignments are done with
+ * the LDMA model and compared with memcpy() and memset() on whole buffers,
+ * so that writes outside the copy are found too. Then more copies are
+ * started than channels are reserved, and below the threshold, to check
+ * that the CPU takes them.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "dma_memcpy.h"
+#include "host_check.h"
+
+/* Channels reserved for the service */
+#define MEMCPY_CHANNELS     0x3
+
+#define MEMORY_SIZE         40000
+
+uint8_t srcMemory[MEMORY_SIZE];
+uint8_t dmaMemory[MEMORY_SIZE];
+uint8_t cpuMemory[MEMORY_SIZE];
+
+volatile uint32_t callbacks;
+
+/* Set once every check has run */
+bool finished;
+
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  CHECK(!(pending & LDMA_IF_ERROR));
+  dmaMemcpyIrqHandler(pending);
+}
+
+static void countCallback(void *user)
+{
+  (void)user;
+  callbacks++;
+}
+
+static void compare(const char *what, uint32_t dstOffset, uint32_t srcOffset, uint32_t size)
+{
+  if ( memcmp(dmaMemory, cpuMemory, MEMORY_SIZE) != 0 )
+  {
+    printf("%s of %lu bytes, dst +%lu, src +%lu: FAIL\n", what, (unsigned long)size,
+           (unsigned long)dstOffset, (unsigned long)srcOffset);
+    hostFailures++;
+  }
+}
+
+static uint32_t dataReads(void)
+{
+  dmaModelStats_TypeDef stats;
+
+  ldmaModelGetStats(&stats);
+  return stats.dataReads;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy and fill, sizes up to several descriptors. Each size is copied with
+ *   every source alignment and one difference between the destination and
+ *   source alignments, the next one for the next size, so that words,
+ *   halfwords and bytes are all used without an interrupt for each of the
+ *   16 alignments of every size.
+ ******************************************************************************/
+static void checkSizes(void)
+{
+  static const uint32_t sizes[] = { 0, 1, 3, 4, 7, 64, 255, 1000, 8192, 8195, 20001, 36000 };
+  uint32_t size, dstOffset, srcOffset;
+
+  for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    size = sizes[i];
+    for (srcOffset = 0; srcOffset < 4; srcOffset++)
+    {
+      dstOffset = (srcOffset + i) % 4;
+      memset(dmaMemory, 0xA5, MEMORY_SIZE);
+      memset(cpuMemory, 0xA5, MEMORY_SIZE);
+      dmaMemcpy(dmaMemory + dstOffset, srcMemory + srcOffset, size);
+      memcpy(cpuMemory + dstOffset, srcMemory + srcOffset, size);
+      compare("memcpy", dstOffset, srcOffset, size);
+    }
+    dstOffset = i % 4;
+    dmaMemset(dmaMemory + dstOffset, 0x3C, size);
+    memset(cpuMemory + dstOffset, 0x3C, size);
+    compare("memset", dstOffset, 0, size);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Three copies on two channels: the third is done by the CPU
+ ******************************************************************************/
+static void checkChannels(void)
+{
+  dmaMemcpyStatus_TypeDef status[3];
+
+  memset(dmaMemory, 0, MEMORY_SIZE);
+  memset(cpuMemory, 0, MEMORY_SIZE);
+  callbacks = 0;
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    status[i] = dmaMemcpyAsync(dmaMemory + i * 10000, srcMemory + i * 1000, 5000,
+                               countCallback, NULL);
+    memcpy(cpuMemory + i * 10000, srcMemory + i * 1000, 5000);
+  }
+  if ( (status[0] != dmaMemcpyStarted) || (status[1] != dmaMemcpyStarted)
+       || (status[2] != dmaMemcpyDone) || (callbacks != 1)
+       || (dmaMemcpyBusy() != MEMCPY_CHANNELS) )
+  {
+    printf("channel reservation: FAIL\n");
+    hostFailures++;
+  }
+  while ( dmaMemcpyBusy() != 0 )
+  {
+    EMU_EnterEM1();
+  }
+  if ( callbacks != 3 )
+  {
+    printf("callbacks: FAIL\n");
+    hostFailures++;
+  }
+  compare("async memcpy", 0, 0, 5000);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Below the threshold, the LDMA does not move data
+ ******************************************************************************/
+static void checkThreshold(void)
+{
+  uint32_t reads;
+
+  dmaMemcpyThresholdSet(256);
+  reads = dataReads();
+  dmaMemcpy(dmaMemory, srcMemory, 255);
+  if ( dataReads() != reads )
+  {
+    printf("threshold: FAIL\n");
+    hostFailures++;
+  }
+  dmaMemcpy(dmaMemory, srcMemory, 256);
+  if ( dataReads() != reads + 64 )
+  {
+    printf("threshold: FAIL\n");
+    hostFailures++;
+  }
+}
+
+/* Called when the runner returns, also when it stopped the example early */
+static void report(void)
+{
+  if ( !finished )
+  {
+    printf("run ended before all checks were done: FAIL\n");
+    hostFailures++;
+  }
+  hostCheckReport();
+}
+
+int main(void)
+{
+  CHIP_Init();
+  atexit(report);
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  for (uint32_t i = 0; i < MEMORY_SIZE; i++)
+  {
+    srcMemory[i] = (uint8_t)(i * 7 + (i >> 8));
+  }
+
+  dmaMemcpyInit(MEMCPY_CHANNELS);
+  dmaMemcpyThresholdSet(0);
+  checkSizes();
+  checkChannels();
+  checkThreshold();
+
+  finished = true;
+  return 0;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************//**
+ * @file  dma_memcpy.h
+ * @brief memcpy() and memset() on the LDMA, with small sizes on the CPU
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef DMA_MEMCPY_H
+#define DMA_MEMCPY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: define DMA_MEMCPY_CPU_ONLY to build without the LDMA, e.g. on a
+// host, then every copy is done by the CPU
+
+// Copies of fewer bytes use the CPU until dmaMemcpyThresholdSet() or
+// dmaMemcpyCalibrate() is called
+#define DMA_MEMCPY_THRESHOLD_DEFAULT  128
+
+// Note: change this to set how many units the LDMA moves per arbitration
+#define DMA_MEMCPY_BLOCK_SIZE         ldmaCtrlBlockSizeUnit8
+
+typedef enum {
+  dmaMemcpyStarted,       // The LDMA copies, the callback is called from its interrupt
+  dmaMemcpyDone           // The CPU copied, the callback has been called
+} dmaMemcpyStatus_TypeDef;
+
+typedef void (*dmaMemcpyCallback_TypeDef)(void *user);
+
+// Free running counter for dmaMemcpyCalibrate(), e.g. a timer
+typedef uint32_t (*dmaMemcpyCounter_TypeDef)(void);
+
+void dmaMemcpyInit(uint32_t channelMask);
+void dmaMemcpyThresholdSet(uint32_t bytes);
+uint32_t dmaMemcpyThresholdGet(void);
+
+void dmaMemcpy(void *dst, const void *src, size_t size);
+void dmaMemset(void *dst, int value, size_t size);
+dmaMemcpyStatus_TypeDef dmaMemcpyAsync(void *dst, const void *src, size_t size,
+                                       dmaMemcpyCallback_TypeDef callback, void *user);
+dmaMemcpyStatus_TypeDef dmaMemsetAsync(void *dst, int value, size_t size,
+                                       dmaMemcpyCallback_TypeDef callback, void *user);
+
+void dmaMemcpyIrqHandler(uint32_t pending);
+uint32_t dmaMemcpyBusy(void);
+
+uint32_t dmaMemcpyCalibrate(dmaMemcpyCounter_TypeDef counter, uint32_t counterMask,
+                            void *scratch, size_t scratchSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DMA_MEMCPY_H
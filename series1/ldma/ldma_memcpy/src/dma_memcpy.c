@@ -0,0 +1,409 @@
+/***************************************************************************//**
+ * @file dma_memcpy.c
+ * @brief memcpy() and memset() on the LDMA, with small sizes on the CPU.
+ *
+ * The channels given to dmaMemcpyInit() are reserved for the service; each
+ * copy takes a free one. Copies smaller than the threshold, copies started
+ * when all reserved channels are busy, and copies too large for the
+ * descriptors of a channel are done by the CPU instead.
+ *
+ * The LDMA moves words when the source and destination have the same
+ * alignment, halfwords or bytes otherwise; the CPU copies the unaligned
+ * head and tail. A channel has three descriptors, which can move up to
+ * 258 times LDMA_DESCRIPTOR_MAX_XFER_SIZE units:
+ *
+ *   first        absolute addresses, up to the maximum transfer size
+ *   middle       relative addresses, the maximum transfer size, looped
+ *   last         relative addresses, the rest, raises the done interrupt
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "dma_memcpy.h"
+
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+#include "em_device.h"
+#include "em_core.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+
+#define MAX_UNITS       LDMA_DESCRIPTOR_MAX_XFER_SIZE
+#define MAX_LOOPS       (_LDMA_CH_LOOP_LOOPCNT_MASK >> _LDMA_CH_LOOP_LOOPCNT_SHIFT)
+
+// Units a channel moves: the first and last descriptors, and the middle
+// one looped MAX_LOOPS times more
+#define CHANNEL_UNITS   ((MAX_LOOPS + 3) * MAX_UNITS)
+
+typedef struct {
+  LDMA_Descriptor_t desc[3];
+  uint32_t fill;                      // Source of memset
+  dmaMemcpyCallback_TypeDef callback;
+  void *user;
+} channel_TypeDef;
+
+static channel_TypeDef channels[DMA_CHAN_COUNT];
+static uint32_t reserved;
+static volatile uint32_t busy;
+#endif
+
+static uint32_t threshold = DMA_MEMCPY_THRESHOLD_DEFAULT;
+
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+/**************************************************************************//**
+ * @brief
+ *    Take a free reserved channel, or return -1
+ *****************************************************************************/
+static int allocate(void)
+{
+  int ch = -1;
+  uint32_t free;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  free = reserved & ~busy;
+  if (free != 0) {
+    for (ch = 0; !(free & (1UL << ch)); ch++) {
+    }
+    busy |= 1UL << ch;
+  }
+  CORE_EXIT_ATOMIC();
+  return ch;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Build the descriptors of channel 'ch' to move 'units' units of
+ *    2^'shift' bytes, and start it
+ *****************************************************************************/
+static void start(int ch, uint8_t *dst, const uint8_t *src, uint32_t units,
+                  uint32_t shift, bool fill)
+{
+  channel_TypeDef *c = &channels[ch];
+  LDMA_TransferCfg_t cfg = LDMA_TRANSFER_CFG_MEMORY();
+  uint32_t count = 0;
+  uint32_t length, loops = 0;
+
+  while (units > 0) {
+    LDMA_Descriptor_t *desc = &c->desc[count];
+
+    // The middle descriptor takes all full transfers but the first
+    if (count == 1) {
+      loops = (units - 1) / MAX_UNITS;
+    }
+    length = (units > MAX_UNITS) ? MAX_UNITS : units;
+    units -= (count == 1 && loops > 0) ? loops * MAX_UNITS : length;
+
+    *desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2M_BYTE(src, dst, length, 1);
+    desc->xfer.size = (shift == 2) ? ldmaCtrlSizeWord
+                      : (shift == 1) ? ldmaCtrlSizeHalf : ldmaCtrlSizeByte;
+    desc->xfer.blockSize = DMA_MEMCPY_BLOCK_SIZE;
+    desc->xfer.doneIfs = 0;
+    if (fill) {
+      desc->xfer.srcInc = ldmaCtrlSrcIncNone;
+    }
+    if (count > 0) {
+      // Continue where the previous descriptor stopped
+      desc->xfer.srcAddrMode = ldmaCtrlSrcAddrModeRel;
+      desc->xfer.dstAddrMode = ldmaCtrlDstAddrModeRel;
+      desc->xfer.srcAddr = 0;
+      desc->xfer.dstAddr = 0;
+    }
+    if ((count == 1) && (loops > 1)) {
+      // Back to itself, the loop exit falls through to the last descriptor
+      desc->xfer.decLoopCnt = 1;
+      desc->xfer.linkAddr = 0;
+      cfg.ldmaLoopCnt = loops - 1;
+    }
+    count++;
+  }
+
+  c->desc[count - 1].xfer.link = 0;
+  c->desc[count - 1].xfer.doneIfs = 1;
+  LDMA_StartTransfer(ch, &cfg, &c->desc[0]);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copy 'size' bytes, or fill them with c->fill, on the LDMA if possible.
+ *    Otherwise, copy on the CPU and call the callback.
+ *****************************************************************************/
+static dmaMemcpyStatus_TypeDef copy(uint8_t *dst, const uint8_t *src, size_t size, bool fill,
+                                    uint32_t value, dmaMemcpyCallback_TypeDef callback,
+                                    void *user)
+{
+  uint32_t shift, head, units;
+  int ch = -1;
+
+  // Largest unit for which the source and destination are aligned alike
+  if (fill || ((((uintptr_t)dst ^ (uintptr_t)src) & 3) == 0)) {
+    shift = 2;
+  } else if ((((uintptr_t)dst ^ (uintptr_t)src) & 1) == 0) {
+    shift = 1;
+  } else {
+    shift = 0;
+  }
+  head = (uint32_t)(-(uintptr_t)dst) & ((1UL << shift) - 1);
+  units = (size > head) ? (uint32_t)((size - head) >> shift) : 0;
+
+  if ((size >= threshold) && (units > 0) && (units <= CHANNEL_UNITS)) {
+    ch = allocate();
+  }
+  if (ch < 0) {
+    if (fill) {
+      memset(dst, (int)value, size);
+    } else {
+      memcpy(dst, src, size);
+    }
+    if (callback != NULL) {
+      callback(user);
+    }
+    return dmaMemcpyDone;
+  }
+
+  // The CPU does the unaligned head and tail
+  if (fill) {
+    memset(dst, (int)value, head);
+    memset(dst + head + (units << shift), (int)value, size - head - (units << shift));
+    channels[ch].fill = value * 0x01010101UL;
+    src = (const uint8_t *)&channels[ch].fill;
+  } else {
+    memcpy(dst, src, head);
+    memcpy(dst + head + (units << shift), src + head + (units << shift),
+           size - head - (units << shift));
+    src += head;
+  }
+  channels[ch].callback = callback;
+  channels[ch].user = user;
+  start(ch, dst + head, src, units, shift, fill);
+  return dmaMemcpyStarted;
+}
+
+static void setDone(void *user)
+{
+  *(volatile bool *)user = true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Sleep in EM1 until 'done' is set. Interrupts are masked between the
+ *    test and the sleep so that the wake-up is not missed.
+ *****************************************************************************/
+static void wait(volatile bool *done)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  while (!*done) {
+    EMU_EnterEM1();
+    CORE_EXIT_CRITICAL();
+    CORE_ENTER_CRITICAL();
+  }
+  CORE_EXIT_CRITICAL();
+}
+#endif
+
+/**************************************************************************//**
+ * @brief
+ *    Reserve the LDMA channels of 'channelMask' for the service
+ *
+ * @note
+ *    LDMA_Init() must have been called, and LDMA_IRQHandler() must pass
+ *    the interrupt flags to dmaMemcpyIrqHandler()
+ *****************************************************************************/
+void dmaMemcpyInit(uint32_t channelMask)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  reserved = channelMask & ((1UL << DMA_CHAN_COUNT) - 1);
+  busy = 0;
+#else
+  (void)channelMask;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copies of fewer than 'bytes' bytes are done by the CPU
+ *****************************************************************************/
+void dmaMemcpyThresholdSet(uint32_t bytes)
+{
+  threshold = bytes;
+}
+
+uint32_t dmaMemcpyThresholdGet(void)
+{
+  return threshold;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    memcpy(), returns when the copy is done
+ *
+ * @details
+ *    Sleeps in EM1 while the LDMA copies, so must not be called from an
+ *    interrupt handler. 'dst' and 'src' must not overlap.
+ *****************************************************************************/
+void dmaMemcpy(void *dst, const void *src, size_t size)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  volatile bool done = false;
+
+  if (copy(dst, src, size, false, 0, setDone, (void *)&done) == dmaMemcpyStarted) {
+    wait(&done);
+  }
+#else
+  memcpy(dst, src, size);
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    memset(), returns when the memory is filled
+ *****************************************************************************/
+void dmaMemset(void *dst, int value, size_t size)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  volatile bool done = false;
+
+  if (copy(dst, NULL, size, true, (uint8_t)value, setDone, (void *)&done)
+      == dmaMemcpyStarted) {
+    wait(&done);
+  }
+#else
+  memset(dst, value, size);
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start a memcpy(), 'callback' is called with 'user' when it is done
+ *
+ * @return
+ *    dmaMemcpyStarted if the LDMA copies, and calls the callback from
+ *    dmaMemcpyIrqHandler(); dmaMemcpyDone if the CPU has copied and called
+ *    the callback already
+ *****************************************************************************/
+dmaMemcpyStatus_TypeDef dmaMemcpyAsync(void *dst, const void *src, size_t size,
+                                       dmaMemcpyCallback_TypeDef callback, void *user)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  return copy(dst, src, size, false, 0, callback, user);
+#else
+  memcpy(dst, src, size);
+  if (callback != NULL) {
+    callback(user);
+  }
+  return dmaMemcpyDone;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start a memset(), as dmaMemcpyAsync()
+ *****************************************************************************/
+dmaMemcpyStatus_TypeDef dmaMemsetAsync(void *dst, int value, size_t size,
+                                       dmaMemcpyCallback_TypeDef callback, void *user)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  return copy(dst, NULL, size, true, (uint8_t)value, callback, user);
+#else
+  memset(dst, value, size);
+  if (callback != NULL) {
+    callback(user);
+  }
+  return dmaMemcpyDone;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Call from LDMA_IRQHandler() with the pending interrupt flags, calls
+ *    the callbacks of the copies done
+ *****************************************************************************/
+void dmaMemcpyIrqHandler(uint32_t pending)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  uint32_t done = pending & busy;
+
+  for (int ch = 0; done != 0; ch++, done >>= 1) {
+    if (done & 1) {
+      // Free the channel first, the callback may start another copy
+      busy &= ~(1UL << ch);
+      if (channels[ch].callback != NULL) {
+        channels[ch].callback(channels[ch].user);
+      }
+    }
+  }
+#else
+  (void)pending;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Mask of the reserved channels copying
+ *****************************************************************************/
+uint32_t dmaMemcpyBusy(void)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  return busy;
+#else
+  return 0;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Measure dmaMemcpy() against memcpy() for sizes from 8 bytes to half of
+ *    'scratch', and set the threshold to the smallest size the LDMA copies
+ *    faster
+ *
+ * @param[in] counter
+ *    Free running count, e.g. of a timer at the core clock
+ *
+ * @param[in] counterMask
+ *    Counter range minus one, e.g. 0xFFFF for a 16-bit timer; a copy must
+ *    take less than the full range
+ *
+ * @return
+ *    The new threshold; half of 'scratch' if the CPU is faster for every
+ *    size, as larger copies still leave the CPU free
+ *****************************************************************************/
+uint32_t dmaMemcpyCalibrate(dmaMemcpyCounter_TypeDef counter, uint32_t counterMask,
+                            void *scratch, size_t scratchSize)
+{
+#if !defined(DMA_MEMCPY_CPU_ONLY)
+  uint8_t *half = (uint8_t *)scratch + scratchSize / 2;
+  uint32_t cpuCount, dmaCount, size, begin;
+
+  for (size = 8; size <= scratchSize / 2; size *= 2) {
+    begin = counter();
+    memcpy(half, scratch, size);
+    cpuCount = (counter() - begin) & counterMask;
+
+    threshold = 0;
+    begin = counter();
+    dmaMemcpy(half, scratch, size);
+    dmaCount = (counter() - begin) & counterMask;
+
+    if (dmaCount < cpuCount) {
+      break;
+    }
+  }
+  threshold = (size > scratchSize / 2) ? (uint32_t)(scratchSize / 2) : size;
+#else
+  (void)counter;
+  (void)counterMask;
+  (void)scratch;
+  (void)scratchSize;
+#endif
+  return threshold;
+}
@@ -0,0 +1,120 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA memcpy Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "em_timer.h"
+#include "dma_memcpy.h"
+
+/* DMA channels reserved for the service: 0 and 1 */
+#define MEMCPY_CHANNELS     0x3
+
+/* Buffer for the calibration, copies go from its first half to the second */
+#define SCRATCH_SIZE        4096
+
+#define BUFFER_SIZE         1024
+
+uint32_t scratch[SCRATCH_SIZE / 4];
+uint8_t srcBuffer[BUFFER_SIZE];
+uint8_t dstBuffer[BUFFER_SIZE];
+uint8_t fillBuffer[BUFFER_SIZE];
+
+/* Values to watch in the debugger */
+uint32_t threshold;
+volatile uint32_t copiesDone;
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler.
+ ******************************************************************************/
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  /* Read interrupt source */
+  pending = LDMA_IntGet();
+
+  /* Clear interrupts */
+  LDMA_IntClear(pending);
+
+  /* Check for LDMA error */
+  if ( pending & LDMA_IF_ERROR )
+  {
+    /* Loop here to enable the debugger to see what has happened */
+    while (1);
+  }
+
+  /* Call the callbacks of the copies done */
+  dmaMemcpyIrqHandler(pending);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Counter for the calibration: TIMER0, free running at HFPERCLK
+ ******************************************************************************/
+static uint32_t timerCount(void)
+{
+  return TIMER_CounterGet(TIMER0);
+}
+
+static void copyDone(void *user)
+{
+  (void)user;
+  copiesDone++;
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+  uint32_t i;
+
+  /* Chip errata */
+  CHIP_Init();
+
+  /* Initialize the LDMA and the timer */
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+  TIMER_Init(TIMER0, &timerInit);
+
+  /* Find where the LDMA becomes faster than the CPU on this device */
+  dmaMemcpyInit(MEMCPY_CHANNELS);
+  threshold = dmaMemcpyCalibrate(timerCount, 0xFFFF, scratch, sizeof(scratch));
+
+  for (i = 0; i < BUFFER_SIZE; i++)
+  {
+    srcBuffer[i] = i;
+  }
+
+  while (1)
+  {
+    /* Blocking copy, sleeps in EM1 while the LDMA copies */
+    dmaMemcpy(dstBuffer, srcBuffer, BUFFER_SIZE);
+    copiesDone++;
+
+    /* Copy and fill in the background, small ones are done by the CPU */
+    dmaMemsetAsync(fillBuffer, copiesDone, BUFFER_SIZE, copyDone, NULL);
+    dmaMemcpyAsync(dstBuffer, srcBuffer + 1, 16, copyDone, NULL);
+
+    /* Poll: sleeping here could miss the last interrupt */
+    while ( dmaMemcpyBusy() != 0 );
+  }
+}
@@ -0,0 +1,158 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Pipeline on the host LDMA model, with simulated peripherals
+ *
+ * Build with the models and the runner of ../../ldma_host_model, see
+ * readme.txt. Three stages: the ADC data register into a first ring of
+ * buffers, a memory copy into a second ring, and the second ring into the
+ * USART transmit register. hostProducer() plays the ADC and the USART: each
+ * call collects the word transmitted, puts the next sample in the ADC data
+ * register and raises both requests. At the end it checks that every
+ * sample was transmitted in order, without any interrupt, and prints the
+ * interrupts and wake-ups an interrupt-driven pipeline would have taken.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "host.h"
+#include "ldma_pipe.h"
+
+#define STAGE_COUNT         3
+#define BUFFER_COUNT        3
+#define BUFFER_LENGTH       8
+#define SAMPLE_COUNT        (20 * BUFFER_LENGTH)
+
+/* Transmit register value when the USART has taken the last word */
+#define TX_EMPTY            0xFFFFFFFFUL
+
+/* Calls without a transmitted word before the producer gives up */
+#define MAX_IDLE            (4 * BUFFER_LENGTH)
+
+ldmaPipe_TypeDef pipe;
+uint32_t pipeBuffers[STAGE_COUNT - 1][BUFFER_COUNT][BUFFER_LENGTH];
+
+/* Simulated ADC0->SINGLEDATA and USART0->TXDATA */
+volatile uint32_t adcRegister;
+volatile uint32_t txRegister = TX_EMPTY;
+
+uint32_t samplesSent;
+uint32_t received[SAMPLE_COUNT];
+uint32_t receivedCount;
+uint32_t idleCalls;
+uint32_t interrupts;
+
+void LDMA_IRQHandler( void )
+{
+  LDMA_IntClear(LDMA_IntGet());
+  interrupts++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check what the USART received, and compare with an interrupt-driven
+ *   pipeline: one interrupt per buffer per stage to start the next transfer,
+ *   each waking the CPU from EM1
+ ******************************************************************************/
+static void report(void)
+{
+  uint32_t errors = 0;
+  uint32_t buffers = SAMPLE_COUNT / BUFFER_LENGTH;
+  uint32_t irqDriven = STAGE_COUNT * buffers;
+
+  for (uint32_t i = 0; i < receivedCount; i++)
+  {
+    if ( received[i] != i )
+    {
+      errors++;
+    }
+  }
+  printf("samples %lu, received %lu, errors %lu, interrupts %lu\n",
+         (unsigned long)samplesSent, (unsigned long)receivedCount,
+         (unsigned long)errors, (unsigned long)interrupts);
+  printf("%lu buffers through %d stages: an interrupt-driven pipeline takes %lu "
+         "interrupts and %lu wake-ups, this one %lu\n",
+         (unsigned long)buffers, STAGE_COUNT, (unsigned long)irqDriven,
+         (unsigned long)irqDriven, (unsigned long)interrupts);
+  printf("%s\n", ((receivedCount == SAMPLE_COUNT) && (errors == 0) && (interrupts == 0))
+         ? "PASS" : "FAIL");
+}
+
+bool hostProducer(void)
+{
+  if ( txRegister != TX_EMPTY )
+  {
+    if ( receivedCount < SAMPLE_COUNT )
+    {
+      received[receivedCount++] = txRegister;
+    }
+    txRegister = TX_EMPTY;
+    idleCalls = 0;
+  }
+  else if ( samplesSent == SAMPLE_COUNT )
+  {
+    idleCalls++;
+  }
+
+  if ( (receivedCount == SAMPLE_COUNT) || (idleCalls == MAX_IDLE) )
+  {
+    report();
+    return false;
+  }
+
+  if ( samplesSent < SAMPLE_COUNT )
+  {
+    adcRegister = samplesSent++;
+    ldmaModelSignal(ldmaPeripheralSignal_ADC0_SINGLE, false);
+  }
+  ldmaModelSignal(ldmaPeripheralSignal_USART0_TXBL, false);
+  return true;
+}
+
+int main(void)
+{
+  ldmaPipeConfig_TypeDef config = {
+    .stageCount  = STAGE_COUNT,
+    .stage       = {
+      { 0, ldmaPeripheralSignal_ADC0_SINGLE, &adcRegister, NULL, ldmaCtrlBlockSizeUnit1, true },
+      { 1, ldmaPeripheralSignal_NONE, NULL, NULL, ldmaCtrlBlockSizeUnit4, false },
+      { 2, ldmaPeripheralSignal_USART0_TXBL, NULL, &txRegister, ldmaCtrlBlockSizeUnit1, false },
+    },
+    .size        = ldmaCtrlSizeWord,
+    .bufferCount = BUFFER_COUNT,
+    .length      = BUFFER_LENGTH,
+    .storage     = pipeBuffers,
+    .syncBase    = 0,
+  };
+
+  CHIP_Init();
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  if ( ldmaPipeInit(&pipe, &config) != ldmaPipeOk )
+  {
+    printf("ldmaPipeInit failed\n");
+    return 1;
+  }
+  ldmaPipeStart(&pipe);
+
+  /* No interrupt is expected: the run ends when the producer is done */
+  while (1)
+  {
+    EMU_EnterEM1();
+  }
+}
@@ -0,0 +1,77 @@
+/***************************************************************************//**
+ * @file  ldma_pipe.h
+ * @brief Multi-stage LDMA pipelines handed off with the SYNC bits
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef LDMA_PIPE_H
+#define LDMA_PIPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_ldma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LDMA_PIPE_MAX_STAGES    4
+#define LDMA_PIPE_MAX_BUFFERS   4
+
+// The LDMA has 8 SYNC bits, one per buffer between two stages
+#define LDMA_PIPE_SYNC_BITS     8
+
+typedef enum {
+  ldmaPipeOk,
+  ldmaPipeBadConfig,      // Stage or buffer count, or channel, not usable
+  ldmaPipeNoSyncBits      // More buffers between stages than SYNC bits
+} ldmaPipeStatus_TypeDef;
+
+// One channel moving a buffer at a time. The first stage reads 'src' and
+// the last one writes 'dst', both peripheral registers; the others read
+// and write the buffers between stages.
+typedef struct {
+  int channel;
+  LDMA_PeripheralSignal_t signal;   // Request, or ldmaPeripheralSignal_NONE to move
+                                    // a whole buffer as soon as it is ready
+  const volatile void *src;         // First stage only
+  volatile void *dst;               // Last stage only
+  LDMA_CtrlBlockSize_t blockSize;
+  bool ignoreSrec;                  // Ignore single requests, e.g. from the ADC
+} ldmaPipeStage_TypeDef;
+
+typedef struct {
+  uint32_t stageCount;
+  ldmaPipeStage_TypeDef stage[LDMA_PIPE_MAX_STAGES];
+  LDMA_CtrlSize_t size;             // Unit of all stages
+  uint32_t bufferCount;             // Buffers between two stages, 2 to LDMA_PIPE_MAX_BUFFERS
+  uint32_t length;                  // Units per buffer
+  void *storage;                    // stageCount - 1 times bufferCount buffers
+  uint32_t syncBase;                // First SYNC bit used
+} ldmaPipeConfig_TypeDef;
+
+typedef struct {
+  ldmaPipeConfig_TypeDef config;
+  // Per stage: wait for the first buffer, then a transfer and a hand-off
+  // for each buffer
+  LDMA_Descriptor_t desc[LDMA_PIPE_MAX_STAGES][1 + 2 * LDMA_PIPE_MAX_BUFFERS];
+} ldmaPipe_TypeDef;
+
+ldmaPipeStatus_TypeDef ldmaPipeInit(ldmaPipe_TypeDef *pipe, const ldmaPipeConfig_TypeDef *config);
+void ldmaPipeStart(ldmaPipe_TypeDef *pipe);
+void ldmaPipeStop(ldmaPipe_TypeDef *pipe);
+uint32_t ldmaPipeSyncMask(const ldmaPipe_TypeDef *pipe);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LDMA_PIPE_H
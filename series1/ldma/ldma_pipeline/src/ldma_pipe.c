@@ -0,0 +1,188 @@
+/***************************************************************************//**
+ * @file ldma_pipe.c
+ * @brief Multi-stage LDMA pipelines handed off with the SYNC bits.
+ *
+ * Each stage is a channel running an endless ring of descriptors, and
+ * between two stages there is a ring of buffers. One SYNC bit per buffer
+ * tells whether it is full: the stage that fills it sets the bit, the
+ * stage that empties it clears it. For buffer i, a stage runs:
+ *
+ *   transfer     buffer i of its input to buffer i of its output
+ *   hand-off     SYNC descriptor: clear the input bit of buffer i, set the
+ *                output bit, then wait until the input buffer i + 1 is
+ *                full and the output buffer i + 1 is empty
+ *
+ * The ring starts with a SYNC descriptor that clears the output bits and
+ * waits for buffer 0. A stage stalls while its next buffer is not ready,
+ * and resumes by itself when the neighbouring stage hands it over, so no
+ * interrupt or CPU wake-up is needed per buffer.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "ldma_pipe.h"
+
+/**************************************************************************//**
+ * @brief
+ *    SYNC bit of buffer 'index' between stages 'ring' and 'ring' + 1
+ *****************************************************************************/
+static uint32_t syncBit(const ldmaPipeConfig_TypeDef *config, uint32_t ring, uint32_t index)
+{
+  return 1UL << (config->syncBase + ring * config->bufferCount + index);
+}
+
+// Bits stage 'stage' waits on: its input full, and its output empty
+static uint32_t inputBit(const ldmaPipeConfig_TypeDef *config, uint32_t stage, uint32_t index)
+{
+  return (stage > 0) ? syncBit(config, stage - 1, index) : 0;
+}
+
+static uint32_t outputBit(const ldmaPipeConfig_TypeDef *config, uint32_t stage, uint32_t index)
+{
+  return (stage + 1 < config->stageCount) ? syncBit(config, stage, index) : 0;
+}
+
+static uint8_t *buffer(const ldmaPipeConfig_TypeDef *config, uint32_t ring, uint32_t index)
+{
+  return (uint8_t *)config->storage
+         + (((ring * config->bufferCount) + index) * config->length << config->size);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Build the descriptor ring of stage 'stage'
+ *****************************************************************************/
+static void buildStage(ldmaPipe_TypeDef *pipe, uint32_t stage)
+{
+  const ldmaPipeConfig_TypeDef *config = &pipe->config;
+  const ldmaPipeStage_TypeDef *s = &config->stage[stage];
+  LDMA_Descriptor_t *desc = pipe->desc[stage];
+  uint32_t count = config->bufferCount;
+  uint32_t outputs = 0;
+  uint32_t next, i;
+  const volatile void *src;
+  volatile void *dst;
+
+  for (i = 0; i < count; i++) {
+    outputs |= outputBit(config, stage, i);
+  }
+  desc[0] = (LDMA_Descriptor_t)
+    LDMA_DESCRIPTOR_LINKREL_SYNC(0, outputs, inputBit(config, stage, 0),
+                                 inputBit(config, stage, 0) | outputBit(config, stage, 0), 1);
+  desc[0].sync.doneIfs = 0;
+
+  for (i = 0; i < count; i++) {
+    src = (stage == 0) ? s->src : buffer(config, stage - 1, i);
+    dst = (stage + 1 == config->stageCount) ? s->dst : buffer(config, stage, i);
+    desc[1 + 2 * i] = (LDMA_Descriptor_t)
+      LDMA_DESCRIPTOR_LINKREL_M2M_BYTE(src, dst, config->length, 1);
+    desc[1 + 2 * i].xfer.size = config->size;
+    desc[1 + 2 * i].xfer.blockSize = s->blockSize;
+    desc[1 + 2 * i].xfer.doneIfs = 0;
+    desc[1 + 2 * i].xfer.ignoreSrec = s->ignoreSrec;
+    if (stage == 0) {
+      desc[1 + 2 * i].xfer.srcInc = ldmaCtrlSrcIncNone;
+    }
+    if (stage + 1 == config->stageCount) {
+      desc[1 + 2 * i].xfer.dstInc = ldmaCtrlDstIncNone;
+    }
+    if (s->signal != ldmaPeripheralSignal_NONE) {
+      // One block per peripheral request
+      desc[1 + 2 * i].xfer.reqMode = ldmaCtrlReqModeBlock;
+      desc[1 + 2 * i].xfer.structReq = 0;
+    }
+
+    // Hand buffer i over, wait for the next one; the last goes back to the
+    // first transfer
+    next = (i + 1) % count;
+    desc[2 + 2 * i] = (LDMA_Descriptor_t)
+      LDMA_DESCRIPTOR_LINKREL_SYNC(outputBit(config, stage, i), inputBit(config, stage, i),
+                                   inputBit(config, stage, next),
+                                   inputBit(config, stage, next) | outputBit(config, stage, next),
+                                   (next == 0) ? 1 - 2 * (int32_t)count : 1);
+    desc[2 + 2 * i].sync.doneIfs = 0;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Check the configuration and build the descriptors of all stages
+ *
+ * @note
+ *    The buffers and the SYNC bits between stages are used only by the
+ *    pipeline; the descriptors are kept in 'pipe', which must stay in RAM
+ *    while it runs
+ *****************************************************************************/
+ldmaPipeStatus_TypeDef ldmaPipeInit(ldmaPipe_TypeDef *pipe, const ldmaPipeConfig_TypeDef *config)
+{
+  uint32_t stage;
+
+  if ((config->stageCount < 2) || (config->stageCount > LDMA_PIPE_MAX_STAGES)
+      || (config->bufferCount < 2) || (config->bufferCount > LDMA_PIPE_MAX_BUFFERS)
+      || (config->length < 1) || (config->length > LDMA_DESCRIPTOR_MAX_XFER_SIZE)
+      || (config->storage == NULL)) {
+    return ldmaPipeBadConfig;
+  }
+  if (config->syncBase + (config->stageCount - 1) * config->bufferCount > LDMA_PIPE_SYNC_BITS) {
+    return ldmaPipeNoSyncBits;
+  }
+  for (stage = 0; stage < config->stageCount; stage++) {
+    if ((config->stage[stage].channel < 0) || (config->stage[stage].channel >= DMA_CHAN_COUNT)) {
+      return ldmaPipeBadConfig;
+    }
+  }
+
+  pipe->config = *config;
+  for (stage = 0; stage < config->stageCount; stage++) {
+    buildStage(pipe, stage);
+  }
+  return ldmaPipeOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start all stages, from the first one, each clearing the SYNC bits of
+ *    its output buffers before its consumer is started
+ *****************************************************************************/
+void ldmaPipeStart(ldmaPipe_TypeDef *pipe)
+{
+  const ldmaPipeStage_TypeDef *s;
+
+  for (uint32_t stage = 0; stage < pipe->config.stageCount; stage++) {
+    s = &pipe->config.stage[stage];
+    LDMA_TransferCfg_t cfg = LDMA_TRANSFER_CFG_PERIPHERAL(s->signal);
+    LDMA_StartTransfer(s->channel, &cfg, &pipe->desc[stage][0]);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Stop all stages. The data in the buffers is lost.
+ *****************************************************************************/
+void ldmaPipeStop(ldmaPipe_TypeDef *pipe)
+{
+  for (uint32_t stage = 0; stage < pipe->config.stageCount; stage++) {
+    LDMA_StopTransfer(pipe->config.stage[stage].channel);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    SYNC bits used by the pipeline, e.g. to watch LDMA->SYNC fill up when
+ *    a stage is too slow
+ *****************************************************************************/
+uint32_t ldmaPipeSyncMask(const ldmaPipe_TypeDef *pipe)
+{
+  const ldmaPipeConfig_TypeDef *config = &pipe->config;
+
+  return ((1UL << ((config->stageCount - 1) * config->bufferCount)) - 1) << config->syncBase;
+}
@@ -0,0 +1,205 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Pipeline Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_gpcrc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "ldma_pipe.h"
+
+/* DMA channels of the two stages, and PRS channel used for the example */
+#define ADC_LDMA_CHANNEL    0
+#define CRC_LDMA_CHANNEL    1
+#define PRS_CHANNEL         0
+
+/* Double buffering between the stages */
+#define BUFFER_COUNT        2
+#define BUFFER_LENGTH       16
+
+/* ADC clock for Series 1, and LETIMER clock and sample rate */
+#define ADC_FREQ            16000000
+#define LETIMER_CLK_FREQ    32768
+#define SAMPLE_RATE         1000
+
+/* ADC -> buffers -> GPCRC */
+ldmaPipe_TypeDef pipe;
+uint32_t pipeBuffers[BUFFER_COUNT][BUFFER_LENGTH];
+
+/* Values to watch in the debugger */
+ldmaPipeStatus_TypeDef pipeStatus;
+volatile uint32_t wakeups;
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler, only for errors: the stages hand the buffers over
+ *   without interrupts
+ ******************************************************************************/
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  /* Read interrupt source */
+  pending = LDMA_IntGet();
+
+  /* Clear interrupts */
+  LDMA_IntClear(pending);
+
+  /* Check for LDMA error */
+  if ( pending & LDMA_IF_ERROR )
+  {
+    /* Loop here to enable the debugger to see what has happened */
+    while (1);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   LETIMER initialization, pulses PRS_CHANNEL at SAMPLE_RATE.
+ ******************************************************************************/
+void initLetimer(void)
+{
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  /* Run the LETIMER from the LFRCO, also in EM2 */
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  /* Reload COMP0 on underflow, pulse output, and run in repeat mode */
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  /* Need REP0 != 0 to pulse on underflow */
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+  LETIMER_CompareSet(LETIMER0, 0, LETIMER_CLK_FREQ / SAMPLE_RATE);
+
+  /* Use LETIMER0 as async PRS source to trigger the ADC in EM2 */
+  CMU_ClockEnable(cmuClock_PRS, true);
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+                           PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   ADC initialization, single conversions of the temperature sensor started
+ *   by PRS_CHANNEL.
+ ******************************************************************************/
+void initAdc(void)
+{
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(cmuClock_ADC0, true);
+
+  /* Select AUXHFRCO for ADC ASYNC mode so it can run in EM2 */
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  /* Internal temperature sensor, so no pin differs between kits */
+  initSingle.posSel     = adcPosSelTEMP;
+  initSingle.reference  = adcRef1V25;
+  initSingle.resolution = adcRes12Bit;
+  initSingle.acqTime    = adcAcqTime256;
+
+  /* Conversions are started by PRS */
+  initSingle.prsEnable      = true;
+  initSingle.prsSel         = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+
+  ADC_Init(ADC0, &init);
+  ADC_InitSingle(ADC0, &initSingle);
+
+  /* Clear the single FIFO */
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   GPCRC initialization, CRC-32 of all the words written to INPUTDATA
+ ******************************************************************************/
+void initGpcrc(void)
+{
+  GPCRC_Init_TypeDef init = GPCRC_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_GPCRC, true);
+  GPCRC_Init(GPCRC, &init);
+  GPCRC_Start(GPCRC);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the LDMA and the pipeline: the ADC results into the
+ *   buffers, one per request, and each full buffer into the GPCRC at once.
+ ******************************************************************************/
+void initLdma(void)
+{
+  ldmaPipeConfig_TypeDef config = {
+    .stageCount  = 2,
+    .stage       = {
+      { ADC_LDMA_CHANNEL, ldmaPeripheralSignal_ADC0_SINGLE, &ADC0->SINGLEDATA, NULL,
+        ldmaCtrlBlockSizeUnit1, true },
+      { CRC_LDMA_CHANNEL, ldmaPeripheralSignal_NONE, NULL, &GPCRC->INPUTDATA,
+        ldmaCtrlBlockSizeUnit4, false },
+    },
+    .size        = ldmaCtrlSizeWord,
+    .bufferCount = BUFFER_COUNT,
+    .length      = BUFFER_LENGTH,
+    .storage     = pipeBuffers,
+    .syncBase    = 0,
+  };
+
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  pipeStatus = ldmaPipeInit(&pipe, &config);
+  if ( pipeStatus == ldmaPipeOk )
+  {
+    ldmaPipeStart(&pipe);
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  /* Chip errata */
+  CHIP_Init();
+
+  initGpcrc();
+  initLdma();
+  initAdc();
+  initLetimer();
+
+  /* The LDMA needs EM1. No interrupt is expected, so wakeups stays 0 */
+  while (1)
+  {
+    EMU_EnterEM1();
+    wakeups++;
+  }
+}
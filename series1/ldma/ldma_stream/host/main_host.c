@@ -0,0 +1,164 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Streaming on the host LDMA model, with a simulated peripheral
+ *
+ * Build with the models and the runner of ../../ldma_host_model, see
+ * readme.txt. hostProducer() plays the part of the ADC: each call puts the
+ * next sample in a data register and raises the LDMA request. The main loop
+ * consumes the stream, then stops consuming for a while to cause overruns,
+ * then changes the buffer length, and checks what the callback received.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "host.h"
+#include "ldma_stream.h"
+
+#define LDMA_CHANNEL        0
+
+#define BUFFER_COUNT        3
+#define MAX_LENGTH          64
+#define START_LENGTH        16
+#define NEW_LENGTH          8
+
+/* Samples sent: consumed, then not consumed, then consumed with NEW_LENGTH */
+#define STALL_START         (10 * START_LENGTH)
+#define STALL_END           (STALL_START + 5 * START_LENGTH)
+#define SAMPLE_COUNT        (STALL_END + 10 * NEW_LENGTH)
+
+ldmaStream_TypeDef stream;
+uint32_t streamBuffers[BUFFER_COUNT][MAX_LENGTH];
+
+/* Simulated ADC0->SINGLEDATA */
+volatile uint32_t sampleRegister;
+volatile uint32_t samplesSent;
+
+/* What the consumer saw */
+uint32_t expected;
+uint32_t buffers;
+uint32_t samples;
+uint32_t gaps;
+uint32_t errors;
+
+bool hostProducer(void)
+{
+  if ( samplesSent == SAMPLE_COUNT )
+  {
+    return false;
+  }
+  sampleRegister = samplesSent++;
+  ldmaModelSignal(ldmaPeripheralSignal_ADC0_SINGLE, false);
+  return true;
+}
+
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  if ( pending & LDMA_IF_ERROR )
+  {
+    errors++;
+  }
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check that samples arrive in order, with gaps only after an overrun.
+ ******************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint32_t *sample = data;
+  uint32_t i;
+
+  (void)user;
+
+  if ( overrun && (sample[0] != expected) )
+  {
+    gaps++;
+    expected = sample[0];
+  }
+  for (i = 0; i < length; i++)
+  {
+    if ( sample[i] != expected++ )
+    {
+      errors++;
+    }
+  }
+  buffers++;
+  samples += length;
+}
+
+int main(void)
+{
+  ldmaStreamConfig_TypeDef config;
+  bool resized = false;
+
+  CHIP_Init();
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &sampleRegister;
+  config.size        = ldmaCtrlSizeWord;
+  config.blockSize   = ldmaCtrlBlockSizeUnit1;
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = MAX_LENGTH;
+  config.length      = START_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if ( ldmaStreamInit(&stream, &config) != ldmaStreamOk )
+  {
+    printf("ldmaStreamInit failed\n");
+    return 1;
+  }
+  ldmaStreamStart(&stream);
+
+  while ( (samplesSent < SAMPLE_COUNT) || (ldmaStreamReady(&stream) != 0) )
+  {
+    EMU_EnterEM1();
+
+    /* The consumer is too slow between STALL_START and STALL_END */
+    if ( (samplesSent <= STALL_START) || (samplesSent >= STALL_END) )
+    {
+      ldmaStreamProcess(&stream);
+    }
+    if ( (samplesSent >= STALL_END) && !resized )
+    {
+      ldmaStreamResize(&stream, NEW_LENGTH);
+      resized = true;
+    }
+  }
+
+  /* 10 buffers, 2 of the 5 sent during the stall, then 10 short buffers */
+  printf("buffers %lu, samples %lu, overruns %lu, gaps %lu, errors %lu\n",
+         (unsigned long)buffers, (unsigned long)samples,
+         (unsigned long)ldmaStreamOverruns(&stream), (unsigned long)gaps,
+         (unsigned long)errors);
+  printf("%s\n", ((buffers == 22) && (samples == 272) && (gaps == 1)
+                  && (ldmaStreamOverruns(&stream) == 3) && (errors == 0))
+         ? "PASS" : "FAIL");
+  return 0;
+}
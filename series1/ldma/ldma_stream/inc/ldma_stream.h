@@ -0,0 +1,92 @@
+/***************************************************************************//**
+ * @file  ldma_stream.h
+ * @brief Double or triple buffered peripheral-to-memory streaming on the LDMA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef LDMA_STREAM_H
+#define LDMA_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_ldma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change this to allow more buffers per stream
+#define LDMA_STREAM_MAX_BUFFERS   4
+
+typedef enum {
+  ldmaStreamOk,
+  ldmaStreamBadConfig,      // Buffer count, unit size or storage not usable
+  ldmaStreamBadLength       // Buffer length 0 or above the configured maximum
+} ldmaStreamStatus_TypeDef;
+
+// Called with each filled buffer, in order. The data is still in the
+// stream's buffer and is given back to the LDMA when the callback returns.
+// 'overrun' is true if buffers were lost since the previous call.
+typedef void (*ldmaStreamCallback_TypeDef)(const void *data, uint32_t length,
+                                           bool overrun, void *user);
+
+typedef struct {
+  int channel;
+  LDMA_PeripheralSignal_t signal;     // Peripheral request, e.g. ADC0_SINGLE
+  const volatile void *source;        // Peripheral data register
+  LDMA_CtrlSize_t size;               // Unit size of the data register
+  LDMA_CtrlBlockSize_t blockSize;     // Units per request, e.g. the FIFO DVL
+  bool ignoreSrec;                    // Ignore single requests
+  void *storage;                      // bufferCount * maxLength units
+  uint32_t bufferCount;               // 2 for double, 3 for triple buffering
+  uint32_t maxLength;                 // Units each buffer can hold
+  uint32_t length;                    // Units per buffer, at most maxLength
+  ldmaStreamCallback_TypeDef callback;
+  void *user;                         // Passed to the callback
+} ldmaStreamConfig_TypeDef;
+
+// Each buffer is filled by a transfer descriptor followed by a write
+// descriptor, which stores the buffer number in 'done' and raises the
+// channel's interrupt
+typedef struct {
+  LDMA_Descriptor_t desc[2 * LDMA_STREAM_MAX_BUFFERS];
+  ldmaStreamConfig_TypeDef config;
+  uint32_t unitBytes;
+  uint32_t bufferLength[LDMA_STREAM_MAX_BUFFERS];  // Units in each buffer
+  volatile uint32_t done;       // Last buffer filled, written by the LDMA
+  volatile uint32_t fill;       // Buffer being filled
+  volatile uint32_t tail;       // Oldest filled buffer
+  volatile uint32_t ready;      // Filled buffers not yet consumed
+  volatile uint32_t overruns;   // Buffers lost
+  volatile bool lost;           // Buffers lost since the last callback
+  volatile bool busy;           // Callback running on the tail buffer
+  volatile bool dropped;        // Tail buffer was lost during the callback
+  bool running;
+} ldmaStream_TypeDef;
+
+ldmaStreamStatus_TypeDef ldmaStreamInit(ldmaStream_TypeDef *stream,
+                                        const ldmaStreamConfig_TypeDef *config);
+void ldmaStreamStart(ldmaStream_TypeDef *stream);
+void ldmaStreamStop(ldmaStream_TypeDef *stream);
+ldmaStreamStatus_TypeDef ldmaStreamResize(ldmaStream_TypeDef *stream,
+                                          uint32_t length);
+
+void ldmaStreamIrqHandler(ldmaStream_TypeDef *stream, uint32_t pending);
+uint32_t ldmaStreamProcess(ldmaStream_TypeDef *stream);
+
+uint32_t ldmaStreamReady(const ldmaStream_TypeDef *stream);
+uint32_t ldmaStreamOverruns(const ldmaStream_TypeDef *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LDMA_STREAM_H
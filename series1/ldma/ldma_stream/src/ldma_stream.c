@@ -0,0 +1,275 @@
+/***************************************************************************//**
+ * @file ldma_stream.c
+ * @brief Double or triple buffered peripheral-to-memory streaming on the LDMA.
+ *
+ * The buffers are filled in turn by a ring of descriptors. Each transfer
+ * descriptor is followed by a write descriptor that stores the number of
+ * the buffer just filled and raises the interrupt, so the interrupt handler
+ * knows exactly how many buffers were filled even when interrupts were late.
+ *
+ * When all buffers are filled and not consumed, the LDMA moves on to the
+ * oldest one: that buffer is counted as an overrun and its data is dropped,
+ * so the consumer always gets the most recent data, in order.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "em_core.h"
+#include "ldma_stream.h"
+
+static uint32_t next(const ldmaStream_TypeDef *stream, uint32_t index)
+{
+  return (index + 1 < stream->config.bufferCount) ? index + 1 : 0;
+}
+
+static uint8_t *buffer(const ldmaStream_TypeDef *stream, uint32_t index)
+{
+  return (uint8_t *)stream->config.storage
+         + (index * stream->config.maxLength * stream->unitBytes);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Account for the buffers the LDMA has filled since the last call
+ *
+ * @note
+ *    Called with interrupts disabled or from the LDMA interrupt
+ *****************************************************************************/
+static void collect(ldmaStream_TypeDef *stream)
+{
+  uint32_t last = stream->done;
+
+  while (stream->fill != next(stream, last)) {
+    stream->bufferLength[stream->fill] = stream->config.length;
+    stream->fill = next(stream, stream->fill);
+    stream->ready++;
+
+    // The LDMA is now filling the oldest buffer not consumed, drop it
+    if (stream->ready == stream->config.bufferCount) {
+      if (stream->busy) {
+        stream->dropped = true;
+      }
+      stream->tail = next(stream, stream->tail);
+      stream->ready--;
+      stream->overruns++;
+      stream->lost = true;
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the ring at the descriptors of buffer 'index'
+ *****************************************************************************/
+static void startAt(ldmaStream_TypeDef *stream, uint32_t index)
+{
+  LDMA_TransferCfg_t transfer =
+    (LDMA_TransferCfg_t)LDMA_TRANSFER_CFG_PERIPHERAL(stream->config.signal);
+
+  // The buffer before 'index' counts as the last one filled
+  stream->done = (index == 0) ? stream->config.bufferCount - 1 : index - 1;
+  stream->fill = index;
+  stream->running = true;
+  LDMA_StartTransfer(stream->config.channel, &transfer, &stream->desc[2 * index]);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Check the configuration and build the descriptor ring
+ *
+ * @note
+ *    The stream keeps a copy of the configuration, but uses the storage in
+ *    place
+ *****************************************************************************/
+ldmaStreamStatus_TypeDef ldmaStreamInit(ldmaStream_TypeDef *stream,
+                                        const ldmaStreamConfig_TypeDef *config)
+{
+  uint32_t count = config->bufferCount;
+
+  if ((count < 2) || (count > LDMA_STREAM_MAX_BUFFERS)
+      || (config->size > ldmaCtrlSizeWord) || (config->storage == NULL)
+      || (config->callback == NULL)) {
+    return ldmaStreamBadConfig;
+  }
+  if (((uintptr_t)config->storage & ((1UL << config->size) - 1)) != 0) {
+    return ldmaStreamBadConfig;
+  }
+  if ((config->maxLength == 0) || (config->maxLength > LDMA_DESCRIPTOR_MAX_XFER_SIZE)) {
+    return ldmaStreamBadConfig;
+  }
+  if ((config->length == 0) || (config->length > config->maxLength)) {
+    return ldmaStreamBadLength;
+  }
+
+  stream->config = *config;
+  stream->unitBytes = 1UL << config->size;
+  stream->tail = 0;
+  stream->ready = 0;
+  stream->overruns = 0;
+  stream->lost = false;
+  stream->busy = false;
+  stream->dropped = false;
+  stream->running = false;
+
+  for (uint32_t i = 0; i < count; i++) {
+    // Fill buffer i from the data register, without an interrupt
+    stream->desc[2 * i] = (LDMA_Descriptor_t)
+      LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(config->source, buffer(stream, i), config->length, 1);
+    stream->desc[2 * i].xfer.size = config->size;
+    stream->desc[2 * i].xfer.blockSize = config->blockSize;
+    stream->desc[2 * i].xfer.ignoreSrec = config->ignoreSrec;
+    stream->desc[2 * i].xfer.doneIfs = 0;
+
+    // Then record it and interrupt, the last buffer links back to the first
+    stream->desc[2 * i + 1] = (LDMA_Descriptor_t)
+      LDMA_DESCRIPTOR_LINKREL_WRITE(i, &stream->done,
+                                    (i == count - 1) ? 1 - (int32_t)(2 * count) : 1);
+  }
+  return ldmaStreamOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start filling the buffers from the first one, buffers not yet
+ *    consumed are dropped
+ *****************************************************************************/
+void ldmaStreamStart(ldmaStream_TypeDef *stream)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  stream->tail = 0;
+  stream->ready = 0;
+  stream->lost = false;
+  startAt(stream, 0);
+  CORE_EXIT_ATOMIC();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Stop the LDMA channel, the buffers filled so far can still be
+ *    consumed
+ *****************************************************************************/
+void ldmaStreamStop(ldmaStream_TypeDef *stream)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (stream->running) {
+    LDMA_StopTransfer(stream->config.channel);
+    collect(stream);
+    stream->running = false;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Change the number of units per buffer
+ *
+ * @details
+ *    Descriptors are only changed while the channel is stopped, so a
+ *    running stream is stopped and restarted: the units already in the
+ *    buffer being filled are dropped, and that buffer is filled again with
+ *    the new length. Filled buffers not yet consumed keep their length.
+ *****************************************************************************/
+ldmaStreamStatus_TypeDef ldmaStreamResize(ldmaStream_TypeDef *stream,
+                                          uint32_t length)
+{
+  bool running = stream->running;
+  CORE_DECLARE_IRQ_STATE;
+
+  if ((length == 0) || (length > stream->config.maxLength)) {
+    return ldmaStreamBadLength;
+  }
+
+  CORE_ENTER_ATOMIC();
+  ldmaStreamStop(stream);
+  stream->config.length = length;
+  for (uint32_t i = 0; i < stream->config.bufferCount; i++) {
+    stream->desc[2 * i].xfer.xferCnt = length - 1;
+  }
+  if (running) {
+    startAt(stream, stream->fill);
+  }
+  CORE_EXIT_ATOMIC();
+  return ldmaStreamOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Call from LDMA_IRQHandler() with the pending interrupt flags
+ *****************************************************************************/
+void ldmaStreamIrqHandler(ldmaStream_TypeDef *stream, uint32_t pending)
+{
+  if (pending & (1UL << stream->config.channel)) {
+    collect(stream);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Pass the filled buffers to the callback, oldest first
+ *
+ * @details
+ *    Call from the main loop. The callback runs with interrupts enabled, on
+ *    the data in place; the buffer is given back to the LDMA when it
+ *    returns.
+ *
+ * @return
+ *    The number of buffers passed to the callback
+ *****************************************************************************/
+uint32_t ldmaStreamProcess(ldmaStream_TypeDef *stream)
+{
+  uint32_t consumed = 0;
+  uint32_t index, length;
+  bool overrun;
+  CORE_DECLARE_IRQ_STATE;
+
+  for (;; ) {
+    CORE_ENTER_ATOMIC();
+    if (stream->ready == 0) {
+      CORE_EXIT_ATOMIC();
+      break;
+    }
+    index = stream->tail;
+    length = stream->bufferLength[index];
+    overrun = stream->lost;
+    stream->lost = false;
+    stream->busy = true;
+    stream->dropped = false;
+    CORE_EXIT_ATOMIC();
+
+    stream->config.callback(buffer(stream, index), length, overrun, stream->config.user);
+    consumed++;
+
+    // A buffer dropped during the callback was already taken off the queue
+    CORE_ENTER_ATOMIC();
+    stream->busy = false;
+    if (!stream->dropped) {
+      stream->tail = next(stream, stream->tail);
+      stream->ready--;
+    }
+    CORE_EXIT_ATOMIC();
+  }
+  return consumed;
+}
+
+uint32_t ldmaStreamReady(const ldmaStream_TypeDef *stream)
+{
+  return stream->ready;
+}
+
+uint32_t ldmaStreamOverruns(const ldmaStream_TypeDef *stream)
+{
+  return stream->overruns;
+}
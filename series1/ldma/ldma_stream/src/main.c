@@ -0,0 +1,236 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Streaming Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "ldma_stream.h"
+
+/* DMA channel and PRS channel used for the example */
+#define LDMA_CHANNEL        0
+#define PRS_CHANNEL         0
+
+/* Triple buffering, each buffer can hold up to MAX_LENGTH samples */
+#define BUFFER_COUNT        3
+#define MAX_LENGTH          64
+#define START_LENGTH        16
+
+/* ADC clock for Series 1, and LETIMER clock and sample rate */
+#define ADC_FREQ            16000000
+#define LETIMER_CLK_FREQ    32768
+#define SAMPLE_RATE         1000
+
+/* Stream of ADC samples */
+ldmaStream_TypeDef stream;
+uint32_t streamBuffers[BUFFER_COUNT][MAX_LENGTH];
+
+/* Values to watch and change in the debugger */
+volatile uint32_t requestedLength = START_LENGTH;
+volatile uint32_t bufferCount;
+volatile uint32_t gapCount;
+volatile uint32_t lastAverage;
+ldmaStreamStatus_TypeDef streamStatus;
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler.
+ ******************************************************************************/
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  /* Read interrupt source */
+  pending = LDMA_IntGet();
+
+  /* Clear interrupts */
+  LDMA_IntClear(pending);
+
+  /* Check for LDMA error */
+  if ( pending & LDMA_IF_ERROR )
+  {
+    /* Loop here to enable the debugger to see what has happened */
+    while (1);
+  }
+
+  /* Account for the buffers filled, they are consumed in the main loop */
+  ldmaStreamIrqHandler(&stream, pending);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Stream consumer, averages each buffer of samples in place.
+ ******************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint32_t *samples = data;
+  uint32_t i, sum = 0;
+
+  (void)user;
+
+  for (i = 0; i < length; i++)
+  {
+    sum += samples[i];
+  }
+  lastAverage = sum / length;
+
+  bufferCount++;
+  if ( overrun )
+  {
+    gapCount++;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   LETIMER initialization, pulses PRS_CHANNEL at SAMPLE_RATE.
+ ******************************************************************************/
+void initLetimer(void)
+{
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  /* Run the LETIMER from the LFRCO, also in EM2 */
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+  CMU_ClockEnable(cmuClock_HFLE, true);
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  /* Reload COMP0 on underflow, pulse output, and run in repeat mode */
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  /* Need REP0 != 0 to pulse on underflow */
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+  LETIMER_CompareSet(LETIMER0, 0, LETIMER_CLK_FREQ / SAMPLE_RATE);
+
+  /* Use LETIMER0 as async PRS source to trigger the ADC in EM2 */
+  CMU_ClockEnable(cmuClock_PRS, true);
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+                           PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   ADC initialization, single conversions of the temperature sensor started
+ *   by PRS_CHANNEL.
+ ******************************************************************************/
+void initAdc(void)
+{
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(cmuClock_ADC0, true);
+
+  /* Select AUXHFRCO for ADC ASYNC mode so it can run in EM2 */
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  /* Internal temperature sensor, so no pin differs between kits */
+  initSingle.posSel     = adcPosSelTEMP;
+  initSingle.reference  = adcRef1V25;
+  initSingle.resolution = adcRes12Bit;
+  initSingle.acqTime    = adcAcqTime256;
+
+  /* Conversions are started by PRS, and the LDMA wakes up in EM2 to read
+     each result */
+  initSingle.prsEnable      = true;
+  initSingle.prsSel         = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  initSingle.singleDmaEm2Wu = true;
+
+  ADC_Init(ADC0, &init);
+  ADC_InitSingle(ADC0, &initSingle);
+
+  /* Clear the single FIFO */
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the LDMA and the stream of ADC samples.
+ ******************************************************************************/
+void initLdma(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  /* One ADC result per request into 3 buffers of START_LENGTH words */
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = ldmaCtrlSizeWord;
+  config.blockSize   = ldmaCtrlBlockSizeUnit1;
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = MAX_LENGTH;
+  config.length      = START_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  streamStatus = ldmaStreamInit(&stream, &config);
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t length = START_LENGTH;
+
+  /* Chip errata */
+  CHIP_Init();
+
+  /* Init DCDC regulator if available */
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  initAdc();
+  initLdma();
+  if ( streamStatus == ldmaStreamOk )
+  {
+    ldmaStreamStart(&stream);
+  }
+  initLetimer();
+
+  while (1)
+  {
+    EMU_EnterEM2(false);
+
+    /* Average the filled buffers */
+    ldmaStreamProcess(&stream);
+
+    /* Buffer length changed from the debugger */
+    if ( requestedLength != length )
+    {
+      streamStatus = ldmaStreamResize(&stream, requestedLength);
+      length = requestedLength;
+    }
+  }
+}
@@ -0,0 +1,256 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Strided Copy on the host LDMA model
+ *
+ * Build with the models and the runner of ../../ldma_host_model, see
+ * readme.txt. Each copy is done by the LDMA model and by ldmaCopyCpu() into
+ * destinations filled the same way, and the whole destinations are
+ * compared, so that writes outside the copy are found too. The shapes cover
+ * 2D copies, transposes, gathers, 3D copies, fills, negative strides, loop
+ * axes longer than one block and rows longer than one descriptor.
+ *
+ * Then the tile sizes of the kit benchmark are copied and transposed, and
+ * the model cycles are printed next to an estimate of the CPU loop.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "ldma_copy.h"
+
+#define LDMA_CHANNEL        0
+
+#define MEMORY_SIZE         16384
+
+/* Image of the benchmark, in uint16_t */
+#define IMAGE_WIDTH         64
+
+/* Cortex-M4 cycles of the ldmaCopyCpu() loop, estimated from its code:
+ * load, store and two pointer updates per element, and the address
+ * computations per row */
+#define CPU_CYCLES_PER_ELEMENT  6
+#define CPU_CYCLES_PER_ROW      12
+
+ldmaCopy_TypeDef copy;
+
+uint32_t srcMemory[MEMORY_SIZE / 4];
+uint32_t dmaMemory[MEMORY_SIZE / 4];
+uint32_t cpuMemory[MEMORY_SIZE / 4];
+
+uint32_t errors;
+
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  if ( pending & LDMA_IF_ERROR )
+  {
+    errors++;
+  }
+  ldmaCopyIrqHandler(&copy, pending);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy with the LDMA from byte 'srcOffset' of the source to byte
+ *   'dstOffset' of the destination, and with the CPU, then compare.
+ *
+ * @return
+ *   Model cycles of the LDMA copy
+ ******************************************************************************/
+static uint64_t check(const char *name, uint32_t srcOffset, uint32_t dstOffset,
+                      const ldmaCopyShape_TypeDef *shape)
+{
+  uint8_t *src = (uint8_t *)srcMemory;
+  dmaModelStats_TypeDef before, after;
+  ldmaCopyStatus_TypeDef status;
+
+  memset(dmaMemory, 0xA5, sizeof(dmaMemory));
+  memset(cpuMemory, 0xA5, sizeof(cpuMemory));
+
+  ldmaModelGetStats(&before);
+  status = ldmaCopyStart(&copy, (uint8_t *)dmaMemory + dstOffset, src + srcOffset, shape);
+  while ( (status == ldmaCopyOk) && !ldmaCopyDone(&copy) )
+  {
+    EMU_EnterEM1();
+  }
+  ldmaModelGetStats(&after);
+
+  ldmaCopyCpu((uint8_t *)cpuMemory + dstOffset, src + srcOffset, shape);
+
+  if ( (status != ldmaCopyOk) || (memcmp(dmaMemory, cpuMemory, sizeof(dmaMemory)) != 0) )
+  {
+    printf("%-28s FAIL (status %d)\n", name, (int)status);
+    errors++;
+  }
+  else if ( name[0] != 0 )
+  {
+    printf("%-28s ok, %llu cycles\n", name, (unsigned long long)(after.cycles - before.cycles));
+  }
+  return after.cycles - before.cycles;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy with the CPU below the threshold, without the LDMA
+ ******************************************************************************/
+static void checkThreshold(void)
+{
+  ldmaCopyShape_TypeDef shape;
+  dmaModelStats_TypeDef before, after;
+
+  ldmaCopyInit(&copy, LDMA_CHANNEL, 64);
+  ldmaCopyShape2d(&shape, 2, 8, 8, IMAGE_WIDTH, 8);
+  ldmaModelGetStats(&before);
+  check("8x8 below threshold", 0, 0, &shape);
+  ldmaModelGetStats(&after);
+  if ( after.dataReads != before.dataReads )
+  {
+    printf("threshold ignored\n");
+    errors++;
+  }
+  ldmaCopyInit(&copy, LDMA_CHANNEL, 0);
+}
+
+static void checkShapes(void)
+{
+  ldmaCopyShape_TypeDef shape;
+
+  ldmaCopyShape2d(&shape, 2, 16, 16, IMAGE_WIDTH, IMAGE_WIDTH);
+  check("2d 16x16 half", 2 * (3 * IMAGE_WIDTH + 5), 2 * 7, &shape);
+
+  ldmaCopyShape2d(&shape, 1, 7, 9, 13, 7);
+  check("2d 7x9 byte, packed dst", 3, 1, &shape);
+
+  ldmaCopyShape2d(&shape, 4, 32, 20, 32, 32);
+  check("2d 32x20 word, contiguous", 0, 0, &shape);
+
+  ldmaCopyShapeTranspose(&shape, 2, 16, 8, IMAGE_WIDTH, 8);
+  check("transpose 16x8 half", 0, 0, &shape);
+
+  ldmaCopyShapeTranspose(&shape, 1, 300, 2, 300, 2);
+  check("transpose 300x2 byte", 0, 0, &shape);
+
+  ldmaCopyShapeGather(&shape, 2, 100, 2);
+  check("gather every 2nd", 2, 0, &shape);
+
+  ldmaCopyShapeGather(&shape, 4, 100, 3);
+  check("gather every 3rd", 0, 8, &shape);
+
+  /* Fill: the source does not move */
+  ldmaCopyShape2d(&shape, 4, 10, 10, 0, 12);
+  shape.srcStride[0] = 0;
+  check("fill 10x10 word", 4, 0, &shape);
+
+  /* Rows in reverse order: start at the last row */
+  ldmaCopyShape2d(&shape, 2, 20, 30, IMAGE_WIDTH, 20);
+  shape.srcStride[1] = -shape.srcStride[1];
+  check("2d flipped", 2 * 29 * IMAGE_WIDTH, 0, &shape);
+
+  /* Elements in reverse order: no increment fits, one per descriptor */
+  ldmaCopyShape2d(&shape, 2, 20, 3, 20, 20);
+  shape.srcStride[0] = -2;
+  check("2d mirrored", 2 * 19, 0, &shape);
+
+  /* 3D: planes of 5x4 words, 6 of them */
+  shape.elemSize = 4;
+  shape.count[0] = 5;
+  shape.count[1] = 4;
+  shape.count[2] = 6;
+  shape.srcStride[0] = 4;
+  shape.srcStride[1] = 4 * 8;
+  shape.srcStride[2] = 4 * 8 * 5;
+  shape.dstStride[0] = 4;
+  shape.dstStride[1] = 4 * 5;
+  shape.dstStride[2] = 4 * 5 * 4 + 8;
+  check("3d 5x4x6 word", 4, 0, &shape);
+
+  /* 3D with the run on the outer axis */
+  shape.elemSize = 1;
+  shape.count[0] = 3;
+  shape.count[1] = 4;
+  shape.count[2] = 50;
+  shape.srcStride[0] = 200;
+  shape.srcStride[1] = 50;
+  shape.srcStride[2] = 1;
+  shape.dstStride[0] = 100;
+  shape.dstStride[1] = 1000;
+  shape.dstStride[2] = 2;
+  check("3d run on axis 2", 0, 0, &shape);
+
+  /* 600 rows: three blocks of the loop axis */
+  ldmaCopyShape2d(&shape, 1, 2, 600, 5, 3);
+  check("2d 2x600 byte", 0, 0, &shape);
+
+  /* Rows longer than one descriptor */
+  ldmaCopyShape2d(&shape, 1, 5000, 2, 5003, 5100);
+  check("2d 5000x2 byte", 0, 0, &shape);
+
+  ldmaCopyShape2d(&shape, 2, 2100, 3, 2100, 2200);
+  check("2d 2100x3 half", 0, 0, &shape);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Tiles of the kit benchmark
+ ******************************************************************************/
+static void benchmark(void)
+{
+  static const uint32_t tiles[] = { 1, 2, 4, 8, 16, 32 };
+  ldmaCopyShape_TypeDef shape;
+  uint64_t copyCycles, transposeCycles, cpuCycles;
+  uint32_t n;
+
+  printf("\ntile   copy  transpose   cpu (est.)\n");
+  for (uint32_t i = 0; i < sizeof(tiles) / sizeof(tiles[0]); i++)
+  {
+    n = tiles[i];
+    ldmaCopyShape2d(&shape, 2, n, n, IMAGE_WIDTH, n);
+    copyCycles = check("", 0, 0, &shape);
+    ldmaCopyShapeTranspose(&shape, 2, n, n, IMAGE_WIDTH, n);
+    transposeCycles = check("", 0, 0, &shape);
+    cpuCycles = (uint64_t)n * n * CPU_CYCLES_PER_ELEMENT + n * CPU_CYCLES_PER_ROW;
+    printf("%4lu %6llu %10llu %12llu\n", (unsigned long)n,
+           (unsigned long long)copyCycles, (unsigned long long)transposeCycles,
+           (unsigned long long)cpuCycles);
+  }
+}
+
+int main(void)
+{
+  CHIP_Init();
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  ldmaChainPoolInit();
+  for (uint32_t i = 0; i < MEMORY_SIZE; i++)
+  {
+    ((uint8_t *)srcMemory)[i] = (uint8_t)(i * 7 + (i >> 8));
+  }
+
+  ldmaCopyInit(&copy, LDMA_CHANNEL, 0);
+  checkShapes();
+  checkThreshold();
+  benchmark();
+
+  printf("\nerrors %lu\n%s\n", (unsigned long)errors, (errors == 0) ? "PASS" : "FAIL");
+  return 0;
+}
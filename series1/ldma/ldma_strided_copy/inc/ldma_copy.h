@@ -0,0 +1,86 @@
+/***************************************************************************//**
+ * @file  ldma_copy.h
+ * @brief Strided 1D to 3D copy, transpose and gather on the LDMA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef LDMA_COPY_H
+#define LDMA_COPY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_ldma.h"
+#include "ldma_chain.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LDMA_COPY_MAX_DIMS    3
+
+// Note: change this to set how many units the LDMA moves per arbitration
+#define LDMA_COPY_BLOCK_SIZE  ldmaCtrlBlockSizeUnit8
+
+typedef enum {
+  ldmaCopyOk,
+  ldmaCopyBadShape,       // Element size, count or alignment not usable
+  ldmaCopyBusy,           // Previous copy of this channel not done
+  ldmaCopyNoMemory        // Descriptor pool too small for the rows
+} ldmaCopyStatus_TypeDef;
+
+// Elements along up to 3 axes, axis 0 the innermost. Strides are in bytes
+// and can be negative or 0; unused axes have a count of 1.
+typedef struct {
+  uint32_t elemSize;                        // 1, 2 or 4 bytes
+  uint32_t count[LDMA_COPY_MAX_DIMS];
+  int32_t srcStride[LDMA_COPY_MAX_DIMS];
+  int32_t dstStride[LDMA_COPY_MAX_DIMS];
+} ldmaCopyShape_TypeDef;
+
+// A copy is split in blocks of rows that the LDMA runs with one counted
+// loop each. The blocks are started in turn from the LDMA interrupt.
+typedef struct {
+  int channel;
+  uint32_t cpuThreshold;          // Copies of this many elements or fewer use the CPU
+  ldmaChain_TypeDef chain;        // Descriptors of the running block
+  ldmaCopyShape_TypeDef shape;    // Axes reordered: run, loop, then outer axes
+  bool run;                       // Axis 0 of 'shape' is moved by one descriptor
+  const uint8_t *src;
+  uint8_t *dst;
+  uint32_t pieces;                // Descriptors per row
+  uint32_t loopBlocks;            // Blocks along the loop axis
+  uint32_t block;                 // Block running
+  uint32_t blockCount;
+  volatile uint32_t done;         // Written by the LDMA at the end of each block
+  volatile bool busy;
+} ldmaCopy_TypeDef;
+
+void ldmaCopyInit(ldmaCopy_TypeDef *copy, int channel, uint32_t cpuThreshold);
+ldmaCopyStatus_TypeDef ldmaCopyStart(ldmaCopy_TypeDef *copy, void *dst, const void *src,
+                                     const ldmaCopyShape_TypeDef *shape);
+void ldmaCopyIrqHandler(ldmaCopy_TypeDef *copy, uint32_t pending);
+bool ldmaCopyDone(const ldmaCopy_TypeDef *copy);
+void ldmaCopyCpu(void *dst, const void *src, const ldmaCopyShape_TypeDef *shape);
+
+void ldmaCopyShape2d(ldmaCopyShape_TypeDef *shape, uint32_t elemSize,
+                     uint32_t width, uint32_t height,
+                     uint32_t srcPitch, uint32_t dstPitch);
+void ldmaCopyShapeTranspose(ldmaCopyShape_TypeDef *shape, uint32_t elemSize,
+                            uint32_t width, uint32_t height,
+                            uint32_t srcPitch, uint32_t dstPitch);
+void ldmaCopyShapeGather(ldmaCopyShape_TypeDef *shape, uint32_t elemSize,
+                         uint32_t count, uint32_t srcStep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LDMA_COPY_H
@@ -0,0 +1,402 @@
+/***************************************************************************//**
+ * @file ldma_copy.c
+ * @brief Strided 1D to 3D copy, transpose and gather on the LDMA.
+ *
+ * The axes of a copy are reordered so that the innermost one, the run, has
+ * strides the LDMA can increment by (0, 1, 2 or 4 elements); one descriptor
+ * then moves a whole row. The next axis is looped with the channel loop
+ * counter, each pass adding the row gap as relative addresses, so one block
+ * of up to 257 rows takes:
+ *
+ *   row 0        descriptors with absolute addresses
+ *   rows 1..n    descriptors with relative addresses, looped
+ *   end          write descriptor that marks the block done
+ *
+ * Runs longer than LDMA_DESCRIPTOR_MAX_XFER_SIZE take more descriptors per
+ * row. There is one loop counter per channel, so longer loop axes and the
+ * outer axis are split into blocks, started in turn from the interrupt.
+ * When no axis suits the LDMA, as for a transpose, each row is a single
+ * element. Small copies are done by the CPU, which is faster than setting
+ * up descriptors.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "ldma_copy.h"
+
+// Rows per block: one with absolute addresses, then up to 256 passes of the
+// loop
+#define ROWS_PER_BLOCK  (2 + (_LDMA_CH_LOOP_LOOPCNT_MASK >> _LDMA_CH_LOOP_LOOPCNT_SHIFT))
+
+static const LDMA_TransferCfg_t memTransfer = LDMA_TRANSFER_CFG_MEMORY();
+
+/**************************************************************************//**
+ * @brief
+ *    LDMA increment for 'stride', or -1 if the LDMA cannot step by it
+ *****************************************************************************/
+static int increment(int32_t stride, uint32_t elemSize)
+{
+  if (stride == 0) {
+    return ldmaCtrlSrcIncNone;
+  } else if (stride == (int32_t)elemSize) {
+    return ldmaCtrlSrcIncOne;
+  } else if (stride == 2 * (int32_t)elemSize) {
+    return ldmaCtrlSrcIncTwo;
+  } else if (stride == 4 * (int32_t)elemSize) {
+    return ldmaCtrlSrcIncFour;
+  }
+  return -1;
+}
+
+static uint32_t loopAxis(const ldmaCopy_TypeDef *copy)
+{
+  return copy->run ? 1 : 0;
+}
+
+static uint32_t runLength(const ldmaCopy_TypeDef *copy)
+{
+  return copy->run ? copy->shape.count[0] : 1;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Reorder the axes of 'shape' into 'copy': the run first if there is
+ *    one, then the others from the innermost. Consecutive rows that are
+ *    contiguous are merged into a longer run.
+ *****************************************************************************/
+static void plan(ldmaCopy_TypeDef *copy, const ldmaCopyShape_TypeDef *shape)
+{
+  uint32_t order[LDMA_COPY_MAX_DIMS] = { 0, 1, 2 };
+  uint32_t axis, i;
+  ldmaCopyShape_TypeDef *s = &copy->shape;
+
+  copy->run = false;
+  for (axis = 0; axis < LDMA_COPY_MAX_DIMS; axis++) {
+    if ((shape->count[axis] > 1)
+        && (increment(shape->srcStride[axis], shape->elemSize) >= 0)
+        && (increment(shape->dstStride[axis], shape->elemSize) >= 0)) {
+      copy->run = true;
+      break;
+    }
+  }
+  if (copy->run) {
+    for (i = axis; i > 0; i--) {
+      order[i] = order[i - 1];
+    }
+    order[0] = axis;
+  }
+
+  s->elemSize = shape->elemSize;
+  for (i = 0; i < LDMA_COPY_MAX_DIMS; i++) {
+    s->count[i] = shape->count[order[i]];
+    s->srcStride[i] = shape->srcStride[order[i]];
+    s->dstStride[i] = shape->dstStride[order[i]];
+  }
+
+  // A row that ends where the next one starts extends the run
+  while (copy->run && (s->count[1] > 1) && (s->srcStride[0] != 0) && (s->dstStride[0] != 0)
+         && (s->srcStride[1] == (int32_t)s->count[0] * s->srcStride[0])
+         && (s->dstStride[1] == (int32_t)s->count[0] * s->dstStride[0])) {
+    s->count[0] *= s->count[1];
+    s->count[1] = s->count[2];
+    s->srcStride[1] = s->srcStride[2];
+    s->dstStride[1] = s->dstStride[2];
+    s->count[2] = 1;
+    s->srcStride[2] = 0;
+    s->dstStride[2] = 0;
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Append the descriptors of one row. The first one takes 'srcAddr' and
+ *    'dstAddr', either absolute or relative; the others continue where the
+ *    previous one stopped.
+ *****************************************************************************/
+static ldmaChainStatus_TypeDef appendRow(ldmaCopy_TypeDef *copy, uint32_t srcAddr,
+                                         uint32_t dstAddr, bool relative)
+{
+  uint32_t remaining = runLength(copy);
+  uint32_t length;
+  ldmaChainStatus_TypeDef status = ldmaChainOk;
+  LDMA_Descriptor_t desc;
+
+  for (uint32_t piece = 0; (piece < copy->pieces) && (status == ldmaChainOk); piece++) {
+    length = (remaining > LDMA_DESCRIPTOR_MAX_XFER_SIZE)
+             ? LDMA_DESCRIPTOR_MAX_XFER_SIZE : remaining;
+    remaining -= length;
+
+    desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2M_BYTE(0, 0, length);
+    desc.xfer.size = (copy->shape.elemSize == 4) ? ldmaCtrlSizeWord
+                     : (copy->shape.elemSize == 2) ? ldmaCtrlSizeHalf : ldmaCtrlSizeByte;
+    desc.xfer.blockSize = LDMA_COPY_BLOCK_SIZE;
+    desc.xfer.doneIfs = 0;
+    if (copy->run) {
+      desc.xfer.srcInc = increment(copy->shape.srcStride[0], copy->shape.elemSize);
+      desc.xfer.dstInc = increment(copy->shape.dstStride[0], copy->shape.elemSize);
+    } else {
+      desc.xfer.srcInc = ldmaCtrlSrcIncNone;
+      desc.xfer.dstInc = ldmaCtrlDstIncNone;
+    }
+    if ((piece == 0) && !relative) {
+      desc.xfer.srcAddr = srcAddr;
+      desc.xfer.dstAddr = dstAddr;
+    } else {
+      desc.xfer.srcAddrMode = ldmaCtrlSrcAddrModeRel;
+      desc.xfer.dstAddrMode = ldmaCtrlDstAddrModeRel;
+      desc.xfer.srcAddr = (piece == 0) ? srcAddr : 0;
+      desc.xfer.dstAddr = (piece == 0) ? dstAddr : 0;
+    }
+    status = ldmaChainAppend(&copy->chain, &desc);
+  }
+  return status;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Build and start the descriptors of block 'copy->block'
+ *****************************************************************************/
+static ldmaChainStatus_TypeDef startBlock(ldmaCopy_TypeDef *copy)
+{
+  const ldmaCopyShape_TypeDef *s = &copy->shape;
+  uint32_t loop = loopAxis(copy);
+  uint32_t chunk = copy->block % copy->loopBlocks;
+  uint32_t rest = copy->block / copy->loopBlocks;
+  uint32_t rows = s->count[loop] - chunk * ROWS_PER_BLOCK;
+  int32_t srcOffset = (int32_t)(chunk * ROWS_PER_BLOCK) * s->srcStride[loop];
+  int32_t dstOffset = (int32_t)(chunk * ROWS_PER_BLOCK) * s->dstStride[loop];
+  int32_t advance;
+  ldmaChainStatus_TypeDef status;
+  LDMA_Descriptor_t mark;
+
+  for (uint32_t axis = loop + 1; axis < LDMA_COPY_MAX_DIMS; axis++) {
+    srcOffset += (int32_t)(rest % s->count[axis]) * s->srcStride[axis];
+    dstOffset += (int32_t)(rest % s->count[axis]) * s->dstStride[axis];
+    rest /= s->count[axis];
+  }
+  if (rows > ROWS_PER_BLOCK) {
+    rows = ROWS_PER_BLOCK;
+  }
+
+  ldmaChainReset(&copy->chain);
+  status = appendRow(copy, (uint32_t)(uintptr_t)(copy->src + srcOffset),
+                     (uint32_t)(uintptr_t)(copy->dst + dstOffset), false);
+
+  if ((status == ldmaChainOk) && (rows > 1)) {
+    // The gap from the end of a row to the start of the next
+    advance = copy->run ? (int32_t)s->count[0] : 0;
+    status = appendRow(copy, (uint32_t)(s->srcStride[loop] - advance * s->srcStride[0]),
+                       (uint32_t)(s->dstStride[loop] - advance * s->dstStride[0]), true);
+    if ((status == ldmaChainOk) && (rows > 2)) {
+      status = ldmaChainLoop(&copy->chain, copy->pieces, rows - 2);
+    }
+  }
+
+  if (status == ldmaChainOk) {
+    mark = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_WRITE(copy->block + 1, &copy->done);
+    status = ldmaChainAppend(&copy->chain, &mark);
+  }
+  if (status == ldmaChainOk) {
+    status = ldmaChainTerminate(&copy->chain);
+  }
+  if (status == ldmaChainOk) {
+    status = ldmaChainStart(&copy->chain, copy->channel, &memTransfer);
+  }
+  return status;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Set up a copy on LDMA channel 'channel'
+ *
+ * @param[in] cpuThreshold
+ *    Copies of this many elements or fewer are done by the CPU in
+ *    ldmaCopyStart(), 0 to always use the LDMA
+ *
+ * @note
+ *    The descriptors come from the pool of ldma_chain.c, which must have
+ *    been initialized with ldmaChainPoolInit()
+ *****************************************************************************/
+void ldmaCopyInit(ldmaCopy_TypeDef *copy, int channel, uint32_t cpuThreshold)
+{
+  copy->channel = channel;
+  copy->cpuThreshold = cpuThreshold;
+  copy->busy = false;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start copying elements of 'src' to 'dst' as described by 'shape'
+ *
+ * @details
+ *    ldmaCopyDone() tells when the copy is done; LDMA_IRQHandler() must pass
+ *    the interrupt flags to ldmaCopyIrqHandler().
+ *****************************************************************************/
+ldmaCopyStatus_TypeDef ldmaCopyStart(ldmaCopy_TypeDef *copy, void *dst, const void *src,
+                                     const ldmaCopyShape_TypeDef *shape)
+{
+  uint32_t elemSize = shape->elemSize;
+  uint32_t total = 1;
+  uint32_t outer = 1;
+  ldmaChainStatus_TypeDef status;
+
+  if (copy->busy) {
+    return ldmaCopyBusy;
+  }
+  if (((elemSize != 1) && (elemSize != 2) && (elemSize != 4))
+      || (((uintptr_t)src | (uintptr_t)dst) & (elemSize - 1))) {
+    return ldmaCopyBadShape;
+  }
+  for (uint32_t axis = 0; axis < LDMA_COPY_MAX_DIMS; axis++) {
+    if ((shape->count[axis] == 0)
+        || (((uint32_t)shape->srcStride[axis] | (uint32_t)shape->dstStride[axis]) & (elemSize - 1))) {
+      return ldmaCopyBadShape;
+    }
+    total *= shape->count[axis];
+  }
+
+  if (total <= copy->cpuThreshold) {
+    ldmaCopyCpu(dst, src, shape);
+    return ldmaCopyOk;
+  }
+
+  plan(copy, shape);
+  copy->src = src;
+  copy->dst = dst;
+  copy->pieces = (runLength(copy) + LDMA_DESCRIPTOR_MAX_XFER_SIZE - 1)
+                 / LDMA_DESCRIPTOR_MAX_XFER_SIZE;
+  copy->loopBlocks = (copy->shape.count[loopAxis(copy)] + ROWS_PER_BLOCK - 1) / ROWS_PER_BLOCK;
+  for (uint32_t axis = loopAxis(copy) + 1; axis < LDMA_COPY_MAX_DIMS; axis++) {
+    outer *= copy->shape.count[axis];
+  }
+  copy->blockCount = copy->loopBlocks * outer;
+  copy->block = 0;
+  copy->done = 0;
+
+  // Two rows of descriptors and the end mark
+  if (ldmaChainCreate(&copy->chain, 2 * copy->pieces + 1) != ldmaChainOk) {
+    return ldmaCopyNoMemory;
+  }
+  copy->busy = true;
+  status = startBlock(copy);
+  if (status != ldmaChainOk) {
+    copy->busy = false;
+    ldmaChainDelete(&copy->chain);
+    return ldmaCopyBadShape;
+  }
+  return ldmaCopyOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Call from LDMA_IRQHandler() with the pending interrupt flags, starts
+ *    the next block when one is done
+ *****************************************************************************/
+void ldmaCopyIrqHandler(ldmaCopy_TypeDef *copy, uint32_t pending)
+{
+  if (!copy->busy || !(pending & (1UL << copy->channel))
+      || (copy->done != copy->block + 1)) {
+    return;
+  }
+
+  copy->block++;
+  if ((copy->block == copy->blockCount) || (startBlock(copy) != ldmaChainOk)) {
+    ldmaChainDelete(&copy->chain);
+    copy->busy = false;
+  }
+}
+
+bool ldmaCopyDone(const ldmaCopy_TypeDef *copy)
+{
+  return !copy->busy;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    The same copy done by the CPU, element by element
+ *****************************************************************************/
+void ldmaCopyCpu(void *dst, const void *src, const ldmaCopyShape_TypeDef *shape)
+{
+  const uint8_t *s;
+  uint8_t *d;
+
+  for (uint32_t k = 0; k < shape->count[2]; k++) {
+    for (uint32_t j = 0; j < shape->count[1]; j++) {
+      s = (const uint8_t *)src + ((int32_t)k * shape->srcStride[2])
+          + ((int32_t)j * shape->srcStride[1]);
+      d = (uint8_t *)dst + ((int32_t)k * shape->dstStride[2])
+          + ((int32_t)j * shape->dstStride[1]);
+      for (uint32_t i = 0; i < shape->count[0]; i++) {
+        switch (shape->elemSize) {
+          case 4:
+            *(uint32_t *)d = *(const uint32_t *)s;
+            break;
+          case 2:
+            *(uint16_t *)d = *(const uint16_t *)s;
+            break;
+          default:
+            *d = *s;
+            break;
+        }
+        s += shape->srcStride[0];
+        d += shape->dstStride[0];
+      }
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copy a width x height block between two row-major images, with rows of
+ *    'srcPitch' and 'dstPitch' elements
+ *****************************************************************************/
+void ldmaCopyShape2d(ldmaCopyShape_TypeDef *shape, uint32_t elemSize,
+                     uint32_t width, uint32_t height,
+                     uint32_t srcPitch, uint32_t dstPitch)
+{
+  shape->elemSize = elemSize;
+  shape->count[0] = width;
+  shape->count[1] = height;
+  shape->count[2] = 1;
+  shape->srcStride[0] = (int32_t)elemSize;
+  shape->srcStride[1] = (int32_t)(srcPitch * elemSize);
+  shape->srcStride[2] = 0;
+  shape->dstStride[0] = (int32_t)elemSize;
+  shape->dstStride[1] = (int32_t)(dstPitch * elemSize);
+  shape->dstStride[2] = 0;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copy a width x height block, transposed: element (x, y) of the source
+ *    goes to (y, x) of the destination
+ *****************************************************************************/
+void ldmaCopyShapeTranspose(ldmaCopyShape_TypeDef *shape, uint32_t elemSize,
+                            uint32_t width, uint32_t height,
+                            uint32_t srcPitch, uint32_t dstPitch)
+{
+  ldmaCopyShape2d(shape, elemSize, width, height, srcPitch, dstPitch);
+  shape->dstStride[0] = (int32_t)(dstPitch * elemSize);
+  shape->dstStride[1] = (int32_t)elemSize;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Gather every 'srcStep'th element of the source into consecutive
+ *    elements of the destination
+ *****************************************************************************/
+void ldmaCopyShapeGather(ldmaCopyShape_TypeDef *shape, uint32_t elemSize,
+                         uint32_t count, uint32_t srcStep)
+{
+  ldmaCopyShape2d(shape, elemSize, count, 1, 0, 0);
+  shape->srcStride[0] = (int32_t)(srcStep * elemSize);
+}
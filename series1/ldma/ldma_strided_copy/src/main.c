@@ -0,0 +1,169 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Strided Copy Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "em_timer.h"
+#include "ldma_copy.h"
+
+/* DMA channel used for the example */
+#define LDMA_CHANNEL        0
+
+/* Source image, tiles are taken from its top left corner */
+#define IMAGE_WIDTH         64
+#define IMAGE_HEIGHT        64
+
+/* Tile sizes measured, from 1x1 to MAX_TILE x MAX_TILE */
+#define TILE_COUNT          6
+#define MAX_TILE            32
+
+/* Strided copy on the LDMA */
+ldmaCopy_TypeDef copy;
+
+uint16_t image[IMAGE_HEIGHT][IMAGE_WIDTH];
+uint16_t dmaTile[MAX_TILE * MAX_TILE];
+uint16_t cpuTile[MAX_TILE * MAX_TILE];
+
+/* Values to watch in the debugger: TIMER0 cycles per copy of each tile
+ * size, from ldmaCopyStart() to the end of the copy for the LDMA */
+const uint32_t tileSize[TILE_COUNT] = { 1, 2, 4, 8, 16, 32 };
+uint32_t dmaCopyCycles[TILE_COUNT];
+uint32_t cpuCopyCycles[TILE_COUNT];
+uint32_t dmaTransposeCycles[TILE_COUNT];
+uint32_t cpuTransposeCycles[TILE_COUNT];
+uint32_t suggestedThreshold;
+uint32_t mismatches;
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler.
+ ******************************************************************************/
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  /* Read interrupt source */
+  pending = LDMA_IntGet();
+
+  /* Clear interrupts */
+  LDMA_IntClear(pending);
+
+  /* Check for LDMA error */
+  if ( pending & LDMA_IF_ERROR )
+  {
+    /* Loop here to enable the debugger to see what has happened */
+    while (1);
+  }
+
+  /* Start the next block of rows, if any */
+  ldmaCopyIrqHandler(&copy, pending);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Free running TIMER0 at the HFPERCLK frequency, to count cycles
+ ******************************************************************************/
+static void initTimer(void)
+{
+  TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+  TIMER_Init(TIMER0, &timerInit);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy a tile with the LDMA and with the CPU, and count the cycles of each.
+ *   The timer is 16 bits wide on some devices, hence the mask.
+ ******************************************************************************/
+static void measure(const ldmaCopyShape_TypeDef *shape,
+                    uint32_t *dmaCycles, uint32_t *cpuCycles)
+{
+  uint32_t start;
+
+  memset(dmaTile, 0, sizeof(dmaTile));
+  memset(cpuTile, 0, sizeof(cpuTile));
+
+  start = TIMER_CounterGet(TIMER0);
+  if ( ldmaCopyStart(&copy, dmaTile, image, shape) == ldmaCopyOk )
+  {
+    while ( !ldmaCopyDone(&copy) );
+  }
+  *dmaCycles = (TIMER_CounterGet(TIMER0) - start) & 0xFFFF;
+
+  start = TIMER_CounterGet(TIMER0);
+  ldmaCopyCpu(cpuTile, image, shape);
+  *cpuCycles = (TIMER_CounterGet(TIMER0) - start) & 0xFFFF;
+
+  if ( memcmp(dmaTile, cpuTile, sizeof(dmaTile)) != 0 )
+  {
+    mismatches++;
+  }
+}
+
+int main(void)
+{
+  ldmaCopyShape_TypeDef shape;
+  uint32_t i, x, y, n;
+
+  /* Chip errata */
+  CHIP_Init();
+
+  /* Initialize the LDMA, the descriptor pool and the timer */
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+  ldmaChainPoolInit();
+  initTimer();
+
+  for (y = 0; y < IMAGE_HEIGHT; y++)
+  {
+    for (x = 0; x < IMAGE_WIDTH; x++)
+    {
+      image[y][x] = (uint16_t)((y << 8) | x);
+    }
+  }
+
+  /* Always use the LDMA, to measure it */
+  ldmaCopyInit(&copy, LDMA_CHANNEL, 0);
+
+  for (i = 0; i < TILE_COUNT; i++)
+  {
+    n = tileSize[i];
+
+    ldmaCopyShape2d(&shape, sizeof(uint16_t), n, n, IMAGE_WIDTH, n);
+    measure(&shape, &dmaCopyCycles[i], &cpuCopyCycles[i]);
+
+    ldmaCopyShapeTranspose(&shape, sizeof(uint16_t), n, n, IMAGE_WIDTH, n);
+    measure(&shape, &dmaTransposeCycles[i], &cpuTransposeCycles[i]);
+
+    /* The CPU is faster up to this many elements */
+    if ( cpuCopyCycles[i] < dmaCopyCycles[i] )
+    {
+      suggestedThreshold = n * n;
+    }
+  }
+
+  /* From now on small tiles are copied by the CPU */
+  ldmaCopyInit(&copy, LDMA_CHANNEL, suggestedThreshold);
+
+  while (1)
+  {
+    EMU_EnterEM1();
+  }
+}
@@ -0,0 +1,274 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Scatter-Gather Transmit on the host LDMA model
+ *
+ * Build with the models and the runner of ../../ldma_host_model, see
+ * readme.txt. First checks the descriptors ldmaWritevBuild() makes for a
+ * few fragment lists, then sends packets made of a header, a payload taken
+ * from the middle of a larger buffer and a trailer, with empty fragments in
+ * between. hostProducer() plays the USART: each call collects the byte the
+ * LDMA wrote to the transmit register and raises the next TXBL request.
+ * The done interrupt of a packet sends the next one, and at the end the
+ * bytes received are compared with the packets.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "ldma_model.h"
+#include "host.h"
+#include "ldma_writev.h"
+#include "host_check.h"
+
+#define TX_CHANNEL          0
+#define PACKET_COUNT        3
+#define PAYLOAD_LENGTH      2500
+#define RECEIVED_MAX        (PACKET_COUNT * (PAYLOAD_LENGTH + 16))
+
+/* Calls without a transmitted byte before the producer gives up */
+#define MAX_IDLE            8
+
+/* Descriptors are read by the model, so the state must not be on the stack */
+ldmaWritev_TypeDef writev;
+
+/* Simulated USART0->TXDATA */
+volatile uint32_t txRegister;
+
+typedef struct {
+  uint8_t type;
+  uint8_t sequence;
+  uint16_t length;
+} header_TypeDef;
+
+header_TypeDef header;
+uint8_t payloadBuffer[PAYLOAD_LENGTH + 100];
+uint8_t trailer[2];
+ldmaIovec_TypeDef iov[5];
+
+uint8_t expected[RECEIVED_MAX];
+uint32_t expectedCount;
+uint8_t received[RECEIVED_MAX];
+uint32_t receivedCount;
+uint32_t lastWrites;
+uint32_t idleCalls;
+uint32_t packetsSent;
+uint32_t interrupts;
+
+/***************************************************************************//**
+ * @brief
+ *   Fill in and send the next packet, and append it to the expected bytes
+ ******************************************************************************/
+static void sendPacket(void)
+{
+  uint32_t payloadLength = PAYLOAD_LENGTH - 1000 * packetsSent;
+  const uint8_t *payload = &payloadBuffer[50 + packetsSent];
+  uint8_t sum = 0;
+
+  header.type = 0xA5;
+  header.sequence = (uint8_t)packetsSent;
+  header.length = (uint16_t)payloadLength;
+  for (uint32_t i = 0; i < payloadLength; i++)
+  {
+    sum += payload[i];
+  }
+  trailer[0] = sum;
+  trailer[1] = (uint8_t)~sum;
+
+  iov[0] = (ldmaIovec_TypeDef){ &header, sizeof(header) };
+  iov[1] = (ldmaIovec_TypeDef){ NULL, 0 };
+  iov[2] = (ldmaIovec_TypeDef){ payload, payloadLength };
+  iov[3] = (ldmaIovec_TypeDef){ trailer, 0 };
+  iov[4] = (ldmaIovec_TypeDef){ trailer, sizeof(trailer) };
+
+  for (uint32_t i = 0; i < 5; i++)
+  {
+    if ( iov[i].length == 0 )
+    {
+      continue;
+    }
+    memcpy(&expected[expectedCount], iov[i].base, iov[i].length);
+    expectedCount += iov[i].length;
+  }
+
+  CHECK(ldmaWritev(&writev, iov, 5) == ldmaWritevOk);
+  packetsSent++;
+}
+
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+  interrupts++;
+
+  if ( pending & LDMA_IF_ERROR )
+  {
+    printf("LDMA error\n");
+    hostFailures++;
+    return;
+  }
+
+  /* The fragments can be reused once the last byte is written */
+  CHECK(ldmaWritevDone(&writev));
+  if ( packetsSent < PACKET_COUNT )
+  {
+    sendPacket();
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Descriptors for a few fragment lists, checked without running them
+ ******************************************************************************/
+static void checkBuild(void)
+{
+  static uint8_t data[3 * LDMA_DESCRIPTOR_MAX_XFER_SIZE];
+  ldmaWritev_TypeDef w;
+  ldmaIovec_TypeDef v[LDMA_WRITEV_MAX_DESCRIPTORS + 1];
+  LDMA_Descriptor_t *d = w.desc;
+
+  ldmaWritevInit(&w, 1, ldmaPeripheralSignal_USART0_TXBL, &txRegister);
+
+  /* Header, payload and trailer apart: one descriptor each */
+  v[0] = (ldmaIovec_TypeDef){ &data[0], 4 };
+  v[1] = (ldmaIovec_TypeDef){ &data[100], 60 };
+  v[2] = (ldmaIovec_TypeDef){ &data[10], 2 };
+  CHECK(ldmaWritevBuild(&w, v, 3) == ldmaWritevOk);
+  CHECK((w.count == 3) && (w.length == 66));
+  CHECK((d[0].xfer.srcAddr == LDMA_HOST_ADDRESS(&data[0])) && (d[0].xfer.xferCnt == 3));
+  CHECK((d[1].xfer.srcAddr == LDMA_HOST_ADDRESS(&data[100])) && (d[1].xfer.xferCnt == 59));
+  CHECK((d[2].xfer.srcAddr == LDMA_HOST_ADDRESS(&data[10])) && (d[2].xfer.xferCnt == 1));
+  for (int i = 0; i < 3; i++)
+  {
+    CHECK(d[i].xfer.dstAddr == LDMA_HOST_ADDRESS(&txRegister));
+    CHECK((d[i].xfer.size == ldmaCtrlSizeByte) && (d[i].xfer.dstInc == ldmaCtrlDstIncNone));
+    CHECK(d[i].xfer.link == (i < 2));
+    CHECK(d[i].xfer.doneIfs == (i == 2));
+  }
+  CHECK((d[0].xfer.linkMode == ldmaLinkModeRel) && (d[0].xfer.linkAddr == 4));
+
+  /* Fragments following each other share a descriptor, empty ones take none */
+  v[0] = (ldmaIovec_TypeDef){ &data[0], 4 };
+  v[1] = (ldmaIovec_TypeDef){ &data[4], 0 };
+  v[2] = (ldmaIovec_TypeDef){ &data[4], 10 };
+  v[3] = (ldmaIovec_TypeDef){ NULL, 0 };
+  v[4] = (ldmaIovec_TypeDef){ &data[14], 6 };
+  CHECK(ldmaWritevBuild(&w, v, 5) == ldmaWritevOk);
+  CHECK((w.count == 1) && (w.length == 20) && (d[0].xfer.xferCnt == 19));
+  CHECK((d[0].xfer.link == 0) && (d[0].xfer.doneIfs == 1));
+
+  /* Long fragments are split, also after a merge */
+  v[0] = (ldmaIovec_TypeDef){ &data[0], 100 };
+  v[1] = (ldmaIovec_TypeDef){ &data[100], 2 * LDMA_DESCRIPTOR_MAX_XFER_SIZE };
+  CHECK(ldmaWritevBuild(&w, v, 2) == ldmaWritevOk);
+  CHECK((w.count == 3) && (w.length == 100 + 2 * LDMA_DESCRIPTOR_MAX_XFER_SIZE));
+  CHECK(d[0].xfer.xferCnt == LDMA_DESCRIPTOR_MAX_XFER_SIZE - 1);
+  CHECK(d[1].xfer.srcAddr == LDMA_HOST_ADDRESS(&data[LDMA_DESCRIPTOR_MAX_XFER_SIZE]));
+  CHECK(d[1].xfer.xferCnt == LDMA_DESCRIPTOR_MAX_XFER_SIZE - 1);
+  CHECK(d[2].xfer.srcAddr == LDMA_HOST_ADDRESS(&data[2 * LDMA_DESCRIPTOR_MAX_XFER_SIZE]));
+  CHECK(d[2].xfer.xferCnt == 99);
+
+  /* Too many fragments, and nothing to send */
+  for (int i = 0; i <= LDMA_WRITEV_MAX_DESCRIPTORS; i++)
+  {
+    v[i] = (ldmaIovec_TypeDef){ &data[2 * i], 1 };
+  }
+  CHECK(ldmaWritevBuild(&w, v, LDMA_WRITEV_MAX_DESCRIPTORS) == ldmaWritevOk);
+  CHECK(w.count == LDMA_WRITEV_MAX_DESCRIPTORS);
+  CHECK(ldmaWritevBuild(&w, v, LDMA_WRITEV_MAX_DESCRIPTORS + 1) == ldmaWritevTooLong);
+  CHECK((w.count == 0) && (w.length == 0));
+  CHECK(ldmaWritev(&w, v, 0) == ldmaWritevOk);
+  CHECK((w.count == 0) && ldmaWritevDone(&w));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Compare the bytes received with the packets sent
+ ******************************************************************************/
+static void report(void)
+{
+  uint32_t errors = 0;
+
+  CHECK(receivedCount == expectedCount);
+  for (uint32_t i = 0; (i < receivedCount) && (i < expectedCount); i++)
+  {
+    if ( received[i] != expected[i] )
+    {
+      errors++;
+    }
+  }
+  CHECK(errors == 0);
+  CHECK(interrupts == PACKET_COUNT);
+
+  printf("packets %lu, bytes expected %lu, received %lu, errors %lu, interrupts %lu\n",
+         (unsigned long)packetsSent, (unsigned long)expectedCount,
+         (unsigned long)receivedCount, (unsigned long)errors,
+         (unsigned long)interrupts);
+  hostCheckReport();
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The USART: take the byte written since the last call, if any, then ask
+ *   for the next one
+ ******************************************************************************/
+bool hostProducer(void)
+{
+  dmaModelStats_TypeDef stats;
+
+  ldmaModelGetStats(&stats);
+  if ( stats.dataWrites != lastWrites )
+  {
+    if ( receivedCount < RECEIVED_MAX )
+    {
+      received[receivedCount++] = (uint8_t)txRegister;
+    }
+    lastWrites = stats.dataWrites;
+    idleCalls = 0;
+  }
+  else if ( ++idleCalls == MAX_IDLE )
+  {
+    report();
+    return false;
+  }
+
+  ldmaModelSignal(ldmaPeripheralSignal_USART0_TXBL, false);
+  return true;
+}
+
+int main(void)
+{
+  CHIP_Init();
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  for (uint32_t i = 0; i < sizeof(payloadBuffer); i++)
+  {
+    payloadBuffer[i] = (uint8_t)(i * 7 + 3);
+  }
+
+  checkBuild();
+
+  ldmaWritevInit(&writev, TX_CHANNEL, ldmaPeripheralSignal_USART0_TXBL, &txRegister);
+  sendPacket();
+
+  while (1)
+  {
+    EMU_EnterEM1();
+  }
+}
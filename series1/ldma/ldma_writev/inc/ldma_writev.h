@@ -0,0 +1,64 @@
+/***************************************************************************//**
+ * @file  ldma_writev.h
+ * @brief Scatter-gather transmit of a list of fragments on the LDMA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef LDMA_WRITEV_H
+#define LDMA_WRITEV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_ldma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change this to send longer fragment lists; a fragment takes one
+// descriptor per LDMA_DESCRIPTOR_MAX_XFER_SIZE bytes
+#define LDMA_WRITEV_MAX_DESCRIPTORS   16
+
+typedef enum {
+  ldmaWritevOk,
+  ldmaWritevTooLong,      // More descriptors needed than LDMA_WRITEV_MAX_DESCRIPTORS
+  ldmaWritevBusy          // Previous list still being sent
+} ldmaWritevStatus_TypeDef;
+
+// One fragment, as struct iovec
+typedef struct {
+  const void *base;
+  uint32_t length;
+} ldmaIovec_TypeDef;
+
+typedef struct {
+  int channel;
+  LDMA_PeripheralSignal_t signal;   // Transmit buffer level, e.g. USART0_TXBL
+  volatile void *txData;            // Transmit data register, e.g. &USART0->TXDATA
+  LDMA_Descriptor_t desc[LDMA_WRITEV_MAX_DESCRIPTORS];
+  uint32_t count;                   // Descriptors built
+  uint32_t length;                  // Bytes to send
+  bool started;
+} ldmaWritev_TypeDef;
+
+void ldmaWritevInit(ldmaWritev_TypeDef *writev, int channel,
+                    LDMA_PeripheralSignal_t signal, volatile void *txData);
+ldmaWritevStatus_TypeDef ldmaWritevBuild(ldmaWritev_TypeDef *writev,
+                                         const ldmaIovec_TypeDef *iov, uint32_t iovCount);
+ldmaWritevStatus_TypeDef ldmaWritev(ldmaWritev_TypeDef *writev,
+                                    const ldmaIovec_TypeDef *iov, uint32_t iovCount);
+bool ldmaWritevDone(const ldmaWritev_TypeDef *writev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LDMA_WRITEV_H
@@ -0,0 +1,132 @@
+/***************************************************************************//**
+ * @file ldma_writev.c
+ * @brief Scatter-gather transmit of a list of fragments on the LDMA.
+ *
+ * Like writev(), ldmaWritev() sends a list of fragments, e.g. a header, a
+ * payload and a trailer, as one stream of bytes, without copying them into
+ * one buffer first. Each fragment becomes a memory to peripheral descriptor
+ * moving one byte per transmit buffer request; the descriptors are linked,
+ * and only the last one raises the done interrupt. Fragments that follow
+ * each other in memory share descriptors, empty ones take none, and long
+ * ones are split at LDMA_DESCRIPTOR_MAX_XFER_SIZE bytes.
+ *
+ * ldmaWritevBuild() only fills in the descriptors, so the lists can be
+ * checked on a host.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "ldma_writev.h"
+
+/**************************************************************************//**
+ * @brief
+ *    Send on 'channel' to the register 'txData', paced by 'signal'
+ *****************************************************************************/
+void ldmaWritevInit(ldmaWritev_TypeDef *writev, int channel,
+                    LDMA_PeripheralSignal_t signal, volatile void *txData)
+{
+  writev->channel = channel;
+  writev->signal = signal;
+  writev->txData = txData;
+  writev->count = 0;
+  writev->length = 0;
+  writev->started = false;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Build the descriptors sending 'iovCount' fragments of 'iov' in order
+ *****************************************************************************/
+ldmaWritevStatus_TypeDef ldmaWritevBuild(ldmaWritev_TypeDef *writev,
+                                         const ldmaIovec_TypeDef *iov, uint32_t iovCount)
+{
+  const uint8_t *base = NULL;
+  uint32_t pending = 0;
+  uint32_t length, i;
+  LDMA_Descriptor_t *desc;
+
+  writev->count = 0;
+  writev->length = 0;
+
+  // Gather runs of contiguous fragments, one more pass flushes the last run
+  for (i = 0; i <= iovCount; i++) {
+    if ((i < iovCount) && (iov[i].length == 0)) {
+      continue;
+    }
+    if ((i < iovCount) && (pending > 0) && ((const uint8_t *)iov[i].base == base + pending)) {
+      pending += iov[i].length;
+      continue;
+    }
+
+    while (pending > 0) {
+      if (writev->count == LDMA_WRITEV_MAX_DESCRIPTORS) {
+        writev->count = 0;
+        writev->length = 0;
+        return ldmaWritevTooLong;
+      }
+      length = (pending > LDMA_DESCRIPTOR_MAX_XFER_SIZE)
+               ? LDMA_DESCRIPTOR_MAX_XFER_SIZE : pending;
+      desc = &writev->desc[writev->count++];
+      *desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_M2P_BYTE(base, writev->txData, length, 1);
+      desc->xfer.doneIfs = 0;
+      writev->length += length;
+      base += length;
+      pending -= length;
+    }
+
+    if (i < iovCount) {
+      base = iov[i].base;
+      pending = iov[i].length;
+    }
+  }
+
+  if (writev->count > 0) {
+    desc = &writev->desc[writev->count - 1];
+    desc->xfer.link = 0;
+    desc->xfer.doneIfs = 1;
+  }
+  return ldmaWritevOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start sending 'iovCount' fragments of 'iov'
+ *
+ * @details
+ *    The fragments must not change until ldmaWritevDone() returns true; the
+ *    list itself can be reused at once.
+ *****************************************************************************/
+ldmaWritevStatus_TypeDef ldmaWritev(ldmaWritev_TypeDef *writev,
+                                    const ldmaIovec_TypeDef *iov, uint32_t iovCount)
+{
+  ldmaWritevStatus_TypeDef status;
+
+  if (!ldmaWritevDone(writev)) {
+    return ldmaWritevBusy;
+  }
+  status = ldmaWritevBuild(writev, iov, iovCount);
+  if ((status == ldmaWritevOk) && (writev->count > 0)) {
+    LDMA_TransferCfg_t cfg = LDMA_TRANSFER_CFG_PERIPHERAL(writev->signal);
+    LDMA_StartTransfer(writev->channel, &cfg, &writev->desc[0]);
+    writev->started = true;
+  }
+  return status;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    True when the last byte has been written to the transmit register
+ *****************************************************************************/
+bool ldmaWritevDone(const ldmaWritev_TypeDef *writev)
+{
+  return !writev->started || LDMA_TransferDone(writev->channel);
+}
@@ -0,0 +1,206 @@
+/**************************************************************************//**
+ * @file
+ * @brief LDMA Scatter-Gather Transmit Example
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "em_chip.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_core.h"
+#include "em_usart.h"
+#include "em_ldma.h"
+#include "ldma_writev.h"
+
+/* DMA channels used for the example */
+#define TX_CHANNEL          0
+#define RX_CHANNEL          1
+
+/* SPI bit rate, and the packets sent */
+#define BIT_RATE            1000000
+#define PAYLOAD_LENGTH      200
+#define PACKET_MAX          (PAYLOAD_LENGTH + 8)
+
+/* Packet header, sent as is from the structure */
+typedef struct {
+  uint8_t type;
+  uint8_t sequence;
+  uint16_t length;
+} header_TypeDef;
+
+/* Transmit state, the descriptors must stay valid while sending */
+ldmaWritev_TypeDef writev;
+header_TypeDef header;
+uint8_t trailer[2];
+
+/* Payloads are taken from the middle of a larger buffer, not copied */
+uint8_t sampleBuffer[4 * PAYLOAD_LENGTH];
+
+/* Bytes looped back from TX to RX */
+LDMA_Descriptor_t rxDescriptor;
+uint8_t rxBuffer[PACKET_MAX];
+
+/* Values to watch in the debugger */
+volatile uint32_t packetCount;
+volatile uint32_t errorCount;
+ldmaWritevStatus_TypeDef writevStatus;
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA IRQ handler.
+ ******************************************************************************/
+void LDMA_IRQHandler( void )
+{
+  uint32_t pending;
+
+  /* Read interrupt source */
+  pending = LDMA_IntGet();
+
+  /* Clear interrupts */
+  LDMA_IntClear(pending);
+
+  /* Check for LDMA error */
+  if ( pending & LDMA_IF_ERROR )
+  {
+    /* Loop here to enable the debugger to see what has happened */
+    while (1);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   USART0 initialization, SPI master with TX looped back to RX inside the
+ *   USART, so no pin is needed
+ ******************************************************************************/
+void initUsart(void)
+{
+  USART_InitSync_TypeDef init = USART_INITSYNC_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_HFPER, true);
+  CMU_ClockEnable(cmuClock_USART0, true);
+
+  init.baudrate = BIT_RATE;
+  init.msbf     = true;
+  USART_InitSync(USART0, &init);
+
+  USART0->CTRL |= USART_CTRL_LOOPBK;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   LDMA initialization
+ ******************************************************************************/
+void initLdma(void)
+{
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  LDMA_Init_t init = LDMA_INIT_DEFAULT;
+  LDMA_Init( &init );
+
+  ldmaWritevInit(&writev, TX_CHANNEL, ldmaPeripheralSignal_USART0_TXBL,
+                 &USART0->TXDATA);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Send one packet: header, payload and trailer, straight from where they
+ *   are, and receive it back
+ ******************************************************************************/
+void sendPacket(const uint8_t *payload, uint32_t length)
+{
+  ldmaIovec_TypeDef iov[3];
+  LDMA_TransferCfg_t rxConfig = LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_USART0_RXDATAV);
+  uint32_t total = sizeof(header) + length + sizeof(trailer);
+  uint8_t sum = 0;
+  uint32_t i;
+
+  CORE_DECLARE_IRQ_STATE;
+
+  header.type     = 0xA5;
+  header.sequence = (uint8_t) packetCount;
+  header.length   = (uint16_t) length;
+  for (i = 0; i < length; i++)
+  {
+    sum += payload[i];
+  }
+  trailer[0] = sum;
+  trailer[1] = (uint8_t) ~sum;
+
+  iov[0].base = &header;
+  iov[0].length = sizeof(header);
+  iov[1].base = payload;
+  iov[1].length = length;
+  iov[2].base = trailer;
+  iov[2].length = sizeof(trailer);
+
+  /* Receive first, so no looped back byte is missed */
+  rxDescriptor = (LDMA_Descriptor_t) LDMA_DESCRIPTOR_SINGLE_P2M_BYTE(&USART0->RXDATA, rxBuffer, total);
+  LDMA_StartTransfer(RX_CHANNEL, &rxConfig, &rxDescriptor);
+
+  writevStatus = ldmaWritev(&writev, iov, 3);
+  if ( writevStatus != ldmaWritevOk )
+  {
+    return;
+  }
+
+  /* Sleep until the last byte is back, the receive done interrupt wakes
+     the MCU even if it comes before EMU_EnterEM1() */
+  CORE_ENTER_CRITICAL();
+  while ( !LDMA_TransferDone(RX_CHANNEL) )
+  {
+    EMU_EnterEM1();
+    CORE_EXIT_CRITICAL();
+    CORE_ENTER_CRITICAL();
+  }
+  CORE_EXIT_CRITICAL();
+
+  /* Check the packet received against its fragments */
+  if ( (memcmp(rxBuffer, &header, sizeof(header)) != 0)
+       || (memcmp(&rxBuffer[sizeof(header)], payload, length) != 0)
+       || (memcmp(&rxBuffer[sizeof(header) + length], trailer, sizeof(trailer)) != 0) )
+  {
+    errorCount++;
+  }
+  packetCount++;
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t i, offset = 0;
+
+  /* Chip errata */
+  CHIP_Init();
+
+  /* Init DCDC regulator if available */
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  for (i = 0; i < sizeof(sampleBuffer); i++)
+  {
+    sampleBuffer[i] = (uint8_t) (i * 7 + 3);
+  }
+
+  initUsart();
+  initLdma();
+
+  /* Send packets with payloads of different lengths from different places */
+  while (1)
+  {
+    sendPacket(&sampleBuffer[offset], PAYLOAD_LENGTH - (offset % 64));
+    offset = (offset + 37) % (sizeof(sampleBuffer) - PAYLOAD_LENGTH);
+  }
+}
@@ -0,0 +1,310 @@
+/**************************************************************************//**
+ * @file
+ * @brief A/B record store on a host, with power cut at every step
+ *
+ * Build on its own, see readme.txt. The two pages are kept in RAM, where
+ * like flash an erase sets every bit and a write can only clear bits. The
+ * power is cut after any number of flash steps of an update, an erase or
+ * one word written: the step it is cut in is left half done, with some
+ * words of the page erased or some bits of the word cleared, and the steps
+ * after it do nothing. abInit() then runs as after a reset, and must find
+ * the last committed record, or the new one once the commit marker is
+ * whole. This is done for every step of an update, from an empty store and
+ * with each page holding the current record, and for random runs with
+ * several cuts in a row.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ab_record.h"
+#include "host_check.h"
+
+#define PAGE_SIZE           256
+#define PAGE_WORDS          (PAGE_SIZE / 4)
+#define RECORD_SIZE         32
+#define RECORD_WORDS        (RECORD_SIZE / 4)
+
+/* Steps of an update: the erase, 3 header words, the record, the commit
+   marker */
+#define UPDATE_STEPS        (1 + 3 + RECORD_WORDS + 1)
+
+static uint32_t flash[2][PAGE_WORDS];
+static uint32_t seed = 1;
+
+/* Whole steps left before the power is cut in the next one */
+static uint32_t stepsLeft = UINT32_MAX;
+static bool powerOff;
+
+/***************************************************************************//**
+ * @brief
+ *   Take one flash step. Returns false once the power is off, and sets
+ *   'partial' for the step the power is cut in.
+ ******************************************************************************/
+static bool step(bool *partial)
+{
+  *partial = false;
+  if ( powerOff )
+  {
+    return false;
+  }
+  if ( stepsLeft == 0 )
+  {
+    *partial = true;
+    powerOff = true;
+    return true;
+  }
+  if ( stepsLeft != UINT32_MAX )
+  {
+    stepsLeft--;
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash erase on RAM, a cut one erases only some of the words
+ ******************************************************************************/
+static void ramErase(uint32_t *page)
+{
+  bool partial;
+  uint32_t i;
+
+  CHECK((page == flash[0]) || (page == flash[1]));
+  if ( !step(&partial) )
+  {
+    return;
+  }
+  for ( i = 0; i < PAGE_WORDS; i++ )
+  {
+    if ( !partial || (hostRandom(&seed) & 1) )
+    {
+      page[i] = 0xFFFFFFFF;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash write on RAM, which can only clear bits; a cut word has only some
+ *   of its bits cleared
+ ******************************************************************************/
+static void ramWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  bool partial;
+  uint32_t i;
+
+  for ( i = 0; i < bytes / 4; i++ )
+  {
+    if ( !step(&partial) )
+    {
+      return;
+    }
+    dst[i] &= partial ? (src[i] | (hostRandom(&seed) << 8) | hostRandom(&seed))
+                      : src[i];
+  }
+}
+
+static const abFlash_TypeDef abFlash =
+{
+  { flash[0], flash[1] }, PAGE_SIZE, RECORD_SIZE, ramErase, ramWrite
+};
+
+/* Record number n, different in every word */
+static void makeRecord(uint32_t n, uint32_t *record)
+{
+  uint32_t i;
+
+  for ( i = 0; i < RECORD_WORDS; i++ )
+  {
+    record[i] = n * 0x9E3779B9UL + i;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Reset: find the record again. Returns its number, 0 if there is none,
+ *   or -1 if it is none of the records written.
+ ******************************************************************************/
+static int64_t recover(uint32_t newest)
+{
+  uint32_t record[RECORD_WORDS];
+  uint32_t expected[RECORD_WORDS];
+  abStatus_TypeDef status;
+  uint32_t n;
+
+  stepsLeft = UINT32_MAX;
+  powerOff = false;
+  status = abInit(&abFlash);
+  if ( status == abEmpty )
+  {
+    return 0;
+  }
+  CHECK(status == abOk);
+  CHECK(abRead(record) == abOk);
+  for ( n = 1; n <= newest; n++ )
+  {
+    makeRecord(n, expected);
+    if ( memcmp(record, expected, RECORD_SIZE) == 0 )
+    {
+      CHECK(abSequence() > 0);
+      return n;
+    }
+  }
+  return -1;
+}
+
+/* Start from an empty store, then write 'updates' records */
+static void prepare(uint32_t updates)
+{
+  uint32_t record[RECORD_WORDS];
+  uint32_t n;
+
+  memset(flash, 0xFF, sizeof(flash));
+  stepsLeft = UINT32_MAX;
+  powerOff = false;
+  CHECK(abInit(&abFlash) == abEmpty);
+  for ( n = 1; n <= updates; n++ )
+  {
+    makeRecord(n, record);
+    CHECK(abWrite(record) == abOk);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   After 'updates' records, cut the next update in each of its steps, and
+ *   after the last one: the old record until the commit marker is written,
+ *   the new one after.
+ *   The store must then take further updates.
+ ******************************************************************************/
+static void checkEveryCut(uint32_t updates)
+{
+  uint32_t record[RECORD_WORDS];
+  uint32_t cut;
+  int64_t found;
+
+  for ( cut = 0; cut <= UPDATE_STEPS; cut++ )
+  {
+    prepare(updates);
+    CHECK(recover(updates) == updates);
+
+    makeRecord(updates + 1, record);
+    stepsLeft = cut;
+    abWrite(record);
+    found = recover(updates + 1);
+    if ( cut < UPDATE_STEPS )
+    {
+      /* The commit marker is not whole, unless the bits the cut left set
+         happen to be set in it too */
+      CHECK((found == updates)
+            || ((cut == UPDATE_STEPS - 1) && (found == updates + 1)));
+    }
+    else
+    {
+      CHECK(found == updates + 1);
+    }
+
+    /* The next update goes through, and the one after */
+    makeRecord(updates + 2, record);
+    CHECK(abWrite(record) == abOk);
+    CHECK(recover(updates + 2) == updates + 2);
+    makeRecord(updates + 3, record);
+    CHECK(abWrite(record) == abOk);
+    CHECK(recover(updates + 3) == updates + 3);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Runs of updates, each cut at a random step or not at all, with a reset
+ *   after each: the record found is the last committed one or the one being
+ *   written, and never goes back
+ ******************************************************************************/
+static void checkRandom(uint32_t trials)
+{
+  uint32_t record[RECORD_WORDS];
+  uint32_t t, u, committed, written;
+  int64_t found;
+
+  for ( t = 0; t < trials; t++ )
+  {
+    prepare(0);
+    committed = 0;
+    written = 0;
+    for ( u = 0; u < 20; u++ )
+    {
+      makeRecord(++written, record);
+      stepsLeft = (hostRandom(&seed) % 3 == 0) ? UINT32_MAX
+                  : hostRandom(&seed) % (UPDATE_STEPS + 1);
+      abWrite(record);
+      found = recover(written);
+      CHECK((found == committed) || (found == written));
+      if ( found == written )
+      {
+        committed = written;
+      }
+    }
+  }
+  printf("%u random runs of 20 updates\n", (unsigned)trials);
+}
+
+static void checkConfig(void)
+{
+  abFlash_TypeDef bad = abFlash;
+
+  bad.recordSize = 0;
+  CHECK(abInit(&bad) == abInvalid);
+  bad.recordSize = 6;
+  CHECK(abInit(&bad) == abInvalid);
+  bad.recordSize = PAGE_SIZE - 12;
+  CHECK(abInit(&bad) == abInvalid);
+  bad.recordSize = PAGE_SIZE - 16;
+  memset(flash, 0xFF, sizeof(flash));
+  CHECK(abInit(&bad) == abEmpty);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t trials = 1000;
+  uint32_t updates;
+  int option;
+
+  while ( (option = getopt(argc, argv, "n:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'n':
+        trials = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("usage: %s [-n random runs]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  checkConfig();
+
+  /* From an empty store, then with page A and page B current */
+  for ( updates = 0; updates < 3; updates++ )
+  {
+    checkEveryCut(updates);
+  }
+  printf("power cut at each of the %u points of an update\n",
+         (unsigned)UPDATE_STEPS + 1);
+  checkRandom(trials);
+
+  hostCheckReport();
+  return 0;
+}
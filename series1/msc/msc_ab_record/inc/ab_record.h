@@ -0,0 +1,50 @@
+/***************************************************************************//**
+ * @file  ab_record.h
+ * @brief Power-fail-safe A/B record store in two flash pages
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef AB_RECORD_H
+#define AB_RECORD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  abOk,
+  abEmpty,          // Neither page holds a committed record
+  abInvalid         // Bad configuration or record size
+} abStatus_TypeDef;
+
+// The two pages holding the record. Erased flash reads 0xFFFFFFFF and a
+// write can only clear bits, as with the MSC.
+typedef struct {
+  uint32_t *page[2];      // Page A and page B, page aligned
+  uint32_t pageSize;      // Page size in bytes
+  uint32_t recordSize;    // Record size in bytes, a multiple of 4
+  void (*erase)(uint32_t *page);
+  void (*write)(uint32_t *dst, const uint32_t *src, uint32_t bytes);
+} abFlash_TypeDef;
+
+abStatus_TypeDef abInit(const abFlash_TypeDef *flash);
+abStatus_TypeDef abRead(void *record);
+abStatus_TypeDef abWrite(const void *record);
+uint32_t abSequence(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AB_RECORD_H
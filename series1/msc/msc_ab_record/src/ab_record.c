@@ -0,0 +1,194 @@
+/***************************************************************************//**
+ * @file ab_record.c
+ * @brief Power-fail-safe A/B record store in two flash pages.
+ *
+ * Each page holds at most one copy of the record:
+ *
+ *   word 0     magic
+ *   word 1     sequence number
+ *   word 2     CRC-32 of the sequence number and the record
+ *   word 3..   record
+ *   last word  commit marker, the sequence number XOR COMMIT_XOR
+ *
+ * An update erases the page that does not hold the current record, writes
+ * the header and the record to it, and only then writes the commit marker.
+ * A reset at any point before the commit marker is written leaves the other
+ * page untouched, and the interrupted page is ignored on the next boot since
+ * it has no valid commit marker.
+ *
+ * Recovery reads the headers of both pages and checks the CRC of at most two
+ * records, so it takes the same time whatever the page size.
+ * This file has no device dependencies.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "ab_record.h"
+
+#define PAGE_MAGIC      0x41425231UL  // "ABR1"
+#define COMMIT_XOR      0x5AA5C33CUL
+#define HEADER_WORDS    3
+
+#define WORD_MAGIC      0
+#define WORD_SEQ        1
+#define WORD_CRC        2
+
+static const abFlash_TypeDef *abFlash;
+
+// Index of the page holding the current record, -1 if none
+static int current;
+static uint32_t currentSeq;
+
+/**************************************************************************//**
+ * @brief
+ *    CRC-32 (IEEE 802.3) of the sequence number and the record
+ *****************************************************************************/
+static uint32_t recordCrc(uint32_t seq, const uint8_t *data, uint32_t size)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  uint8_t b;
+
+  for (uint32_t i = 0; i < 4 + size; i++) {
+    b = (i < 4) ? (uint8_t)(seq >> (8 * i)) : data[i - 4];
+    crc ^= b;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320UL) : (crc >> 1);
+    }
+  }
+  return ~crc;
+}
+
+static uint32_t commitWord(void)
+{
+  return HEADER_WORDS + abFlash->recordSize / 4;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Returns true if the page holds a committed, intact record
+ *****************************************************************************/
+static bool pageCommitted(const uint32_t *page)
+{
+  uint32_t seq = page[WORD_SEQ];
+
+  return (page[WORD_MAGIC] == PAGE_MAGIC)
+         && (page[commitWord()] == (seq ^ COMMIT_XOR))
+         && (page[WORD_CRC] == recordCrc(seq, (const uint8_t *)&page[HEADER_WORDS],
+                                         abFlash->recordSize));
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Find the current record
+ *
+ * @return
+ *    abEmpty if no committed record was found, abRead() then fails until the
+ *    first abWrite()
+ *****************************************************************************/
+abStatus_TypeDef abInit(const abFlash_TypeDef *flash)
+{
+  bool valid[2];
+
+  if ((flash->recordSize == 0) || (flash->recordSize % 4 != 0)
+      || (4 * (HEADER_WORDS + 1) + flash->recordSize > flash->pageSize)) {
+    return abInvalid;
+  }
+
+  abFlash = flash;
+  valid[0] = pageCommitted(flash->page[0]);
+  valid[1] = pageCommitted(flash->page[1]);
+
+  if (valid[0] && valid[1]) {
+    // Both committed: a reset hit after the commit but before the next
+    // update erased the other page. The newer one wins.
+    int32_t diff = (int32_t)(flash->page[1][WORD_SEQ] - flash->page[0][WORD_SEQ]);
+    current = (diff > 0) ? 1 : 0;
+  } else if (valid[0]) {
+    current = 0;
+  } else if (valid[1]) {
+    current = 1;
+  } else {
+    current = -1;
+    currentSeq = 0;
+    return abEmpty;
+  }
+
+  currentSeq = flash->page[current][WORD_SEQ];
+  return abOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copy the current record (recordSize bytes) to 'record'
+ *****************************************************************************/
+abStatus_TypeDef abRead(void *record)
+{
+  if (abFlash == NULL) {
+    return abInvalid;
+  }
+  if (current < 0) {
+    return abEmpty;
+  }
+  memcpy(record, &abFlash->page[current][HEADER_WORDS], abFlash->recordSize);
+  return abOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Replace the record. The old record stays current until the commit
+ *    marker of the new one has been written.
+ *
+ * @param[in] record
+ *    recordSize bytes, word aligned
+ *****************************************************************************/
+abStatus_TypeDef abWrite(const void *record)
+{
+  uint32_t header[HEADER_WORDS];
+  uint32_t commit;
+  uint32_t seq = currentSeq + 1;
+  int next = (current == 0) ? 1 : 0;
+  uint32_t *page;
+
+  if (abFlash == NULL) {
+    return abInvalid;
+  }
+  page = abFlash->page[next];
+
+  header[WORD_MAGIC] = PAGE_MAGIC;
+  header[WORD_SEQ] = seq;
+  header[WORD_CRC] = recordCrc(seq, (const uint8_t *)record, abFlash->recordSize);
+  commit = seq ^ COMMIT_XOR;
+
+  // 1. Erase the page that does not hold the current record
+  abFlash->erase(page);
+
+  // 2. Header and record
+  abFlash->write(page, header, sizeof(header));
+  abFlash->write(page + HEADER_WORDS, (const uint32_t *)record, abFlash->recordSize);
+
+  // 3. Commit marker, the new record is current from here on
+  abFlash->write(page + commitWord(), &commit, sizeof(commit));
+
+  current = next;
+  currentSeq = seq;
+  return abOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Sequence number of the current record, 0 if there is none
+ *****************************************************************************/
+uint32_t abSequence(void)
+{
+  return currentSeq;
+}
@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * @file
+ * @brief This project demonstrates power-fail-safe updates of a settings
+ * record kept in two flash pages. A reset at any point of an update leaves
+ * either the old or the new record readable on the next boot.
+ ******************************************************************************
+ * @section License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_msc.h"
+#include "ab_record.h"
+
+// The USERDATA page is a single page, so the record uses the last two pages
+// of the main flash instead
+#define PAGE_A          ((uint32_t*)(FLASH_BASE + FLASH_SIZE - 2 * FLASH_PAGE_SIZE))
+#define PAGE_B          ((uint32_t*)(FLASH_BASE + FLASH_SIZE - FLASH_PAGE_SIZE))
+
+// Record kept in flash, its size must be a multiple of 4 bytes
+typedef struct {
+  uint32_t bootCount;
+  uint32_t value;
+} settings_TypeDef;
+
+/**************************************************************************//**
+ * @brief  Erase one page
+ *****************************************************************************/
+static void flashErase(uint32_t *page)
+{
+  MSC_ErasePage(page);
+}
+
+/**************************************************************************//**
+ * @brief  Program words
+ *****************************************************************************/
+static void flashWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  MSC_WriteWord(dst, src, bytes);
+}
+
+const abFlash_TypeDef abFlash = {
+  { PAGE_A, PAGE_B },
+  FLASH_PAGE_SIZE,
+  sizeof(settings_TypeDef),
+  flashErase,
+  flashWrite
+};
+
+// Values to watch in the debugger
+abStatus_TypeDef initStatus;
+settings_TypeDef settings;
+uint32_t sequence;
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  // Chip errata
+  CHIP_Init();
+
+  MSC_Init();
+
+  // Find the current record, only the two page headers are looked at
+  initStatus = abInit(&abFlash);
+  if (abRead(&settings) != abOk) {
+    settings.bootCount = 0;
+    settings.value = 32;
+  }
+
+  // Update the record. Resetting the board at any time during this call
+  // leaves either the old or the new record in place.
+  settings.bootCount++;
+  abWrite(&settings);
+
+  sequence = abSequence();
+
+  MSC_Deinit();
+
+  // Infinite Loop
+  while(1);
+}
@@ -0,0 +1,528 @@
+/**************************************************************************//**
+ * @file
+ * @brief Key/value store on a host: checks and benchmark
+ *
+ * Build on its own, see readme.txt. The store runs on pages in RAM, where
+ * like flash an erase sets every bit and a write can only clear bits. A
+ * model of the keys in RAM is kept along, and checked against the store:
+ * set, get and delete, garbage collection and remounts during a long run
+ * of random updates, a full store, and the erase count of every page.
+ *
+ * The power is then cut in each flash step of a run of updates, an erase or
+ * one word written, leaving that step half done. After the cut kvInit()
+ * must find every key as before, the key being updated with its old or its
+ * new value, and the store must take further updates.
+ *
+ * The benchmark prints the flash words written and the erases per update,
+ * against erasing a page and writing the value for each update.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "kv_store.h"
+#include "host_check.h"
+
+#define PAGE_SIZE           512
+#define PAGE_WORDS          (PAGE_SIZE / 4)
+#define PAGE_COUNT          4
+
+/* What the store should hold */
+typedef struct
+{
+  bool present[KV_MAX_KEYS];
+  uint16_t size[KV_MAX_KEYS];
+  uint8_t data[KV_MAX_KEYS][KV_MAX_VALUE_SIZE];
+} Model;
+
+static uint32_t flash[PAGE_COUNT][PAGE_WORDS];
+static uint32_t pageErases[PAGE_COUNT];
+static uint32_t seed = 1;
+
+/* Whole steps left before the power is cut in the next one */
+static uint32_t stepsLeft = UINT32_MAX;
+static bool powerOff;
+
+/***************************************************************************//**
+ * @brief
+ *   Take one flash step. Returns false once the power is off, and sets
+ *   'partial' for the step the power is cut in.
+ ******************************************************************************/
+static bool step(bool *partial)
+{
+  *partial = false;
+  if ( powerOff )
+  {
+    return false;
+  }
+  if ( stepsLeft == 0 )
+  {
+    *partial = true;
+    powerOff = true;
+    return true;
+  }
+  if ( stepsLeft != UINT32_MAX )
+  {
+    stepsLeft--;
+  }
+  return true;
+}
+
+static void powerOn(void)
+{
+  stepsLeft = UINT32_MAX;
+  powerOff = false;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash erase on RAM, a cut one erases only some of the words
+ ******************************************************************************/
+static void ramErase(uint32_t *page)
+{
+  uint32_t index = (uint32_t)(page - flash[0]) / PAGE_WORDS;
+  bool partial;
+  uint32_t i;
+
+  CHECK((page - flash[0]) % PAGE_WORDS == 0);
+  CHECK(index < PAGE_COUNT);
+  if ( !step(&partial) )
+  {
+    return;
+  }
+  for ( i = 0; i < PAGE_WORDS; i++ )
+  {
+    if ( !partial || (hostRandom(&seed) & 1) )
+    {
+      page[i] = 0xFFFFFFFF;
+    }
+  }
+  pageErases[index]++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash write on RAM, which can only clear bits; a cut word has only some
+ *   of its bits cleared
+ ******************************************************************************/
+static void ramWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  bool partial;
+  uint32_t i;
+
+  for ( i = 0; i < bytes / 4; i++ )
+  {
+    if ( !step(&partial) )
+    {
+      return;
+    }
+    dst[i] &= partial ? (src[i] | (hostRandom(&seed) << 8) | hostRandom(&seed))
+                      : src[i];
+  }
+}
+
+static const kvFlash_TypeDef kvFlash =
+{
+  flash[0], PAGE_SIZE, PAGE_COUNT, ramErase, ramWrite
+};
+
+/* Start from erased flash */
+static void format(Model *model)
+{
+  memset(flash, 0xFF, sizeof(flash));
+  memset(pageErases, 0, sizeof(pageErases));
+  memset(model, 0, sizeof(*model));
+  powerOn();
+  CHECK(kvInit(&kvFlash) == kvFormatted);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   True if the store holds the value of the model for a key, or, if 'alt'
+ *   is given, the value of 'alt'
+ ******************************************************************************/
+static bool keyMatches(const Model *model, const Model *alt, uint16_t key)
+{
+  uint8_t data[KV_MAX_VALUE_SIZE];
+  uint16_t size = sizeof(data);
+  kvStatus_TypeDef status = kvRead(key, data, &size);
+  bool match;
+
+  if ( !model->present[key] )
+  {
+    match = (status == kvNotFound);
+  }
+  else
+  {
+    match = (status == kvOk) && (size == model->size[key])
+            && (memcmp(data, model->data[key], size) == 0);
+  }
+  if ( !match && (alt != NULL) )
+  {
+    return keyMatches(alt, NULL, key);
+  }
+  return match;
+}
+
+static uint32_t checkAll(const Model *model)
+{
+  uint32_t bad = 0;
+  uint16_t key;
+
+  for ( key = 0; key < KV_MAX_KEYS; key++ )
+  {
+    if ( !keyMatches(model, NULL, key) )
+    {
+      bad++;
+    }
+  }
+  return bad;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A random update of the model and of the store: a write of 1 to 'maxSize'
+ *   bytes to one of 'keys' keys, or one time in 8 a delete
+ ******************************************************************************/
+static kvStatus_TypeDef randomUpdate(Model *model, uint32_t keys,
+                                     uint32_t maxSize)
+{
+  uint16_t key = (uint16_t)(hostRandom(&seed) % keys);
+  uint16_t size = (uint16_t)(1 + hostRandom(&seed) % maxSize);
+  uint8_t data[KV_MAX_VALUE_SIZE];
+  kvStatus_TypeDef status;
+  uint32_t i;
+
+  if ( hostRandom(&seed) % 8 == 0 )
+  {
+    status = kvDelete(key);
+    CHECK(status == (model->present[key] ? kvOk : kvNotFound));
+    model->present[key] = false;
+    return status;
+  }
+  for ( i = 0; i < size; i++ )
+  {
+    data[i] = (uint8_t)hostRandom(&seed);
+  }
+  status = kvWrite(key, data, size);
+  if ( status == kvOk )
+  {
+    model->present[key] = true;
+    model->size[key] = size;
+    memcpy(model->data[key], data, size);
+  }
+  return status;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set, get and delete, and arguments that must be refused
+ ******************************************************************************/
+static void checkBasic(void)
+{
+  static const uint8_t value[] = { 1, 2, 3, 4, 5 };
+  kvFlash_TypeDef bad = kvFlash;
+  kvStats_TypeDef before, after;
+  uint8_t data[KV_MAX_VALUE_SIZE];
+  uint16_t size;
+  Model model;
+
+  bad.pageCount = 2;
+  CHECK(kvInit(&bad) == kvInvalid);
+  bad = kvFlash;
+  bad.pageSize = 64;
+  CHECK(kvInit(&bad) == kvInvalid);
+
+  format(&model);
+  size = sizeof(data);
+  CHECK(kvRead(3, data, &size) == kvNotFound);
+  CHECK(kvWrite(3, value, sizeof(value)) == kvOk);
+  size = sizeof(data);
+  CHECK(kvRead(3, data, &size) == kvOk);
+  CHECK((size == sizeof(value)) && (memcmp(data, value, size) == 0));
+
+  /* A buffer too small gives the size */
+  size = 2;
+  CHECK(kvRead(3, data, &size) == kvInvalid);
+  CHECK(size == sizeof(value));
+
+  /* An unchanged value writes nothing */
+  kvGetStats(&before);
+  CHECK(kvWrite(3, value, sizeof(value)) == kvOk);
+  kvGetStats(&after);
+  CHECK(after.wordsWritten == before.wordsWritten);
+
+  CHECK(kvWrite(KV_MAX_KEYS, value, sizeof(value)) == kvInvalid);
+  CHECK(kvWrite(4, value, 0) == kvInvalid);
+  CHECK(kvWrite(4, data, KV_MAX_VALUE_SIZE + 1) == kvInvalid);
+
+  CHECK(kvDelete(3) == kvOk);
+  CHECK(kvDelete(3) == kvNotFound);
+  size = sizeof(data);
+  CHECK(kvRead(3, data, &size) == kvNotFound);
+
+  /* Still deleted after a remount */
+  CHECK(kvInit(&kvFlash) == kvOk);
+  size = sizeof(data);
+  CHECK(kvRead(3, data, &size) == kvNotFound);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A long run of random updates with a remount now and then: the store
+ *   always matches the model, garbage collection copies live records, and
+ *   the pages are erased as often as each other
+ ******************************************************************************/
+static void checkRun(uint32_t updates)
+{
+  kvStats_TypeDef stats;
+  uint32_t u, p, minErases, maxErases, gcCopies = 0;
+  Model model;
+
+  format(&model);
+  for ( u = 0; u < updates; u++ )
+  {
+    CHECK(randomUpdate(&model, 12, KV_MAX_VALUE_SIZE / 2) != kvNoSpace);
+    if ( hostRandom(&seed) % 64 == 0 )
+    {
+      kvGetStats(&stats);
+      gcCopies += stats.gcCopies;
+      CHECK(kvInit(&kvFlash) == kvOk);
+      CHECK(checkAll(&model) == 0);
+    }
+  }
+  CHECK(checkAll(&model) == 0);
+  kvGetStats(&stats);
+  gcCopies += stats.gcCopies;
+  CHECK(gcCopies > 0);
+
+  minErases = maxErases = pageErases[0];
+  for ( p = 1; p < PAGE_COUNT; p++ )
+  {
+    minErases = (pageErases[p] < minErases) ? pageErases[p] : minErases;
+    maxErases = (pageErases[p] > maxErases) ? pageErases[p] : maxErases;
+  }
+  printf("%u updates: page erases %u to %u, %u records moved by GC\n",
+         (unsigned)updates, (unsigned)minErases, (unsigned)maxErases,
+         (unsigned)gcCopies);
+  CHECK(minErases > 0);
+  CHECK(maxErases - minErases <= 1);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Fill the store with large values until it is full: kvNoSpace, nothing
+ *   lost, and room again after a delete
+ ******************************************************************************/
+static void checkFull(void)
+{
+  uint8_t data[KV_MAX_VALUE_SIZE];
+  kvStats_TypeDef stats;
+  kvStatus_TypeDef status = kvOk;
+  uint32_t capacity = (PAGE_COUNT - 2) * (PAGE_WORDS - 2);
+  uint16_t key;
+  Model model;
+
+  format(&model);
+  memset(data, 0x5A, sizeof(data));
+  for ( key = 0; (key < KV_MAX_KEYS) && (status == kvOk); key++ )
+  {
+    data[0] = (uint8_t)key;
+    status = kvWrite(key, data, sizeof(data));
+    if ( status == kvOk )
+    {
+      model.present[key] = true;
+      model.size[key] = sizeof(data);
+      memcpy(model.data[key], data, sizeof(data));
+    }
+  }
+  CHECK(status == kvNoSpace);
+  kvGetStats(&stats);
+  CHECK(stats.liveWords <= capacity);
+  CHECK(checkAll(&model) == 0);
+
+  /* Updates of the keys in place still fit */
+  for ( key = 0; key < 8; key++ )
+  {
+    data[0] = (uint8_t)key;
+    data[1] = (uint8_t)(key + 1);
+    CHECK(kvWrite(key, data, sizeof(data)) == kvOk);
+    memcpy(model.data[key], data, sizeof(data));
+  }
+  CHECK(kvInit(&kvFlash) == kvOk);
+  CHECK(checkAll(&model) == 0);
+
+  /* A delete makes room for a new key */
+  key = 0;
+  while ( model.present[key] )
+  {
+    key++;
+  }
+  CHECK(kvWrite(key, data, sizeof(data)) == kvNoSpace);
+  CHECK(kvDelete(0) == kvOk);
+  model.present[0] = false;
+  CHECK(kvWrite(key, data, sizeof(data)) == kvOk);
+  model.present[key] = true;
+  model.size[key] = sizeof(data);
+  memcpy(model.data[key], data, sizeof(data));
+  CHECK(kvInit(&kvFlash) == kvOk);
+  CHECK(checkAll(&model) == 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Cut the power in each step of each of 'updates' random updates, which
+ *   go through several page switches and garbage collections. After each
+ *   cut the store is mounted again and must hold the model, the key being
+ *   updated with its old or new value, then take further updates.
+ ******************************************************************************/
+static void checkPowerCuts(uint32_t updates)
+{
+  static uint32_t saved[PAGE_COUNT][PAGE_WORDS];
+  static uint32_t savedErases[PAGE_COUNT];
+  uint32_t u, cut, cuts = 0, savedSeed, i;
+  Model model, before, after;
+  kvStatus_TypeDef status;
+  bool done;
+
+  format(&model);
+  for ( u = 0; u < updates; u++ )
+  {
+    memcpy(saved, flash, sizeof(flash));
+    memcpy(savedErases, pageErases, sizeof(pageErases));
+    before = model;
+    savedSeed = seed;
+
+    /* The update cut short after 0, 1, 2... steps, until it goes through */
+    done = false;
+    for ( cut = 0; !done; cut++ )
+    {
+      memcpy(flash, saved, sizeof(flash));
+      seed = savedSeed;
+      after = before;
+      powerOn();
+      CHECK(kvInit(&kvFlash) == kvOk);
+      stepsLeft = cut;
+      randomUpdate(&after, 12, KV_MAX_VALUE_SIZE / 2);
+      done = !powerOff;
+      powerOn();
+      CHECK(kvInit(&kvFlash) == kvOk);
+      for ( i = 0; i < KV_MAX_KEYS; i++ )
+      {
+        if ( !keyMatches(&before, &after, (uint16_t)i) )
+        {
+          printf("update %u cut after %u steps: key %u lost\n",
+                 (unsigned)u, (unsigned)cut, (unsigned)i);
+          hostFailures++;
+        }
+      }
+      cuts++;
+
+      /* Two more updates go through and are found after a remount */
+      if ( !done )
+      {
+        Model next = before;
+
+        for ( i = 0; i < KV_MAX_KEYS; i++ )
+        {
+          if ( keyMatches(&after, NULL, (uint16_t)i) )
+          {
+            next.present[i] = after.present[i];
+            next.size[i] = after.size[i];
+            memcpy(next.data[i], after.data[i], KV_MAX_VALUE_SIZE);
+          }
+        }
+        status = randomUpdate(&next, 12, KV_MAX_VALUE_SIZE / 2);
+        CHECK(status != kvNoSpace);
+        status = randomUpdate(&next, 12, KV_MAX_VALUE_SIZE / 2);
+        CHECK(status != kvNoSpace);
+        CHECK(kvInit(&kvFlash) == kvOk);
+        CHECK(checkAll(&next) == 0);
+      }
+    }
+
+    /* Go on from the update that went through */
+    memcpy(flash, saved, sizeof(flash));
+    memcpy(pageErases, savedErases, sizeof(pageErases));
+    seed = savedSeed;
+    model = before;
+    powerOn();
+    CHECK(kvInit(&kvFlash) == kvOk);
+    randomUpdate(&model, 12, KV_MAX_VALUE_SIZE / 2);
+  }
+  CHECK(checkAll(&model) == 0);
+  printf("%u power cuts in %u updates\n", (unsigned)cuts, (unsigned)updates);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash words written and erases per update of a value of 'size' bytes to
+ *   one of 'keys' keys, against erasing a page and writing the value for
+ *   each update
+ ******************************************************************************/
+static void benchmark(uint32_t keys, uint16_t size, uint32_t updates)
+{
+  uint8_t data[KV_MAX_VALUE_SIZE];
+  kvStats_TypeDef stats;
+  uint32_t u, payloadWords = (size + 3) / 4;
+  Model model;
+
+  format(&model);
+  CHECK(kvInit(&kvFlash) == kvOk);
+  for ( u = 0; u < updates; u++ )
+  {
+    memset(data, (int)(u & 0xFF), size);
+    data[0] = (uint8_t)(u >> 8);
+    CHECK(kvWrite((uint16_t)(u % keys), data, size) == kvOk);
+  }
+  kvGetStats(&stats);
+  printf("%2u keys of %2u bytes: %5.2f words and %6.4f erases per update, "
+         "write amplification %4.2f (erase and write: %u words, 1 erase)\n",
+         (unsigned)keys, (unsigned)size,
+         (double)stats.wordsWritten / updates,
+         (double)stats.erases / updates,
+         (double)stats.wordsWritten / (updates * payloadWords),
+         (unsigned)payloadWords);
+  CHECK(stats.erases < updates / 10);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t updates = 20000;
+  int option;
+
+  while ( (option = getopt(argc, argv, "n:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'n':
+        updates = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("usage: %s [-n random updates]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  checkBasic();
+  checkRun(updates);
+  checkFull();
+  checkPowerCuts(300);
+  benchmark(1, 4, 10000);
+  benchmark(4, 8, 10000);
+  benchmark(12, 32, 10000);
+
+  hostCheckReport();
+  return 0;
+}
@@ -0,0 +1,66 @@
+/***************************************************************************//**
+ * @file  kv_store.h
+ * @brief Log-structured key/value store spread over several flash pages
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change these to size the RAM index and the largest value
+#define KV_MAX_KEYS         32
+#define KV_MAX_VALUE_SIZE   64
+
+typedef enum {
+  kvOk,
+  kvNotFound,       // Key has never been written or has been deleted
+  kvNoSpace,        // Live data would no longer fit in the store
+  kvInvalid,        // Bad key, size or configuration
+  kvFormatted       // kvInit() found no store and formatted the pages
+} kvStatus_TypeDef;
+
+// Flash the store lives in. Erased flash reads 0xFFFFFFFF and a write can
+// only clear bits, as with the MSC.
+typedef struct {
+  uint32_t *base;         // First page of the store, page aligned
+  uint32_t pageSize;      // Page size in bytes
+  uint32_t pageCount;     // Number of pages, at least 3
+  void (*erase)(uint32_t *page);
+  void (*write)(uint32_t *dst, const uint32_t *src, uint32_t bytes);
+} kvFlash_TypeDef;
+
+// Counters for wear and overhead
+typedef struct {
+  uint32_t erases;        // Page erases since kvInit()
+  uint32_t wordsWritten;  // Flash words written since kvInit()
+  uint32_t gcCopies;      // Records moved by garbage collection
+  uint32_t liveWords;     // Words used by the current value of every key
+  uint32_t freeWords;     // Words left in the active page
+} kvStats_TypeDef;
+
+kvStatus_TypeDef kvInit(const kvFlash_TypeDef *flash);
+kvStatus_TypeDef kvWrite(uint16_t key, const void *data, uint16_t size);
+kvStatus_TypeDef kvRead(uint16_t key, void *data, uint16_t *size);
+kvStatus_TypeDef kvDelete(uint16_t key);
+void kvGetStats(kvStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KV_STORE_H
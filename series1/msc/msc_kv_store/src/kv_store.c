@@ -0,0 +1,450 @@
+/***************************************************************************//**
+ * @file kv_store.c
+ * @brief Log-structured key/value store spread over several flash pages.
+ *
+ * Every update is appended to the active page as a record:
+ *
+ *   word 0     key (bits 31:16) and value size in bytes (bits 15:0)
+ *   word 1     CRC-16-CCITT of word 0 and the value
+ *   word 2..   value, padded to a whole word
+ *
+ * A record with size 0 deletes the key. Each page starts with a magic word
+ * and a sequence number, and the pages are used as a ring so that all of them
+ * are erased equally often. One page is always kept erased. When the active
+ * page is full the erased page becomes the active one, the live records of
+ * the oldest page are copied into it and the oldest page is erased.
+ *
+ * A RAM index holds the address of the current record of every key, so
+ * lookups do not touch the log. This file has no device dependencies.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "kv_store.h"
+
+#define PAGE_MAGIC          0x4B565331UL  // "KVS1"
+#define PAGE_HEADER_WORDS   2
+#define RECORD_HEADER_WORDS 2
+#define BLANK               0xFFFFFFFFUL
+
+#define RECORD_KEY(hdr)     ((uint16_t)((hdr) >> 16))
+#define RECORD_SIZE(hdr)    ((uint16_t)((hdr) & 0xFFFF))
+#define RECORD_WORDS(size)  (RECORD_HEADER_WORDS + (((uint32_t)(size) + 3) / 4))
+
+static const kvFlash_TypeDef *kvFlash;
+static uint32_t wordsPerPage;
+
+// Address of the current record of every key, NULL if none
+static const uint32_t *kvIndex[KV_MAX_KEYS];
+
+static uint32_t activePage;
+static uint32_t activeSeq;
+static uint32_t *writePtr;
+
+static kvStats_TypeDef kvStats;
+
+// Records are assembled here so they can be written with one call
+static uint32_t staging[RECORD_WORDS(KV_MAX_VALUE_SIZE)];
+
+/**************************************************************************//**
+ * @brief
+ *    CRC-16-CCITT of the record header and value
+ *****************************************************************************/
+static uint16_t recordCrc(uint32_t hdr, const uint8_t *data, uint16_t size)
+{
+  uint16_t crc = 0xFFFF;
+  uint8_t  b;
+
+  for (int i = 0; i < 4 + size; i++) {
+    b = (i < 4) ? (uint8_t)(hdr >> (8 * i)) : data[i - 4];
+    crc ^= (uint16_t)b << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static uint32_t *pageStart(uint32_t page)
+{
+  return kvFlash->base + page * wordsPerPage;
+}
+
+static uint32_t *pageEnd(uint32_t page)
+{
+  return pageStart(page) + wordsPerPage;
+}
+
+static bool pageBlank(uint32_t page)
+{
+  for (const uint32_t *p = pageStart(page); p < pageEnd(page); p++) {
+    if (*p != BLANK) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void pageErase(uint32_t page)
+{
+  kvFlash->erase(pageStart(page));
+  kvStats.erases++;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Returns the number of words taken by the record at p, or 0 if p is the
+ *    end of the log in this page. *valid is set if the record CRC matches.
+ *****************************************************************************/
+static uint32_t recordAt(const uint32_t *p, const uint32_t *end, bool *valid)
+{
+  uint32_t hdr;
+  uint32_t words;
+
+  *valid = false;
+  if ((p + RECORD_HEADER_WORDS > end) || (*p == BLANK)) {
+    return 0;
+  }
+
+  hdr = p[0];
+  words = RECORD_WORDS(RECORD_SIZE(hdr));
+  if ((RECORD_SIZE(hdr) > KV_MAX_VALUE_SIZE) || (p + words > end)) {
+    // A header cut short by a reset, the last word written in the page.
+    // Only it is skipped so the log goes on after it; skipping to the end
+    // would leave no room to finish an interrupted garbage collection.
+    return 1;
+  }
+
+  // A record interrupted by a reset fails the CRC but can still be skipped
+  *valid = (RECORD_KEY(hdr) < KV_MAX_KEYS)
+           && (p[1] == recordCrc(hdr, (const uint8_t *)&p[2], RECORD_SIZE(hdr)));
+  return words;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Point the index for key at a new record (or NULL) and keep the live
+ *    data count in step
+ *****************************************************************************/
+static void indexSet(uint16_t key, const uint32_t *record)
+{
+  if (kvIndex[key] != NULL) {
+    kvStats.liveWords -= RECORD_WORDS(RECORD_SIZE(kvIndex[key][0]));
+  }
+  kvIndex[key] = record;
+  if (record != NULL) {
+    kvStats.liveWords += RECORD_WORDS(RECORD_SIZE(record[0]));
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Add the records of a page to the index. Returns the end of the log.
+ *****************************************************************************/
+static uint32_t *scanPage(uint32_t page)
+{
+  uint32_t *p = pageStart(page) + PAGE_HEADER_WORDS;
+  uint32_t *end = pageEnd(page);
+  uint32_t words;
+  bool valid;
+
+  while ((words = recordAt(p, end, &valid)) != 0) {
+    if (valid) {
+      indexSet(RECORD_KEY(p[0]), (RECORD_SIZE(p[0]) != 0) ? p : NULL);
+    }
+    p += words;
+  }
+  return p;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Write the record in the staging buffer to the end of the active page
+ *
+ * @return
+ *    Address of the new record, NULL if it does not fit
+ *****************************************************************************/
+static const uint32_t *appendStaged(void)
+{
+  uint32_t words = RECORD_WORDS(RECORD_SIZE(staging[0]));
+  uint32_t *record = writePtr;
+
+  if (writePtr + words > pageEnd(activePage)) {
+    return NULL;
+  }
+
+  kvFlash->write(writePtr, staging, words * 4);
+  writePtr += words;
+  kvStats.wordsWritten += words;
+  return record;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Write the header of an erased page. The sequence number goes first: a
+ *    page only counts once its magic is written, so a reset in between
+ *    cannot leave a page with a blank sequence number.
+ *****************************************************************************/
+static void writePageHeader(uint32_t page, uint32_t seq)
+{
+  static const uint32_t magic = PAGE_MAGIC;
+
+  kvFlash->write(pageStart(page) + 1, &seq, sizeof(seq));
+  kvFlash->write(pageStart(page), &magic, sizeof(magic));
+  kvStats.wordsWritten += PAGE_HEADER_WORDS;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Copy the live records of a page to the active page and erase it
+ *****************************************************************************/
+static void collectPage(uint32_t page)
+{
+  const uint32_t *p = pageStart(page) + PAGE_HEADER_WORDS;
+  const uint32_t *end = pageEnd(page);
+  const uint32_t *copy;
+  uint32_t words;
+  bool valid;
+
+  if (pageStart(page)[0] == PAGE_MAGIC) {
+    while ((words = recordAt(p, end, &valid)) != 0) {
+      if (valid && (kvIndex[RECORD_KEY(p[0])] == p)) {
+        memcpy(staging, p, words * 4);
+        copy = appendStaged();
+        if (copy == NULL) {
+          // Only possible if the capacity check in kvWrite() was bypassed
+          return;
+        }
+        indexSet(RECORD_KEY(p[0]), copy);
+        kvStats.gcCopies++;
+      }
+      p += words;
+    }
+  }
+  pageErase(page);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Move on to the erased page and reclaim the oldest page
+ *****************************************************************************/
+static void nextPage(void)
+{
+  activePage = (activePage + 1) % kvFlash->pageCount;
+  activeSeq++;
+
+  if (!pageBlank(activePage)) {
+    pageErase(activePage);
+  }
+
+  writePageHeader(activePage, activeSeq);
+  writePtr = pageStart(activePage) + PAGE_HEADER_WORDS;
+
+  // The page after the active one is the oldest, it becomes the erased page
+  collectPage((activePage + 1) % kvFlash->pageCount);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Fill the staging buffer with a record
+ *****************************************************************************/
+static void stageRecord(uint16_t key, const void *data, uint16_t size)
+{
+  staging[0] = ((uint32_t)key << 16) | size;
+  staging[RECORD_WORDS(size) - 1] = BLANK;
+  if (size != 0) {
+    memcpy(&staging[RECORD_HEADER_WORDS], data, size);
+  }
+  staging[1] = recordCrc(staging[0], (const uint8_t *)&staging[RECORD_HEADER_WORDS], size);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Append a record, switching pages as often as needed. The record is
+ *    staged again after a page switch as garbage collection reuses the
+ *    staging buffer.
+ *****************************************************************************/
+static kvStatus_TypeDef appendRecord(uint16_t key, const void *data, uint16_t size)
+{
+  const uint32_t *record;
+
+  for (uint32_t i = 0; i <= kvFlash->pageCount; i++) {
+    stageRecord(key, data, size);
+    record = appendStaged();
+    if (record != NULL) {
+      indexSet(key, (size != 0) ? record : NULL);
+      return kvOk;
+    }
+    nextPage();
+  }
+  return kvNoSpace;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Mount the store, formatting it if no valid page is found
+ *
+ * @details
+ *    The index is rebuilt by scanning the pages from the oldest to the
+ *    active one. If a reset interrupted garbage collection the page being
+ *    collected is finished off here.
+ *****************************************************************************/
+kvStatus_TypeDef kvInit(const kvFlash_TypeDef *flash)
+{
+  uint32_t *start;
+  uint32_t page;
+  bool found = false;
+
+  if ((flash->pageCount < 3) || (flash->pageSize % 4 != 0)
+      || (flash->pageSize < 4 * (PAGE_HEADER_WORDS + RECORD_WORDS(KV_MAX_VALUE_SIZE)))) {
+    return kvInvalid;
+  }
+
+  kvFlash = flash;
+  wordsPerPage = flash->pageSize / 4;
+  memset(kvIndex, 0, sizeof(kvIndex));
+  memset(&kvStats, 0, sizeof(kvStats));
+
+  // The active page carries the highest sequence number. A page with a
+  // blank one had its header cut short, it is not taken as the newest.
+  for (page = 0; page < flash->pageCount; page++) {
+    start = pageStart(page);
+    if ((start[0] == PAGE_MAGIC) && (start[1] != BLANK)
+        && (!found || (start[1] > activeSeq))) {
+      activePage = page;
+      activeSeq = start[1];
+      found = true;
+    }
+  }
+
+  if (!found) {
+    for (page = 0; page < flash->pageCount; page++) {
+      if (!pageBlank(page)) {
+        pageErase(page);
+      }
+    }
+    activePage = 0;
+    activeSeq = 1;
+    writePageHeader(0, activeSeq);
+    writePtr = pageStart(0) + PAGE_HEADER_WORDS;
+    return kvFormatted;
+  }
+
+  // Oldest to newest so that later records override earlier ones
+  for (uint32_t i = 1; i <= flash->pageCount; i++) {
+    page = (activePage + i) % flash->pageCount;
+    if (pageStart(page)[0] == PAGE_MAGIC) {
+      start = scanPage(page);
+      if (page == activePage) {
+        writePtr = start;
+      }
+    }
+  }
+
+  // The page after the active one must be erased
+  page = (activePage + 1) % flash->pageCount;
+  if (!pageBlank(page)) {
+    collectPage(page);
+  }
+
+  return kvOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Store a value. Nothing is written if the value is unchanged.
+ *****************************************************************************/
+kvStatus_TypeDef kvWrite(uint16_t key, const void *data, uint16_t size)
+{
+  uint32_t oldWords = 0;
+  uint32_t capacity;
+
+  if ((kvFlash == NULL) || (key >= KV_MAX_KEYS)
+      || (size == 0) || (size > KV_MAX_VALUE_SIZE)) {
+    return kvInvalid;
+  }
+
+  if (kvIndex[key] != NULL) {
+    if ((RECORD_SIZE(kvIndex[key][0]) == size)
+        && (memcmp(&kvIndex[key][RECORD_HEADER_WORDS], data, size) == 0)) {
+      return kvOk;
+    }
+    oldWords = RECORD_WORDS(RECORD_SIZE(kvIndex[key][0]));
+  }
+
+  // Live data must fit in all pages but the erased and the active one
+  capacity = (kvFlash->pageCount - 2) * (wordsPerPage - PAGE_HEADER_WORDS);
+  if (kvStats.liveWords - oldWords + RECORD_WORDS(size) > capacity) {
+    return kvNoSpace;
+  }
+
+  return appendRecord(key, data, size);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Read a value
+ *
+ * @param[in,out] size
+ *    Size of the data buffer on entry, size of the value on return
+ *
+ * @return
+ *    kvInvalid if the buffer is too small, *size then holds the value size
+ *****************************************************************************/
+kvStatus_TypeDef kvRead(uint16_t key, void *data, uint16_t *size)
+{
+  uint16_t valueSize;
+
+  if ((kvFlash == NULL) || (key >= KV_MAX_KEYS)) {
+    return kvInvalid;
+  }
+  if (kvIndex[key] == NULL) {
+    return kvNotFound;
+  }
+
+  valueSize = RECORD_SIZE(kvIndex[key][0]);
+  if (*size < valueSize) {
+    *size = valueSize;
+    return kvInvalid;
+  }
+
+  memcpy(data, &kvIndex[key][RECORD_HEADER_WORDS], valueSize);
+  *size = valueSize;
+  return kvOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Delete a key
+ *****************************************************************************/
+kvStatus_TypeDef kvDelete(uint16_t key)
+{
+  if ((kvFlash == NULL) || (key >= KV_MAX_KEYS)) {
+    return kvInvalid;
+  }
+  if (kvIndex[key] == NULL) {
+    return kvNotFound;
+  }
+
+  return appendRecord(key, NULL, 0);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Get the wear and usage counters
+ *****************************************************************************/
+void kvGetStats(kvStats_TypeDef *stats)
+{
+  *stats = kvStats;
+  stats->freeWords = (kvFlash != NULL) ? (uint32_t)(pageEnd(activePage) - writePtr) : 0;
+}
@@ -0,0 +1,105 @@
+/**************************************************************************//**
+ * @file
+ * @brief This project demonstrates a wear-levelled key/value store kept in
+ * the last pages of the main flash. A boot counter and a set of values are
+ * updated without erasing a page for every write.
+ ******************************************************************************
+ * @section License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_msc.h"
+#include "kv_store.h"
+
+// Note: change this to use more or fewer pages for the store
+#define KV_PAGES        4
+
+// The store occupies the last KV_PAGES pages of the main flash
+#define KV_BASE         ((uint32_t*)(FLASH_BASE + FLASH_SIZE - KV_PAGES * FLASH_PAGE_SIZE))
+
+// Keys used by this example
+#define KEY_BOOT_COUNT  0
+#define KEY_SAMPLE      1
+
+// Number of sample updates written per boot
+#define SAMPLE_UPDATES  500
+
+/**************************************************************************//**
+ * @brief  Erase one page of the store
+ *****************************************************************************/
+static void flashErase(uint32_t *page)
+{
+  MSC_ErasePage(page);
+}
+
+/**************************************************************************//**
+ * @brief  Program words into the store
+ *****************************************************************************/
+static void flashWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  MSC_WriteWord(dst, src, bytes);
+}
+
+const kvFlash_TypeDef kvFlash = {
+  KV_BASE,
+  FLASH_PAGE_SIZE,
+  KV_PAGES,
+  flashErase,
+  flashWrite
+};
+
+// Values to watch in the debugger
+kvStatus_TypeDef mountStatus;
+uint32_t bootCount;
+uint32_t lastSample;
+kvStats_TypeDef stats;
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint16_t size;
+
+  // Chip errata
+  CHIP_Init();
+
+  MSC_Init();
+
+  // Rebuild the RAM index from the log (formats the pages on first use)
+  mountStatus = kvInit(&kvFlash);
+
+  // Count the number of boots
+  size = sizeof(bootCount);
+  if (kvRead(KEY_BOOT_COUNT, &bootCount, &size) != kvOk) {
+    bootCount = 0;
+  }
+  bootCount++;
+  kvWrite(KEY_BOOT_COUNT, &bootCount, sizeof(bootCount));
+
+  // Frequent small updates only append a record, pages are erased in turn
+  for (uint32_t i = 0; i < SAMPLE_UPDATES; i++) {
+    uint32_t sample = (bootCount << 16) | i;
+    kvWrite(KEY_SAMPLE, &sample, sizeof(sample));
+  }
+
+  // Read back the last value through the RAM index
+  size = sizeof(lastSample);
+  kvRead(KEY_SAMPLE, &lastSample, &size);
+
+  kvGetStats(&stats);
+
+  MSC_Deinit();
+
+  // Infinite Loop
+  while(1);
+}
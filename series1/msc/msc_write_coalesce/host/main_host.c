@@ -0,0 +1,431 @@
+/**************************************************************************//**
+ * @file
+ * @brief Write coalescing on a host: checks, power loss and flash wear
+ *
+ * Build on its own, see readme.txt. The two snapshot pages are kept in RAM,
+ * where like flash an erase sets every bit and a write can only clear bits,
+ * and the shadow is a RAM array that a power loss fills with garbage. Random
+ * bursts of small updates are checked against a model of the values: after a
+ * reset with the shadow kept every update is there, and after a power loss
+ * the values are those of the last snapshot. With a flush on the low voltage
+ * warning, as the VMON interrupt of main.c does, a power loss loses nothing.
+ * The power is also cut in each flash step of a snapshot, an erase or one
+ * word written, leaving that step half done: the old or the new snapshot
+ * must then be restored.
+ *
+ * The flash words written and the erases of the counter of main.c are
+ * printed for its flush threshold and for no coalescing at all, next to an
+ * erase and write for every update.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "write_coalesce.h"
+#include "host_check.h"
+
+#define PAGE_SIZE           2048
+#define PAGE_WORDS          (PAGE_SIZE / 4)
+#define VALUE_COUNT         4
+
+/* As in main.c */
+#define FLUSH_THRESHOLD     100
+#define FLUSH_TICKS         60
+#define TICK_WAKEUPS        4
+#define WRITE_WORD_ENERGY   180
+#define ERASE_ENERGY        150000
+
+static uint32_t flash[2][PAGE_WORDS];
+static volatile uint32_t shadow[WC_SHADOW_WORDS(WC_MAX_VALUES)];
+static uint32_t seed = 1;
+
+/* Flash operations done, counted here rather than trusted to wcGetStats() */
+static uint32_t erases;
+static uint32_t wordsWritten;
+
+/* Whole steps left before the power is cut in the next one */
+static uint32_t stepsLeft = UINT32_MAX;
+static bool powerOff;
+
+/***************************************************************************//**
+ * @brief
+ *   Take one flash step. Returns false once the power is off, and sets
+ *   'partial' for the step the power is cut in.
+ ******************************************************************************/
+static bool step(bool *partial)
+{
+  *partial = false;
+  if ( powerOff )
+  {
+    return false;
+  }
+  if ( stepsLeft == 0 )
+  {
+    *partial = true;
+    powerOff = true;
+    return true;
+  }
+  if ( stepsLeft != UINT32_MAX )
+  {
+    stepsLeft--;
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash erase on RAM, a cut one erases only some of the words
+ ******************************************************************************/
+static void ramErase(uint32_t *page)
+{
+  bool partial;
+  uint32_t i;
+
+  CHECK((page == flash[0]) || (page == flash[1]));
+  if ( !step(&partial) )
+  {
+    return;
+  }
+  for ( i = 0; i < PAGE_WORDS; i++ )
+  {
+    if ( !partial || (hostRandom(&seed) & 1) )
+    {
+      page[i] = 0xFFFFFFFF;
+    }
+  }
+  erases++;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Flash write on RAM, which can only clear bits; a cut word has only some
+ *   of its bits cleared
+ ******************************************************************************/
+static void ramWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  bool partial;
+  uint32_t i;
+
+  for ( i = 0; i < bytes / 4; i++ )
+  {
+    if ( !step(&partial) )
+    {
+      return;
+    }
+    dst[i] &= partial ? (src[i] | (hostRandom(&seed) << 8) | hostRandom(&seed))
+                      : src[i];
+    wordsWritten++;
+  }
+}
+
+static wcConfig_TypeDef config =
+{
+  { flash[0], flash[1] }, PAGE_SIZE, VALUE_COUNT, shadow,
+  FLUSH_THRESHOLD, FLUSH_TICKS, WRITE_WORD_ENERGY, ERASE_ENERGY,
+  ramErase, ramWrite
+};
+
+/* Erased flash and a shadow of garbage, as on a new device */
+static void blank(void)
+{
+  uint32_t i;
+
+  memset(flash, 0xFF, sizeof(flash));
+  for ( i = 0; i < WC_SHADOW_WORDS(WC_MAX_VALUES); i++ )
+  {
+    shadow[i] = hostRandom(&seed);
+  }
+  erases = 0;
+  wordsWritten = 0;
+  stepsLeft = UINT32_MAX;
+  powerOff = false;
+}
+
+/* Power loss: the shadow in RAM is lost, the flash is kept */
+static wcRestore_TypeDef powerLoss(void)
+{
+  uint32_t i;
+
+  for ( i = 0; i < WC_SHADOW_WORDS(WC_MAX_VALUES); i++ )
+  {
+    shadow[i] = hostRandom(&seed);
+  }
+  stepsLeft = UINT32_MAX;
+  powerOff = false;
+  return wcInit(&config);
+}
+
+static bool valuesAre(const uint32_t *model)
+{
+  uint32_t i;
+
+  for ( i = 0; i < VALUE_COUNT; i++ )
+  {
+    if ( wcGet(i) != model[i] )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A random update of the model and of the values, with a tick now and
+ *   then. 'flushed' follows the values as of the last snapshot.
+ ******************************************************************************/
+static void randomUpdate(uint32_t *model, uint32_t *flushed)
+{
+  uint32_t index = hostRandom(&seed) % VALUE_COUNT;
+  uint32_t value;
+
+  if ( hostRandom(&seed) & 1 )
+  {
+    value = hostRandom(&seed) % 4;
+    model[index] += value;
+    wcAdd(index, value);
+  }
+  else
+  {
+    value = hostRandom(&seed) % 8;
+    model[index] = value;
+    wcSet(index, value);
+  }
+  if ( hostRandom(&seed) % TICK_WAKEUPS == 0 )
+  {
+    wcTick();
+  }
+  if ( wcPending() == 0 )
+  {
+    memcpy(flushed, model, VALUE_COUNT * sizeof(uint32_t));
+  }
+}
+
+static void checkConfig(void)
+{
+  wcConfig_TypeDef bad = config;
+
+  bad.count = 0;
+  CHECK(wcInit(&bad) == wcInvalid);
+  bad.count = WC_MAX_VALUES + 1;
+  CHECK(wcInit(&bad) == wcInvalid);
+  bad = config;
+  bad.pageSize = 4 * (VALUE_COUNT + 1);
+  CHECK(wcInit(&bad) == wcInvalid);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Bursts of updates, each followed by a reset with the shadow kept or a
+ *   power loss, with or without a flush on the low voltage warning first
+ ******************************************************************************/
+static void checkBursts(uint32_t bursts)
+{
+  uint32_t model[VALUE_COUNT] = { 0 };
+  uint32_t flushed[VALUE_COUNT] = { 0 };
+  uint32_t b, u, length, lost = 0, vmonFlushes = 0;
+  wcRestore_TypeDef restore;
+
+  blank();
+  CHECK(wcInit(&config) == wcRestoredNone);
+  CHECK(valuesAre(model));
+  for ( b = 0; b < bursts; b++ )
+  {
+    length = hostRandom(&seed) % (3 * FLUSH_THRESHOLD);
+    for ( u = 0; u < length; u++ )
+    {
+      randomUpdate(model, flushed);
+    }
+    CHECK(valuesAre(model));
+    CHECK(wcPending() < FLUSH_THRESHOLD);
+
+    switch ( hostRandom(&seed) % 3 )
+    {
+      case 0:
+        /* Reset, the shadow in retention registers is kept */
+        restore = wcInit(&config);
+        CHECK(restore == wcRestoredShadow);
+        CHECK(valuesAre(model));
+        if ( wcPending() == 0 )
+        {
+          memcpy(flushed, model, sizeof(model));
+        }
+        break;
+
+      case 1:
+        /* Power loss with no warning: the updates since the last snapshot
+           are lost */
+        if ( !valuesAre(flushed) )
+        {
+          lost++;
+        }
+        restore = powerLoss();
+        CHECK(restore == ((wordsWritten == 0) ? wcRestoredNone
+                          : wcRestoredFlash));
+        CHECK(valuesAre(flushed));
+        memcpy(model, flushed, sizeof(model));
+        break;
+
+      default:
+        /* VMON warns of the power loss: flush, nothing is lost */
+        if ( wcFlush() )
+        {
+          vmonFlushes++;
+        }
+        CHECK(wcPending() == 0);
+        memcpy(flushed, model, sizeof(model));
+        powerLoss();
+        CHECK(valuesAre(model));
+        break;
+    }
+  }
+  printf("%u bursts: %u power losses with no warning lost updates, "
+         "none did after the %u VMON flushes\n",
+         (unsigned)bursts, (unsigned)lost, (unsigned)vmonFlushes);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Cut the power in each step of a snapshot, with and without a page erase:
+ *   the old or the new snapshot is restored, and the next ones go through
+ ******************************************************************************/
+static void checkPowerCuts(void)
+{
+  static uint32_t saved[2][PAGE_WORDS];
+  uint32_t slotWords = WC_SHADOW_WORDS(VALUE_COUNT);
+  uint32_t slotsPerPage = PAGE_WORDS / slotWords;
+  uint32_t before[VALUE_COUNT], after[VALUE_COUNT];
+  uint32_t snapshots, cut, i, cuts = 0;
+  bool done;
+
+  /* Snapshots up to the last slot of the first page, of the second page,
+     then into the first page again */
+  for ( snapshots = 1; snapshots <= 3 * slotsPerPage; snapshots++ )
+  {
+    if ( (snapshots % slotsPerPage > 1)
+         && (snapshots % slotsPerPage < slotsPerPage - 1) )
+    {
+      continue;
+    }
+    blank();
+    CHECK(wcInit(&config) == wcRestoredNone);
+    for ( i = 0; i < snapshots; i++ )
+    {
+      wcSet(0, i + 1);
+      wcSet(1, ~i);
+      CHECK(wcFlush());
+    }
+    for ( i = 0; i < VALUE_COUNT; i++ )
+    {
+      before[i] = wcGet(i);
+    }
+    memcpy(saved, flash, sizeof(flash));
+
+    done = false;
+    for ( cut = 0; !done; cut++ )
+    {
+      memcpy(flash, saved, sizeof(flash));
+      CHECK(powerLoss() == wcRestoredFlash);
+      CHECK(valuesAre(before));
+      wcSet(0, 0xA5A5A5A5);
+      wcSet(2, snapshots);
+      for ( i = 0; i < VALUE_COUNT; i++ )
+      {
+        after[i] = wcGet(i);
+      }
+      stepsLeft = cut;
+      wcFlush();
+      done = !powerOff;
+      cuts++;
+
+      powerLoss();
+      CHECK(valuesAre(before) || valuesAre(after));
+      CHECK(!done || valuesAre(after));
+
+      /* The next snapshots go through */
+      for ( i = 0; i < 3; i++ )
+      {
+        wcSet(3, i + 1);
+        CHECK(wcFlush());
+      }
+      CHECK(powerLoss() == wcRestoredFlash);
+      CHECK(wcGet(3) == 3);
+    }
+  }
+  printf("%u power cuts in snapshots\n", (unsigned)cuts);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The counter of main.c, incremented on every wakeup with a tick every
+ *   TICK_WAKEUPS wakeups, written with a flush threshold of 'threshold'
+ ******************************************************************************/
+static void benchmark(uint32_t threshold, uint32_t updates)
+{
+  wcStats_TypeDef stats;
+  uint32_t u;
+
+  blank();
+  config.flushThreshold = threshold;
+  CHECK(wcInit(&config) == wcRestoredNone);
+  for ( u = 0; u < updates; u++ )
+  {
+    wcAdd(0, 1);
+    if ( (u + 1) % TICK_WAKEUPS == 0 )
+    {
+      wcTick();
+    }
+  }
+  wcGetStats(&stats);
+  CHECK(stats.updates == updates);
+  CHECK(stats.wordsWritten == wordsWritten);
+  CHECK(stats.erases == erases);
+  printf("threshold %3u: %7u words written, %5u erases, %6u nJ per update\n",
+         (unsigned)threshold, (unsigned)wordsWritten, (unsigned)erases,
+         (unsigned)stats.energyPerUpdate);
+  config.flushThreshold = FLUSH_THRESHOLD;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t bursts = 1000;
+  uint32_t updates = 100000;
+  int option;
+
+  while ( (option = getopt(argc, argv, "n:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'n':
+        bursts = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("usage: %s [-n random bursts]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  checkConfig();
+  checkBursts(bursts);
+  checkPowerCuts();
+
+  benchmark(1, updates);
+  benchmark(FLUSH_THRESHOLD, updates);
+  printf("erase and write: %7u words written, %5u erases, %6u nJ per update\n",
+         (unsigned)updates, (unsigned)updates,
+         (unsigned)(WRITE_WORD_ENERGY + ERASE_ENERGY));
+
+  hostCheckReport();
+  return 0;
+}
@@ -0,0 +1,75 @@
+/***************************************************************************//**
+ * @file  write_coalesce.h
+ * @brief Coalescing of frequent small updates into whole flash snapshots
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef WRITE_COALESCE_H
+#define WRITE_COALESCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change this to allow more values per snapshot
+#define WC_MAX_VALUES   16
+
+// Words of shadow storage needed for 'count' values
+#define WC_SHADOW_WORDS(count)  ((count) + 2)
+
+// Why wcInit() picked the values it started with
+typedef enum {
+  wcRestoredShadow,   // Shadow was intact (e.g. retention registers after EM4)
+  wcRestoredFlash,    // Last snapshot in flash
+  wcRestoredNone,     // Nothing found, all values are 0
+  wcInvalid           // Bad configuration
+} wcRestore_TypeDef;
+
+typedef struct {
+  uint32_t *page[2];            // Two pages used in turn for snapshots
+  uint32_t pageSize;            // Page size in bytes
+  uint32_t count;               // Number of values, at most WC_MAX_VALUES
+  volatile uint32_t *shadow;    // WC_SHADOW_WORDS(count) words of RAM or
+                                // retention registers holding pending values
+  uint32_t flushThreshold;      // Flush after this many updates
+  uint32_t flushTicks;          // Flush pending updates after this many ticks
+  uint32_t writeWordEnergy;     // nJ to program one word, for the report
+  uint32_t eraseEnergy;         // nJ to erase one page, for the report
+  void (*erase)(uint32_t *page);
+  void (*write)(uint32_t *dst, const uint32_t *src, uint32_t bytes);
+} wcConfig_TypeDef;
+
+typedef struct {
+  uint32_t updates;             // Calls to wcSet()/wcAdd() that changed a value
+  uint32_t flushes;             // Snapshots written
+  uint32_t erases;              // Page erases
+  uint32_t wordsWritten;        // Flash words programmed
+  uint32_t energyPerUpdate;     // nJ of flash energy per update
+  uint32_t directEnergyPerUpdate; // nJ per update with erase + write each time
+} wcStats_TypeDef;
+
+wcRestore_TypeDef wcInit(const wcConfig_TypeDef *config);
+void wcSet(uint32_t index, uint32_t value);
+void wcAdd(uint32_t index, uint32_t delta);
+uint32_t wcGet(uint32_t index);
+bool wcFlush(void);
+void wcTick(void);
+uint32_t wcPending(void);
+void wcGetStats(wcStats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WRITE_COALESCE_H
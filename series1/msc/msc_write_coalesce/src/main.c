@@ -0,0 +1,217 @@
+/**************************************************************************//**
+ * @file
+ * @brief This project demonstrates coalescing of frequent small updates, a
+ * counter incremented every 256 ms, into flash snapshots written on a
+ * threshold, after a timeout, or when VMON reports that AVDD is dropping.
+ ******************************************************************************
+ * @section License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_cryotimer.h"
+#include "em_emu.h"
+#include "em_msc.h"
+#include "write_coalesce.h"
+
+// Snapshots use the last two pages of the main flash
+#define PAGE_A          ((uint32_t*)(FLASH_BASE + FLASH_SIZE - 2 * FLASH_PAGE_SIZE))
+#define PAGE_B          ((uint32_t*)(FLASH_BASE + FLASH_SIZE - FLASH_PAGE_SIZE))
+
+// Values kept in flash
+#define VALUE_COUNTER   0
+#define VALUE_BOOTS     1
+#define VALUE_COUNT     2
+
+// Note: change these to trade flash wear for the number of updates that can
+// be lost on a reset without a low voltage warning
+#define FLUSH_THRESHOLD 100   // Updates
+#define FLUSH_TICKS     60    // Ticks of TICK_WAKEUPS cryotimer periods
+
+// Cryotimer period of 256 ULFRCO cycles, about 256 ms; one tick is about 1 s
+#define CRYOTIMER_PERIOD  cryotimerPeriod_256
+#define TICK_WAKEUPS      4
+
+// Flush when AVDD falls below this voltage (mV)
+#define THRESHOLD_VOLTAGE 3000
+
+// Typical flash energy at 3.3 V, only used for the report
+#define WRITE_WORD_ENERGY 180     // nJ, about 20 us at 9 mA
+#define ERASE_ENERGY      150000  // nJ, about 20 ms at 2.3 mA
+
+// The shadow lives in the RTCC retention registers where there is an RTCC,
+// so pending updates also survive EM4H and resets other than power-on
+#if defined(RTCC_PRESENT)
+#define SHADOW          ((volatile uint32_t *)&RTCC->RET[0].REG)
+#else
+static uint32_t shadowRam[WC_SHADOW_WORDS(VALUE_COUNT)];
+#define SHADOW          ((volatile uint32_t *)shadowRam)
+#endif
+
+/**************************************************************************//**
+ * @brief  Erase one page
+ *****************************************************************************/
+static void flashErase(uint32_t *page)
+{
+  MSC_ErasePage(page);
+}
+
+/**************************************************************************//**
+ * @brief  Program words
+ *****************************************************************************/
+static void flashWrite(uint32_t *dst, const uint32_t *src, uint32_t bytes)
+{
+  MSC_WriteWord(dst, src, bytes);
+}
+
+const wcConfig_TypeDef config = {
+  { PAGE_A, PAGE_B },
+  FLASH_PAGE_SIZE,
+  VALUE_COUNT,
+  SHADOW,
+  FLUSH_THRESHOLD,
+  FLUSH_TICKS,
+  WRITE_WORD_ENERGY,
+  ERASE_ENERGY,
+  flashErase,
+  flashWrite
+};
+
+// Values to watch in the debugger
+wcRestore_TypeDef restore;
+wcStats_TypeDef stats;
+uint32_t lowVoltageFlushes;
+
+volatile bool wakeup;
+volatile bool lowVoltage;
+
+/**************************************************************************//**
+ * @brief  Cryotimer Handler
+ *****************************************************************************/
+void CRYOTIMER_IRQHandler(void)
+{
+  // Acknowledge the interrupt
+  uint32_t flags = CRYOTIMER_IntGet();
+  CRYOTIMER_IntClear(flags);
+
+  wakeup = true;
+
+  // Put a barrier here to ensure interrupts are not retriggered
+  __DSB();
+}
+
+/**************************************************************************//**
+ * @brief  EMU Handler
+ *****************************************************************************/
+void EMU_IRQHandler(void)
+{
+  // AVDD has dropped below the threshold, the main loop flushes at once
+  EMU_IntClear(EMU_IF_VMONAVDDFALL);
+  lowVoltage = true;
+}
+
+/**************************************************************************//**
+ * @brief  Cryotimer initialization
+ *****************************************************************************/
+void initCryotimer(void)
+{
+  // Enable cryotimer clock
+  CMU_ClockEnable(cmuClock_CRYOTIMER, true);
+
+  // Initialize cryotimer
+  CRYOTIMER_Init_TypeDef init = CRYOTIMER_INIT_DEFAULT;
+  init.osc    = cryotimerOscULFRCO;
+  init.presc  = cryotimerPresc_1;
+  init.period = CRYOTIMER_PERIOD;
+  CRYOTIMER_Init(&init);
+
+  // Enable Cryotimer interrupts
+  CRYOTIMER_IntEnable(CRYOTIMER_IF_PERIOD);
+  NVIC_EnableIRQ(CRYOTIMER_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief  VMON initialization
+ *****************************************************************************/
+void initVmon(void)
+{
+  EMU_VmonInit_TypeDef vmonInit = EMU_VMONINIT_DEFAULT;
+  vmonInit.channel = emuVmonChannel_AVDD;
+  vmonInit.threshold = THRESHOLD_VOLTAGE;
+  vmonInit.fallWakeup = true;
+  EMU_VmonInit(&vmonInit);
+
+  // Interrupt when AVDD falls below the threshold
+  EMU_IntClear(EMU_IF_VMONAVDDFALL);
+  EMU_IntEnable(EMU_IF_VMONAVDDFALL);
+  NVIC_ClearPendingIRQ(EMU_IRQn);
+  NVIC_EnableIRQ(EMU_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief  Shadow storage initialization
+ *****************************************************************************/
+void initShadow(void)
+{
+#if defined(RTCC_PRESENT)
+  // The retention registers are accessed through the low energy interface
+  CMU_ClockEnable(cmuClock_CORELE, true);
+  CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_ULFRCO);
+  CMU_ClockEnable(cmuClock_RTCC, true);
+#endif
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t wakeups = 0;
+
+  // Chip errata
+  CHIP_Init();
+
+  initShadow();
+
+  MSC_Init();
+
+  // Restore the values from the shadow, or from the last snapshot
+  restore = wcInit(&config);
+  wcAdd(VALUE_BOOTS, 1);
+
+  initVmon();
+  initCryotimer();
+
+  // Infinite loop
+  while (1) {
+    if (lowVoltage) {
+      lowVoltage = false;
+      if (wcFlush()) {
+        lowVoltageFlushes++;
+      }
+    }
+
+    if (wakeup) {
+      wakeup = false;
+
+      // One small update every wakeup, it only touches the shadow
+      wcAdd(VALUE_COUNTER, 1);
+
+      if (++wakeups == TICK_WAKEUPS) {
+        wakeups = 0;
+        wcTick();
+      }
+      wcGetStats(&stats);
+    }
+
+    EMU_EnterEM2(false);
+  }
+}
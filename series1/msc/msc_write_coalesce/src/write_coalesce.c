@@ -0,0 +1,313 @@
+/***************************************************************************//**
+ * @file write_coalesce.c
+ * @brief Coalescing of frequent small updates into whole flash snapshots.
+ *
+ * Updates only change a shadow copy of the values. The shadow is written to
+ * flash as one snapshot, with a single write call, when enough updates have
+ * accumulated, when pending updates have aged for a number of ticks, or on
+ * request (e.g. on a low voltage warning). Snapshots are appended to one of
+ * two pages:
+ *
+ *   word 0     sequence number
+ *   word 1     CRC-32 of the sequence number and the values
+ *   word 2..   values
+ *
+ * When a page is full the other page is erased and used next, so the newest
+ * snapshot is never erased before a newer one has been written.
+ * This file has no device dependencies.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+#include "write_coalesce.h"
+
+#define SHADOW_MAGIC    0x57435348UL  // "WCSH"
+#define BLANK           0xFFFFFFFFUL
+#define SLOT_HEADER     2
+
+static const wcConfig_TypeDef *wcConfig;
+static uint32_t slotWords;
+static uint32_t slotsPerPage;
+
+static uint32_t activePage;
+static uint32_t nextSlot;
+static uint32_t lastSeq;
+
+static uint32_t pending;
+static uint32_t age;
+
+static wcStats_TypeDef wcStats;
+
+// Snapshot assembled here so it is written with one call
+static uint32_t snapshot[SLOT_HEADER + WC_MAX_VALUES];
+
+/**************************************************************************//**
+ * @brief
+ *    CRC-32 (IEEE 802.3) of the sequence number and the values
+ *****************************************************************************/
+static uint32_t snapshotCrc(uint32_t seq, const uint32_t *values, uint32_t count)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  uint32_t word;
+
+  for (uint32_t i = 0; i <= count; i++) {
+    word = (i == 0) ? seq : values[i - 1];
+    for (int byte = 0; byte < 4; byte++) {
+      crc ^= (word >> (8 * byte)) & 0xFF;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320UL) : (crc >> 1);
+      }
+    }
+  }
+  return ~crc;
+}
+
+static uint32_t *slotAddress(uint32_t page, uint32_t slot)
+{
+  return wcConfig->page[page] + slot * slotWords;
+}
+
+static bool slotValid(const uint32_t *slot)
+{
+  return (slot[0] != BLANK)
+         && (slot[1] == snapshotCrc(slot[0], &slot[SLOT_HEADER], wcConfig->count));
+}
+
+static bool slotBlank(const uint32_t *slot)
+{
+  for (uint32_t i = 0; i < slotWords; i++) {
+    if (slot[i] != BLANK) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Check word kept after the values in the shadow
+ *****************************************************************************/
+static uint32_t shadowCheck(void)
+{
+  uint32_t check = SHADOW_MAGIC ^ 0xFFFFFFFFUL;
+
+  for (uint32_t i = 1; i <= wcConfig->count; i++) {
+    check = (check ^ wcConfig->shadow[i]) * 31;
+  }
+  return check;
+}
+
+static void shadowSeal(void)
+{
+  wcConfig->shadow[0] = SHADOW_MAGIC;
+  wcConfig->shadow[wcConfig->count + 1] = shadowCheck();
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Find the newest snapshot. Returns NULL if there is none.
+ *****************************************************************************/
+static const uint32_t *findNewest(void)
+{
+  const uint32_t *newest = NULL;
+  const uint32_t *slot;
+
+  for (uint32_t page = 0; page < 2; page++) {
+    for (uint32_t i = 0; i < slotsPerPage; i++) {
+      slot = slotAddress(page, i);
+      if (slotValid(slot)
+          && ((newest == NULL) || ((int32_t)(slot[0] - newest[0]) > 0))) {
+        newest = slot;
+        activePage = page;
+        nextSlot = i + 1;
+      }
+    }
+  }
+  return newest;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Restore the values and locate the end of the snapshot log
+ *
+ * @details
+ *    An intact shadow holds updates newer than the last snapshot and is kept
+ *    as is. Otherwise the values are loaded from the newest snapshot.
+ *****************************************************************************/
+wcRestore_TypeDef wcInit(const wcConfig_TypeDef *config)
+{
+  const uint32_t *newest;
+  wcRestore_TypeDef restore;
+
+  if ((config->count == 0) || (config->count > WC_MAX_VALUES)
+      || (config->pageSize < 4 * (SLOT_HEADER + config->count))) {
+    return wcInvalid;
+  }
+
+  wcConfig = config;
+  slotWords = SLOT_HEADER + config->count;
+  slotsPerPage = (config->pageSize / 4) / slotWords;
+  memset(&wcStats, 0, sizeof(wcStats));
+  pending = 0;
+  age = 0;
+
+  activePage = 0;
+  nextSlot = 0;
+  newest = findNewest();
+  lastSeq = (newest != NULL) ? newest[0] : 0;
+
+  // Skip slots left half written by a reset
+  while ((nextSlot < slotsPerPage) && !slotBlank(slotAddress(activePage, nextSlot))) {
+    nextSlot++;
+  }
+
+  if ((config->shadow[0] == SHADOW_MAGIC)
+      && (config->shadow[config->count + 1] == shadowCheck())) {
+    restore = wcRestoredShadow;
+    // The shadow may hold updates that never reached the flash
+    pending = 1;
+  } else if (newest != NULL) {
+    restore = wcRestoredFlash;
+    for (uint32_t i = 0; i < config->count; i++) {
+      config->shadow[i + 1] = newest[SLOT_HEADER + i];
+    }
+    shadowSeal();
+  } else {
+    restore = wcRestoredNone;
+    for (uint32_t i = 0; i < config->count; i++) {
+      config->shadow[i + 1] = 0;
+    }
+    shadowSeal();
+  }
+  return restore;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Write the shadow to flash if there are pending updates
+ *
+ * @return
+ *    true if a snapshot was written
+ *****************************************************************************/
+bool wcFlush(void)
+{
+  uint32_t next;
+
+  if ((wcConfig == NULL) || (pending == 0)) {
+    return false;
+  }
+
+  if (nextSlot >= slotsPerPage) {
+    next = activePage ^ 1;
+    wcConfig->erase(wcConfig->page[next]);
+    wcStats.erases++;
+    activePage = next;
+    nextSlot = 0;
+  }
+
+  lastSeq++;
+  snapshot[0] = lastSeq;
+  for (uint32_t i = 0; i < wcConfig->count; i++) {
+    snapshot[SLOT_HEADER + i] = wcConfig->shadow[i + 1];
+  }
+  snapshot[1] = snapshotCrc(lastSeq, &snapshot[SLOT_HEADER], wcConfig->count);
+
+  wcConfig->write(slotAddress(activePage, nextSlot), snapshot, slotWords * 4);
+  nextSlot++;
+
+  wcStats.flushes++;
+  wcStats.wordsWritten += slotWords;
+  pending = 0;
+  age = 0;
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Set a value. Flushes once flushThreshold updates are pending.
+ *****************************************************************************/
+void wcSet(uint32_t index, uint32_t value)
+{
+  if ((wcConfig == NULL) || (index >= wcConfig->count)
+      || (wcConfig->shadow[index + 1] == value)) {
+    return;
+  }
+
+  wcConfig->shadow[index + 1] = value;
+  shadowSeal();
+  wcStats.updates++;
+
+  if (++pending >= wcConfig->flushThreshold) {
+    wcFlush();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Add to a value, e.g. a counter
+ *****************************************************************************/
+void wcAdd(uint32_t index, uint32_t delta)
+{
+  wcSet(index, wcGet(index) + delta);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Current value, including pending updates
+ *****************************************************************************/
+uint32_t wcGet(uint32_t index)
+{
+  if ((wcConfig == NULL) || (index >= wcConfig->count)) {
+    return 0;
+  }
+  return wcConfig->shadow[index + 1];
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Call periodically. Flushes pending updates older than flushTicks ticks.
+ *****************************************************************************/
+void wcTick(void)
+{
+  if ((wcConfig != NULL) && (pending > 0) && (++age >= wcConfig->flushTicks)) {
+    wcFlush();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Number of updates not yet written to flash
+ *****************************************************************************/
+uint32_t wcPending(void)
+{
+  return pending;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Get the wear and energy counters
+ *****************************************************************************/
+void wcGetStats(wcStats_TypeDef *stats)
+{
+  uint64_t energy;
+
+  *stats = wcStats;
+  if ((wcConfig == NULL) || (wcStats.updates == 0)) {
+    return;
+  }
+
+  energy = (uint64_t)wcStats.wordsWritten * wcConfig->writeWordEnergy
+           + (uint64_t)wcStats.erases * wcConfig->eraseEnergy;
+  stats->energyPerUpdate = (uint32_t)(energy / wcStats.updates);
+  stats->directEnergyPerUpdate = wcConfig->eraseEnergy + wcConfig->writeWordEnergy;
+}
@@ -0,0 +1,63 @@
+/***************************************************************************//**
+ * @file  em_device.h
+ * @brief Host stand-in for em_device.h, with the MSC registers msc_queue.c uses
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Registers written by msc_queue.c. The host test plays the flash
+// controller on them, and defines hostMsc and the NVIC functions.
+typedef struct {
+  volatile uint32_t WRITECMD;
+  volatile uint32_t ADDRB;
+  volatile uint32_t WDATA;
+  volatile uint32_t STATUS;
+  volatile uint32_t IF;
+  volatile uint32_t IFC;
+  volatile uint32_t IEN;
+} MSC_TypeDef;
+
+extern MSC_TypeDef hostMsc;
+
+#define MSC                           (&hostMsc)
+
+#define MSC_WRITECMD_LADDRIM          (1UL << 0)
+#define MSC_WRITECMD_ERASEPAGE        (1UL << 1)
+#define MSC_WRITECMD_WRITEONCE        (1UL << 3)
+#define MSC_WRITECMD_WRITETRIG        (1UL << 4)
+
+#define MSC_STATUS_BUSY               (1UL << 0)
+#define MSC_STATUS_LOCKED             (1UL << 1)
+#define MSC_STATUS_INVADDR            (1UL << 2)
+
+#define MSC_IF_ERASE                  (1UL << 0)
+#define MSC_IF_WRITE                  (1UL << 1)
+#define MSC_IFC_ERASE                 MSC_IF_ERASE
+#define MSC_IFC_WRITE                 MSC_IF_WRITE
+#define MSC_IEN_ERASE                 MSC_IF_ERASE
+#define MSC_IEN_WRITE                 MSC_IF_WRITE
+
+#define FLASH_PAGE_SIZE               2048
+
+typedef enum {
+  MSC_IRQn = 24
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+#endif // EM_DEVICE_H
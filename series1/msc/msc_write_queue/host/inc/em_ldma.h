@@ -0,0 +1,21 @@
+/***************************************************************************//**
+ * @file  em_ldma.h
+ * @brief Host stand-in for em_ldma.h, without the MSC WDATA request, so that
+ * msc_queue.c writes one word at a time from the MSC WRITE interrupt
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_LDMA_H
+#define EM_LDMA_H
+
+#include "em_device.h"
+
+#endif // EM_LDMA_H
@@ -0,0 +1,28 @@
+/***************************************************************************//**
+ * @file  em_msc.h
+ * @brief Host stand-in for em_msc.h, the status codes only
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef EM_MSC_H
+#define EM_MSC_H
+
+#include "em_device.h"
+
+typedef enum {
+  mscReturnOk          = 0,
+  mscReturnInvalidAddr = -1,
+  mscReturnLocked      = -2,
+  mscReturnTimeOut     = -3,
+  mscReturnUnaligned   = -4
+} MSC_Status_TypeDef;
+
+#endif // EM_MSC_H
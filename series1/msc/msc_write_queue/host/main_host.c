@@ -0,0 +1,311 @@
+/**************************************************************************//**
+ * @file
+ * @brief Flash erase/write queue on a host against an in-memory flash
+ *
+ * Build on its own, see readme.txt. The stand-ins in host/inc have no MSC
+ * WDATA request, so msc_queue.c writes one word at a time, and runFlash()
+ * plays the flash controller: it carries out the command written to
+ * MSC->WRITECMD on the RAM flash, sets the interrupt flag and calls
+ * MSC_IRQHandler(). The test checks that unaligned or empty writes are
+ * refused, that erases and writes across a page boundary land where they
+ * should, that callbacks come from the interrupt in queue order, also for
+ * jobs queued from a callback and for a job that fails to start, and that
+ * a full queue refuses the next job.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "em_device.h"
+#include "msc_queue.h"
+#include "host_check.h"
+
+#define PAGE_WORDS          (FLASH_PAGE_SIZE / 4)
+#define PAGE_COUNT          4
+#define FLASH_WORDS         (PAGE_COUNT * PAGE_WORDS)
+
+/* Flash steps and interrupts before runFlash() gives up */
+#define MAX_STEPS           100000
+
+/* Jobs chained from the callback in checkFromCallback() */
+#define CHAIN_LENGTH        20
+
+MSC_TypeDef hostMsc;
+
+/* Defined by msc_queue.c */
+void MSC_IRQHandler(void);
+
+static uint32_t flash[FLASH_WORDS];
+static uint32_t data[2 * PAGE_WORDS];
+static bool irqEnabled;
+static bool irqPending;
+static bool inIrq;
+
+/* Callbacks, in the order they were called */
+static MSC_Status_TypeDef doneStatus[MSC_QUEUE_DEPTH + CHAIN_LENGTH];
+static uintptr_t doneUser[MSC_QUEUE_DEPTH + CHAIN_LENGTH];
+static uint32_t doneCount;
+static uint32_t chainLeft;
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  CHECK(irq == MSC_IRQn);
+  irqEnabled = true;
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+  CHECK(irq == MSC_IRQn);
+  irqPending = true;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  CHECK(irq == MSC_IRQn);
+  irqPending = false;
+}
+
+/* Word of the RAM flash MSC->ADDRB points to */
+static uint32_t *addressed(void)
+{
+  uint32_t offset = MSC->ADDRB - (uint32_t)(uintptr_t)flash;
+
+  CHECK((offset < sizeof(flash)) && ((offset & 0x3) == 0));
+  return &flash[(offset / 4) % FLASH_WORDS];
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Play the flash controller and the NVIC until the queue has nothing left
+ *   to do. Returns the number of words written and pages erased.
+ ******************************************************************************/
+static uint32_t runFlash(void)
+{
+  uint32_t steps = 0;
+  uint32_t loops, command, *word;
+
+  for ( loops = 0; loops < MAX_STEPS; loops++ )
+  {
+    /* IFC is write-only on the device, it clears IF */
+    MSC->IF &= ~MSC->IFC;
+    MSC->IFC = 0;
+
+    command = MSC->WRITECMD;
+    MSC->WRITECMD = 0;
+    if ( command & MSC_WRITECMD_ERASEPAGE )
+    {
+      word = addressed();
+      CHECK(((word - flash) % PAGE_WORDS) == 0);
+      memset(word, 0xFF, FLASH_PAGE_SIZE);
+      MSC->IF |= MSC_IF_ERASE;
+      steps++;
+      continue;
+    }
+    if ( command & MSC_WRITECMD_WRITEONCE )
+    {
+      word = addressed();
+      *word &= MSC->WDATA;
+      MSC->IF |= MSC_IF_WRITE;
+      steps++;
+      continue;
+    }
+
+    if ( irqEnabled && (irqPending || (MSC->IF & MSC->IEN)) )
+    {
+      irqPending = false;
+      inIrq = true;
+      MSC_IRQHandler();
+      inIrq = false;
+      continue;
+    }
+    return steps;
+  }
+  CHECK(loops < MAX_STEPS);
+  return steps;
+}
+
+static void jobDone(MSC_Status_TypeDef status, void *user)
+{
+  CHECK(inIrq);
+  CHECK(doneCount < sizeof(doneUser) / sizeof(doneUser[0]));
+  doneStatus[doneCount % (sizeof(doneUser) / sizeof(doneUser[0]))] = status;
+  doneUser[doneCount % (sizeof(doneUser) / sizeof(doneUser[0]))] = (uintptr_t)user;
+  doneCount++;
+}
+
+/* Queues the next word of the chain from the callback of the previous one */
+static void chainDone(MSC_Status_TypeDef status, void *user)
+{
+  uint32_t i = (uint32_t)(uintptr_t)user;
+
+  jobDone(status, user);
+  if ( chainLeft > 0 )
+  {
+    chainLeft--;
+    CHECK(mscQueueWrite(&flash[i + 1], &data[i + 1], 4, chainDone,
+                        (void *)(uintptr_t)(i + 1)));
+  }
+}
+
+static void reset(void)
+{
+  memset(flash, 0, sizeof(flash));
+  memset(&hostMsc, 0, sizeof(hostMsc));
+  doneCount = 0;
+  mscQueueInit(0);
+  CHECK(irqEnabled && !irqPending);
+}
+
+/* Unaligned or empty writes are refused without touching the flash */
+static void checkArguments(void)
+{
+  reset();
+  CHECK(!mscQueueWrite((uint32_t *)((uint8_t *)flash + 2), data, 8, jobDone, NULL));
+  CHECK(!mscQueueWrite((uint32_t *)((uint8_t *)flash + 1), data, 4, jobDone, NULL));
+  CHECK(!mscQueueWrite(flash, (const uint8_t *)data + 2, 8, jobDone, NULL));
+  CHECK(!mscQueueWrite(flash, data, 0, jobDone, NULL));
+  CHECK(!mscQueueWrite(flash, data, 6, jobDone, NULL));
+  CHECK(!mscQueueBusy());
+  CHECK(MSC->WRITECMD == 0);
+  CHECK(runFlash() == 0);
+  CHECK(doneCount == 0);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Erase pages 1 and 2, then write across the boundary between them, all
+ *   queued before the flash runs
+ ******************************************************************************/
+static void checkWrites(void)
+{
+  uint32_t start = 2 * PAGE_WORDS - 3;
+  uint32_t words = 8;
+  uint32_t i;
+
+  reset();
+  CHECK(mscQueueErase(&flash[PAGE_WORDS], jobDone, (void *)1));
+  CHECK(mscQueueErase(&flash[2 * PAGE_WORDS], jobDone, (void *)2));
+  CHECK(mscQueueWrite(&flash[start], data, 4 * words, jobDone, (void *)3));
+  CHECK(mscQueueBusy());
+
+  /* Callbacks come from the interrupt only */
+  CHECK(doneCount == 0);
+
+  CHECK(runFlash() == 2 + words);
+  CHECK(!mscQueueBusy());
+  CHECK(doneCount == 3);
+  for ( i = 0; i < 3; i++ )
+  {
+    CHECK((doneStatus[i] == mscReturnOk) && (doneUser[i] == i + 1));
+  }
+
+  for ( i = 0; i < FLASH_WORDS; i++ )
+  {
+    if ( (i >= start) && (i < start + words) )
+    {
+      CHECK(flash[i] == data[i - start]);
+    }
+    else if ( (i >= PAGE_WORDS) && (i < 3 * PAGE_WORDS) )
+    {
+      CHECK(flash[i] == 0xFFFFFFFF);
+    }
+    else
+    {
+      CHECK(flash[i] == 0);
+    }
+  }
+}
+
+/* Each callback queues the next write while the queue is empty */
+static void checkFromCallback(void)
+{
+  uint32_t i;
+
+  reset();
+  memset(flash, 0xFF, sizeof(flash));
+  chainLeft = CHAIN_LENGTH - 1;
+  CHECK(mscQueueWrite(&flash[0], &data[0], 4, chainDone, (void *)0));
+  CHECK(runFlash() == CHAIN_LENGTH);
+  CHECK(!mscQueueBusy());
+  CHECK(doneCount == CHAIN_LENGTH);
+  for ( i = 0; i < CHAIN_LENGTH; i++ )
+  {
+    CHECK((doneStatus[i] == mscReturnOk) && (doneUser[i] == i));
+    CHECK(flash[i] == data[i]);
+  }
+  CHECK(flash[CHAIN_LENGTH] == 0xFFFFFFFF);
+}
+
+/* A full queue refuses the next job */
+static void checkFull(void)
+{
+  uint32_t i;
+
+  reset();
+  for ( i = 0; i < MSC_QUEUE_DEPTH; i++ )
+  {
+    CHECK(mscQueueErase(&flash[(i % PAGE_COUNT) * PAGE_WORDS], jobDone,
+                        (void *)(uintptr_t)i));
+  }
+  CHECK(!mscQueueErase(flash, jobDone, NULL));
+  CHECK(!mscQueueWrite(flash, data, 4, jobDone, NULL));
+  CHECK(runFlash() == MSC_QUEUE_DEPTH);
+  CHECK(doneCount == MSC_QUEUE_DEPTH);
+  for ( i = 0; i < MSC_QUEUE_DEPTH; i++ )
+  {
+    CHECK((doneStatus[i] == mscReturnOk) && (doneUser[i] == i));
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A job that fails to start is reported from the interrupt, and the job
+ *   queued behind it still runs
+ ******************************************************************************/
+static void checkLocked(void)
+{
+  reset();
+  memset(flash, 0xFF, sizeof(flash));
+  flash[PAGE_WORDS] = 0;
+  MSC->STATUS = MSC_STATUS_LOCKED;
+  CHECK(mscQueueErase(&flash[PAGE_WORDS], jobDone, (void *)1));
+  CHECK(doneCount == 0);
+  CHECK(irqPending);
+  MSC->STATUS = 0;
+  CHECK(mscQueueWrite(&flash[3], data, 8, jobDone, (void *)2));
+  CHECK(runFlash() == 2);
+  CHECK(doneCount == 2);
+  CHECK((doneStatus[0] == mscReturnLocked) && (doneUser[0] == 1));
+  CHECK((doneStatus[1] == mscReturnOk) && (doneUser[1] == 2));
+  CHECK(flash[PAGE_WORDS] == 0);
+  CHECK((flash[3] == data[0]) && (flash[4] == data[1]));
+}
+
+int main(void)
+{
+  uint32_t seed = 1;
+  uint32_t i;
+
+  for ( i = 0; i < 2 * PAGE_WORDS; i++ )
+  {
+    data[i] = hostRandom(&seed) ^ (hostRandom(&seed) << 16);
+  }
+
+  checkArguments();
+  checkWrites();
+  checkFromCallback();
+  checkFull();
+  checkLocked();
+
+  hostCheckReport();
+  return 0;
+}
@@ -0,0 +1,43 @@
+/***************************************************************************//**
+ * @file  msc_queue.h
+ * @brief Non-blocking flash erase/write queue using the LDMA to feed MSC_WDATA
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef MSC_QUEUE_H
+#define MSC_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_msc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change this to set how many operations can be pending at once
+#define MSC_QUEUE_DEPTH   8
+
+// Called from interrupt context when an operation has completed
+typedef void (*mscQueueCallback_TypeDef)(MSC_Status_TypeDef status, void *user);
+
+void mscQueueInit(unsigned int ldmaChannel);
+bool mscQueueErase(uint32_t *page, mscQueueCallback_TypeDef callback, void *user);
+bool mscQueueWrite(uint32_t *address, const void *data, uint32_t numBytes,
+                   mscQueueCallback_TypeDef callback, void *user);
+bool mscQueueBusy(void);
+void mscQueueLdmaIrqHandler(uint32_t pending);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MSC_QUEUE_H
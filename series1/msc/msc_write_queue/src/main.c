@@ -0,0 +1,181 @@
+/**************************************************************************//**
+ * @file
+ * @brief This project demonstrates a non-blocking flash erase/write queue
+ * that lets the LDMA feed the MSC while the core sleeps in EM1, and compares
+ * its throughput with the blocking MSC_WriteWord() API.
+ ******************************************************************************
+ * @section License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_ldma.h"
+#include "em_msc.h"
+#include "em_timer.h"
+#include "msc_queue.h"
+
+// Note: change this to benchmark a different amount of data
+#define BENCH_PAGES     2
+#define BENCH_BYTES     (BENCH_PAGES * FLASH_PAGE_SIZE)
+
+// The benchmark uses the last BENCH_PAGES pages of the main flash
+#define BENCH_BASE      ((uint32_t*)(FLASH_BASE + FLASH_SIZE - BENCH_PAGES * FLASH_PAGE_SIZE))
+
+// TIMER0 prescaler used to time the benchmark
+#define TIMER_PRESCALE  timerPrescale1024
+#define TIMER_DIV       1024
+
+#define LDMA_CHANNEL    0
+
+// Data to program
+uint32_t benchData[BENCH_BYTES / 4];
+
+// Results to watch in the debugger
+uint32_t blockingBytesPerMs;
+uint32_t queuedBytesPerMs;
+uint32_t queuedWakeups;
+MSC_Status_TypeDef queuedStatus;
+
+// Number of queued operations not yet completed
+volatile uint32_t pendingOps;
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending = LDMA_IntGet();
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR) {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  LDMA_IntClear(pending);
+  mscQueueLdmaIrqHandler(pending);
+}
+
+/**************************************************************************//**
+ * @brief Called when a queued erase or write has completed
+ *****************************************************************************/
+static void opDone(MSC_Status_TypeDef status, void *user)
+{
+  (void)user;
+
+  if (status != mscReturnOk) {
+    queuedStatus = status;
+  }
+  pendingOps--;
+}
+
+/**************************************************************************//**
+ * @brief TIMER0 initialization, used as a free running tick counter
+ *****************************************************************************/
+void initTimer(void)
+{
+  CMU_ClockEnable(cmuClock_TIMER0, true);
+
+  TIMER_Init_TypeDef init = TIMER_INIT_DEFAULT;
+  init.prescale = TIMER_PRESCALE;
+  init.enable = false;
+  TIMER_Init(TIMER0, &init);
+}
+
+/**************************************************************************//**
+ * @brief Restart the tick counter
+ *****************************************************************************/
+static void timerStart(void)
+{
+  TIMER_Enable(TIMER0, false);
+  TIMER_CounterSet(TIMER0, 0);
+  TIMER_Enable(TIMER0, true);
+}
+
+/**************************************************************************//**
+ * @brief Bytes per millisecond for a transfer that took 'ticks' ticks
+ *****************************************************************************/
+static uint32_t bytesPerMs(uint32_t bytes, uint32_t ticks)
+{
+  uint64_t freq = CMU_ClockFreqGet(cmuClock_TIMER0);
+
+  if (ticks == 0) {
+    ticks = 1;
+  }
+  return (uint32_t)(((uint64_t)bytes * freq) / ((uint64_t)ticks * TIMER_DIV * 1000));
+}
+
+/**************************************************************************//**
+ * @brief Erase the benchmark pages with the blocking API
+ *****************************************************************************/
+static void eraseBenchPages(void)
+{
+  for (uint32_t i = 0; i < BENCH_PAGES; i++) {
+    MSC_ErasePage(BENCH_BASE + i * FLASH_PAGE_SIZE / 4);
+  }
+}
+
+/**************************************************************************//**
+ * @brief  Main function
+ *****************************************************************************/
+int main(void)
+{
+  uint32_t ticks;
+
+  // Chip errata
+  CHIP_Init();
+
+  for (uint32_t i = 0; i < BENCH_BYTES / 4; i++) {
+    benchData[i] = i;
+  }
+
+  initTimer();
+
+  MSC_Init();
+
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+  LDMA_Init(&ldmaInit);
+
+  // Blocking: the core is busy until the last word is programmed
+  eraseBenchPages();
+  timerStart();
+  MSC_WriteWord(BENCH_BASE, benchData, BENCH_BYTES);
+  ticks = TIMER_CounterGet(TIMER0);
+  blockingBytesPerMs = bytesPerMs(BENCH_BYTES, ticks);
+
+  // Queued: the core sleeps in EM1 until the queue is empty
+  eraseBenchPages();
+  mscQueueInit(LDMA_CHANNEL);
+  queuedStatus = mscReturnOk;
+  pendingOps = 1;
+  timerStart();
+  mscQueueWrite(BENCH_BASE, benchData, BENCH_BYTES, opDone, NULL);
+  while (pendingOps > 0) {
+    EMU_EnterEM1();
+    queuedWakeups++;
+  }
+  ticks = TIMER_CounterGet(TIMER0);
+  queuedBytesPerMs = bytesPerMs(BENCH_BYTES, ticks);
+
+  // Erases can be queued as well, the write after them waits its turn
+  pendingOps = BENCH_PAGES + 1;
+  for (uint32_t i = 0; i < BENCH_PAGES; i++) {
+    mscQueueErase(BENCH_BASE + i * FLASH_PAGE_SIZE / 4, opDone, NULL);
+  }
+  mscQueueWrite(BENCH_BASE, benchData, sizeof(uint32_t), opDone, NULL);
+  while (pendingOps > 0) {
+    EMU_EnterEM1();
+  }
+
+  // Infinite Loop
+  while(1);
+}
@@ -0,0 +1,348 @@
+/***************************************************************************//**
+ * @file msc_queue.c
+ * @brief Non-blocking flash erase/write queue. Writes are fed to MSC_WDATA by
+ * the LDMA on the MSC WDATA request and erases complete on the MSC ERASE
+ * interrupt, so the core can sleep in EM1 while the flash is programmed.
+ * Callbacks are only called from the MSC or LDMA interrupt, never from the
+ * function that queued the job, so a callback may queue the next job.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "em_device.h"
+#include "em_core.h"
+#include "em_ldma.h"
+#include "msc_queue.h"
+
+typedef enum {
+  jobErase,
+  jobWrite
+} jobType_TypeDef;
+
+typedef struct {
+  jobType_TypeDef type;
+  uint32_t *address;
+  const uint32_t *data;
+  uint32_t numBytes;
+  mscQueueCallback_TypeDef callback;
+  void *user;
+} job_TypeDef;
+
+// Pending operations, jobs[head] is the one in progress
+static job_TypeDef jobs[MSC_QUEUE_DEPTH];
+static volatile uint32_t head;
+static volatile uint32_t count;
+
+// Progress of the write in progress
+static uint32_t *writeAddress;
+static const uint32_t *writeData;
+static uint32_t bytesLeft;
+
+static unsigned int channel;
+
+// A job that failed to start, reported from the MSC interrupt
+static volatile bool failPending;
+static volatile MSC_Status_TypeDef failStatus;
+
+#if defined(LDMA_CH_REQSEL_SIGSEL_MSCWDATA)
+static LDMA_Descriptor_t desc;
+#endif
+
+static void startJob(void);
+
+/**************************************************************************//**
+ * @brief
+ *    Report the result of the job in progress and start the next one
+ *****************************************************************************/
+static void jobDone(MSC_Status_TypeDef status)
+{
+  mscQueueCallback_TypeDef callback = jobs[head].callback;
+  void *user = jobs[head].user;
+  bool more;
+
+  MSC->IEN &= ~(MSC_IEN_ERASE | MSC_IEN_WRITE);
+
+  head = (head + 1) % MSC_QUEUE_DEPTH;
+  count--;
+
+  // A job queued by the callback on an empty queue is started by
+  // enqueue(), so only a job that was already waiting is started here
+  more = (count > 0);
+
+  if (callback != NULL) {
+    callback(status, user);
+  }
+
+  if (more) {
+    startJob();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Report a job that could not be started from the MSC interrupt, so that
+ *    the callback is not called from enqueue()
+ *****************************************************************************/
+static void jobFailed(MSC_Status_TypeDef status)
+{
+  failStatus = status;
+  failPending = true;
+  NVIC_SetPendingIRQ(MSC_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Load the flash address and check that it may be written
+ *****************************************************************************/
+static MSC_Status_TypeDef loadAddress(uint32_t *address)
+{
+  MSC->ADDRB = (uint32_t)(uintptr_t)address;
+  MSC->WRITECMD = MSC_WRITECMD_LADDRIM;
+
+  if (MSC->STATUS & MSC_STATUS_INVADDR) {
+    return mscReturnInvalidAddr;
+  }
+  if (MSC->STATUS & MSC_STATUS_LOCKED) {
+    return mscReturnLocked;
+  }
+  return mscReturnOk;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start writing the part of the job that fits in the current page
+ *****************************************************************************/
+static void startWriteChunk(void)
+{
+  uint32_t pageLeft = FLASH_PAGE_SIZE - ((uintptr_t)writeAddress & (FLASH_PAGE_SIZE - 1));
+  uint32_t chunk = (bytesLeft < pageLeft) ? bytesLeft : pageLeft;
+  MSC_Status_TypeDef status;
+
+  status = loadAddress(writeAddress);
+  if (status != mscReturnOk) {
+    jobFailed(status);
+    return;
+  }
+
+#if defined(LDMA_CH_REQSEL_SIGSEL_MSCWDATA)
+  LDMA_TransferCfg_t transferConfig = LDMA_TRANSFER_CFG_PERIPHERAL(ldmaPeripheralSignal_MSC_WDATA);
+
+  desc = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_M2P_BYTE(writeData, &(MSC->WDATA), chunk / 4);
+  desc.xfer.size = ldmaCtrlSizeWord;
+
+  writeAddress += chunk / 4;
+  writeData += chunk / 4;
+  bytesLeft -= chunk;
+
+  // The MSC requests a word each time WDATA is ready for the next one
+  LDMA_StartTransfer(channel, &transferConfig, &desc);
+  MSC->WRITECMD = MSC_WRITECMD_WRITETRIG;
+#else
+  // No LDMA request from the MSC on this device, write one word at a time,
+  // the MSC WRITE interrupt moves on to the next one
+  (void)chunk;
+  MSC->WDATA = *writeData;
+  writeAddress++;
+  writeData++;
+  bytesLeft -= 4;
+
+  MSC->IFC = MSC_IFC_WRITE;
+  MSC->IEN |= MSC_IEN_WRITE;
+  MSC->WRITECMD = MSC_WRITECMD_WRITEONCE;
+#endif
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Start the job at the head of the queue
+ *****************************************************************************/
+static void startJob(void)
+{
+  job_TypeDef *job = &jobs[head];
+  MSC_Status_TypeDef status;
+
+  if (job->type == jobErase) {
+    status = loadAddress(job->address);
+    if (status != mscReturnOk) {
+      jobFailed(status);
+      return;
+    }
+    MSC->IFC = MSC_IFC_ERASE;
+    MSC->IEN |= MSC_IEN_ERASE;
+    MSC->WRITECMD = MSC_WRITECMD_ERASEPAGE;
+  } else {
+    writeAddress = job->address;
+    writeData = job->data;
+    bytesLeft = job->numBytes;
+    startWriteChunk();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Add a job to the queue, starting it if the queue was idle
+ *****************************************************************************/
+static bool enqueue(const job_TypeDef *job)
+{
+  CORE_DECLARE_IRQ_STATE;
+  bool idle;
+
+  CORE_ENTER_ATOMIC();
+  if (count == MSC_QUEUE_DEPTH) {
+    CORE_EXIT_ATOMIC();
+    return false;
+  }
+  jobs[(head + count) % MSC_QUEUE_DEPTH] = *job;
+  idle = (count == 0);
+  count++;
+  if (idle) {
+    startJob();
+  }
+  CORE_EXIT_ATOMIC();
+  return true;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    A write chunk has been handed over to the MSC. Wait for the last word to
+ *    be programmed before moving on.
+ *****************************************************************************/
+static void writeChunkSent(void)
+{
+  MSC->IFC = MSC_IFC_WRITE;
+  MSC->IEN |= MSC_IEN_WRITE;
+
+  // The MSC may already be done, in which case no WRITE interrupt follows
+  if (!(MSC->STATUS & MSC_STATUS_BUSY)) {
+    MSC->IEN &= ~MSC_IEN_WRITE;
+    if (bytesLeft > 0) {
+      startWriteChunk();
+    } else {
+      jobDone(mscReturnOk);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    MSC IRQ handler. Signals the end of an erase or of the last word of a
+ *    write chunk.
+ *****************************************************************************/
+void MSC_IRQHandler(void)
+{
+  uint32_t flags = MSC->IF & MSC->IEN;
+
+  MSC->IFC = flags;
+
+  if (count == 0) {
+    return;
+  }
+
+  if (failPending) {
+    failPending = false;
+    jobDone(failStatus);
+    return;
+  }
+
+  if (flags & MSC_IF_ERASE) {
+    jobDone(mscReturnOk);
+  } else if ((flags & MSC_IF_WRITE) && !(MSC->STATUS & MSC_STATUS_BUSY)) {
+    MSC->IEN &= ~MSC_IEN_WRITE;
+    if (bytesLeft > 0) {
+      startWriteChunk();
+    } else {
+      jobDone(mscReturnOk);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Must be called from LDMA_IRQHandler() with the pending flags
+ *****************************************************************************/
+void mscQueueLdmaIrqHandler(uint32_t pending)
+{
+  if ((pending & (1 << channel)) && (count > 0)) {
+    writeChunkSent();
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Initialize the queue. MSC_Init() and LDMA_Init() must have been called.
+ *
+ * @param[in] ldmaChannel
+ *    LDMA channel reserved for flash writes
+ *****************************************************************************/
+void mscQueueInit(unsigned int ldmaChannel)
+{
+  channel = ldmaChannel;
+  head = 0;
+  count = 0;
+  failPending = false;
+
+  MSC->IEN &= ~(MSC_IEN_ERASE | MSC_IEN_WRITE);
+  MSC->IFC = MSC_IFC_ERASE | MSC_IFC_WRITE;
+  NVIC_ClearPendingIRQ(MSC_IRQn);
+  NVIC_EnableIRQ(MSC_IRQn);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Queue a page erase
+ *
+ * @return
+ *    false if the queue is full
+ *****************************************************************************/
+bool mscQueueErase(uint32_t *page, mscQueueCallback_TypeDef callback, void *user)
+{
+  job_TypeDef job = { jobErase, page, NULL, 0, callback, user };
+
+  return enqueue(&job);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Queue a write. The data must stay valid until the callback is called.
+ *
+ * @param[in] address
+ *    Word aligned flash address. Writes may cross page boundaries.
+ *
+ * @param[in] data
+ *    Word aligned source data
+ *
+ * @param[in] numBytes
+ *    Number of bytes, a multiple of 4
+ *
+ * @return
+ *    false if the queue is full or the arguments are not word aligned
+ *****************************************************************************/
+bool mscQueueWrite(uint32_t *address, const void *data, uint32_t numBytes,
+                   mscQueueCallback_TypeDef callback, void *user)
+{
+  job_TypeDef job = { jobWrite, address, (const uint32_t *)data, numBytes, callback, user };
+
+  if ((numBytes == 0) || (numBytes & 0x3)
+      || ((uintptr_t)address & 0x3) || ((uintptr_t)data & 0x3)) {
+    return false;
+  }
+  return enqueue(&job);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Returns true while operations are pending
+ *****************************************************************************/
+bool mscQueueBusy(void)
+{
+  return count > 0;
+}
@@ -0,0 +1,561 @@
+/**************************************************************************//**
+ * @file
+ * @brief OPAMP gain auto-ranging on a host: checks
+ *
+ * Build on its own, see readme.txt. A simulated OPAMP and ADC fill the
+ * buffers of a stream with synthetic waveforms: sines under an envelope
+ * that steps or ramps between levels. A switch of the gain is applied a few
+ * results into the next frame, like a late interrupt, and the output holds
+ * the old gain for a few more results while it settles. Frames are
+ * consumed after the boundary, or one frame later, as the main loop of the
+ * kit does. Each consumed frame is checked against the simulation: every
+ * result past the settling ones was taken at the gain of the tag, and
+ * converts back to the input within half a step of the ADC at that gain.
+ *
+ * A sweep of steady sines checks that the ranging ends on the highest gain
+ * that does not clip and stays there, a step up of the input that the
+ * clipping is over within a few frames, and a late interrupt that the
+ * switch waits for the next boundary. The dynamic range gained against a
+ * fixed gain is printed.
+ * @version 1.0.0
+ ******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2018 Silicon Labs, http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "opa_range.h"
+#include "host_check.h"
+
+/* Results of the kit: 1 kHz, frames of 128, 2.5 V reference */
+#define SAMPLE_HZ           1000
+#define FRAME_LENGTH        128
+#define FULL_SCALE_UV       2500000
+
+#define MAX_LEVELS          8
+
+/* Ladder ratios of the kit: R2 = 0.33, 1, 3, 7 and 15 R1 */
+static const opaRangeGain_TypeDef kitGains[] =
+{
+  { 4, 3 }, { 2, 1 }, { 4, 1 }, { 8, 1 }, { 16, 1 }
+};
+
+#define KIT_RANGES          (sizeof(kitGains) / sizeof(kitGains[0]))
+
+static const opaRangeConfig_TypeDef kitConfig =
+{
+  kitGains, KIT_RANGES, 0, 2, 4032, 3072, 4, 2, 1
+};
+
+/* Input of the OPAMP, in uV: a sine from 0 to the envelope */
+typedef struct
+{
+  double level[MAX_LEVELS];   /* Peak of each segment */
+  uint32_t count;
+  double segmentS;            /* Length of a segment */
+  bool ramp;                  /* Envelope ramps from one level to the next */
+  double hz;
+} Waveform;
+
+typedef struct
+{
+  opaRange_TypeDef range;
+  uint32_t bufferCount;
+  uint32_t delay;             /* Frames the consumer is behind */
+  uint32_t latency;           /* Results before a switch is applied */
+  uint32_t transient;         /* Results at the old gain after a switch */
+  uint32_t opaRange;          /* Range of the simulated OPAMP */
+  uint32_t oldRange;
+  bool pending;               /* Switch at 'latency' in this frame */
+  uint32_t settleLeft;
+  uint32_t fill;
+  uint64_t generated;
+  uint64_t consumed;
+  bool skipBoundary;          /* Next boundary is missed */
+  int lastBoundary;           /* -1 missed, else what the boundary returned */
+  uint16_t codes[OPA_RANGE_MAX_BUFFERS][FRAME_LENGTH];
+  int8_t truth[OPA_RANGE_MAX_BUFFERS][FRAME_LENGTH];  /* -1 while settling */
+  double input[OPA_RANGE_MAX_BUFFERS][FRAME_LENGTH];
+  opaRangeTag_TypeDef lastTag;
+  uint32_t clippedFrames;
+  uint32_t badTags;
+  uint32_t badInputs;
+} Sim;
+
+static uint32_t seed = 1;
+
+static double gainOf(const opaRangeConfig_TypeDef *config, uint32_t range)
+{
+  return (double)config->gains[range].num / config->gains[range].den;
+}
+
+static double waveformAt(const Waveform *w, double t)
+{
+  double position = t / w->segmentS;
+  uint32_t segment = (uint32_t)position;
+  double envelope;
+
+  if ( segment + 1 >= w->count )
+  {
+    envelope = w->level[w->count - 1];
+  }
+  else if ( w->ramp )
+  {
+    /* Geometric, so that each gain gets the same time */
+    envelope = w->level[segment]
+               * pow(w->level[segment + 1] / w->level[segment],
+                     position - segment);
+  }
+  else
+  {
+    envelope = w->level[segment];
+  }
+  return envelope * 0.5 * (1 + sin(2 * M_PI * w->hz * t));
+}
+
+static uint16_t convert(double outputUv)
+{
+  double code = floor(outputUv * OPA_RANGE_CODES / FULL_SCALE_UV + 0.5);
+
+  if ( code < 0 )
+  {
+    return 0;
+  }
+  return (code > OPA_RANGE_CODES - 1) ? OPA_RANGE_CODES - 1 : (uint16_t)code;
+}
+
+static void simInit(Sim *sim, const opaRangeConfig_TypeDef *config,
+                    uint32_t delay, uint32_t latency, uint32_t transient)
+{
+  memset(sim, 0, sizeof(*sim));
+  CHECK(opaRangeInit(&sim->range, config) == opaRangeOk);
+  sim->bufferCount = config->bufferCount;
+  sim->delay = delay;
+  sim->latency = latency;
+  sim->transient = transient;
+  sim->opaRange = config->initialRange;
+
+  /* The OPAMP settles from being enabled in the first frame */
+  sim->oldRange = config->initialRange;
+  sim->settleLeft = latency + transient;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Consume a frame and check it against the simulation
+ ******************************************************************************/
+static void simConsume(Sim *sim, uint32_t buffer)
+{
+  const opaRangeConfig_TypeDef *config = &sim->range.config;
+  opaRangeTag_TypeDef tag;
+  double halfStep, input;
+  uint32_t i;
+
+  opaRangeFrame(&sim->range, buffer, sim->codes[buffer], FRAME_LENGTH, &tag);
+  halfStep = 0.5 * FULL_SCALE_UV / OPA_RANGE_CODES / gainOf(config, tag.range);
+  for ( i = tag.settle; i < FRAME_LENGTH; i++ )
+  {
+    if ( sim->truth[buffer][i] != (int8_t)tag.range )
+    {
+      sim->badTags++;
+    }
+    else if ( sim->codes[buffer][i] < OPA_RANGE_CODES - 1 )
+    {
+      input = opaRangeToInput(&sim->range, &tag, sim->codes[buffer][i],
+                              FULL_SCALE_UV);
+      if ( fabs(input - sim->input[buffer][i]) > halfStep + 1 )
+      {
+        sim->badInputs++;
+      }
+    }
+  }
+  if ( tag.clipped > 0 )
+  {
+    sim->clippedFrames++;
+  }
+  sim->lastTag = tag;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Fill a frame, call the boundary at its end, then consume the frames the
+ *   consumer is done waiting for
+ ******************************************************************************/
+static void simFrame(Sim *sim, const Waveform *w)
+{
+  const opaRangeConfig_TypeDef *config = &sim->range.config;
+  uint32_t buffer = sim->fill;
+  uint32_t next = (buffer + 1) % sim->bufferCount;
+  uint32_t i, range;
+  double t, input;
+
+  for ( i = 0; i < FRAME_LENGTH; i++ )
+  {
+    if ( sim->pending && (i == sim->latency) )
+    {
+      sim->opaRange = sim->range.applied;
+      sim->settleLeft = sim->transient;
+      sim->pending = false;
+    }
+    t = (double)(sim->generated * FRAME_LENGTH + i) / SAMPLE_HZ;
+    input = waveformAt(w, t);
+    if ( sim->pending || (sim->settleLeft > 0) )
+    {
+      /* Before the switch or while settling, the old gain */
+      range = sim->oldRange;
+      sim->truth[buffer][i] = sim->pending ? (int8_t)range : -1;
+      if ( !sim->pending )
+      {
+        sim->settleLeft--;
+      }
+    }
+    else
+    {
+      range = sim->opaRange;
+      sim->truth[buffer][i] = (int8_t)range;
+    }
+    sim->input[buffer][i] = input;
+    sim->codes[buffer][i] = convert(input * gainOf(config, range));
+  }
+  sim->generated++;
+
+  if ( sim->skipBoundary )
+  {
+    sim->skipBoundary = false;
+    sim->lastBoundary = -1;
+  }
+  else
+  {
+    /* A switch here is a request to the OPAMP that takes 'latency' */
+    sim->oldRange = sim->opaRange;
+    sim->lastBoundary = opaRangeBoundary(&sim->range, next) ? 1 : 0;
+    sim->pending = (sim->lastBoundary == 1);
+    if ( sim->pending && (sim->latency == 0) )
+    {
+      sim->opaRange = sim->range.applied;
+      sim->settleLeft = sim->transient;
+      sim->pending = false;
+    }
+  }
+  sim->fill = next;
+
+  while ( sim->generated - sim->consumed > sim->delay )
+  {
+    simConsume(sim, (uint32_t)(sim->consumed % sim->bufferCount));
+    sim->consumed++;
+  }
+}
+
+static void simCheckFrames(const Sim *sim)
+{
+  CHECK(sim->badTags == 0);
+  CHECK(sim->badInputs == 0);
+}
+
+/* Range the ranging climbs to from range 0 for a steady peak, or -1 if the
+   peak is too close to a threshold to tell */
+static int expectedRange(const opaRangeConfig_TypeDef *config, double peakUv)
+{
+  uint32_t r;
+  double next;
+
+  for ( r = 0; r + 1 < config->rangeCount; r++ )
+  {
+    next = peakUv * gainOf(config, r + 1) * OPA_RANGE_CODES / FULL_SCALE_UV;
+    if ( fabs(next - config->upCode) < 8 )
+    {
+      return -1;
+    }
+    if ( next >= config->upCode )
+    {
+      break;
+    }
+  }
+  return (int)r;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Configurations that must not be used
+ ******************************************************************************/
+static void checkConfigs(void)
+{
+  static const opaRangeGain_TypeDef flat[] = { { 2, 1 }, { 4, 2 } };
+  static const opaRangeGain_TypeDef zero[] = { { 2, 1 }, { 4, 0 } };
+  opaRangeConfig_TypeDef config;
+  opaRange_TypeDef range;
+
+  CHECK(opaRangeInit(&range, &kitConfig) == opaRangeOk);
+  CHECK(range.applied == 0);
+  CHECK(range.tags[0].settle == kitConfig.settleSamples);
+
+#define CHECK_BAD(field, value)                                         \
+  do {                                                                  \
+    config = kitConfig;                                                 \
+    config.field = value;                                               \
+    CHECK(opaRangeInit(&range, &config) == opaRangeBadConfig);          \
+  } while (0)
+
+  CHECK_BAD(gains, NULL);
+  CHECK_BAD(gains, flat);
+  CHECK_BAD(gains, zero);
+  CHECK_BAD(rangeCount, 0);
+  CHECK_BAD(rangeCount, OPA_RANGE_MAX_RANGES + 1);
+  CHECK_BAD(initialRange, KIT_RANGES);
+  CHECK_BAD(bufferCount, 1);
+  CHECK_BAD(bufferCount, OPA_RANGE_MAX_BUFFERS + 1);
+  CHECK_BAD(clipCode, 0);
+  CHECK_BAD(clipCode, OPA_RANGE_CODES);
+  CHECK_BAD(upCode, 0);
+  CHECK_BAD(upCode, kitConfig.clipCode);
+  CHECK_BAD(upFrames, 0);
+  CHECK_BAD(downRanges, 0);
+
+#undef CHECK_BAD
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Steady sines from 1.6 V down to 6 mV: the ranging ends on the highest
+ *   gain whose peak stays below upCode with the gain above, and does not
+ *   switch in the last frames. The codes used against range 0, the fixed
+ *   gain that takes the largest input, are printed.
+ ******************************************************************************/
+static void checkSweep(uint32_t bufferCount, uint32_t delay, bool print)
+{
+  opaRangeConfig_TypeDef config = kitConfig;
+  Waveform w;
+  Sim sim;
+  double peak, bits;
+  uint32_t f, switches, fixedCodes, codes;
+  int expected;
+
+  config.bufferCount = bufferCount;
+  if ( print )
+  {
+    printf("  peak uV  range  codes  fixed  bits  oversampling\n");
+  }
+  for ( peak = 1600000; peak > 6000; peak *= 0.8 )
+  {
+    expected = expectedRange(&config, peak);
+    if ( expected < 0 )
+    {
+      continue;
+    }
+    memset(&w, 0, sizeof(w));
+    w.level[0] = peak;
+    w.count = 1;
+    w.segmentS = 1;
+    w.hz = 50;
+    simInit(&sim, &config, delay, 1, 0);
+    for ( f = 0; f < 40; f++ )
+    {
+      simFrame(&sim, &w);
+    }
+    switches = sim.range.switches;
+    for ( f = 0; f < 20; f++ )
+    {
+      simFrame(&sim, &w);
+      CHECK(sim.lastTag.range == (uint32_t)expected);
+      CHECK(sim.lastTag.clipped == 0);
+    }
+    CHECK(sim.range.switches == switches);
+    simCheckFrames(&sim);
+
+    /* More codes than at the fixed gain, never fewer */
+    fixedCodes = convert(peak * gainOf(&config, 0));
+    codes = sim.lastTag.peak;
+    CHECK(codes >= fixedCodes);
+    if ( print )
+    {
+      /* Each bit of resolution takes 4 times the samples to get by
+         averaging */
+      bits = log2((double)codes / fixedCodes);
+      printf("%9.0f  %5u  %5u  %5u  %4.1f  %12.0f\n", peak,
+             (unsigned)sim.lastTag.range, (unsigned)codes,
+             (unsigned)fixedCodes, bits, pow(4, bits));
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   A small input steps up to near full scale: frames clip until the gain
+ *   has stepped down to range 0, at most two steps of downRanges here, each
+ *   taking up to 2 + delay frames. The ranging then settles again.
+ ******************************************************************************/
+static void checkClipRecovery(uint32_t bufferCount, uint32_t delay)
+{
+  opaRangeConfig_TypeDef config = kitConfig;
+  uint32_t f, steps, switches;
+  Waveform w;
+  Sim sim;
+
+  config.bufferCount = bufferCount;
+  memset(&w, 0, sizeof(w));
+  w.level[0] = 50000;
+  w.level[1] = 1700000;
+  w.count = 2;
+  w.segmentS = 40.0 * FRAME_LENGTH / SAMPLE_HZ;
+  w.hz = 50;
+  simInit(&sim, &config, delay, 1, 0);
+  for ( f = 0; f < 40; f++ )
+  {
+    simFrame(&sim, &w);
+  }
+  CHECK(sim.lastTag.range == KIT_RANGES - 1);
+  CHECK(sim.clippedFrames == 0);
+
+  steps = (KIT_RANGES - 1 + config.downRanges - 1) / config.downRanges;
+  for ( f = 0; f < 40; f++ )
+  {
+    simFrame(&sim, &w);
+  }
+  printf("step up with %u buffers: %u clipped frames\n",
+         (unsigned)bufferCount, (unsigned)sim.clippedFrames);
+  CHECK(sim.clippedFrames > 0);
+  CHECK(sim.clippedFrames <= steps * (2 + delay));
+  CHECK(sim.lastTag.range == (uint32_t)expectedRange(&config, w.level[1]));
+
+  switches = sim.range.switches;
+  for ( f = 0; f < 20; f++ )
+  {
+    simFrame(&sim, &w);
+  }
+  CHECK(sim.range.switches == switches);
+  simCheckFrames(&sim);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   The boundary where a switch is due is missed: the next one sees two
+ *   frames filled and does not switch, the one after does
+ ******************************************************************************/
+static void checkLateBoundary(void)
+{
+  opaRangeConfig_TypeDef config = kitConfig;
+  uint32_t f, switches = 0;
+  bool missed = false;
+  Waveform w;
+  Sim sim;
+
+  config.bufferCount = 3;
+  memset(&w, 0, sizeof(w));
+  w.level[0] = 20000;
+  w.count = 1;
+  w.segmentS = 1;
+  w.hz = 50;
+  simInit(&sim, &config, 0, 1, 0);
+  for ( f = 0; (f < 40) && !missed; f++ )
+  {
+    simFrame(&sim, &w);
+    if ( sim.range.target != sim.range.applied )
+    {
+      switches = sim.range.switches;
+      sim.skipBoundary = true;
+      simFrame(&sim, &w);
+      CHECK(sim.lastBoundary == -1);
+      simFrame(&sim, &w);
+      CHECK(sim.lastBoundary == 0);
+      CHECK(sim.range.lateBoundaries == 1);
+      CHECK(sim.range.switches == switches);
+      simFrame(&sim, &w);
+      CHECK(sim.lastBoundary == 1);
+      CHECK(sim.range.switches == switches + 1);
+      missed = true;
+    }
+  }
+  CHECK(missed);
+  for ( f = 0; f < 40; f++ )
+  {
+    simFrame(&sim, &w);
+  }
+  CHECK(sim.lastTag.range == KIT_RANGES - 1);
+  simCheckFrames(&sim);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Random envelopes, stream depths, latencies and settings: every frame is
+ *   tagged with the gain of its valid results
+ ******************************************************************************/
+static void checkRandom(uint32_t trials)
+{
+  static const double rates[] = { 5, 50, 120 };
+  opaRangeConfig_TypeDef config;
+  uint32_t t, i, f, settle, latency;
+  Waveform w;
+  Sim sim;
+
+  for ( t = 0; t < trials; t++ )
+  {
+    config = kitConfig;
+    config.bufferCount = 2 + hostRandom(&seed) % (OPA_RANGE_MAX_BUFFERS - 1);
+    config.initialRange = hostRandom(&seed) % KIT_RANGES;
+    config.upFrames = 1 + hostRandom(&seed) % 6;
+    config.downRanges = 1 + hostRandom(&seed) % 3;
+    config.settleSamples = hostRandom(&seed) % 5;
+    latency = hostRandom(&seed) % (config.settleSamples + 1);
+
+    memset(&w, 0, sizeof(w));
+    w.count = 2 + hostRandom(&seed) % (MAX_LEVELS - 1);
+    for ( i = 0; i < w.count; i++ )
+    {
+      /* 5 mV to 2.4 V, log-uniform */
+      w.level[i] = 5000 * pow(480, (hostRandom(&seed) % 1000) / 1000.0);
+    }
+    w.segmentS = (4 + hostRandom(&seed) % 20) * (double)FRAME_LENGTH / SAMPLE_HZ;
+    w.ramp = (hostRandom(&seed) % 2) != 0;
+    w.hz = rates[hostRandom(&seed) % 3];
+
+    settle = config.settleSamples;
+    simInit(&sim, &config, hostRandom(&seed) % (config.bufferCount - 1), latency,
+            settle - latency);
+    for ( f = 0; f < w.count * w.segmentS * SAMPLE_HZ / FRAME_LENGTH; f++ )
+    {
+      simFrame(&sim, &w);
+    }
+    simCheckFrames(&sim);
+  }
+  printf("%u random waveforms\n", (unsigned)trials);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t trials = 1000;
+  int option;
+
+  while ( (option = getopt(argc, argv, "n:")) != -1 )
+  {
+    switch ( option )
+    {
+      case 'n':
+        trials = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("usage: %s [-n random waveforms]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  checkConfigs();
+  checkSweep(2, 0, true);
+  checkSweep(3, 1, false);
+  checkClipRecovery(2, 0);
+  checkClipRecovery(3, 1);
+  checkLateBoundary();
+  checkRandom(trials);
+
+  hostCheckReport();
+  return 0;
+}
@@ -0,0 +1,90 @@
+/***************************************************************************//**
+ * @file  opa_range.h
+ * @brief Gain auto-ranging of an OPAMP in front of the ADC, per frame
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+#ifndef OPA_RANGE_H
+#define OPA_RANGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Note: change these to allow more gains or more buffers per stream
+#define OPA_RANGE_MAX_RANGES    8
+#define OPA_RANGE_MAX_BUFFERS   4
+
+// Codes of a 12-bit result
+#define OPA_RANGE_CODES         4096
+
+typedef enum {
+  opaRangeOk,
+  opaRangeBadConfig         // Gains not increasing, or counts or codes out
+                            // of range
+} opaRangeStatus_TypeDef;
+
+// Gain of a range, num / den, e.g. 4 / 3 for R2 = 0.33 R1
+typedef struct {
+  uint16_t num;
+  uint16_t den;
+} opaRangeGain_TypeDef;
+
+typedef struct {
+  const opaRangeGain_TypeDef *gains;  // Increasing
+  uint32_t rangeCount;
+  uint32_t initialRange;
+  uint32_t bufferCount;     // Buffers of the stream
+  uint32_t clipCode;        // A result at or above it may have clipped
+  uint32_t upCode;          // Largest peak the next gain may give
+  uint32_t upFrames;        // Frames in a row that fit the next gain before
+                            // switching to it
+  uint32_t downRanges;      // Ranges dropped after a clipped frame
+  uint32_t settleSamples;   // Results not valid after a switch
+} opaRangeConfig_TypeDef;
+
+// What a frame was taken with, and what was found in it
+typedef struct {
+  uint32_t range;           // Range of the valid results
+  uint32_t settle;          // Results before the first valid one
+  uint32_t peak;            // Largest valid result
+  uint32_t clipped;         // Valid results at or above clipCode
+} opaRangeTag_TypeDef;
+
+typedef struct {
+  opaRangeConfig_TypeDef config;
+  opaRangeTag_TypeDef tags[OPA_RANGE_MAX_BUFFERS];  // Tag of each buffer
+  volatile uint32_t applied;      // Range of the OPAMP
+  volatile uint32_t target;       // Range to apply at the next boundary
+  uint32_t filling;               // Buffer being filled
+  uint32_t upCount;               // Frames in a row that fit the next gain
+  uint32_t switches;
+  uint32_t lateBoundaries;        // Boundaries seen too late to switch at
+} opaRange_TypeDef;
+
+opaRangeStatus_TypeDef opaRangeInit(opaRange_TypeDef *range,
+                                    const opaRangeConfig_TypeDef *config);
+bool opaRangeBoundary(opaRange_TypeDef *range, uint32_t buffer);
+void opaRangeFrame(opaRange_TypeDef *range, uint32_t buffer,
+                   const uint16_t *codes, uint32_t length,
+                   opaRangeTag_TypeDef *tag);
+uint32_t opaRangeToInput(const opaRange_TypeDef *range,
+                         const opaRangeTag_TypeDef *tag, uint32_t code,
+                         uint32_t fullScale);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OPA_RANGE_H
@@ -0,0 +1,368 @@
+/**************************************************************************//**
+ * @file main_tg11.c
+ * @brief This project configures opamp 1 as a non-inverting amplifier whose
+ * gain is given by the following equation: Vout = Vin * (1 + R2/R1), and
+ * picks the R2/R1 resistor ladder ratio from the signal. The ADC converts
+ * the opamp output 1000 times per second into frames of 128 results, and
+ * the gain is raised while the signal is small and lowered as soon as a
+ * frame clips. The gain only changes between frames, so each frame is
+ * tagged with the gain its results were taken with.
+ * @version 0.0.1
+ ******************************************************************************
+ * @section License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include "em_device.h"
+#include "em_chip.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_opamp.h"
+#include "em_adc.h"
+#include "em_prs.h"
+#include "em_ldma.h"
+#include "em_letimer.h"
+#include "ldma_stream.h"
+#include "opa_range.h"
+
+// Init to max ADC clock for Series 1
+#define ADC_FREQ        16000000
+#define letimerClkFreq  32768
+
+// Desired sample frequency (in Hz)
+#define letimerDesired  1000
+
+#define letimerCompare  letimerClkFreq / letimerDesired
+
+#define LDMA_CHANNEL    0
+#define PRS_CHANNEL     0
+
+// Opamp and pins, see README for the corresponding EXP header pins; the
+// positive input of OPA1 is its pad, PD6
+#define OPA_INDEX       OPA1
+#define OPA_OUT_MODE    opaOutModeAPORT2YCH14 // Opamp output on PA14
+#define ADC_INPUT       adcPosSelAPORT2YCH14  // ADC input on PA14
+
+// Full scale of the 2.5V reference, in uV
+#define FULL_SCALE_UV   2500000
+
+// The ADC requests the LDMA once ADC_DVL results are in the single FIFO
+#define ADC_DVL         4
+
+// Double buffering of frames of FRAME_LENGTH samples
+#define BUFFER_COUNT    2
+#define FRAME_LENGTH    128
+
+// Note: change these to select other R2/R1 resistor ladder ratios, lowest
+//       gain first. Each gain is Vout / Vin = 1 + R2/R1.
+#define RANGE_COUNT     5
+
+static const OPAMP_ResSel_TypeDef rangeResSel[RANGE_COUNT] = {
+  opaResSelR2eq0_33R1,  // Vout = Vin * 4/3
+  opaResSelR2eqR1,      // Vout = Vin * 2
+  opaResSelR2eq3R1,     // Vout = Vin * 4
+  opaResSelR2eq7R1,     // Vout = Vin * 8
+  opaResSelR2eq15R1     // Vout = Vin * 16
+};
+
+static const opaRangeGain_TypeDef rangeGains[RANGE_COUNT] = {
+  { 4, 3 }, { 2, 1 }, { 4, 1 }, { 8, 1 }, { 16, 1 }
+};
+
+// Start at the lowest gain. A frame clips at 4032 (98% of full scale) and
+// drops two gains; the gain goes up one step once 4 frames in a row would
+// stay below 3072 (75%) with it. The result right after a switch is
+// skipped, the opamp settles within microseconds but the switch is only
+// made when the interrupt of the frame is served.
+static const opaRangeConfig_TypeDef rangeConfig = {
+  rangeGains, RANGE_COUNT, 0, BUFFER_COUNT, 4032, 3072, 4, 2, 1
+};
+
+// Stream of ADC samples
+ldmaStream_TypeDef stream;
+uint16_t streamBuffers[BUFFER_COUNT][FRAME_LENGTH];
+
+// Ranging of the opamp gain
+opaRange_TypeDef range;
+
+// Note: These aren't necessary and are only provided so that they can be viewed
+// in the debugger. Additionally they are declared as volatile so that they
+// won't be optimized out by the compiler
+static volatile opaRangeStatus_TypeDef rangeStatus;
+static volatile opaRangeTag_TypeDef lastTag;
+static volatile uint32_t inputPeakUv;
+static volatile uint32_t inputMeanUv;
+static volatile uint32_t rangeFrames[RANGE_COUNT];
+static volatile uint32_t frameCount;
+
+/**************************************************************************//**
+ * @brief
+ *    Select the resistor ladder ratio of a range
+ *****************************************************************************/
+static void setGain(uint32_t index)
+{
+  VDAC0->OPA[OPA_INDEX].MUX = (VDAC0->OPA[OPA_INDEX].MUX
+                               & ~_VDAC_OPA_MUX_RESSEL_MASK)
+                              | rangeResSel[index];
+}
+
+/**************************************************************************//**
+ * @brief LDMA Handler
+ *****************************************************************************/
+void LDMA_IRQHandler(void)
+{
+  uint32_t pending;
+
+  // Read and clear interrupt flags
+  pending = LDMA_IntGet();
+  LDMA_IntClear(pending);
+
+  // Check for LDMA error
+  if (pending & LDMA_IF_ERROR)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Account for the frames filled, they are consumed in the main loop
+  ldmaStreamIrqHandler(&stream, pending);
+
+  // A frame has ended, switch the gain before the first results of the
+  // next one
+  if (pending & (1UL << LDMA_CHANNEL))
+  {
+    if (opaRangeBoundary(&range, stream.fill))
+    {
+      setGain(range.applied);
+    }
+  }
+}
+
+/**************************************************************************//**
+ * @brief Stream consumer, finds the range of each frame and its input
+ *****************************************************************************/
+static void consume(const void *data, uint32_t length, bool overrun, void *user)
+{
+  const uint16_t *codes = data;
+  uint32_t buffer = (uint32_t)(codes - streamBuffers[0]) / FRAME_LENGTH;
+  opaRangeTag_TypeDef tag;
+  uint32_t sum = 0;
+  uint32_t i;
+
+  (void)overrun;
+  (void)user;
+
+  opaRangeFrame(&range, buffer, codes, length, &tag);
+
+  // Input of the opamp, from the gain the frame was taken with
+  for (i = tag.settle; i < length; i++)
+  {
+    sum += codes[i];
+  }
+  if (tag.settle < length)
+  {
+    inputMeanUv = opaRangeToInput(&range, &tag,
+                                  sum / (length - tag.settle), FULL_SCALE_UV);
+  }
+  inputPeakUv = opaRangeToInput(&range, &tag, tag.peak, FULL_SCALE_UV);
+
+  lastTag = tag;
+  rangeFrames[tag.range]++;
+  frameCount++;
+}
+
+/**************************************************************************//**
+ * @brief LETIMER initialization
+ *****************************************************************************/
+void initLetimer(void)
+{
+  // Start LFRCO and wait until it is stable
+  CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
+
+  // Enable clock to the interface of the low energy modules
+  CMU_ClockEnable(cmuClock_HFLE, true);
+
+  // Route the LFRCO clock to LFA (LETIMER0)
+  CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
+
+  // Enable clock for LETIMER0
+  CMU_ClockEnable(cmuClock_LETIMER0, true);
+
+  LETIMER_Init_TypeDef letimerInit = LETIMER_INIT_DEFAULT;
+
+  // Reload COMP0 on underflow, pulse output, and run in repeat mode
+  letimerInit.comp0Top  = true;
+  letimerInit.ufoa0     = letimerUFOAPulse;
+  letimerInit.repMode   = letimerRepeatFree;
+
+  // Initialize LETIMER
+  LETIMER_Init(LETIMER0, &letimerInit);
+
+  // Need REP0 != 0 to pulse on underflow
+  LETIMER_RepeatSet(LETIMER0, 0, 1);
+
+  // Compare on wake-up interval count
+  LETIMER_CompareSet(LETIMER0, 0, letimerCompare);
+
+  // Use LETIMER0 as async PRS to trigger ADC in EM2
+  CMU_ClockEnable(cmuClock_PRS, true);
+
+  PRS_SourceAsyncSignalSet(PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_LETIMER0,
+      PRS_CH_CTRL_SIGSEL_LETIMER0CH0);
+}
+
+/**************************************************************************//**
+ * @brief LDMA initialization, streams the ADC results into frames
+ *****************************************************************************/
+void initLdma(void)
+{
+  ldmaStreamConfig_TypeDef config;
+
+  // Enable LDMA clock
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  // Basic LDMA configuration
+  LDMA_Init_t ldmaInit = LDMA_INIT_DEFAULT;
+
+  LDMA_Init(&ldmaInit);
+
+  // ADC_DVL 16-bit results per request, the low half of SINGLEDATA
+  config.channel     = LDMA_CHANNEL;
+  config.signal      = ldmaPeripheralSignal_ADC0_SINGLE;
+  config.source      = &ADC0->SINGLEDATA;
+  config.size        = ldmaCtrlSizeHalf;
+  config.blockSize   = (LDMA_CtrlBlockSize_t)(ADC_DVL - 1);
+  config.ignoreSrec  = true;
+  config.storage     = streamBuffers;
+  config.bufferCount = BUFFER_COUNT;
+  config.maxLength   = FRAME_LENGTH;
+  config.length      = FRAME_LENGTH;
+  config.callback    = consume;
+  config.user        = NULL;
+
+  if (ldmaStreamInit(&stream, &config) == ldmaStreamOk)
+  {
+    ldmaStreamStart(&stream);
+  }
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Initialize ADC
+ *****************************************************************************/
+void initAdc(void)
+{
+  // Declare init structs
+  ADC_Init_TypeDef init = ADC_INIT_DEFAULT;
+  ADC_InitSingle_TypeDef initSingle = ADC_INITSINGLE_DEFAULT;
+
+  // Enable ADC clock
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  CMU_ClockEnable(cmuClock_HFPER, true);
+
+  // Select AUXHFRCO for ADC ASYNC mode so it can run in EM2
+  CMU->ADCCTRL = CMU_ADCCTRL_ADC0CLKSEL_AUXHFRCO;
+
+  // Set AUXHFRCO frequency and use it to setup the ADC
+  CMU_AUXHFRCOFreqSet(cmuAUXHFRCOFreq_4M0Hz);
+  init.timebase = ADC_TimebaseCalc(CMU_AUXHFRCOBandGet());
+  init.prescale = ADC_PrescaleCalc(ADC_FREQ, CMU_AUXHFRCOBandGet());
+
+  // Let the ADC enable its clock on demand in EM2
+  init.em2ClockConfig = adcEm2ClockOnDemand;
+
+  // Initialize ADC
+  ADC_Init(ADC0, &init);
+
+  // Set the ADC to use single ended mode
+  initSingle.diff       = 0;            // Single ended
+  initSingle.reference  = adcRef2V5;    // Internal 2.5V reference
+  initSingle.resolution = adcRes12Bit;  // 12-bit resolution
+  initSingle.acqTime    = adcAcqTime16;
+  initSingle.posSel     = ADC_INPUT;    // Same pin as the opamp output
+
+  // Conversions are started by PRS, and the LDMA wakes up in EM2 to read
+  // the results
+  initSingle.prsEnable      = true;
+  initSingle.prsSel         = (ADC_PRSSEL_TypeDef) PRS_CHANNEL;
+  initSingle.singleDmaEm2Wu = true;
+
+  ADC_InitSingle(ADC0, &initSingle);
+
+  // Set the single data valid level (DVL) and clear the single FIFO
+  ADC0->SINGLECTRLX = (ADC0->SINGLECTRLX & ~_ADC_SINGLECTRLX_DVL_MASK)
+                      | ((ADC_DVL - 1) << _ADC_SINGLECTRLX_DVL_SHIFT);
+  ADC0->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Initialize OPAMP
+ *****************************************************************************/
+void initOpamp(void)
+{
+  // Configure OPA1
+  OPAMP_Init_TypeDef init = OPA_INIT_NON_INVERTING;
+  init.resInMux = opaResInMuxVss;       // Set the input to the resistor ladder to VSS
+  init.resSel   = rangeResSel[rangeConfig.initialRange]; // Starting ratio
+  init.outMode  = OPA_OUT_MODE;         // Route opamp output to the ADC input
+
+  // Enable OPA1
+  OPAMP_Enable(VDAC0, OPA_INDEX, &init);
+}
+
+/**************************************************************************//**
+ * @brief
+ *    Main function
+ *
+ * @note
+ *    The input to the resistor ladder must be set to ground for a non-inverting
+ *    opamp configuration (either by setting RESINMUX to VSS or by setting
+ *    RESINMUX to NEGPAD and then connecting the negative pad (in this case
+ *    OPAMP_N1) to ground.
+ *****************************************************************************/
+int main(void)
+{
+  // Chip errata
+  CHIP_Init();
+
+  // Init DCDC regulator if available
+  EMU_DCDCInit_TypeDef dcdcInit = EMU_DCDCINIT_DEFAULT;
+  EMU_DCDCInit(&dcdcInit);
+
+  // Ranging starts at the initial gain
+  rangeStatus = opaRangeInit(&range, &rangeConfig);
+  if (rangeStatus != opaRangeOk)
+  {
+    // Loop here to enable the debugger to see what has happened
+    while (1);
+  }
+
+  // Enable the VDAC clock for accessing the opamp registers
+  CMU_ClockEnable(cmuClock_VDAC0, true); // Enable VDAC clock
+
+  // Initialize the opamp and ADC
+  initOpamp();
+  initAdc();
+
+  // Conversions of the opamp output via PRS, streamed into frames
+  initLdma();
+  // Set up LETIMER to trigger ADC via PRS in periodic intervals
+  initLetimer();
+
+  // Infinite loop
+  while (1)
+  {
+    // Enter EM2 until the next frame is filled
+    EMU_EnterEM2(false);
+
+    // Find the range of the filled frames
+    ldmaStreamProcess(&stream);
+  }
+}
@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file opa_range.c
+ * @brief Gain auto-ranging of an OPAMP in front of the ADC, per frame.
+ *
+ * The OPAMP gain is picked from a table of ranges, the resistor ladder
+ * ratios of a non-inverting amplifier, so that a small signal uses most of
+ * the ADC codes instead of being oversampled to get the same resolution
+ * back. The ADC results come by DMA in frames, and the gain only changes
+ * between two frames, so that each frame is tagged with the one gain its
+ * results were taken with:
+ *   - opaRangeBoundary() is called from the DMA interrupt at the end of a
+ *     frame, with the buffer now being filled. It applies the target range
+ *     if it differs from the range of the OPAMP, and tags the new buffer
+ *     with the range and the number of results to skip while the OPAMP
+ *     output settles, which must also cover the interrupt latency. If more
+ *     than one frame went by since the last call, the interrupt came too
+ *     late to know which result is the first at the new gain, so the switch
+ *     waits for the next boundary
+ *   - opaRangeFrame() is called by whoever consumes a frame. It gives the
+ *     tag of the frame with the peak of its valid results, and sets the
+ *     target range: downRanges lower than that of the frame if a result
+ *     clipped, or one higher once upFrames frames in a row would have
+ *     peaked below upCode with the next gain
+ *
+ * upCode below clipCode is the hysteresis: after a step up, the signal must
+ * grow by clipCode / upCode before a step down, so a steady signal does not
+ * switch back and forth. Frames are consumed while later ones are filled,
+ * so a decision takes effect one or two frames later; frames taken before
+ * the target changed do not count toward a step up.
+ *
+ * opaRangeToInput() turns a result of a tagged frame back into the input
+ * of the OPAMP.
+ * @version 0.0.1
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2018 Silicon Labs, Inc. http://www.silabs.com</b>
+ *******************************************************************************
+ *
+ * This file is licensed under the Silabs License Agreement. See the file
+ * "Silabs_License_Agreement.txt" for details. Before using this software for
+ * any purpose, you must agree to the terms of that agreement.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "opa_range.h"
+
+static uint32_t nextBuffer(const opaRange_TypeDef *range, uint32_t buffer)
+{
+  return (buffer + 1 < range->config.bufferCount) ? buffer + 1 : 0;
+}
+
+static void tagBuffer(opaRange_TypeDef *range, uint32_t buffer,
+                      uint32_t settle)
+{
+  range->tags[buffer].range = range->applied;
+  range->tags[buffer].settle = settle;
+  range->tags[buffer].peak = 0;
+  range->tags[buffer].clipped = 0;
+}
+
+opaRangeStatus_TypeDef opaRangeInit(opaRange_TypeDef *range,
+                                    const opaRangeConfig_TypeDef *config)
+{
+  uint32_t i;
+
+  if ((config->gains == NULL)
+      || (config->rangeCount == 0)
+      || (config->rangeCount > OPA_RANGE_MAX_RANGES)
+      || (config->initialRange >= config->rangeCount)
+      || (config->bufferCount < 2)
+      || (config->bufferCount > OPA_RANGE_MAX_BUFFERS)
+      || (config->clipCode == 0)
+      || (config->clipCode >= OPA_RANGE_CODES)
+      || (config->upCode == 0)
+      || (config->upCode >= config->clipCode)
+      || (config->upFrames == 0)
+      || (config->downRanges == 0)) {
+    return opaRangeBadConfig;
+  }
+  for (i = 0; i < config->rangeCount; i++) {
+    const opaRangeGain_TypeDef *gain = &config->gains[i];
+
+    if ((gain->num == 0) || (gain->den == 0)) {
+      return opaRangeBadConfig;
+    }
+    // Each gain above the one before: num / den > prev.num / prev.den
+    if ((i > 0) && ((uint32_t)gain->num * config->gains[i - 1].den
+                    <= (uint32_t)config->gains[i - 1].num * gain->den)) {
+      return opaRangeBadConfig;
+    }
+  }
+
+  memset(range, 0, sizeof(*range));
+  range->config = *config;
+  range->applied = config->initialRange;
+  range->target = config->initialRange;
+
+  // The OPAMP is enabled just before the stream starts, so the first frame
+  // also waits for it to settle
+  for (i = 0; i < config->bufferCount; i++) {
+    tagBuffer(range, i, 0);
+  }
+  range->tags[0].settle = config->settleSamples;
+  return opaRangeOk;
+}
+
+bool opaRangeBoundary(opaRange_TypeDef *range, uint32_t buffer)
+{
+  uint32_t b;
+  bool late;
+  bool apply;
+
+  if ((buffer >= range->config.bufferCount) || (buffer == range->filling)) {
+    return false;
+  }
+
+  // Buffers skipped over were filled at the range of the OPAMP
+  late = (buffer != nextBuffer(range, range->filling));
+  for (b = nextBuffer(range, range->filling); b != buffer;
+       b = nextBuffer(range, b)) {
+    tagBuffer(range, b, 0);
+  }
+  if (late) {
+    range->lateBoundaries++;
+  }
+
+  apply = !late && (range->target != range->applied);
+  if (apply) {
+    range->applied = range->target;
+    range->switches++;
+  }
+  tagBuffer(range, buffer, apply ? range->config.settleSamples : 0);
+  range->filling = buffer;
+  return apply;
+}
+
+void opaRangeFrame(opaRange_TypeDef *range, uint32_t buffer,
+                   const uint16_t *codes, uint32_t length,
+                   opaRangeTag_TypeDef *tag)
+{
+  const opaRangeConfig_TypeDef *config = &range->config;
+  const opaRangeGain_TypeDef *gain;
+  const opaRangeGain_TypeDef *next;
+  uint32_t peak = 0;
+  uint32_t clipped = 0;
+  uint32_t i;
+  uint32_t r;
+
+  *tag = range->tags[buffer % config->bufferCount];
+  for (i = tag->settle; i < length; i++) {
+    if (codes[i] > peak) {
+      peak = codes[i];
+    }
+    if (codes[i] >= config->clipCode) {
+      clipped++;
+    }
+  }
+  tag->peak = peak;
+  tag->clipped = clipped;
+
+  // No valid result to decide on
+  if (tag->settle >= length) {
+    return;
+  }
+
+  r = tag->range;
+  if (clipped > 0) {
+    r = (r > config->downRanges) ? r - config->downRanges : 0;
+    if (r < range->target) {
+      range->target = r;
+    }
+    range->upCount = 0;
+  } else if ((r == range->target) && (r + 1 < config->rangeCount)) {
+    // Peak with the next gain below upCode:
+    // peak * next.num / next.den < upCode * gain.num / gain.den
+    gain = &config->gains[r];
+    next = &config->gains[r + 1];
+    if ((uint64_t)peak * next->num * gain->den
+        < (uint64_t)config->upCode * gain->num * next->den) {
+      range->upCount++;
+      if (range->upCount >= config->upFrames) {
+        range->target = r + 1;
+        range->upCount = 0;
+      }
+    } else {
+      range->upCount = 0;
+    }
+  } else {
+    range->upCount = 0;
+  }
+}
+
+uint32_t opaRangeToInput(const opaRange_TypeDef *range,
+                         const opaRangeTag_TypeDef *tag, uint32_t code,
+                         uint32_t fullScale)
+{
+  const opaRangeGain_TypeDef *gain = &range->config.gains[tag->range];
+  uint64_t num = (uint64_t)code * fullScale * gain->den;
+  uint64_t den = (uint64_t)gain->num * OPA_RANGE_CODES;
+
+  return (uint32_t)((num + den / 2) / den);
+}